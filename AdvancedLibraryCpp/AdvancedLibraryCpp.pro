@@ -26,23 +26,39 @@ HEADERS += \
         concurrency/semaphore.h \
         concurrency/thread.h \
         concurrency/timer.h \
+        structures/adaptive_radix_tree.h \
+        structures/b_plus_tree.h \
         structures/binary_tree.h \
         structures/cache.h \
+        structures/cache_snapshot.h \
         structures/command.h \
+        structures/compact_avl_tree.h \
+        structures/concurrent_skip_list.h \
         structures/fenwick_tree.h \
+        structures/flat_tree.h \
         structures/heap.h \
+        structures/interval_tree.h \
+        structures/loading_cache.h \
+        structures/node_allocator.h \
+        structures/persistent_avl_tree.h \
         structures/segment_tree.h \
+        structures/static_search_tree.h \
         structures/tree.h \
+        structures/tree_index.h \
+        structures/tree_serialization.h \
         structures/union_find.h \
         structures/union_set.h \
         test/test_read_csv.h \
         tools/delimiters.h \
         tools/divisors.h \
         tools/enum_factory.h \
+        tools/mapped_file.h \
         tools/math_operation.h \
         tools/memory.h \
+        tools/miss_ratio_curve.h \
         tools/random.h \
         tools/read_csv.h \
+        tools/sorted_range.h \
         tools/timestamp.h \
         tools/types.h
 
@@ -61,21 +77,35 @@ testmode {
                 test/test_subset.h \
                 test/simple_protocol_moc.h \
                 test/simple_worker_moc.h \
+                test/lookup_data.h \
                 test/test_binary_tree.h \
                 test/test_avl_tree.h \
+                test/test_b_plus_tree.h \
+                test/test_adaptive_radix_tree.h \
+                test/test_flat_tree.h \
+                test/test_compact_avl_tree.h \
+                test/test_concurrent_skip_list.h \
+                test/test_persistent_avl_tree.h \
+                test/test_static_search_tree.h \
+                test/test_interval_tree.h \
                 test/test_command.h \
                 test/test_fenwick_tree.h \
                 test/test_heap.h \
                 test/test_lru_cache.h \
+                test/test_loading_cache.h \
+                test/test_cache_snapshot.h \
                 test/test_message_queue.h \
                 test/test_segment_tree.h \
                 test/test_semaphore.h \
                 test/test_timer.h \
                 test/test_tree.h \
+                test/test_tree_index.h \
+                test/test_tree_serialization.h \
                 test/test_union_find.h \
                 test/test_union_set.h \
                 test/test_wrapper_thread.h \
                 test/test_math.h \
+                test/test_miss_ratio_curve.h \
                 test/test_timestamp.h \
                 test/test_lockable.h
     SOURCES  += \
@@ -92,16 +122,29 @@ testmode {
                 test/test_fenwick_tree.cpp \
                 test/test_heap.cpp \
                 test/test_lru_cache.cpp \
+                test/test_loading_cache.cpp \
+                test/test_cache_snapshot.cpp \
                 test/test_message_queue.cpp \
                 test/test_segment_tree.cpp \
                 test/test_semaphore.cpp \
                 test/test_timer.cpp \
                 test/test_tree.cpp \
+                test/test_tree_index.cpp \
+                test/test_tree_serialization.cpp \
                 test/test_union_find.cpp \
                 test/test_union_set.cpp \
                 test/test_wrapper_thread.cpp \
                 test/test_avl_tree.cpp \
+                test/test_b_plus_tree.cpp \
+                test/test_adaptive_radix_tree.cpp \
+                test/test_flat_tree.cpp \
+                test/test_compact_avl_tree.cpp \
+                test/test_concurrent_skip_list.cpp \
+                test/test_persistent_avl_tree.cpp \
+                test/test_static_search_tree.cpp \
+                test/test_interval_tree.cpp \
                 test/test_math.cpp \
+                test/test_miss_ratio_curve.cpp \
                 test/test_timestamp.cpp \
                 test/tests.cpp
 
@@ -0,0 +1,939 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace advanced {
+namespace structures {
+
+/** @test TestAdaptiveRadixTree in test/test_adaptive_radix_tree(.h|.cpp) */
+
+/**
+ * @brief Adaptive radix tree (Leis, Kemper and Neumann), a map from string
+ * keys to T for prefix lookups. Every inner node branches on one byte of the
+ * key and takes the smallest layout for its number of children:
+ *
+ * - node4:   up to 4 sorted keys and children, searched linearly
+ * - node16:  up to 16 sorted keys, searched with one SSE2 comparison
+ * - node48:  a 256 bytes index into up to 48 children
+ * - node256: 256 children indexed by the byte
+ *
+ * Nodes grow and shrink between the layouts as children come and go. Chains
+ * of nodes with a single child are compressed in the prefix of the next node
+ * (path compression), so the height depends on the keys and not on their
+ * length. A key that is a prefix of other keys is kept in the inner node
+ * where it ends.
+ *
+ * The visits are in lexicographic order of the keys, the same order than
+ * std::string::operator<.
+ */
+template <class T>
+class adaptive_radix_tree_t {
+public:
+  using key_type    = std::string;
+  using mapped_type = T;
+  using value_type  = std::pair<const std::string, T>;
+
+  adaptive_radix_tree_t() = default;
+
+  adaptive_radix_tree_t(const adaptive_radix_tree_t& other)
+    : _root{ clone(other._root) }, _size{ other._size }
+  { }
+
+  adaptive_radix_tree_t(adaptive_radix_tree_t&& other) noexcept
+    : _root{ other._root }, _size{ other._size }
+  {
+    other._root = nullptr;
+    other._size = 0;
+  }
+
+  adaptive_radix_tree_t&
+  operator=(const adaptive_radix_tree_t& other) {
+    if (this != &other) {
+      *this = adaptive_radix_tree_t{ other };
+    }
+    return *this;
+  }
+
+  adaptive_radix_tree_t&
+  operator=(adaptive_radix_tree_t&& other) noexcept {
+    if (this != &other) {
+      clear();
+      std::swap(_root, other._root);
+      std::swap(_size, other._size);
+    }
+    return *this;
+  }
+
+  ~adaptive_radix_tree_t() {
+    clear();
+  }
+
+  /**
+   * @brief insert  it inserts key with value if key is not in the tree yet
+   * @return whether it was inserted
+   */
+  bool
+  insert(const std::string& key, const T& value) {
+    return emplace(key, value, false);
+  }
+
+  /**
+   * @brief insert_or_assign  it inserts key with value, or replaces the value
+   * of key if it is already in the tree
+   * @return whether it was inserted
+   */
+  bool
+  insert_or_assign(const std::string& key, const T& value) {
+    return emplace(key, value, true);
+  }
+
+  /**
+   * @brief find  the key and value of key, nullptr if it is not in the tree
+   */
+  value_type*
+  find(const std::string& key) {
+    return const_cast<value_type*>(
+      static_cast<const adaptive_radix_tree_t*>(this)->find(key));
+  }
+
+  const value_type*
+  find(const std::string& key) const {
+    const node_t* node { _root };
+    size_t        depth{ 0 };
+    while (node) {
+      if (node->kind == kind_t::leaf) {
+        const leaf_t* leaf{ static_cast<const leaf_t*>(node) };
+        return leaf->value.first == key ? &leaf->value : nullptr;
+      }
+      const inner_t* inner{ static_cast<const inner_t*>(node) };
+      if (!matches(*inner, key, depth)) {
+        return nullptr;
+      }
+      depth += inner->prefix.size();
+      if (depth == key.size()) {
+        return inner->leaf ? &inner->leaf->value : nullptr;
+      }
+      node_t* const* child{ find_child(inner, byte_at(key, depth++)) };
+      node = child ? *child : nullptr;
+    }
+    return nullptr;
+  }
+
+  inline bool
+  contains(const std::string& key) const {
+    return find(key) != nullptr;
+  }
+
+  /**
+   * @brief remove  it removes key, the nodes left with few children shrink
+   * and the ones left with a single child are merged with it
+   * @return whether key was in the tree
+   */
+  bool
+  remove(const std::string& key) {
+    node_t** ref   { &_root };
+    node_t** parent{ nullptr };
+    size_t   depth { 0 };
+    uint8_t  byte  { 0 };
+    while (*ref) {
+      if ((*ref)->kind == kind_t::leaf) {
+        leaf_t* leaf{ static_cast<leaf_t*>(*ref) };
+        if (leaf->value.first != key) {
+          return false;
+        }
+        if (parent) {
+          remove_child(*parent, byte);
+        }
+        else {
+          _root = nullptr;
+        }
+        delete leaf;
+        _size--;
+        if (parent) {
+          collapse(*parent);
+        }
+        return true;
+      }
+      inner_t* inner{ static_cast<inner_t*>(*ref) };
+      if (!matches(*inner, key, depth)) {
+        return false;
+      }
+      depth += inner->prefix.size();
+      if (depth == key.size()) {
+        if (!inner->leaf) {
+          return false;
+        }
+        delete inner->leaf;
+        inner->leaf = nullptr;
+        _size--;
+        collapse(*ref);
+        return true;
+      }
+      byte = byte_at(key, depth++);
+      node_t** child{ find_child(inner, byte) };
+      if (!child) {
+        return false;
+      }
+      parent = ref;
+      ref    = child;
+    }
+    return false;
+  }
+
+  /**
+   * @brief longest_prefix_match  the longest key of the tree that is a prefix
+   * of key, e.g. the route of an address
+   * @return nullptr if no key is a prefix of key
+   */
+  const value_type*
+  longest_prefix_match(const std::string& key) const {
+    const value_type* longest{ nullptr };
+    const node_t*     node   { _root };
+    size_t            depth  { 0 };
+    while (node) {
+      if (node->kind == kind_t::leaf) {
+        const leaf_t* leaf{ static_cast<const leaf_t*>(node) };
+        const std::string& candidate{ leaf->value.first };
+        if (candidate.size() <= key.size() &&
+            key.compare(0, candidate.size(), candidate) == 0) {
+          longest = &leaf->value;
+        }
+        break;
+      }
+      const inner_t* inner{ static_cast<const inner_t*>(node) };
+      if (!matches(*inner, key, depth)) {
+        break;
+      }
+      depth += inner->prefix.size();
+      if (inner->leaf) {
+        longest = &inner->leaf->value;
+      }
+      if (depth == key.size()) {
+        break;
+      }
+      node_t* const* child{ find_child(inner, byte_at(key, depth++)) };
+      node = child ? *child : nullptr;
+    }
+    return longest;
+  }
+
+  /**
+   * @brief for_each_prefix  it calls visitor(const value_type&) for the keys
+   * starting with prefix in order, until it returns true
+   * @return the number of visited keys
+   */
+  template <class visitor_t>
+  size_t
+  for_each_prefix(const std::string& prefix, visitor_t&& visitor) const {
+    const node_t* node { _root };
+    size_t        depth{ 0 };
+    size_t        visited{ 0 };
+    while (node) {
+      if (node->kind == kind_t::leaf) {
+        const std::string& key{ static_cast<const leaf_t*>(node)->value.first };
+        if (key.compare(0, prefix.size(), prefix) == 0) {
+          visit(node, visitor, visited);
+        }
+        break;
+      }
+      const inner_t* inner{ static_cast<const inner_t*>(node) };
+      // the prefix may end inside the prefix of the node
+      const size_t length{ std::min(prefix.size() - depth, inner->prefix.size()) };
+      if (prefix.compare(depth, length, inner->prefix, 0, length) != 0) {
+        break;
+      }
+      depth += inner->prefix.size();
+      if (depth >= prefix.size()) {
+        visit(node, visitor, visited);
+        break;
+      }
+      node_t* const* child{ find_child(inner, byte_at(prefix, depth++)) };
+      node = child ? *child : nullptr;
+    }
+    return visited;
+  }
+
+  /**
+   * @brief for_each  it calls visitor(const value_type&) for all the keys in
+   * order, until it returns true
+   * @return the number of visited keys
+   */
+  template <class visitor_t>
+  size_t
+  for_each(visitor_t&& visitor) const {
+    size_t visited{ 0 };
+    if (_root) {
+      visit(_root, visitor, visited);
+    }
+    return visited;
+  }
+
+  inline size_t
+  size() const noexcept {
+    return _size;
+  }
+
+  inline bool
+  empty() const noexcept {
+    return _size == 0;
+  }
+
+  void
+  clear() noexcept {
+    destroy(_root);
+    _root = nullptr;
+    _size = 0;
+  }
+
+private:
+  enum class kind_t : uint8_t {
+    leaf,
+    node4,
+    node16,
+    node48,
+    node256
+  };
+
+  struct node_t {
+    explicit node_t(kind_t k) : kind{ k } { }
+
+    kind_t kind;
+  };
+
+  struct leaf_t : node_t {
+    leaf_t(const std::string& key, const T& v)
+      : node_t{ kind_t::leaf }, value{ key, v }
+    { }
+
+    value_type value;
+  };
+
+  struct inner_t : node_t {
+    explicit inner_t(kind_t k) : node_t{ k } { }
+
+    uint16_t    count{ 0 };         // children, the leaf is not counted
+    std::string prefix;             // compressed path before the branch byte
+    leaf_t*     leaf { nullptr };   // key ending in this node
+  };
+
+  struct node4_t : inner_t {
+    static constexpr size_t capacity{ 4 };
+
+    node4_t() : inner_t{ kind_t::node4 } { }
+
+    std::array<uint8_t, capacity> keys    { };
+    std::array<node_t*, capacity> children{ };
+  };
+
+  struct node16_t : inner_t {
+    static constexpr size_t capacity{ 16 };
+
+    node16_t() : inner_t{ kind_t::node16 } { }
+
+    alignas(16) std::array<uint8_t, capacity> keys{ };
+    std::array<node_t*, capacity>             children{ };
+  };
+
+  /**
+   * index[byte] is the position of the child plus one, 0 if there is no child
+   */
+  struct node48_t : inner_t {
+    static constexpr size_t capacity{ 48 };
+
+    node48_t() : inner_t{ kind_t::node48 } { }
+
+    std::array<uint8_t, 256>      index   { };
+    std::array<node_t*, capacity> children{ };
+  };
+
+  struct node256_t : inner_t {
+    node256_t() : inner_t{ kind_t::node256 } { }
+
+    std::array<node_t*, 256> children{ };
+  };
+
+  /**
+   * the nodes shrink below these counts, lower than the capacity of the
+   * smaller layout so a node does not bounce between two layouts
+   */
+  static constexpr size_t shrink16 { 3 };
+  static constexpr size_t shrink48 { 12 };
+  static constexpr size_t shrink256{ 37 };
+
+  inline static uint8_t
+  byte_at(const std::string& key, size_t position) {
+    return static_cast<uint8_t>(key[position]);
+  }
+
+  /**
+   * @brief matches  whether key continues with the prefix of node at depth
+   */
+  inline static bool
+  matches(const inner_t& node, const std::string& key, size_t depth) {
+    return key.size() - depth >= node.prefix.size() &&
+           key.compare(depth, node.prefix.size(), node.prefix) == 0;
+  }
+
+  bool
+  emplace(const std::string& key, const T& value, bool assign) {
+    node_t** ref  { &_root };
+    size_t   depth{ 0 };
+    while (*ref) {
+      if ((*ref)->kind == kind_t::leaf) {
+        leaf_t* leaf{ static_cast<leaf_t*>(*ref) };
+        if (leaf->value.first == key) {
+          if (assign) {
+            leaf->value.second = value;
+          }
+          return false;
+        }
+        split_leaf(*ref, depth, new leaf_t{ key, value });
+        _size++;
+        return true;
+      }
+      inner_t*     inner{ static_cast<inner_t*>(*ref) };
+      const size_t common{ common_prefix(inner->prefix, 0, key, depth) };
+      if (common < inner->prefix.size()) {
+        split_prefix(*ref, common, depth, new leaf_t{ key, value });
+        _size++;
+        return true;
+      }
+      depth += common;
+      if (depth == key.size()) {
+        if (inner->leaf) {
+          if (assign) {
+            inner->leaf->value.second = value;
+          }
+          return false;
+        }
+        inner->leaf = new leaf_t{ key, value };
+        _size++;
+        return true;
+      }
+      const uint8_t byte{ byte_at(key, depth++) };
+      node_t**      child{ find_child(inner, byte) };
+      if (!child) {
+        leaf_t* leaf{ new leaf_t{ key, value } };
+        try {
+          add_child(*ref, byte, leaf);
+        }
+        catch (...) {
+          delete leaf;
+          throw;
+        }
+        _size++;
+        return true;
+      }
+      ref = child;
+    }
+    *ref = new leaf_t{ key, value };
+    _size++;
+    return true;
+  }
+
+  inline static size_t
+  common_prefix(const std::string& a, size_t from_a, const std::string& b, size_t from_b) {
+    const size_t length{ std::min(a.size() - from_a, b.size() - from_b) };
+    size_t       common{ 0 };
+    while (common < length && a[from_a + common] == b[from_b + common]) {
+      common++;
+    }
+    return common;
+  }
+
+  /**
+   * @brief split_leaf  ref holds a leaf with other key than created, both go
+   * under a new node4 with their common prefix
+   */
+  void
+  split_leaf(node_t*& ref, size_t depth, leaf_t* created) {
+    leaf_t*      leaf  { static_cast<leaf_t*>(ref) };
+    const size_t common{ common_prefix(leaf->value.first, depth, created->value.first, depth) };
+    node4_t*     node  { nullptr };
+    try {
+      node = new node4_t{ };
+      node->prefix = created->value.first.substr(depth, common);
+    }
+    catch (...) {
+      delete node;
+      delete created;
+      throw;
+    }
+    depth += common;
+    for (leaf_t* child : { leaf, created }) {
+      if (child->value.first.size() == depth) {
+        node->leaf = child;
+      }
+      else {
+        insert_sorted(node, byte_at(child->value.first, depth), child);
+      }
+    }
+    ref = node;
+  }
+
+  /**
+   * @brief split_prefix  the key of created differs from the prefix of the
+   * node in ref after common bytes: a new node4 takes the common part
+   */
+  void
+  split_prefix(node_t*& ref, size_t common, size_t depth, leaf_t* created) {
+    inner_t* inner{ static_cast<inner_t*>(ref) };
+    node4_t* node { nullptr };
+    try {
+      node = new node4_t{ };
+      node->prefix = inner->prefix.substr(0, common);
+    }
+    catch (...) {
+      delete node;
+      delete created;
+      throw;
+    }
+    const uint8_t byte{ static_cast<uint8_t>(inner->prefix[common]) };
+    inner->prefix.erase(0, common + 1);
+    insert_sorted(node, byte, inner);
+    depth += common;
+    if (created->value.first.size() == depth) {
+      node->leaf = created;
+    }
+    else {
+      insert_sorted(node, byte_at(created->value.first, depth), created);
+    }
+    ref = node;
+  }
+
+  /**
+   * @brief find16  position of byte in the keys of a node16, count if it is
+   * not there. The 16 keys are compared at once.
+   */
+  inline static size_t
+  find16(const uint8_t* keys, size_t count, uint8_t byte) {
+#if defined(__SSE2__)
+    const __m128i    all    { _mm_loadu_si128(reinterpret_cast<const __m128i*>(keys)) };
+    const __m128i    equal  { _mm_cmpeq_epi8(all, _mm_set1_epi8(static_cast<char>(byte))) };
+    const unsigned   mask   { static_cast<unsigned>(_mm_movemask_epi8(equal)) &
+                              ((1u << count) - 1u) };
+    return mask ? static_cast<size_t>(__builtin_ctz(mask)) : count;
+#else
+    size_t position{ 0 };
+    while (position < count && keys[position] != byte) {
+      position++;
+    }
+    return position;
+#endif
+  }
+
+  static node_t**
+  find_child(inner_t* node, uint8_t byte) {
+    switch (node->kind) {
+    case kind_t::node4: {
+      node4_t* node4{ static_cast<node4_t*>(node) };
+      for (size_t ii = 0; ii < node4->count; ii++) {
+        if (node4->keys[ii] == byte) {
+          return &node4->children[ii];
+        }
+      }
+      return nullptr;
+    }
+    case kind_t::node16: {
+      node16_t*    node16{ static_cast<node16_t*>(node) };
+      const size_t position{ find16(node16->keys.data(), node16->count, byte) };
+      return position < node16->count ? &node16->children[position] : nullptr;
+    }
+    case kind_t::node48: {
+      node48_t*     node48{ static_cast<node48_t*>(node) };
+      const uint8_t slot  { node48->index[byte] };
+      return slot ? &node48->children[slot - 1u] : nullptr;
+    }
+    case kind_t::node256: {
+      node256_t* node256{ static_cast<node256_t*>(node) };
+      return node256->children[byte] ? &node256->children[byte] : nullptr;
+    }
+    default:
+      return nullptr;
+    }
+  }
+
+  inline static node_t* const*
+  find_child(const inner_t* node, uint8_t byte) {
+    return find_child(const_cast<inner_t*>(node), byte);
+  }
+
+  template <class node_type>
+  static void
+  insert_sorted(node_type* node, uint8_t byte, node_t* child) {
+    size_t position{ 0 };
+    while (position < node->count && node->keys[position] < byte) {
+      position++;
+    }
+    std::copy_backward(node->keys.begin() + position, node->keys.begin() + node->count,
+                       node->keys.begin() + node->count + 1);
+    std::copy_backward(node->children.begin() + position,
+                       node->children.begin() + node->count,
+                       node->children.begin() + node->count + 1);
+    node->keys[position]     = byte;
+    node->children[position] = child;
+    node->count++;
+  }
+
+  template <class node_type>
+  static void
+  erase_sorted(node_type* node, uint8_t byte) {
+    size_t position{ 0 };
+    while (node->keys[position] != byte) {
+      position++;
+    }
+    std::copy(node->keys.begin() + position + 1, node->keys.begin() + node->count,
+              node->keys.begin() + position);
+    std::copy(node->children.begin() + position + 1,
+              node->children.begin() + node->count,
+              node->children.begin() + position);
+    node->count--;
+    node->children[node->count] = nullptr;
+  }
+
+  /**
+   * @brief move_header  the new layout takes the prefix and the leaf
+   */
+  inline static void
+  move_header(inner_t* from, inner_t* to) {
+    to->prefix = std::move(from->prefix);
+    to->leaf   = from->leaf;
+  }
+
+  /**
+   * @brief add_child  it adds child at byte to the node in ref, replacing the
+   * node by the next layout if it is full
+   */
+  static void
+  add_child(node_t*& ref, uint8_t byte, node_t* child) {
+    switch (ref->kind) {
+    case kind_t::node4: {
+      node4_t* node4{ static_cast<node4_t*>(ref) };
+      if (node4->count < node4_t::capacity) {
+        insert_sorted(node4, byte, child);
+        return;
+      }
+      node16_t* node16{ new node16_t{ } };
+      move_header(node4, node16);
+      std::copy(node4->keys.begin(), node4->keys.end(), node16->keys.begin());
+      std::copy(node4->children.begin(), node4->children.end(), node16->children.begin());
+      node16->count = node4->count;
+      insert_sorted(node16, byte, child);
+      delete node4;
+      ref = node16;
+      return;
+    }
+    case kind_t::node16: {
+      node16_t* node16{ static_cast<node16_t*>(ref) };
+      if (node16->count < node16_t::capacity) {
+        insert_sorted(node16, byte, child);
+        return;
+      }
+      node48_t* node48{ new node48_t{ } };
+      move_header(node16, node48);
+      for (size_t ii = 0; ii < node16->count; ii++) {
+        node48->index[node16->keys[ii]] = static_cast<uint8_t>(ii + 1);
+        node48->children[ii]            = node16->children[ii];
+      }
+      node48->count = node16->count;
+      delete node16;
+      ref = node48;
+      add_child(ref, byte, child);
+      return;
+    }
+    case kind_t::node48: {
+      node48_t* node48{ static_cast<node48_t*>(ref) };
+      if (node48->count < node48_t::capacity) {
+        // removals leave holes, the first free position is taken
+        size_t slot{ 0 };
+        while (node48->children[slot]) {
+          slot++;
+        }
+        node48->children[slot] = child;
+        node48->index[byte]    = static_cast<uint8_t>(slot + 1);
+        node48->count++;
+        return;
+      }
+      node256_t* node256{ new node256_t{ } };
+      move_header(node48, node256);
+      for (size_t key = 0; key < 256; key++) {
+        if (node48->index[key]) {
+          node256->children[key] = node48->children[node48->index[key] - 1u];
+        }
+      }
+      node256->count = node48->count;
+      delete node48;
+      ref = node256;
+      add_child(ref, byte, child);
+      return;
+    }
+    case kind_t::node256: {
+      node256_t* node256{ static_cast<node256_t*>(ref) };
+      node256->children[byte] = child;
+      node256->count++;
+      return;
+    }
+    default:
+      return;
+    }
+  }
+
+  /**
+   * @brief remove_child  it removes the child at byte of the node in ref, the
+   * node takes the previous layout when it has few children left. The smaller
+   * node is allocated before anything changes, so if it throws the node is
+   * left as it is.
+   */
+  static void
+  remove_child(node_t*& ref, uint8_t byte) {
+    switch (ref->kind) {
+    case kind_t::node4:
+      erase_sorted(static_cast<node4_t*>(ref), byte);
+      return;
+    case kind_t::node16: {
+      node16_t* node16{ static_cast<node16_t*>(ref) };
+      node4_t*  node4 { node16->count - 1u <= shrink16 ? new node4_t{ } : nullptr };
+      erase_sorted(node16, byte);
+      if (node4) {
+        move_header(node16, node4);
+        std::copy(node16->keys.begin(), node16->keys.begin() + node16->count, node4->keys.begin());
+        std::copy(node16->children.begin(), node16->children.begin() + node16->count,
+                  node4->children.begin());
+        node4->count = node16->count;
+        delete node16;
+        ref = node4;
+      }
+      return;
+    }
+    case kind_t::node48: {
+      node48_t* node48{ static_cast<node48_t*>(ref) };
+      node16_t* node16{ node48->count - 1u <= shrink48 ? new node16_t{ } : nullptr };
+      node48->children[node48->index[byte] - 1u] = nullptr;
+      node48->index[byte] = 0;
+      node48->count--;
+      if (node16) {
+        move_header(node48, node16);
+        for (size_t key = 0; key < 256; key++) {
+          if (node48->index[key]) {
+            node16->keys[node16->count]     = static_cast<uint8_t>(key);
+            node16->children[node16->count] = node48->children[node48->index[key] - 1u];
+            node16->count++;
+          }
+        }
+        delete node48;
+        ref = node16;
+      }
+      return;
+    }
+    case kind_t::node256: {
+      node256_t* node256{ static_cast<node256_t*>(ref) };
+      node48_t*  node48 { node256->count - 1u <= shrink256 ? new node48_t{ } : nullptr };
+      node256->children[byte] = nullptr;
+      node256->count--;
+      if (node48) {
+        move_header(node256, node48);
+        for (size_t key = 0; key < 256; key++) {
+          if (node256->children[key]) {
+            node48->children[node48->count] = node256->children[key];
+            node48->index[key]              = static_cast<uint8_t>(++node48->count);
+          }
+        }
+        delete node256;
+        ref = node48;
+      }
+      return;
+    }
+    default:
+      return;
+    }
+  }
+
+  /**
+   * @brief collapse  after a removal, a node without children is replaced by
+   * its leaf, and a node with a single child and no leaf is merged with it
+   */
+  static void
+  collapse(node_t*& ref) {
+    inner_t* inner{ static_cast<inner_t*>(ref) };
+    if (inner->count == 0) {
+      ref = inner->leaf;
+      delete_node(inner);
+    }
+    else if (inner->count == 1 && !inner->leaf) {
+      uint8_t byte { 0 };
+      node_t* child{ nullptr };
+      for_each_child(inner, [&byte, &child](uint8_t key, const node_t* node) {
+        byte  = key;
+        child = const_cast<node_t*>(node);
+        return true;
+      });
+      if (child->kind != kind_t::leaf) {
+        // the prefix is built apart, so the child is unchanged if it throws
+        inner_t*    merged{ static_cast<inner_t*>(child) };
+        std::string prefix{ inner->prefix };
+        prefix += static_cast<char>(byte);
+        prefix += merged->prefix;
+        merged->prefix = std::move(prefix);
+      }
+      ref = child;
+      delete_node(inner);
+    }
+  }
+
+  /**
+   * @brief for_each_child  it calls func(uint8_t, const node_t*) for the
+   * children of node in order of their bytes, until it returns true
+   * @return whether func returned true
+   */
+  template <class function_t>
+  static bool
+  for_each_child(const inner_t* node, function_t&& func) {
+    switch (node->kind) {
+    case kind_t::node4: {
+      const node4_t* node4{ static_cast<const node4_t*>(node) };
+      for (size_t ii = 0; ii < node4->count; ii++) {
+        if (func(node4->keys[ii], node4->children[ii])) {
+          return true;
+        }
+      }
+      return false;
+    }
+    case kind_t::node16: {
+      const node16_t* node16{ static_cast<const node16_t*>(node) };
+      for (size_t ii = 0; ii < node16->count; ii++) {
+        if (func(node16->keys[ii], node16->children[ii])) {
+          return true;
+        }
+      }
+      return false;
+    }
+    case kind_t::node48: {
+      const node48_t* node48{ static_cast<const node48_t*>(node) };
+      for (size_t key = 0; key < 256; key++) {
+        if (node48->index[key] &&
+            func(static_cast<uint8_t>(key), node48->children[node48->index[key] - 1u])) {
+          return true;
+        }
+      }
+      return false;
+    }
+    case kind_t::node256: {
+      const node256_t* node256{ static_cast<const node256_t*>(node) };
+      for (size_t key = 0; key < 256; key++) {
+        if (node256->children[key] &&
+            func(static_cast<uint8_t>(key), node256->children[key])) {
+          return true;
+        }
+      }
+      return false;
+    }
+    default:
+      return false;
+    }
+  }
+
+  /**
+   * @brief visit  in order visit of the subtree of node, the key ending in an
+   * inner node comes before the longer ones
+   * @return whether the visitor returned true
+   */
+  template <class visitor_t>
+  static bool
+  visit(const node_t* node, visitor_t& visitor, size_t& visited) {
+    if (node->kind == kind_t::leaf) {
+      visited++;
+      return visitor(static_cast<const leaf_t*>(node)->value);
+    }
+    const inner_t* inner{ static_cast<const inner_t*>(node) };
+    if (inner->leaf && visit(inner->leaf, visitor, visited)) {
+      return true;
+    }
+    return for_each_child(inner, [&visitor, &visited](uint8_t, const node_t* child) {
+      return visit(child, visitor, visited);
+    });
+  }
+
+  /**
+   * @brief delete_node  it deletes node without its children
+   */
+  static void
+  delete_node(node_t* node) noexcept {
+    switch (node->kind) {
+    case kind_t::leaf:    delete static_cast<leaf_t*>(node);    break;
+    case kind_t::node4:   delete static_cast<node4_t*>(node);   break;
+    case kind_t::node16:  delete static_cast<node16_t*>(node);  break;
+    case kind_t::node48:  delete static_cast<node48_t*>(node);  break;
+    case kind_t::node256: delete static_cast<node256_t*>(node); break;
+    }
+  }
+
+  /**
+   * @brief destroy  it deletes node and its subtree, the recursion is as deep
+   * as the number of branches in the longest key
+   */
+  static void
+  destroy(node_t* node) noexcept {
+    if (!node) {
+      return;
+    }
+    if (node->kind != kind_t::leaf) {
+      inner_t* inner{ static_cast<inner_t*>(node) };
+      delete inner->leaf;
+      for_each_child(inner, [](uint8_t, const node_t* child) {
+        destroy(const_cast<node_t*>(child));
+        return false;
+      });
+    }
+    delete_node(node);
+  }
+
+  template <class node_type>
+  static node_t*
+  clone_inner(const node_type* node) {
+    node_type* copy{ new node_type{ *node } };
+    copy->leaf = nullptr;
+    copy->children.fill(nullptr);
+    try {
+      if (node->leaf) {
+        copy->leaf = new leaf_t{ *node->leaf };
+      }
+      for (size_t ii = 0; ii < node->children.size(); ii++) {
+        copy->children[ii] = clone(node->children[ii]);
+      }
+    }
+    catch (...) {
+      destroy(copy);
+      throw;
+    }
+    return copy;
+  }
+
+  static node_t*
+  clone(const node_t* node) {
+    if (!node) {
+      return nullptr;
+    }
+    switch (node->kind) {
+    case kind_t::leaf:    return new leaf_t{ *static_cast<const leaf_t*>(node) };
+    case kind_t::node4:   return clone_inner(static_cast<const node4_t*>(node));
+    case kind_t::node16:  return clone_inner(static_cast<const node16_t*>(node));
+    case kind_t::node48:  return clone_inner(static_cast<const node48_t*>(node));
+    case kind_t::node256: return clone_inner(static_cast<const node256_t*>(node));
+    }
+    return nullptr;
+  }
+
+  node_t* _root{ nullptr };
+  size_t  _size{ 0 };
+};
+
+}
+}
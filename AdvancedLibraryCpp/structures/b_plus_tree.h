@@ -0,0 +1,782 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <iterator>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "../tools/sorted_range.h"
+
+namespace advanced {
+namespace structures {
+
+/** @test TestBPlusTree in test/test_b_plus_tree(.h|.cpp) */
+
+/**
+ * @brief Cache-conscious ordered set. Every node holds up to fanout keys in a
+ * contiguous array, so a lookup visits log_fanout(n) nodes instead of the
+ * log2(n) nodes of avl_tree_t, and the keys are only stored in the leaves,
+ * which are linked to each other for ordered iteration and range scans.
+ *
+ * The search inside a node doesn't branch on the comparisons: arithmetic keys
+ * are counted with a plain loop the compiler vectorizes, other keys use a
+ * branchless binary search.
+ *
+ * The API mirrors avl_tree_t: insert, remove, contains, lower_bound,
+ * upper_bound, rebuild and bidirectional iterators.
+ *
+ * @note keys are unique and T must be default constructible. The default
+ * fanout puts 64 int keys (256 bytes) in each leaf.
+ */
+template <class T, size_t fanout = 64>
+class b_plus_tree_t {
+  static_assert(fanout >= 4, "b_plus_tree_t needs at least 4 keys per node");
+
+  static constexpr size_t max_height    { 64 };
+  static constexpr size_t min_leaf_keys { fanout / 2 };
+  static constexpr size_t min_inner_keys{ (fanout - 1) / 2 };
+
+  struct node_t {
+    size_t count{ 0 };          // number of keys
+  };
+
+  struct leaf_t : node_t {
+    std::array<T, fanout> keys;
+    leaf_t*               previous{ nullptr };
+    leaf_t*               next    { nullptr };
+  };
+
+  /**
+   * children[i] holds the keys in [keys[i - 1], keys[i])
+   */
+  struct inner_t : node_t {
+    std::array<T, fanout - 1>   keys;
+    std::array<node_t*, fanout> children;
+  };
+
+  using path_t = std::array<std::pair<inner_t*, size_t>, max_height>;
+
+public:
+
+  /**
+   * @brief In-order bidirectional iterator, it walks through the linked
+   * leaves. The end iterator holds a null leaf, decrementing it goes to the
+   * greatest key.
+   * @note  values are read-only, modifying them would break the tree order
+   */
+  class const_iterator {
+    friend class b_plus_tree_t;
+
+  public:
+    using iterator_category = std::bidirectional_iterator_tag;
+    using value_type        = T;
+    using difference_type   = std::ptrdiff_t;
+    using pointer           = const T*;
+    using reference         = const T&;
+
+    const_iterator() = default;
+
+    inline reference
+    operator*() const {
+      return _leaf->keys[_index];
+    }
+
+    inline pointer
+    operator->() const {
+      return &_leaf->keys[_index];
+    }
+
+    const_iterator&
+    operator++() {
+      if (++_index == _leaf->count) {
+        _leaf  = _leaf->next;
+        _index = 0;
+      }
+      return *this;
+    }
+
+    const_iterator&
+    operator--() {
+      if (!_leaf) {
+        _leaf  = _tree->_last;
+        _index = _leaf ? _leaf->count - 1 : 0;
+      }
+      else if (_index) {
+        _index--;
+      }
+      else {
+        _leaf  = _leaf->previous;
+        _index = _leaf ? _leaf->count - 1 : 0;
+      }
+      return *this;
+    }
+
+    inline const_iterator
+    operator++(int) {
+      const_iterator previous{ *this };
+      ++*this;
+      return previous;
+    }
+
+    inline const_iterator
+    operator--(int) {
+      const_iterator previous{ *this };
+      --*this;
+      return previous;
+    }
+
+    inline bool
+    operator==(const const_iterator& other) const {
+      return _leaf == other._leaf && _index == other._index;
+    }
+
+    inline bool
+    operator!=(const const_iterator& other) const {
+      return !(*this == other);
+    }
+
+  private:
+    const_iterator(const leaf_t* leaf, size_t index, const b_plus_tree_t* tree)
+      : _leaf{ leaf }, _index{ index }, _tree{ tree }
+    { }
+
+    const leaf_t*        _leaf { nullptr };
+    size_t               _index{ 0 };
+    const b_plus_tree_t* _tree { nullptr };
+  };
+
+  using iterator               = const_iterator;
+  using reverse_iterator       = std::reverse_iterator<const_iterator>;
+  using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+  b_plus_tree_t() = default;
+
+  b_plus_tree_t(const b_plus_tree_t& other) {
+    rebuild(other.begin(), other.end());
+  }
+
+  b_plus_tree_t(b_plus_tree_t&& other) noexcept {
+    steal(other);
+  }
+
+  b_plus_tree_t&
+  operator=(const b_plus_tree_t& other) {
+    if (this != &other) {
+      rebuild(other.begin(), other.end());
+    }
+    return *this;
+  }
+
+  b_plus_tree_t&
+  operator=(b_plus_tree_t&& other) noexcept {
+    if (this != &other) {
+      clear();
+      steal(other);
+    }
+    return *this;
+  }
+
+  ~b_plus_tree_t() {
+    clear();
+  }
+
+  /**
+   * @brief insert  it inserts a value if it's not in the tree yet. Full nodes
+   * are split bottom-up, the tree only grows at the root.
+   * @return whether the value was inserted or not
+   */
+  bool
+  insert(const T& value) {
+    if (!_root) {
+      leaf_t* leaf{ new leaf_t };
+      leaf->keys[0] = value;
+      leaf->count   = 1;
+      _root   = _first = _last = leaf;
+      _height = _size = 1;
+      return true;
+    }
+    path_t  path;
+    leaf_t* leaf{ descend(value, path) };
+    const size_t index{ count_lower<false>(leaf->keys.data(), leaf->count, value) };
+    if (index < leaf->count && !(value < leaf->keys[index])) {
+      return false;
+    }
+    _size++;
+    if (leaf->count < fanout) {
+      insert_at(leaf->keys.data(), leaf->count++, index, value);
+      return true;
+    }
+
+    T       separator;
+    node_t* created{ split_leaf(leaf, index, value, separator) };
+    for (size_t level = _height - 1; level--; ) {
+      inner_t*     parent{ path[level].first };
+      const size_t child { path[level].second };
+      if (parent->count < fanout - 1) {
+        insert_at(parent->keys.data(), parent->count, child, std::move(separator));
+        insert_at(parent->children.data(), parent->count + 1, child + 1, created);
+        parent->count++;
+        return true;
+      }
+      created = split_inner(parent, child, separator, created);
+    }
+
+    inner_t* root{ new inner_t };
+    root->keys[0]     = std::move(separator);
+    root->children[0] = _root;
+    root->children[1] = created;
+    root->count       = 1;
+    _root = root;
+    _height++;
+    return true;
+  }
+
+  /**
+   * @brief remove  it removes value from the tree. Nodes that drop below half
+   * full borrow a key from a sibling or are merged with it, the tree only
+   * shrinks at the root.
+   * @return whether the tree contained the value
+   */
+  bool
+  remove(const T& value) {
+    if (!_root) {
+      return false;
+    }
+    path_t  path;
+    leaf_t* leaf{ descend(value, path) };
+    const size_t index{ count_lower<false>(leaf->keys.data(), leaf->count, value) };
+    if (index == leaf->count || value < leaf->keys[index]) {
+      return false;
+    }
+    erase_at(leaf->keys.data(), leaf->count--, index);
+    _size--;
+
+    node_t* node{ leaf };
+    for (size_t level = _height - 1; level--; ) {
+      const bool is_leaf{ node == leaf };
+      if (node->count >= (is_leaf ? min_leaf_keys : min_inner_keys)) {
+        return true;
+      }
+      inner_t*     parent{ path[level].first };
+      const size_t child { path[level].second };
+      is_leaf ? fix_leaf(parent, child) : fix_inner(parent, child);
+      node = parent;
+    }
+
+    if (!node->count) {
+      if (_height == 1) {
+        delete leaf;
+        _root = _first = _last = nullptr;
+        _height = 0;
+      }
+      else {
+        inner_t* root{ static_cast<inner_t*>(node) };
+        _root = root->children[0];
+        delete root;
+        _height--;
+      }
+    }
+    return true;
+  }
+
+  /**
+   * @brief contains  whether the value is in the tree or not
+   */
+  bool
+  contains(const T& value) const {
+    if (!_root) {
+      return false;
+    }
+    const leaf_t* leaf{ find_leaf(value) };
+    const size_t  index{ count_lower<false>(leaf->keys.data(), leaf->count, value) };
+    return index < leaf->count && !(value < leaf->keys[index]);
+  }
+
+  /**
+   * @brief find  iterator to value, or end() if it's not in the tree
+   */
+  const_iterator
+  find(const T& value) const {
+    const_iterator it{ lower_bound(value) };
+    return it != end() && !(value < *it) ? it : end();
+  }
+
+  /**
+   * @brief lower_bound  iterator to the first value not lower than value
+   */
+  const_iterator
+  lower_bound(const T& value) const {
+    if (!_root) {
+      return end();
+    }
+    const leaf_t* leaf{ find_leaf(value) };
+    return at(leaf, count_lower<false>(leaf->keys.data(), leaf->count, value));
+  }
+
+  /**
+   * @brief upper_bound  iterator to the first value greater than value
+   */
+  const_iterator
+  upper_bound(const T& value) const {
+    if (!_root) {
+      return end();
+    }
+    const leaf_t* leaf{ find_leaf(value) };
+    return at(leaf, count_lower<true>(leaf->keys.data(), leaf->count, value));
+  }
+
+  /**
+   * @brief rebuild  It replaces the content of the tree by the sorted range
+   * [first, last) in O(n), the nodes are filled evenly bottom-up. Repeated
+   * values are skipped.
+   * @throws std::invalid_argument if the range is not sorted, the tree is left
+   * empty
+   */
+  template <class Iterator>
+  b_plus_tree_t&
+  rebuild(Iterator first, Iterator last) {
+    clear();
+    const size_t count{ tools::count_sorted(first, last) };
+    if (!count) {
+      return *this;
+    }
+
+    std::vector<node_t*> nodes;
+    std::vector<T>       lowest;      // lowest key of each node of the level
+    const size_t leaves{ (count + fanout - 1) / fanout };
+    leaf_t*  previous{ nullptr };
+    Iterator previous_value{ last };
+    for (size_t ii = 0; ii < leaves; ii++) {
+      leaf_t* leaf{ new leaf_t };
+      leaf->count    = count / leaves + (ii < count % leaves);
+      leaf->previous = previous;
+      for (size_t key = 0; key < leaf->count; key++) {
+        while (previous_value != last && !(*previous_value < *first)) {
+          ++first;
+        }
+        leaf->keys[key] = *first;
+        previous_value  = first++;
+      }
+      if (previous) {
+        previous->next = leaf;
+      }
+      else {
+        _first = leaf;
+      }
+      nodes.push_back(leaf);
+      lowest.push_back(leaf->keys[0]);
+      previous = leaf;
+    }
+    _last   = previous;
+    _size   = count;
+    _height = 1;
+
+    while (nodes.size() > 1) {
+      const size_t groups{ (nodes.size() + fanout - 1) / fanout };
+      std::vector<node_t*> parents;
+      std::vector<T>       parents_lowest;
+      size_t child{ 0 };
+      for (size_t ii = 0; ii < groups; ii++) {
+        inner_t*     inner{ new inner_t };
+        const size_t children{ nodes.size() / groups + (ii < nodes.size() % groups) };
+        parents_lowest.push_back(std::move(lowest[child]));
+        for (size_t jj = 0; jj < children; jj++, child++) {
+          inner->children[jj] = nodes[child];
+          if (jj) {
+            inner->keys[jj - 1] = std::move(lowest[child]);
+          }
+        }
+        inner->count = children - 1;
+        parents.push_back(inner);
+      }
+      nodes.swap(parents);
+      lowest.swap(parents_lowest);
+      _height++;
+    }
+    _root = nodes.front();
+    return *this;
+  }
+
+  /**
+   * @brief clear  it removes all elements
+   */
+  void
+  clear() noexcept {
+    if (_root) {
+      destroy(_root, 1);
+    }
+    _root   = nullptr;
+    _first  = _last = nullptr;
+    _height = _size = 0;
+  }
+
+  /**
+   * @brief left_most  the lowest value
+   * @throws std::out_of_range if the tree is empty
+   */
+  const T&
+  left_most() const {
+    if (!_first) {
+      throw std::out_of_range{ "b_plus_tree_t is empty" };
+    }
+    return _first->keys[0];
+  }
+
+  /**
+   * @brief right_most  the greatest value
+   * @throws std::out_of_range if the tree is empty
+   */
+  const T&
+  right_most() const {
+    if (!_last) {
+      throw std::out_of_range{ "b_plus_tree_t is empty" };
+    }
+    return _last->keys[_last->count - 1];
+  }
+
+  /**
+   * @brief height  number of levels, the leaves included
+   */
+  inline size_t
+  height() const noexcept {
+    return _height;
+  }
+
+  inline size_t
+  size() const noexcept {
+    return _size;
+  }
+
+  inline bool
+  empty() const noexcept {
+    return _size == 0;
+  }
+
+  inline const_iterator
+  begin() const {
+    return const_iterator{ _first, 0, this };
+  }
+
+  inline const_iterator
+  end() const {
+    return const_iterator{ nullptr, 0, this };
+  }
+
+  inline const_iterator
+  cbegin() const {
+    return begin();
+  }
+
+  inline const_iterator
+  cend() const {
+    return end();
+  }
+
+  inline const_reverse_iterator
+  rbegin() const {
+    return const_reverse_iterator{ end() };
+  }
+
+  inline const_reverse_iterator
+  rend() const {
+    return const_reverse_iterator{ begin() };
+  }
+
+private:
+
+  /**
+   * @brief count_lower  number of keys lower than value, or lower than or
+   * equal to value if inclusive. It doesn't branch on the comparisons.
+   */
+  template <bool inclusive>
+  static size_t
+  count_lower(const T* keys, size_t count, const T& value) {
+    if constexpr (std::is_arithmetic<T>::value) {
+      size_t result{ 0 };
+      for (size_t ii = 0; ii < count; ii++) {
+        result += inclusive ? !(value < keys[ii]) : keys[ii] < value;
+      }
+      return result;
+    }
+    else {
+      if (!count) {
+        return 0;
+      }
+      const T* base{ keys };
+      while (count > 1) {
+        const size_t half{ count / 2 };
+        const bool   lower{ inclusive ? !(value < base[half]) : base[half] < value };
+        base  += lower ? half : 0;
+        count -= half;
+      }
+      const bool lower{ inclusive ? !(value < *base) : *base < value };
+      return static_cast<size_t>(base - keys) + lower;
+    }
+  }
+
+  /**
+   * @brief find_leaf  the leaf where value is or should be
+   */
+  const leaf_t*
+  find_leaf(const T& value) const {
+    const node_t* node{ _root };
+    for (size_t level = 1; level < _height; level++) {
+      const inner_t* inner{ static_cast<const inner_t*>(node) };
+      node = inner->children[count_lower<true>(inner->keys.data(), inner->count, value)];
+    }
+    return static_cast<const leaf_t*>(node);
+  }
+
+  /**
+   * @brief descend  it finds the leaf of value, recording the inner nodes and
+   * the child followed at each level
+   */
+  leaf_t*
+  descend(const T& value, path_t& path) {
+    node_t* node{ _root };
+    for (size_t level = 0; level + 1 < _height; level++) {
+      inner_t*     inner{ static_cast<inner_t*>(node) };
+      const size_t child{ count_lower<true>(inner->keys.data(), inner->count, value) };
+      path[level] = { inner, child };
+      node        = inner->children[child];
+    }
+    return static_cast<leaf_t*>(node);
+  }
+
+  /**
+   * @brief at  iterator to the index-th key of leaf, or to the next leaf
+   */
+  inline const_iterator
+  at(const leaf_t* leaf, size_t index) const {
+    if (index == leaf->count) {
+      return const_iterator{ leaf->next, 0, this };
+    }
+    return const_iterator{ leaf, index, this };
+  }
+
+  template <class U, class V>
+  static void
+  insert_at(U* items, size_t count, size_t index, V&& item) {
+    std::move_backward(items + index, items + count, items + count + 1);
+    items[index] = std::forward<V>(item);
+  }
+
+  template <class U>
+  static void
+  erase_at(U* items, size_t count, size_t index) {
+    std::move(items + index + 1, items + count, items + index);
+    if constexpr (!std::is_trivially_destructible<U>::value) {
+      items[count - 1] = U{};   // releases the resources held by the value
+    }
+  }
+
+  /**
+   * @brief split_leaf  it splits a full leaf inserting value at index
+   * @param separator[out]  lowest key of the new leaf
+   * @return the new leaf, at the right of leaf
+   */
+  leaf_t*
+  split_leaf(leaf_t* leaf, size_t index, const T& value, T& separator) {
+    leaf_t*      right{ new leaf_t };
+    const size_t lower{ (fanout + 1) / 2 };
+    if (index < lower) {
+      std::move(leaf->keys.begin() + lower - 1, leaf->keys.end(), right->keys.begin());
+      insert_at(leaf->keys.data(), lower - 1, index, value);
+    }
+    else {
+      std::move(leaf->keys.begin() + lower, leaf->keys.end(), right->keys.begin());
+      insert_at(right->keys.data(), fanout - lower, index - lower, value);
+    }
+    leaf->count  = lower;
+    right->count = fanout + 1 - lower;
+
+    right->previous = leaf;
+    right->next     = leaf->next;
+    if (leaf->next) {
+      leaf->next->previous = right;
+    }
+    else {
+      _last = right;
+    }
+    leaf->next = right;
+    separator  = right->keys[0];
+    return right;
+  }
+
+  /**
+   * @brief split_inner  it splits a full inner node inserting separator at
+   * index and child at index + 1
+   * @param separator[in,out]  the key moved up to the parent
+   * @return the new inner node, at the right of inner
+   */
+  static inner_t*
+  split_inner(inner_t* inner, size_t index, T& separator, node_t* child) {
+    std::array<T, fanout>           keys;
+    std::array<node_t*, fanout + 1> children;
+    std::move(inner->keys.begin(), inner->keys.end(), keys.begin());
+    std::copy(inner->children.begin(), inner->children.end(), children.begin());
+    insert_at(keys.data(), fanout - 1, index, std::move(separator));
+    insert_at(children.data(), fanout, index + 1, child);
+
+    inner_t*     right{ new inner_t };
+    const size_t lower{ fanout / 2 };
+    std::move(keys.begin(), keys.begin() + lower, inner->keys.begin());
+    std::copy(children.begin(), children.begin() + lower + 1, inner->children.begin());
+    inner->count = lower;
+    separator    = std::move(keys[lower]);
+    std::move(keys.begin() + lower + 1, keys.end(), right->keys.begin());
+    std::copy(children.begin() + lower + 1, children.end(), right->children.begin());
+    right->count = fanout - lower - 1;
+    return right;
+  }
+
+  /**
+   * @brief fix_leaf  it refills the child-th leaf of parent, that has less
+   * than min_leaf_keys keys, from a sibling
+   */
+  void
+  fix_leaf(inner_t* parent, size_t child) {
+    leaf_t* leaf{ static_cast<leaf_t*>(parent->children[child]) };
+    if (child) {
+      leaf_t* left{ static_cast<leaf_t*>(parent->children[child - 1]) };
+      if (left->count > min_leaf_keys) {
+        insert_at(leaf->keys.data(), leaf->count++, 0,
+                  std::move(left->keys[left->count - 1]));
+        erase_at(left->keys.data(), left->count, left->count - 1);
+        left->count--;
+        parent->keys[child - 1] = leaf->keys[0];
+        return;
+      }
+    }
+    if (child < parent->count) {
+      leaf_t* right{ static_cast<leaf_t*>(parent->children[child + 1]) };
+      if (right->count > min_leaf_keys) {
+        leaf->keys[leaf->count++] = std::move(right->keys[0]);
+        erase_at(right->keys.data(), right->count--, 0);
+        parent->keys[child] = right->keys[0];
+        return;
+      }
+    }
+    merge_leaves(parent, child ? child - 1 : child);
+  }
+
+  /**
+   * @brief merge_leaves  it moves the keys of the (index + 1)-th leaf of
+   * parent to the index-th one
+   */
+  void
+  merge_leaves(inner_t* parent, size_t index) {
+    leaf_t* left { static_cast<leaf_t*>(parent->children[index]) };
+    leaf_t* right{ static_cast<leaf_t*>(parent->children[index + 1]) };
+    std::move(right->keys.begin(), right->keys.begin() + right->count,
+              left->keys.begin() + left->count);
+    left->count += right->count;
+    left->next   = right->next;
+    if (right->next) {
+      right->next->previous = left;
+    }
+    else {
+      _last = left;
+    }
+    delete right;
+    erase_at(parent->keys.data(), parent->count, index);
+    erase_at(parent->children.data(), parent->count + 1, index + 1);
+    parent->count--;
+  }
+
+  /**
+   * @brief fix_inner  it refills the child-th inner node of parent, that has
+   * less than min_inner_keys keys, rotating a key through the parent or
+   * merging it with a sibling
+   */
+  static void
+  fix_inner(inner_t* parent, size_t child) {
+    inner_t* inner{ static_cast<inner_t*>(parent->children[child]) };
+    if (child) {
+      inner_t* left{ static_cast<inner_t*>(parent->children[child - 1]) };
+      if (left->count > min_inner_keys) {
+        insert_at(inner->keys.data(), inner->count, 0,
+                  std::move(parent->keys[child - 1]));
+        insert_at(inner->children.data(), inner->count + 1, 0,
+                  left->children[left->count]);
+        inner->count++;
+        parent->keys[child - 1] = std::move(left->keys[left->count - 1]);
+        left->count--;
+        return;
+      }
+    }
+    if (child < parent->count) {
+      inner_t* right{ static_cast<inner_t*>(parent->children[child + 1]) };
+      if (right->count > min_inner_keys) {
+        inner->keys[inner->count]         = std::move(parent->keys[child]);
+        inner->children[inner->count + 1] = right->children[0];
+        inner->count++;
+        parent->keys[child] = std::move(right->keys[0]);
+        erase_at(right->keys.data(), right->count, 0);
+        erase_at(right->children.data(), right->count + 1, 0);
+        right->count--;
+        return;
+      }
+    }
+    merge_inner(parent, child ? child - 1 : child);
+  }
+
+  /**
+   * @brief merge_inner  it moves the separator and the content of the
+   * (index + 1)-th inner node of parent to the index-th one
+   */
+  static void
+  merge_inner(inner_t* parent, size_t index) {
+    inner_t* left { static_cast<inner_t*>(parent->children[index]) };
+    inner_t* right{ static_cast<inner_t*>(parent->children[index + 1]) };
+    left->keys[left->count] = std::move(parent->keys[index]);
+    std::move(right->keys.begin(), right->keys.begin() + right->count,
+              left->keys.begin() + left->count + 1);
+    std::copy(right->children.begin(), right->children.begin() + right->count + 1,
+              left->children.begin() + left->count + 1);
+    left->count += right->count + 1;
+    delete right;
+    erase_at(parent->keys.data(), parent->count, index);
+    erase_at(parent->children.data(), parent->count + 1, index + 1);
+    parent->count--;
+  }
+
+  /**
+   * @brief destroy  it deletes node and its descendents, level 1 is the root
+   */
+  void
+  destroy(node_t* node, size_t level) noexcept {
+    if (level == _height) {
+      delete static_cast<leaf_t*>(node);
+      return;
+    }
+    inner_t* inner{ static_cast<inner_t*>(node) };
+    for (size_t child = 0; child <= inner->count; child++) {
+      destroy(inner->children[child], level + 1);
+    }
+    delete inner;
+  }
+
+  void
+  steal(b_plus_tree_t& other) noexcept {
+    _root   = other._root;
+    _first  = other._first;
+    _last   = other._last;
+    _height = other._height;
+    _size   = other._size;
+    other._root   = nullptr;
+    other._first  = other._last = nullptr;
+    other._height = other._size = 0;
+  }
+
+  node_t* _root  { nullptr };
+  leaf_t* _first { nullptr };
+  leaf_t* _last  { nullptr };
+  size_t  _height{ 0 };
+  size_t  _size  { 0 };
+};
+
+}
+}
@@ -1,6 +1,14 @@
 #pragma once
 #include <algorithm>
+#include <future>
+#include <iterator>
+#include <stdexcept>
+#include <thread>
+#include <tuple>
+#include <type_traits>
 #include "tree.h"
+#include "node_allocator.h"
+#include "../tools/sorted_range.h"
 
 
 namespace advanced {
@@ -8,24 +16,72 @@ namespace structures {
 
 /** @test TestBinaryTree in tests/test_binary_tree(.h|.cpp) */
 
-template <class T>
+template <class T, bool order_statistics = false>
+class binary_node_t;
+
+template <class T, class allocator_t>
+class basic_binary_tree_t;
+
+template <class T, class node_t = binary_node_t<T>>
+class binary_tree_iterator_t;
+
+template <class T, class allocator_t = heap_node_allocator_t<binary_node_t<T>>>
 class binary_tree_t;
 
-template <class T>
+template <class T, class allocator_t = heap_node_allocator_t<binary_node_t<T>>>
 class avl_tree_t;
 
 /**
- * @brief templated binary node to be inserted into the bianry tree object
+ * @brief node_augmentation_t  data about a subtree kept in the value of its
+ * root by avl_tree_t, like the greatest endpoint of an interval tree. The
+ * tree calls update whenever the children of a node change, rotations
+ * included, so it only has to combine the value with the ones of the
+ * children. The default keeps nothing. A specialization for T sets enabled
+ * and provides
+ *   static void update(T& value, const T* left, const T* right)
+ * where left and right are nullptr for a missing child.
  */
 template <class T>
-class binary_node_t : public base_node_t<T, binary_node_t<T>> {
-  friend class binary_tree_t<T>;
-  friend class avl_tree_t<T>;
-  friend class tree_t<T, binary_node_t<T>>;
+struct node_augmentation_t {
+  static constexpr bool enabled{ false };
+
+  inline static void
+  update(T&, const T*, const T*) { }
+};
+
+/**
+ * @brief subtree_size_t  number of nodes in the subtree of a binary_node_t,
+ * only kept by the nodes of an order_statistic_tree_t. The default one is
+ * empty, so the other nodes don't grow.
+ */
+template <bool order_statistics>
+struct subtree_size_t {
+  static constexpr bool enabled{ true };
+  size_t _count{ 1u };
+};
+
+template <>
+struct subtree_size_t<false> {
+  static constexpr bool enabled{ false };
+};
+
+/**
+ * @brief templated binary node to be inserted into the bianry tree object
+ * @param order_statistics  whether the node keeps the size of its subtree
+ */
+template <class T, bool order_statistics>
+class binary_node_t : public base_node_t<T, binary_node_t<T, order_statistics>>,
+                      private subtree_size_t<order_statistics> {
+  template <class, class> friend class basic_binary_tree_t;
+  template <class, class> friend class binary_tree_t;
+  template <class, class> friend class avl_tree_t;
+  template <class, class> friend class binary_tree_iterator_t;
+  friend class tree_t<T, binary_node_t>;
 
 public:
-  using node_type_t            = binary_node_t<T>;
-  using base_type_t            = base_node_t<T, binary_node_t<T>>;
+  using node_type_t            = binary_node_t;
+  using base_type_t            = base_node_t<T, binary_node_t>;
+  using subtree_size_type_t    = subtree_size_t<order_statistics>;
   using iterator               = typename base_type_t::iterator;
   using const_iterator         = typename base_type_t::const_iterator;
   using reverse_iterator       = typename base_type_t::reverse_iterator;
@@ -118,11 +174,22 @@ public:
   binary_node_t() = default;
 
   /**
-   * @brief binary_node_t it completely copy the entire node and content
+   * @brief binary_node_t  deep copy of other and its subtree, the copy has no
+   * parent. It's iterative, so the depth of the tree is not limited by the
+   * call stack.
    * @param other
    */
-  binary_node_t(const binary_node_t& other) {
-    *this = other;
+  binary_node_t(const binary_node_t& other)
+    : base_type_t(other._node), subtree_size_type_t(other),
+      _height{ other._height }
+  {
+    try {
+      copy_subtree(other);
+    }
+    catch (...) {
+      clear();
+      throw;
+    }
   }
 
   /**
@@ -130,22 +197,28 @@ public:
    * right child to the new object
    * @param other
    */
-  binary_node_t(binary_node_t&& other) {
-    *this = std::move(other);
+  binary_node_t(binary_node_t&& other)
+    noexcept(std::is_nothrow_move_constructible<T>::value)
+    : base_type_t(std::move(other._node))
+  {
+    take_children(other);
   }
 
   /**
-   * Contructor that forward anything to base_node constructor
+   * Contructor that forward anything to base_node constructor, except a
+   * binary_node_t that is copied by the copy constructor
    */
-  template<typename ...Args>
+  template<typename ...Args, typename = typename std::enable_if<
+             !std::is_same<std::tuple<typename std::decay<Args>::type...>,
+                           std::tuple<binary_node_t>>::value>::type>
   binary_node_t(Args&&...args)
-      : base_node_t<T, binary_node_t<T> > (std::forward<Args>(args)...)
+      : base_type_t(std::forward<Args>(args)...)
   { }
 
   /**
-   * @brief operator = copy assingment operator creates a new empty node and copy
-   * the contents from the other node to it, also creates and copy recursively
-   * the left and right children if they exist in the other
+   * @brief operator = copy assingment operator, it replaces the value and the
+   * children of this node by a deep copy of other. The parent of this node is
+   * kept.
    * It performs a full copy, so expensive, but can be used as prototype
    * from Prototype Design pattern.
    * @param other node to be copied
@@ -153,20 +226,10 @@ public:
    */
   binary_node_t&
   operator=(const binary_node_t& other) {
-    clear();
-
-    if (other.has_left()) {
-      _left   = new binary_node_t();
-      *_left  = other.left();
-      _left->set_parent(this);
-    }
-    if (other.has_right()) {
-      _right  = new binary_node_t();
-      *_right = other.right();
-      _right->set_parent(this);
+    if (this != &other) {
+      binary_node_t copy{ other };
+      *this = std::move(copy);
     }
-
-    base_type_t::_node = other._node;
     return *this;
   } // LCOV_EXCL_LINE
 
@@ -179,21 +242,12 @@ public:
    * @return reference to this
    */
   binary_node_t&
-  operator=(binary_node_t&& other) {
-    clear();
-    _left  = other._left;
-    _right = other._right;
-    other._left = other._right = nullptr;
-    other.set_parent(nullptr);
-
-    if (has_left()) {
-      _left->set_parent(this);
+  operator=(binary_node_t&& other) noexcept(std::is_nothrow_move_assignable<T>::value) {
+    if (this != &other) {
+      clear();
+      base_type_t::_node = std::move(other._node);
+      take_children(other);
     }
-    if (has_right()) {
-      _right->set_parent(this);
-    }
-
-    base_type_t::_node = std::move(other._node);
     return *this;
   } // LCOV_EXCL_LINE
 
@@ -421,6 +475,127 @@ public:
 
 
 protected:
+  /**
+   * @brief take_children  it moves the children of other to this node, other
+   * loses its parent too
+   */
+  void
+  take_children(binary_node_t& other) noexcept {
+    _left   = other._left;
+    _right  = other._right;
+    copy_balance(other);
+    other._left = other._right = nullptr;
+    other.set_parent(nullptr);
+    if (_left) {
+      _left->set_parent(this);
+    }
+    if (_right) {
+      _right->set_parent(this);
+    }
+  }
+
+  /**
+   * @brief copy_subtree  it copies the descendants of source as descendants
+   * of this node, iteratively
+   */
+  void
+  copy_subtree(const binary_node_t& source) {
+    std::vector<std::pair<const binary_node_t*, binary_node_t*>> pending{
+      { &source, this }
+    };
+    while (!pending.empty()) {
+      const auto [from, to] = pending.back();
+      pending.pop_back();
+      for (auto child : { &binary_node_t::_left, &binary_node_t::_right }) {
+        if (const binary_node_t* node = from->*child) {
+          to->*child = new binary_node_t{ node->_node, to };
+          (to->*child)->copy_balance(*node);
+          pending.emplace_back(node, to->*child);
+        }
+      }
+    }
+  }
+
+  /**
+   * @brief copy_balance  it copies the height and the subtree size of other
+   */
+  inline void
+  copy_balance(const binary_node_t& other) noexcept {
+    _height = other._height;
+    static_cast<subtree_size_type_t&>(*this) = other;
+  }
+
+  /**
+   * @brief visit_in_order  in_order with an inlined visitor, node_t is
+   * binary_node_t or const binary_node_t
+   * @return number of nodes
+   */
+  template <class node_t, class visitor_t>
+  static size_t
+  visit_in_order(node_t& node, visitor_t& visitor) {
+    size_t visited{ 1u };
+    if (node._left) {
+      visited += visit_in_order(static_cast<node_t&>(*node._left), visitor);
+    }
+    if (!visitor(node)) {
+      if (node._right) {
+        visited += visit_in_order(static_cast<node_t&>(*node._right), visitor);
+      }
+    }
+    return visited;
+  }
+
+  /**
+   * @brief visit_pre_order  pre_order with an inlined visitor
+   * @return number of nodes
+   */
+  template <class node_t, class visitor_t>
+  static size_t
+  visit_pre_order(node_t& node, visitor_t& visitor) {
+    size_t visited{ 1u };
+    if (!visitor(node)) {
+      if (node._left) {
+        visited += visit_pre_order(static_cast<node_t&>(*node._left), visitor);
+      }
+      if (node._right) {
+        visited += visit_pre_order(static_cast<node_t&>(*node._right), visitor);
+      }
+    }
+    return visited;
+  }
+
+  /**
+   * @brief visit_pos_order  pos_order with an inlined visitor
+   * @return number of nodes
+   */
+  template <class node_t, class visitor_t>
+  static size_t
+  visit_pos_order(node_t& node, visitor_t& visitor) {
+    size_t visited{ 1u };
+    if (node._left) {
+      visited += visit_pos_order(static_cast<node_t&>(*node._left), visitor);
+    }
+    if (node._right) {
+      visited += visit_pos_order(static_cast<node_t&>(*node._right), visitor);
+    }
+    visitor(node);
+    return visited;
+  }
+
+  /**
+   * @brief for_each_child  it calls func(node_t*) for each non-null child
+   */
+  template <class node_t, class function_t>
+  inline static void
+  for_each_child(node_t& node, function_t&& func) {
+    if (node._left) {
+      func(static_cast<node_t*>(node._left));
+    }
+    if (node._right) {
+      func(static_cast<node_t*>(node._right));
+    }
+  }
+
   /**
    * @brief children  get children as a vector
    * @return
@@ -431,206 +606,893 @@ protected:
   } // LCOV_EXCL_LINE
 
   size_t                    _height  { 1u };
-  binary_node_t<T>*         _left    { nullptr };
-  binary_node_t<T>*         _right   { nullptr };
+  binary_node_t*            _left    { nullptr };
+  binary_node_t*            _right   { nullptr };
   using base_type_t::swap;
 };
 
 /**
- * @brief templated simple binary tree
+ * @brief In-order bidirectional iterator over a binary tree, it walks through
+ * the parent links, so it needs no stack and can be resumed at any time.
+ * Incrementing costs O(1) amortized. The end iterator holds a null node,
+ * decrementing it goes to the rightmost node.
+ * @note  values are read-only, modifying them would break the tree order
  */
-template <class T>
-class binary_tree_t : public tree_t<T, binary_node_t<T>>{
+template <class T, class node_t>
+class binary_tree_iterator_t {
 public:
-  using node_type_t    = binary_node_t<T>;
-  using base_type_t    = tree_t<T, node_type_t>;
-
-  binary_tree_t(const T& root) : tree_t<T, node_type_t> (root)
+  using iterator_category = std::bidirectional_iterator_tag;
+  using value_type        = T;
+  using difference_type   = std::ptrdiff_t;
+  using pointer           = const T*;
+  using reference         = const T&;
+  using node_type_t       = node_t;
+  using tree_type_t       = tree_t<T, node_type_t>;
+
+  binary_tree_iterator_t() = default;
+
+  binary_tree_iterator_t(const node_type_t* node, const tree_type_t* tree)
+    : _node{ node }, _tree{ tree }
   { }
 
-  binary_tree_t() = default;
+  inline reference
+  operator*() const {
+    return _node->get();
+  }
+
+  inline pointer
+  operator->() const {
+    return &_node->get();
+  }
+
+  /**
+   * @brief node  the node the iterator points to
+   */
+  inline const node_type_t&
+  node() const {
+    return *_node;
+  }
+
+  binary_tree_iterator_t&
+  operator++() {
+    if (_node->_right) {
+      _node = _node->_right;
+      while (_node->_left) {
+        _node = _node->_left;
+      }
+    }
+    else {
+      const node_type_t* child{ _node };
+      _node = _node->_parent;
+      while (_node && _node->_right == child) {
+        child = _node;
+        _node = _node->_parent;
+      }
+    }
+    return *this;
+  }
+
+  binary_tree_iterator_t&
+  operator--() {
+    if (!_node) {
+      _node = _tree->has_root() ? &_tree->root() : nullptr;
+      while (_node && _node->_right) {
+        _node = _node->_right;
+      }
+    }
+    else if (_node->_left) {
+      _node = _node->_left;
+      while (_node->_right) {
+        _node = _node->_right;
+      }
+    }
+    else {
+      const node_type_t* child{ _node };
+      _node = _node->_parent;
+      while (_node && _node->_left == child) {
+        child = _node;
+        _node = _node->_parent;
+      }
+    }
+    return *this;
+  }
+
+  inline binary_tree_iterator_t
+  operator++(int) {
+    binary_tree_iterator_t previous{ *this };
+    ++*this;
+    return previous;
+  }
+
+  inline binary_tree_iterator_t
+  operator--(int) {
+    binary_tree_iterator_t previous{ *this };
+    --*this;
+    return previous;
+  }
+
+  inline bool
+  operator==(const binary_tree_iterator_t& other) const {
+    return _node == other._node;
+  }
+
+  inline bool
+  operator!=(const binary_tree_iterator_t& other) const {
+    return _node != other._node;
+  }
+
+private:
+  const node_type_t* _node{ nullptr };
+  const tree_type_t* _tree{ nullptr };
 };
 
 /**
- * @brief templated avl tree
+ * @brief Binary tree whose nodes are created and destroyed through a node
+ * allocator (see node_allocator.h), it's the common base of binary_tree_t and
+ * avl_tree_t. The node type is the one created by the allocator.
  */
-template <class T>
-class avl_tree_t : public tree_t<T, binary_node_t<T>>{
+template <class T, class allocator_t>
+class basic_binary_tree_t
+    : public tree_t<T, typename allocator_t::value_type> {
 public:
-  using node_type_t     = binary_node_t<T>;
-  using base_type_t     = tree_t<T, node_type_t>;
+  using node_type_t            = typename allocator_t::value_type;
+  using base_type_t            = tree_t<T, node_type_t>;
+  using iterator               = binary_tree_iterator_t<T, node_type_t>;
+  using const_iterator         = binary_tree_iterator_t<T, node_type_t>;
+  using reverse_iterator       = std::reverse_iterator<const_iterator>;
+  using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+  basic_binary_tree_t() = default;
 
   /**
-   * @brief avl_tree_t  default constructor
-   * @param root
+   * @brief basic_binary_tree_t  constructor with a configured allocator, e.g.
+   * arena_node_allocator_t{ nodes_per_slab } or
+   * pmr_node_allocator_t{ &memory_resource }
    */
-  avl_tree_t(const T& root) {
-    insert(root);
-  }
-
-  avl_tree_t() = default;
+  explicit basic_binary_tree_t(allocator_t&& allocator)
+    : _allocator{ std::move(allocator) }
+  { }
 
   /**
-   * @brief insert inserts a non existent previously value in the tree
-   * @param value
-   * @return  whether the value was inserted or not, if the value is already in
-   * tree it will return false
+   * @brief basic_binary_tree_t  deep copy, the nodes are allocated by the
+   * allocator returned by other.get_allocator().select_on_copy()
    */
-  bool
-  insert(const T& value) {
-    bool inserted{ true };
-    insert(this->_root, value, inserted);
-    return inserted;
+  basic_binary_tree_t(const basic_binary_tree_t& other)
+    : base_type_t{}, _allocator{ other._allocator.select_on_copy() }
+  {
+    copy_nodes(other);
   }
 
   /**
-   * @brief remove  it removes one value from the tree
-   * @param value
-   * @return   If the tree contained the value
+   * @brief basic_binary_tree_t  it transfers the nodes and the allocator
    */
-  bool
-  remove(const T& value) {
-    bool removed{ false };
-    remove(this->_root, value, removed);
-    return removed;
+  basic_binary_tree_t(basic_binary_tree_t&& other) noexcept
+    : base_type_t{}, _allocator{ std::move(other._allocator) }
+  {
+    this->_root  = other._root;
+    other._root  = nullptr;
   }
 
-  /**
-   * @brief remove_all it removes all elemnts that matches the value
-   * @param value
-   * @return the count of removed elemnts
-   * @note   complexity is O(repeated_values * log(n))
-   */
-  size_t
-  remove_all(const T& value) {
-    size_t removed_elements{ 0 };
-    while (remove(value)) {
-      removed_elements++;
+  basic_binary_tree_t&
+  operator=(const basic_binary_tree_t& other) {
+    if (this != &other) {
+      clear();
+      copy_nodes(other);
     }
-    return removed_elements;
+    return *this;
   }
 
-  /**
-   * @brief height gets the height of the three
-   * @return
-   */
-  inline size_t
-  height() const {
-    return height(this->_root);
+  basic_binary_tree_t&
+  operator=(basic_binary_tree_t&& other) noexcept {
+    if (this != &other) {
+      clear();
+      _allocator  = std::move(other._allocator);
+      this->_root = other._root;
+      other._root = nullptr;
+    }
+    return *this;
   }
 
-  /**
-   * @brief left_most
-   * @return the left most node
-   */
-  const node_type_t&
-  left_most() const {
-    return *avl_tree_t::leftmost(this->_root);
+  virtual
+  ~basic_binary_tree_t() {
+    clear();
   }
 
   /**
-   * @brief right_most
-   * @return the right most node
+   * @brief clear  it destroys all nodes through the allocator
    */
-  const node_type_t&
-  right_most() const {
-    return *avl_tree_t::rightmost(this->_root);
+  virtual void
+  clear() noexcept override {
+    destroy_subtree(this->_root);
+    this->_root = nullptr;
+    _allocator.release();
   }
 
   /**
-   * @brief contains   it searches the tree recursively for a value
-   * @param value      key value to be found
-   * @return           whether the value is in the tree or not
+   * @brief get_allocator  the node allocator
    */
-  bool
-  contains(const T& value) const {
-    return this->has_root() ? contains(this->root(), value) : false;
+  inline const allocator_t&
+  get_allocator() const {
+    return _allocator;
   }
 
   /**
-   * @brief root tree root
-   * @return tree root reference
+   * @brief begin  in-order iterator to the leftmost node
    */
-  const node_type_t&
-  root() const {
-    return base_type_t::root();
+  const_iterator
+  begin() const {
+    const node_type_t* node{ this->_root };
+    while (node && node->_left) {
+      node = node->_left;
+    }
+    return const_iterator{ node, this };
   }
 
   /**
-   * @brief root tree root
-   * @return tree root reference
+   * @brief end  in-order iterator past the rightmost node
    */
-  const node_type_t&
-  root() {
-    return base_type_t::root();
+  inline const_iterator
+  end() const {
+    return const_iterator{ nullptr, this };
   }
 
-  /**
-   * @brief enable_duplicates It makes the AVL tree allow multiple equal entries
-   * @default not allowed
-   */
-  void
-  enable_duplicates() {
-    _allow_duplicates = true;
+  inline const_iterator
+  cbegin() const {
+    return begin();
   }
 
-  /**
-   * @brief disable_duplicates It makes the AVL tree disallow multiple equal
-   * entries
-   * @default not allowed
-   */
-  void
-  disable_duplicates() {
-    _allow_duplicates = false;
+  inline const_iterator
+  cend() const {
+    return end();
   }
 
-  /**
-   * @brief size number of elements in tree
-   * @return number of elements in tree
-   */
-  size_t
-  size() const {
-    return _number_of_elements;
+  inline const_reverse_iterator
+  rbegin() const {
+    return const_reverse_iterator{ end() };
   }
 
-  /**
-   * @brief is_multiple_keys_allowed whether this class allowes or not
-   * multiple keys
-   * @return whether this class allowes or not multiple keys
-   */
-  inline bool
-  is_multiple_keys_allowed() const {
-    return _allow_duplicates;
+  inline const_reverse_iterator
+  rend() const {
+    return const_reverse_iterator{ begin() };
   }
 
+protected:
+
   /**
-   * @brief clear  it removes all elements from the tree
+   * @brief create_node  allocates a new node
    */
-  virtual void
-  clear() override {
-    base_type_t::clear();
-    _number_of_elements = 0;
+  template <typename ...Args>
+  inline node_type_t*
+  create_node(Args&&...args) {
+    return _allocator.create(std::forward<Args>(args)...);
   }
 
   /**
-   * @brief in_order recursive in order
-   * @param func
-   * @return
+   * @brief destroy_node  frees a node that has no children anymore
    */
-  size_t
-  in_order(const std::function<bool(const node_type_t&)>& func) const {
-    return base_type_t::in_order(func);
+  inline void
+  destroy_node(node_type_t* node) {
+    _allocator.destroy(node);
   }
 
   /**
-   * @brief in_order recursive in order
-   * @param func
-   * @return
+   * @brief destroy_subtree  it destroys the node and all of its descendents
+   * in post order, walking back through the parent links so it does not
+   * allocate. Children are unlinked before destroying their parent, so the
+   * node destructor never deletes them on its own.
    */
-  size_t
-  in_order(const std::function<bool(const node_type_t&)>& func) {
-    const base_type_t& ref{ static_cast<base_type_t&>(*this) };
-    return ref.in_order(func);
+  void
+  destroy_subtree(node_type_t* node) noexcept {
+    if (!node) {
+      return;
+    }
+    if (allocator_t::bulk_release && std::is_trivially_destructible<T>::value &&
+        node == this->_root) {
+      // the whole tree is freed at once by release()
+      return;
+    }
+    node_type_t* const top{ node };
+    while (node) {
+      if (node->_left) {
+        node = node->_left;
+      }
+      else if (node->_right) {
+        node = node->_right;
+      }
+      else {
+        node_type_t* parent{ node == top ? nullptr : node->_parent };
+        if (parent) {
+          (parent->_left == node ? parent->_left : parent->_right) = nullptr;
+        }
+        destroy_node(node);
+        node = parent;
+      }
+    }
+  }
+
+  /**
+   * @brief clone  it copies the subtree of node into target, iteratively and
+   * in pre order, so a fresh arena lays the copy out in one sequential pass.
+   * The walk goes down the left children and only stacks the right ones.
+   */
+  void
+  clone(node_type_t*& target, const node_type_t* node, node_type_t* parent) {
+    struct pending_t {
+      node_type_t**      link;
+      const node_type_t* source;
+      node_type_t*       parent;
+    };
+    std::vector<pending_t> pending;
+    pending_t next{ &target, node, parent };
+    while (next.source) {
+      node_type_t* copy{ create_node(next.source->get(), next.parent) };
+      copy->copy_balance(*next.source);
+      *next.link    = copy;
+      if (next.source->_right) {
+        pending.push_back({ &copy->_right, next.source->_right, copy });
+      }
+      if (next.source->_left) {
+        next = { &copy->_left, next.source->_left, copy };
+      }
+      else if (!pending.empty()) {
+        next = pending.back();
+        pending.pop_back();
+      }
+      else {
+        next.source = nullptr;
+      }
+    }
+  }
+
+  allocator_t _allocator;
+
+private:
+
+  void
+  copy_nodes(const basic_binary_tree_t& other) {
+    try {
+      clone(this->_root, other._root, nullptr);
+    }
+    catch (...) {
+      clear();
+      throw;
+    }
+  }
+};
+
+/**
+ * @brief templated simple binary tree
+ * @note  the nodes added with binary_node_t::add_left/add_right are allocated
+ * with new, so they can only be used with the default heap allocator, use the
+ * tree add_left/add_right otherwise.
+ */
+template <class T, class allocator_t>
+class binary_tree_t : public basic_binary_tree_t<T, allocator_t> {
+public:
+  using base_type_t    = basic_binary_tree_t<T, allocator_t>;
+  using node_type_t    = typename base_type_t::node_type_t;
+
+  binary_tree_t(const T& root) {
+    add_root(root);
+  }
+
+  binary_tree_t() = default;
+
+  explicit binary_tree_t(allocator_t&& allocator)
+    : base_type_t{ std::move(allocator) }
+  { }
+
+  /**
+   * @brief add_root it replaces the root and all its nodes
+   * @param root
+   */
+  binary_tree_t&
+  add_root(const T& root) {
+    this->clear();
+    this->_root = this->create_node(root, nullptr);
+    return *this;
+  }
+
+  /**
+   * @brief add_left  add left child to node using the tree allocator
+   * @return whether it could be added or not, it means, if there was no
+   * previous left child
+   */
+  bool
+  add_left(node_type_t& node, const T& child) {
+    bool ok{ !node._left };
+    if (ok) {
+      node._left = this->create_node(child, &node);
+    }
+    return ok;
+  }
+
+  /**
+   * @brief add_right  add right child to node using the tree allocator
+   * @return whether it could be added or not, it means, if there was no
+   * previous right child
+   */
+  bool
+  add_right(node_type_t& node, const T& child) {
+    bool ok{ !node._right };
+    if (ok) {
+      node._right = this->create_node(child, &node);
+    }
+    return ok;
+  }
+
+  /**
+   * @brief delete_child  it removes the left or right subtree of node using
+   * the tree allocator
+   * @return whether there was a child to be removed
+   */
+  bool
+  delete_child(node_type_t& node, typename node_type_t::direction child) {
+    node_type_t*& target{
+      child == node_type_t::direction::left ? node._left : node._right };
+    bool ok{ target != nullptr };
+    this->destroy_subtree(target);
+    target = nullptr;
+    return ok;
+  }
+};
+
+/**
+ * @brief templated avl tree
+ * @param allocator_t  node allocator, see node_allocator.h
+ */
+template <class T, class allocator_t>
+class avl_tree_t : public basic_binary_tree_t<T, allocator_t> {
+public:
+  using base_type_t            = basic_binary_tree_t<T, allocator_t>;
+  using node_type_t            = typename base_type_t::node_type_t;
+  using iterator               = typename base_type_t::iterator;
+  using const_iterator         = typename base_type_t::const_iterator;
+  using reverse_iterator       = typename base_type_t::reverse_iterator;
+  using const_reverse_iterator = typename base_type_t::const_reverse_iterator;
+
+  /**
+   * @brief avl_tree_t  default constructor
+   * @param root
+   */
+  avl_tree_t(const T& root) {
+    insert(root);
+  }
+
+  avl_tree_t() = default;
+
+  explicit avl_tree_t(allocator_t&& allocator)
+    : base_type_t{ std::move(allocator) }
+  { }
+
+  /**
+   * @brief insert inserts a non existent previously value in the tree.
+   * It's iterative: it descends to the leaf and rebalances bottom-up following
+   * the parent nodes, until a subtree keeps its height.
+   * @param value
+   * @return  whether the value was inserted or not, if the value is already in
+   * tree it will return false
+   */
+  bool
+  insert(const T& value) {
+    node_type_t* parent{ nullptr };
+    node_type_t* node  { this->_root };
+    bool         right { false };
+    while (node) {
+      parent = node;
+      if (value < node->get()) {
+        right = false;
+      }
+      else if (value > node->get() || _allow_duplicates) {
+        right = true;
+      }
+      else {
+        return false;
+      }
+      node = right ? node->_right : node->_left;
+    }
+
+    node = this->create_node(value, parent);
+    augment(node);
+    if (!parent) {
+      this->_root = node;
+    }
+    else if (right) {
+      parent->_right = node;
+    }
+    else {
+      parent->_left = node;
+    }
+    _number_of_elements++;
+    rebalance_path(parent);
+    return true;
+  }
+
+  /**
+   * @brief remove  it removes one value from the tree, iteratively
+   * @param value
+   * @return   If the tree contained the value
+   */
+  bool
+  remove(const T& value) {
+    node_type_t* node{ find_node(value) };
+    if (!node) {
+      return false;
+    }
+    // with two children, the successor value replaces the removed one and the
+    // successor node, that has no left child, is unlinked instead
+    if (node->_left && node->_right) {
+      node_type_t* successor{ leftmost(node->_right) };
+      node->set_value(std::move(successor->get()));
+      node = successor;
+    }
+    node_type_t* child { node->_left ? node->_left : node->_right };
+    node_type_t* parent{ node->_parent };
+    if (child) {
+      child->set_parent(parent);
+    }
+    replace_child(parent, node, child);
+    node->_left = node->_right = nullptr;
+    this->destroy_node(node);
+    _number_of_elements--;
+    rebalance_path(parent);
+    return true;
+  }
+
+  /**
+   * @brief remove_all it removes all elemnts that matches the value
+   * @param value
+   * @return the count of removed elemnts
+   * @note   complexity is O(repeated_values * log(n))
+   */
+  size_t
+  remove_all(const T& value) {
+    size_t removed_elements{ 0 };
+    while (remove(value)) {
+      removed_elements++;
+    }
+    return removed_elements;
+  }
+
+  /**
+   * @brief height gets the height of the three
+   * @return
+   */
+  inline size_t
+  height() const {
+    return height(this->_root);
+  }
+
+  /**
+   * @brief left_most
+   * @return the left most node
+   */
+  const node_type_t&
+  left_most() const {
+    return *avl_tree_t::leftmost(this->_root);
+  }
+
+  /**
+   * @brief right_most
+   * @return the right most node
+   */
+  const node_type_t&
+  right_most() const {
+    return *avl_tree_t::rightmost(this->_root);
+  }
+
+  /**
+   * @brief find  it searches the tree for a value
+   * @return iterator to an element equal to value, or end()
+   */
+  const_iterator
+  find(const T& value) const {
+    return const_iterator{ find_node(value), this };
+  }
+
+  /**
+   * @brief lower_bound  first element not lower than value
+   * @return iterator to the element, or end() if there is none
+   */
+  const_iterator
+  lower_bound(const T& value) const {
+    const node_type_t* result{ nullptr };
+    const node_type_t* node  { this->_root };
+    while (node) {
+      if (node->get() < value) {
+        node = node->_right;
+      }
+      else {
+        result = node;
+        node   = node->_left;
+      }
+    }
+    return const_iterator{ result, this };
+  }
+
+  /**
+   * @brief upper_bound  first element greater than value
+   * @return iterator to the element, or end() if there is none
+   */
+  const_iterator
+  upper_bound(const T& value) const {
+    const node_type_t* result{ nullptr };
+    const node_type_t* node  { this->_root };
+    while (node) {
+      if (value < node->get()) {
+        result = node;
+        node   = node->_left;
+      }
+      else {
+        node = node->_right;
+      }
+    }
+    return const_iterator{ result, this };
+  }
+
+  /**
+   * @brief equal_range  all elements equal to value, [lower_bound, upper_bound)
+   */
+  inline std::pair<const_iterator, const_iterator>
+  equal_range(const T& value) const {
+    return { lower_bound(value), upper_bound(value) };
+  }
+
+  /**
+   * @brief contains   it searches the tree for a value
+   * @param value      key value to be found
+   * @return           whether the value is in the tree or not
+   */
+  bool
+  contains(const T& value) const {
+    return find_node(value) != nullptr;
+  }
+
+  /**
+   * @brief root tree root
+   * @return tree root reference
+   */
+  const node_type_t&
+  root() const {
+    return base_type_t::root();
+  }
+
+  /**
+   * @brief root tree root
+   * @return tree root reference
+   */
+  const node_type_t&
+  root() {
+    return base_type_t::root();
+  }
+
+  /**
+   * @brief enable_duplicates It makes the AVL tree allow multiple equal entries
+   * @default not allowed
+   */
+  void
+  enable_duplicates() {
+    _allow_duplicates = true;
+  }
+
+  /**
+   * @brief disable_duplicates It makes the AVL tree disallow multiple equal
+   * entries
+   * @default not allowed
+   */
+  void
+  disable_duplicates() {
+    _allow_duplicates = false;
+  }
+
+  /**
+   * @brief has_order_statistics  whether the nodes keep the size of their
+   * subtree, as the ones of an order_statistic_tree_t, so every insertion and
+   * removal updates the sizes up to the root
+   */
+  inline static constexpr bool
+  has_order_statistics() {
+    return order_statistics;
+  }
+
+  /**
+   * @brief rank  number of elements lower than value, O(log n)
+   * @note  only available with order statistics
+   */
+  inline size_t
+  rank(const T& value) const {
+    return count_lower(value, false);
+  }
+
+  /**
+   * @brief select  the k-th lowest element, starting from 0, O(log n)
+   * @return iterator to the element, or end() if k >= size()
+   * @note  only available with order statistics
+   */
+  const_iterator
+  select(size_t k) const {
+    static_assert(order_statistics, "Order statistics are disabled");
+    const node_type_t* node{ this->_root };
+    while (node) {
+      const size_t lower{ count(node->_left) };
+      if (k < lower) {
+        node = node->_left;
+      }
+      else if (k > lower) {
+        k   -= lower + 1;
+        node = node->_right;
+      }
+      else {
+        break;
+      }
+    }
+    return const_iterator{ node, this };
+  }
+
+  /**
+   * @brief count_range  number of elements in [first, last], O(log n)
+   * @note  only available with order statistics
+   */
+  size_t
+  count_range(const T& first, const T& last) const {
+    if (last < first) {
+      return 0u;
+    }
+    return count_lower(last, true) - count_lower(first, false);
+  }
+
+  /**
+   * @brief rebuild  It replaces the content of the tree by the sorted range
+   * [first, last) in O(n), building a perfectly balanced tree without
+   * rotations. Repeated values are skipped unless duplicates are enabled.
+   * @throws std::invalid_argument if the range is not sorted, the tree is left
+   * empty
+   */
+  template <class Iterator>
+  avl_tree_t&
+  rebuild(Iterator first, Iterator last) {
+    clear();
+    const size_t count{ tools::count_sorted(first, last, _allow_duplicates) };
+    Iterator previous{ last };
+    try {
+      this->_root = build(first, previous, last, count, nullptr);
+    }
+    catch (...) {
+      clear();
+      throw;
+    }
+    _number_of_elements = count;
+    return *this;
+  }
+
+  /**
+   * @brief split  It moves all elements greater than or equal to key to a new
+   * tree, this tree keeps the lower ones. O(log n) with order statistics,
+   * otherwise the lower elements are counted in O(k)
+   * @return the tree with the elements greater than or equal to key
+   */
+  avl_tree_t
+  split(const T& key) {
+    const size_t size{ _number_of_elements };
+    size_t lower_size{ 0 };
+    if constexpr (order_statistics) {
+      lower_size = count_lower(key, false);
+    }
+    else {
+      for (auto it = this->begin(); it != this->end() && *it < key; ++it) {
+        lower_size++;
+      }
+    }
+    auto parts{ split_before(detach_root(), key) };
+    this->_root = parts.first;
+    _number_of_elements = lower_size;
+
+    avl_tree_t greater{ this->_allocator.select_on_copy() };
+    greater._allow_duplicates   = _allow_duplicates;
+    greater._number_of_elements = size - _number_of_elements;
+    adopt(greater, parts.second);
+    return greater;
+  }
+
+  /**
+   * @brief join  It appends all elements of other, that must be greater than
+   * the elements of this tree. O(log n)
+   * @throws std::invalid_argument if other has elements lower than the
+   * greatest element of this tree, both trees are left unchanged
+   */
+  avl_tree_t&
+  join(avl_tree_t&& other) {
+    if (!other.has_root()) {
+      return *this;
+    }
+    if (this->has_root() && other.left_most().get() < right_most().get()) {
+      throw std::invalid_argument{ "The trees overlap" };
+    }
+    const size_t size{ _number_of_elements + other._number_of_elements };
+    node_type_t* greater{ take_nodes(other) };
+    this->_root = join2(detach_root(), greater);
+    _number_of_elements = size;
+    return *this;
+  }
+
+  /**
+   * @brief set_union  It adds all elements of other that are not in this tree,
+   * in O(m log(n/m + 1)), m being the size of the smallest tree. Large trees
+   * are processed in parallel.
+   * @note  both trees are considered sets, without duplicates
+   */
+  avl_tree_t&
+  set_union(avl_tree_t&& other) {
+    return set_operation(std::move(other), operation_t::union_op);
+  }
+
+  /**
+   * @brief set_intersection  It keeps only the elements that are also in other
+   * in O(m log(n/m + 1)). Large trees are processed in parallel.
+   * @note  both trees are considered sets, without duplicates
+   */
+  avl_tree_t&
+  set_intersection(avl_tree_t&& other) {
+    return set_operation(std::move(other), operation_t::intersection_op);
+  }
+
+  /**
+   * @brief set_difference  It removes all elements that are in other in
+   * O(m log(n/m + 1)). Large trees are processed in parallel.
+   * @note  both trees are considered sets, without duplicates
+   */
+  avl_tree_t&
+  set_difference(avl_tree_t&& other) {
+    return set_operation(std::move(other), operation_t::difference_op);
+  }
+
+  /**
+   * @brief size number of elements in tree
+   * @return number of elements in tree
+   */
+  size_t
+  size() const {
+    return _number_of_elements;
+  }
+
+  /**
+   * @brief is_multiple_keys_allowed whether this class allowes or not
+   * multiple keys
+   * @return whether this class allowes or not multiple keys
+   */
+  inline bool
+  is_multiple_keys_allowed() const {
+    return _allow_duplicates;
+  }
+
+  /**
+   * @brief clear  it removes all elements from the tree
+   */
+  virtual void
+  clear() noexcept override {
+    base_type_t::clear();
+    _number_of_elements = 0;
+  }
+
+  /**
+   * @brief in_order recursive in order
+   * @param func
+   * @return
+   */
+  size_t
+  in_order(const std::function<bool(const node_type_t&)>& func) const {
+    return base_type_t::in_order(func);
+  }
+
+  /**
+   * @brief in_order recursive in order
+   * @param func
+   * @return
+   */
+  size_t
+  in_order(const std::function<bool(const node_type_t&)>& func) {
+    const base_type_t& ref{ static_cast<base_type_t&>(*this) };
+    return ref.in_order(func);
   }
 
   /**
@@ -717,210 +1579,669 @@ public:
     return ref.depth_first_search(pred);
   }
 
+  /**
+   * @brief in_order  recursive in order with an inlined visitor, callable as
+   * bool(const node_type_t&)
+   */
+  template <class visitor_t>
+  size_t
+  in_order(visitor_t&& visitor) const {
+    return base_type_t::in_order(visitor);
+  }
+
+  template <class visitor_t>
+  size_t
+  in_order(visitor_t&& visitor) {
+    const base_type_t& ref{ static_cast<base_type_t&>(*this) };
+    return ref.in_order(visitor);
+  }
+
+  /**
+   * @brief pre_order  recursive pre order with an inlined visitor
+   */
+  template <class visitor_t>
+  size_t
+  pre_order(visitor_t&& visitor) const {
+    return base_type_t::pre_order(visitor);
+  }
+
+  template <class visitor_t>
+  size_t
+  pre_order(visitor_t&& visitor) {
+    const base_type_t& ref{ static_cast<base_type_t&>(*this) };
+    return ref.pre_order(visitor);
+  }
+
+  /**
+   * @brief pos_order  recursive pos order with an inlined visitor
+   */
+  template <class visitor_t>
+  size_t
+  pos_order(visitor_t&& visitor) const {
+    return base_type_t::pos_order(visitor);
+  }
+
+  template <class visitor_t>
+  size_t
+  pos_order(visitor_t&& visitor) {
+    const base_type_t& ref{ static_cast<base_type_t&>(*this) };
+    return ref.pos_order(visitor);
+  }
+
+  /**
+   * @brief breadth_first_search  BFS with an inlined visitor, the queue is
+   * kept in scratch so it can be reused between searches
+   */
+  template <class visitor_t>
+  size_t
+  breadth_first_search(visitor_t&& visitor) const {
+    return base_type_t::breadth_first_search(visitor);
+  }
+
+  template <class visitor_t>
+  size_t
+  breadth_first_search(visitor_t&& visitor) {
+    const base_type_t& ref{ static_cast<base_type_t&>(*this) };
+    return ref.breadth_first_search(visitor);
+  }
+
+  template <class visitor_t>
+  size_t
+  breadth_first_search(visitor_t&& visitor,
+                       std::vector<const node_type_t*>& scratch) const {
+    return base_type_t::breadth_first_search(visitor, scratch);
+  }
+
+  /**
+   * @brief depth_first_search  DFS with an inlined visitor, the stack is
+   * kept in scratch so it can be reused between searches
+   */
+  template <class visitor_t>
+  size_t
+  depth_first_search(visitor_t&& visitor) const {
+    return base_type_t::depth_first_search(visitor);
+  }
+
+  template <class visitor_t>
+  size_t
+  depth_first_search(visitor_t&& visitor) {
+    const base_type_t& ref{ static_cast<base_type_t&>(*this) };
+    return ref.depth_first_search(visitor);
+  }
+
+  template <class visitor_t>
+  size_t
+  depth_first_search(visitor_t&& visitor,
+                     std::vector<const node_type_t*>& scratch) const {
+    return base_type_t::depth_first_search(visitor, scratch);
+  }
+
+  /**
+   * @brief parallel_pre_order  pre order search of the subtrees from several
+   * threads, see tree_t::parallel_pre_order
+   */
+  template <class visitor_t>
+  size_t
+  parallel_pre_order(visitor_t&& visitor,
+                     size_t threads = std::thread::hardware_concurrency()) const {
+    return base_type_t::parallel_pre_order(visitor, threads);
+  }
+
+  /**
+   * @brief parallel_for_each_node  it calls func(const node_type_t&) for each
+   * node from several threads, see tree_t::parallel_for_each_node
+   */
+  template <class function_t>
+  size_t
+  parallel_for_each_node(function_t&& func,
+                         size_t threads = std::thread::hardware_concurrency()) const {
+    return base_type_t::parallel_for_each_node(func, threads);
+  }
+
   protected:
 
   /**
-   * @brief contains  searches the tree recursively for a value
-   * @param node      current node
+   * @brief find_node  iterative search
    * @param value     value
-   * @return          whether the value is in the tree or not
+   * @return          the first node found equal to value, or nullptr
    */
-  bool
-  contains(const node_type_t& node, const T&value) const {
-    bool found{ false };
-    if (value < *node) {
-      if (node.has_left()) {
-        found = contains(node.left(), value);
+  node_type_t*
+  find_node(const T& value) const {
+    node_type_t* node{ this->_root };
+    while (node) {
+      if (value < node->get()) {
+        node = node->_left;
       }
-    }
-    else if (value > *node) {
-      if (node.has_right()) {
-        found = contains(node.right(), value);
+      else if (value > node->get()) {
+        node = node->_right;
+      }
+      else {
+        break;
       }
     }
-    else {
-      found = value == *node;
-    }
-    return found;
+    return node;
   }
 
   /**
-   * @brief insert_left  inserts in the left side of the node
-   * @param node
-   * @param value
-   * @param inserted
+   * @brief replace_child  it links child where node was linked to parent
    */
   void
-  insert_left(node_type_t*& node, const T& value, bool& inserted) {
-    if (node->has_left()) {
-      insert(node->_left, value, inserted);
+  replace_child(node_type_t* parent, const node_type_t* node,
+                node_type_t* child) {
+    if (!parent) {
+      this->_root = child;
+    }
+    else if (parent->_left == node) {
+      parent->_left = child;
     }
     else {
-      node->add_left(value);
-      _number_of_elements++;
+      parent->_right = child;
     }
   }
 
   /**
-   * @brief insert_right  it inserts in the right side of the node
-   * @param node
-   * @param value
-   * @param inserted
+   * @brief rebalance_path  it updates the heights and rotates the unbalanced
+   * nodes from node up to the root. It stops as soon as a subtree keeps its
+   * previous height, since nothing above it changes, unless the subtree sizes
+   * or a node_augmentation_t are maintained.
+   * @param node  parent of the inserted or unlinked node
    */
   void
-  insert_right(node_type_t*& node, const T& value, bool& inserted) {
-    if (node->has_right()) {
-      insert(node->_right, value, inserted);
+  rebalance_path(node_type_t* node) {
+    while (node) {
+      node_type_t* parent{ node->_parent };
+      const size_t previous{ node->_height };
+      node_type_t* head{ rebalance(node) };
+      if (head != node) {
+        replace_child(parent, node, head);
+      }
+      if (head->_height == previous && !order_statistics &&
+          !node_augmentation_t<T>::enabled) {
+        break;
+      }
+      node = parent;
     }
-    else {
-      node->add_right(value);
-      _number_of_elements++;
+  }
+
+  /**
+   * @brief rebalance  it updates the height of node and rotates it if its
+   * children heights differ by 2
+   * @return the head of the subtree after the rotation
+   */
+  inline static node_type_t*
+  rebalance(node_type_t* node) {
+    update_height(node);
+    const long factor{ balance(node) };
+    if (factor > 1) {
+      return balance(node->_left) >= 0 ? rotate_right(node)
+                                       : double_rotate_right(node);
     }
+    if (factor < -1) {
+      return balance(node->_right) <= 0 ? rotate_left(node)
+                                        : double_rotate_left(node);
+    }
+    return node;
   }
 
   /**
-   * @brief rotate_if_needed   Rotate the tree if the children nodes are not
-   * balanced
-   * @param father[in|out] node that will be the parent after the rotation
-   * @param value          value inserted
+   * @brief balance  height(left) - height(right)
    */
-  void
-  rotate_if_needed(node_type_t*& father, const T& value) {
-    father->_height =
-      std::max(height(father->_left), height(father->_right)) + 1;
+  inline static long
+  balance(const node_type_t* node) {
+    return static_cast<long>(height(node->_left)) -
+           static_cast<long>(height(node->_right));
+  }
+
+  inline static void
+  update_height(node_type_t* node) {
+    node->_height = std::max(height(node->_left), height(node->_right)) + 1;
+    recount(node);
+    augment(node);
+  }
+
+  /**
+   * @brief augment  it updates the node_augmentation_t of node from its
+   * children
+   */
+  inline static void
+  augment(node_type_t* node) {
+    if constexpr (node_augmentation_t<T>::enabled) {
+      node_augmentation_t<T>::update(node->get(),
+                                     node->_left  ? &node->_left->get()  : nullptr,
+                                     node->_right ? &node->_right->get() : nullptr);
+    }
+  }
+
+  /**
+   * @brief count  number of nodes in the subtree of node
+   */
+  inline static size_t
+  count(const node_type_t* node) {
+    static_assert(order_statistics, "Order statistics are disabled");
+    return node ? node->_count : 0u;
+  }
+
+  /**
+   * @brief recount  it updates the subtree size of node from its children,
+   * it does nothing without order statistics
+   */
+  inline static void
+  recount(node_type_t* node) {
+    if constexpr (order_statistics) {
+      node->_count = count(node->_left) + count(node->_right) + 1;
+    }
+  }
 
-    if (height(father->_left) - height(father->_right) == 2) {
-      if (value < father->_left->get()) {
-        father = rotate_right(father);
+  /**
+   * @brief count_lower  number of elements lower than value, or lower than or
+   * equal to value if inclusive
+   */
+  size_t
+  count_lower(const T& value, bool inclusive) const {
+    static_assert(order_statistics, "Order statistics are disabled");
+    size_t result{ 0 };
+    const node_type_t* node{ this->_root };
+    while (node) {
+      const bool lower{ inclusive ? !(value < node->get())
+                                  : node->get() < value };
+      if (lower) {
+        result += count(node->_left) + 1;
+        node = node->_right;
       }
       else {
-        father = double_rotate_right(father);
+        node = node->_left;
       }
     }
-    else if (height(father->_right) - height(father->_left) == 2) {
-      if (value > father->_right->get()) {
-        father = rotate_left(father);
-      }
-      else {
-        father = double_rotate_left(father);
+    return result;
+  }
+
+  enum class operation_t {
+    union_op,
+    intersection_op,
+    difference_op
+  };
+
+  /**
+   * @brief split_t  result of splitting a subtree by a key, all subtrees are
+   * detached (no parent)
+   */
+  struct split_t {
+    node_type_t* lower  { nullptr };
+    node_type_t* found  { nullptr };  // single node equal to the key
+    node_type_t* greater{ nullptr };
+  };
+
+  /**
+   * Subtrees smaller than this height are never processed in parallel
+   */
+  static constexpr size_t parallel_height{ 14 };
+
+  /**
+   * @brief build  it builds a balanced subtree with the next count values of
+   * the sorted range, in order, skipping repeated values if needed
+   */
+  template <class Iterator>
+  node_type_t*
+  build(Iterator& it, Iterator& previous, const Iterator& last, size_t count,
+        node_type_t* parent) {
+    if (!count) {
+      return nullptr;
+    }
+    const size_t lower{ count / 2 };
+    node_type_t* left{ build(it, previous, last, lower, nullptr) };
+    if (previous != last && !_allow_duplicates) {
+      while (!(*previous < *it)) {
+        ++it;
       }
     }
+    node_type_t* node{ nullptr };
+    try {
+      node = this->create_node(*it, parent);
+    }
+    catch (...) {
+      this->destroy_subtree(left);
+      throw;
+    }
+    previous = it++;
+    node->_left = left;
+    if (left) {
+      left->set_parent(node);
+    }
+    try {
+      node->_right = build(it, previous, last, count - lower - 1, node);
+    }
+    catch (...) {
+      // node is not linked to its parent yet, so it's the top of the subtree
+      this->destroy_subtree(node);
+      throw;
+    }
+    update_height(node);
+    return node;
   }
 
   /**
-   * @brief rotate_on_remove  Rotates the AVL tree when an element was removed
-   * from the tree
-   * @param father the node will be the father after rotation
-   * @param value
+   * @brief detach_root  it takes all nodes out of the tree
+   */
+  inline node_type_t*
+  detach_root() {
+    node_type_t* root{ this->_root };
+    this->_root = nullptr;
+    _number_of_elements = 0;
+    return root;
+  }
+
+  /**
+   * @brief take_nodes  it takes all nodes out of other, they are moved if
+   * both allocators are interchangeable, or copied into this allocator
+   * otherwise
+   */
+  node_type_t*
+  take_nodes(avl_tree_t& other) {
+    node_type_t* nodes{ nullptr };
+    if (this->_allocator == other._allocator) {
+      nodes = other.detach_root();
+    }
+    else {
+      this->clone(nodes, other._root, nullptr);
+      other.clear();
+    }
+    return nodes;
+  }
+
+  /**
+   * @brief adopt  it gives the nodes created by this allocator to target
    */
   void
-  rotate_on_remove_if_needed(node_type_t*& father) {
-    father->_height = std::max(height(father->_left), height(father->_right)) + 1;
-
-    // If node is unbalanced
-    // If left node is deleted, right case
-    if (height(father->_left) - height(father->_right) == 2) {
-      // right right case
-      if (height(father->_left->_left) - height(father->_left->_right) == 1) {
-        father = rotate_right(father);
-      }
-      // right left case
-      else {
-        father = double_rotate_right(father);
-      }
+  adopt(avl_tree_t& target, node_type_t* nodes) {
+    if (this->_allocator == target._allocator) {
+      target._root = nodes;
     }
-    // If right node is deleted, left case
-    else if (height(father->_right) - height(father->_left) == 2) {
-      // left left case
-      if (height(father->_right->_right) - height(father->_right->_left) == 1) {
-        father = rotate_left(father);
+    else {
+      target.clone(target._root, nodes, nullptr);
+      this->destroy_subtree(nodes);
+    }
+  }
+
+  /**
+   * @brief detach  it unlinks the children of node and returns them
+   */
+  inline static std::pair<node_type_t*, node_type_t*>
+  detach(node_type_t* node) {
+    std::pair<node_type_t*, node_type_t*> children{ node->_left, node->_right };
+    for (auto child : { node->_left, node->_right }) {
+      if (child) {
+        child->set_parent(nullptr);
       }
-      // left right case
-      else {
-        father = double_rotate_left(father);
+    }
+    node->_left = node->_right = nullptr;
+    node->set_parent(nullptr);
+    update_height(node);
+    return children;
+  }
+
+  /**
+   * @brief rebalance_up  it rebalances from node up to the root of its
+   * subtree
+   * @return the root of the subtree
+   */
+  static node_type_t*
+  rebalance_up(node_type_t* node) {
+    node_type_t* top{ node };
+    while (node) {
+      node_type_t* parent{ node->_parent };
+      node_type_t* head  { rebalance(node) };
+      if (parent) {
+        if (parent->_left == node) {
+          parent->_left = head;
+        }
+        else {
+          parent->_right = head;
+        }
       }
+      top  = head;
+      node = parent;
     }
+    return top;
   }
 
   /**
-   * @brief insert  inserts the value into the tree, make necessary rotations
-   * to keep tree's balance
-   * @param node
-   * @param value
-   * @return
+   * @brief join  it joins two detached subtrees with a detached middle node,
+   * all values of lower < middle < all values of greater.
+   * It costs O(|height(lower) - height(greater)| + 1)
+   * @return the root of the joined subtree
    */
-  void
-  insert(node_type_t*& node, const T& value, bool& inserted) {
-    node_type_t* father{ node };
-    if (node) {
-      if (value < node->get()) {
-        insert_left(node, value, inserted);
+  static node_type_t*
+  join(node_type_t* lower, node_type_t* middle, node_type_t* greater) {
+    const auto link{ [](node_type_t* parent, node_type_t* left,
+                        node_type_t* right) {
+      parent->_left  = left;
+      parent->_right = right;
+      if (left) {
+        left->set_parent(parent);
       }
-      else if (value > node->get()) {
-        insert_right(node, value, inserted);
+      if (right) {
+        right->set_parent(parent);
       }
-      else if (_allow_duplicates) {
-        insert_right(node, value, inserted);
+      update_height(parent);
+    }};
+
+    if (height(lower) > height(greater) + 1) {
+      // the middle node goes down the right spine of the lower subtree
+      node_type_t* parent{ nullptr };
+      node_type_t* spine { lower };
+      while (height(spine) > height(greater) + 1) {
+        parent = spine;
+        spine  = spine->_right;
       }
-      else {
-        inserted = false;
+      link(middle, spine, greater);
+      parent->_right = middle;
+      middle->set_parent(parent);
+      return rebalance_up(parent);
+    }
+    if (height(greater) > height(lower) + 1) {
+      node_type_t* parent{ nullptr };
+      node_type_t* spine { greater };
+      while (height(spine) > height(lower) + 1) {
+        parent = spine;
+        spine  = spine->_left;
       }
+      link(middle, lower, spine);
+      parent->_left = middle;
+      middle->set_parent(parent);
+      return rebalance_up(parent);
     }
-    // I'm root:
-    else {
-      add_root(value);
-      _number_of_elements++;
-      father = this->_root;
+    link(middle, lower, greater);
+    middle->set_parent(nullptr);
+    return middle;
+  }
+
+  /**
+   * @brief join2  it joins two detached subtrees, all values of lower < all
+   * values of greater
+   */
+  static node_type_t*
+  join2(node_type_t* lower, node_type_t* greater) {
+    if (!lower) {
+      return greater;
     }
+    if (!greater) {
+      return lower;
+    }
+    node_type_t* last{ nullptr };
+    lower = split_last(lower, last);
+    return join(lower, last, greater);
+  }
 
-    if (inserted) {
-      rotate_if_needed(father, value);
+  /**
+   * @brief split_last  it removes the rightmost node of a detached subtree
+   * @param last[out]  the rightmost node, detached
+   * @return the root of the remaining subtree
+   */
+  static node_type_t*
+  split_last(node_type_t* node, node_type_t*& last) {
+    auto children{ detach(node) };
+    if (!children.second) {
+      last = node;
+      return children.first;
     }
+    node_type_t* greater{ split_last(children.second, last) };
+    return join(children.first, node, greater);
+  }
 
-    node = father;
+  /**
+   * @brief split  it splits a detached subtree by key, O(log n)
+   */
+  static split_t
+  split(node_type_t* node, const T& key) {
+    if (!node) {
+      return {};
+    }
+    auto children{ detach(node) };
+    if (key < node->get()) {
+      split_t parts{ split(children.first, key) };
+      parts.greater = join(parts.greater, node, children.second);
+      return parts;
+    }
+    if (node->get() < key) {
+      split_t parts{ split(children.second, key) };
+      parts.lower = join(children.first, node, parts.lower);
+      return parts;
+    }
+    return { children.first, node, children.second };
   }
 
   /**
-   * @brief remove remove an element from tree, rotate if necessary to keep the
-   * tree's balance
-   * @param node
-   * @param value
-   * @return
+   * @brief split_before  it splits a detached subtree in the values lower than
+   * key and the values greater than or equal to key, even with duplicates
    */
-  void
-  remove(node_type_t*& node, const T& value, bool& removed) {
-    node_type_t* temp{ node };
+  static std::pair<node_type_t*, node_type_t*>
+  split_before(node_type_t* node, const T& key) {
+    if (!node) {
+      return {};
+    }
+    auto children{ detach(node) };
+    if (node->get() < key) {
+      auto parts{ split_before(children.second, key) };
+      parts.first = join(children.first, node, parts.first);
+      return parts;
+    }
+    auto parts{ split_before(children.first, key) };
+    parts.second = join(parts.second, node, children.second);
+    return parts;
+  }
 
-    if (node) {
-      // Searching for element
-      if (value < node->get()) {
-        remove(node->_left, value, removed);
+  /**
+   * @brief set_operation  join based union, intersection and difference of
+   * this tree and other. The discarded nodes are collected and destroyed at
+   * the end, so the recursion never touches the allocator and can be forked.
+   */
+  avl_tree_t&
+  set_operation(avl_tree_t&& other, operation_t operation) {
+    if (this == &other) {
+      if (operation == operation_t::difference_op) {
+        clear();
       }
-      else if (value > node->get()) {
-        remove(node->_right, value, removed);
+      return *this;
+    }
+    const size_t size{ _number_of_elements + other._number_of_elements };
+    node_type_t* nodes{ take_nodes(other) };
+    std::vector<node_type_t*> garbage;
+    const size_t threads{ std::max(1u, std::thread::hardware_concurrency()) };
+    size_t forks{ 0 };
+    while ((1u << forks) < threads) {
+      forks++;
+    }
+    this->_root = set_operation(detach_root(), nodes, operation, garbage, forks);
+    _number_of_elements = size - garbage.size();
+    for (auto node : garbage) {
+      this->destroy_node(node);
+    }
+    return *this;
+  }
+
+  static node_type_t*
+  set_operation(node_type_t* first, node_type_t* second, operation_t operation,
+                std::vector<node_type_t*>& garbage, size_t forks) {
+    if (!first || !second) {
+      node_type_t* kept{ nullptr };
+      if (operation == operation_t::union_op) {
+        kept = first ? first : second;
       }
-      // Element found With 2 children
-      else if (node->children_count() == 2u) {
-        temp = leftmost(node->_right);
-        node->set_value(*temp);
-        remove(node->_right, *temp, removed);
+      else if (operation == operation_t::difference_op) {
+        kept = first;
+        collect(second, garbage);
       }
-      // With one or zero child
       else {
-        temp = node;
-        node = node->has_left() ? node->_left : node->_right;
-        if (node) {
-          temp->_left = temp->_right = nullptr;
-          node->set_parent(temp->_parent);
-        }
-        delete temp;
-        removed = true;
-        _number_of_elements--;
+        collect(first, garbage);
+        collect(second, garbage);
+      }
+      return kept;
+    }
+
+    // the difference splits the first tree by the root of the second one
+    const bool by_first{ operation != operation_t::difference_op };
+    node_type_t* pivot{ by_first ? first : second };
+    auto children{ detach(pivot) };
+    split_t parts{ split(by_first ? second : first, pivot->get()) };
+
+    node_type_t* lower  { nullptr };
+    node_type_t* greater{ nullptr };
+    if (forks && std::max(height(first), height(second)) >= parallel_height) {
+      std::vector<node_type_t*> forked_garbage;
+      auto forked{ std::async(std::launch::async, [&]() {
+        return by_first
+          ? set_operation(children.first, parts.lower, operation, forked_garbage, forks - 1)
+          : set_operation(parts.lower, children.first, operation, forked_garbage, forks - 1);
+      }) };
+      greater = by_first
+        ? set_operation(children.second, parts.greater, operation, garbage, forks - 1)
+        : set_operation(parts.greater, children.second, operation, garbage, forks - 1);
+      lower = forked.get();
+      garbage.insert(garbage.end(), forked_garbage.begin(), forked_garbage.end());
+    }
+    else {
+      lower = by_first
+        ? set_operation(children.first, parts.lower, operation, garbage, 0)
+        : set_operation(parts.lower, children.first, operation, garbage, 0);
+      greater = by_first
+        ? set_operation(children.second, parts.greater, operation, garbage, 0)
+        : set_operation(parts.greater, children.second, operation, garbage, 0);
+    }
+
+    switch (operation) {
+    case operation_t::union_op:
+      if (parts.found) {
+        garbage.push_back(parts.found);
       }
+      return join(lower, pivot, greater);
 
-      if (node) {
-        rotate_on_remove_if_needed(node);
+    case operation_t::intersection_op:
+      if (parts.found) {
+        garbage.push_back(parts.found);
+        return join(lower, pivot, greater);
       }
+      garbage.push_back(pivot);
+      return join2(lower, greater);
+
+    default:
+      garbage.push_back(pivot);
+      if (parts.found) {
+        garbage.push_back(parts.found);
+      }
+      return join2(lower, greater);
+    }
+  }
+
+  /**
+   * @brief collect  it adds all nodes of a detached subtree to garbage
+   */
+  static void
+  collect(node_type_t* node, std::vector<node_type_t*>& garbage) {
+    if (node) {
+      auto children{ detach(node) };
+      garbage.push_back(node);
+      collect(children.first,  garbage);
+      collect(children.second, garbage);
     }
   }
 
@@ -945,11 +2266,18 @@ public:
     if (other && other->has_left()) {
       head = other->_left;
       other->_left   = head->_right;
+      if (other->_left) {
+        other->_left->set_parent(other);
+      }
       head->_right   = other;
       head->set_parent(other->_parent);
       other->set_parent(head);
       other->_height = std::max(height(other->_left), height(other->_right)) + 1;
       head->_height  = std::max(height(head->_left),  other->_height)        + 1;
+      recount(other);
+      recount(head);
+      augment(other);
+      augment(head);
     }
     return head;
   }
@@ -965,11 +2293,18 @@ public:
     if (other && other->has_right()) {
       head = other->_right;
       other->_right  = head->_left;
+      if (other->_right) {
+        other->_right->set_parent(other);
+      }
       head->_left     = other;
       head->set_parent(other->_parent);
       other->set_parent(head);
       other->_height = std::max(height(other->_left), height(other->_right)) + 1;
       head->_height  = std::max(height(head->_right), other->_height)        + 1;
+      recount(other);
+      recount(head);
+      augment(other);
+      augment(head);
     }
     return head;
   }
@@ -1005,7 +2340,10 @@ public:
    */
   inline static node_type_t*
   leftmost(node_type_t* node) {
-    return node->has_left() ? leftmost(node->_left) : node;
+    while (node->_left) {
+      node = node->_left;
+    }
+    return node;
   }
 
   /**
@@ -1015,7 +2353,10 @@ public:
    */
   inline static node_type_t*
   rightmost(node_type_t* node) {
-    return node->has_right() ? rightmost(node->_right) : node;
+    while (node->_right) {
+      node = node->_right;
+    }
+    return node;
   }
 
 private:
@@ -1024,9 +2365,18 @@ private:
   using base_type_t::add_root;
   // LCOV_EXCL_STOP
 
+  static constexpr bool order_statistics{ node_type_t::subtree_size_type_t::enabled };
+
   bool    _allow_duplicates{ false };
   size_t  _number_of_elements{ 0 };
 };
 
+/**
+ * @brief order_statistic_tree_t  avl tree whose nodes keep the size of their
+ * subtree, so rank, select and count_range run in O(log n)
+ */
+template <class T, class allocator_t = heap_node_allocator_t<binary_node_t<T, true>>>
+using order_statistic_tree_t = avl_tree_t<T, allocator_t>;
+
 }
 }
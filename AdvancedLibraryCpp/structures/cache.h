@@ -1,7 +1,14 @@
 #pragma once
 #include <unordered_map>
 #include <list>
+#include <algorithm>
 #include <cmath>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <string>
+#include <string_view>
+#include <type_traits>
 
 
 namespace advanced {
@@ -9,6 +16,94 @@ namespace structures {
 
 /** @test TestLRUCache in test/test_lru_cache(.h|.cpp) */
 
+/**
+ * @brief Counters collected by cache_t since its creation or the last call to
+ * reset_statistics
+ */
+struct cache_statistics_t {
+  size_t    hits{ 0 };       ///< find or operator[] calls that found the key
+  size_t    misses{ 0 };     ///< find or operator[] calls that did not
+  size_t    inserts{ 0 };    ///< keys inserted
+  size_t    evictions{ 0 };  ///< keys discarded because the cache was full
+  size_t    removals{ 0 };   ///< keys removed by remove
+  uint64_t  accesses{ 0 };   ///< find, operator[] and add calls
+  uint64_t  occupancy{ 0 };  ///< sum of the cache size seen by each access
+
+  /**
+   * @brief hit_ratio  hits / (hits + misses)
+   */
+  inline double
+  hit_ratio() const {
+    const size_t lookups{ hits + misses };
+    return lookups ? static_cast<double>(hits) / lookups : 0.0;
+  }
+
+  /**
+   * @brief miss_ratio  misses / (hits + misses)
+   */
+  inline double
+  miss_ratio() const {
+    const size_t lookups{ hits + misses };
+    return lookups ? static_cast<double>(misses) / lookups : 0.0;
+  }
+
+  /**
+   * @brief average_lifetime  average number of accesses an entry stays in the
+   * cache. It's computed by the Little's law (average size / insertion rate),
+   * so no timestamp is stored per entry, and it converges to the real average
+   * on long runs.
+   */
+  inline double
+  average_lifetime() const {
+    return inserts ? static_cast<double>(occupancy) / inserts : 0.0;
+  }
+};
+
+/**
+ * @brief cache_key_traits_t  how the cache_t index refers to the keys stored
+ * in its list. The index never owns a copy of the key, it keeps a view to the
+ * list node instead, so each key is stored only once and lookups can be done
+ * with any type the view is constructible from, without creating a key_t.
+ *
+ * The default view is a pointer to the stored key, so only key_t lookups are
+ * allowed. Strings are viewed as std::basic_string_view, so
+ * cache_t<std::string> can be searched with std::string_view or const char*
+ * without allocating.
+ */
+template <typename key_t>
+struct cache_key_traits_t {
+  class view_t {
+    public:
+    view_t(const key_t& key) : _key{ &key } { }
+
+    inline bool
+    operator==(const view_t& other) const {
+      return *_key == *other._key;
+    }
+
+    inline const key_t&
+    get() const {
+      return *_key;
+    }
+
+    private:
+    const key_t* _key;
+  };
+
+  struct hash_t {
+    inline size_t
+    operator()(const view_t& view) const {
+      return std::hash<key_t>{}(view.get());
+    }
+  };
+};
+
+template <typename char_t, typename traits_t, typename allocator_t>
+struct cache_key_traits_t<std::basic_string<char_t, traits_t, allocator_t>> {
+  using view_t = std::basic_string_view<char_t, traits_t>;
+  using hash_t = std::hash<view_t>;
+};
+
 /**
  * @brief Templated LRU Cache implementation
  * @see   https://www.geeksforgeeks.org/lru-cache-implementation/
@@ -23,17 +118,56 @@ class cache_t {
   using iterator                  = typename std::list<key_t>::iterator;
   using const_iterator            = typename std::list<key_t>::const_iterator;
   using const_reverse_iterator    = typename std::list<key_t>::const_reverse_iterator;
-  using map_t                     = std::unordered_map<key_t, const_iterator>;
+  using view_t                    = typename cache_key_traits_t<key_t>::view_t;
+  using view_hash_t               = typename cache_key_traits_t<key_t>::hash_t;
+  using map_t                     = std::unordered_map<view_t, const_iterator, view_hash_t>;
   using map_iterator              = typename map_t::iterator;
   using value_t                   = key_t;
 
+  /**
+   * Enabled for the lookup types other than key_t accepted by the index, e.g.
+   * std::string_view and const char* for std::string keys
+   */
+  template <typename lookup_t>
+  using if_heterogeneous_t = typename std::enable_if<
+    !std::is_same<typename std::decay<lookup_t>::type, key_t>::value &&
+    std::is_constructible<view_t, const lookup_t&>::value>::type;
+
   cache_t()                       = default;
-  cache_t(const cache_t&)         = default;
   cache_t(cache_t&&) noexcept     = default;
-  inline cache_t&operator=(const cache_t&)     = default;
   inline cache_t&operator=(cache_t&&) noexcept = default;
   virtual ~cache_t() { }
 
+  /**
+   * @brief cache_t  copy constructor, the index is rebuilt to refer to the
+   * copied list
+   */
+  cache_t(const cache_t& other) {
+    *this = other;
+  }
+
+  /**
+   * @brief operator =  copy assignment, the index is rebuilt to refer to the
+   * copied list
+   */
+  cache_t&
+  operator=(const cache_t& other) {
+    if (this != &other) {
+      _max_capacity          = other._max_capacity;
+      _max_elements          = other._max_elements;
+      _clipped_values        = other._clipped_values;
+      _last_operation_result = other._last_operation_result;
+      _statistics            = other._statistics;
+      _map.clear();
+      _list = other._list;
+      _map.reserve(std::max(_max_capacity, _list.size()));
+      for (auto it = _list.cbegin(); it != _list.cend(); it++) {
+        _map.emplace(view_t{ *it }, it);
+      }
+    }
+    return *this;
+  }
+
   /**
    * @brief cache_t It constructs a cache object with a determinated capacity
    * @param capacity
@@ -48,7 +182,18 @@ class cache_t {
    */
   virtual bool
   contains(const key_t& key) const {
-    return _map.count(key);
+    return _map.count(view_t{ key });
+  }
+
+  /**
+   * Const search with any type accepted by the index, it doesn't create a
+   * key_t, e.g. cache_t<std::string>::contains(std::string_view)
+   * @return whether element is present or not
+   */
+  template <typename lookup_t, typename = if_heterogeneous_t<lookup_t>>
+  bool
+  contains(const lookup_t& key) const {
+    return _map.count(view_t{ key });
   }
 
   /**
@@ -62,16 +207,41 @@ class cache_t {
    */
   std::pair<bool, const_iterator>
   find(const key_t& key) {
+    return find_view(view_t{ key });
+  }
+
+  /**
+   * @brief find  same as find(const key_t&), but using any type accepted by the
+   *              index, e.g. cache_t<std::string>::find(std::string_view).
+   *              A hit never allocates.
+   */
+  template <typename lookup_t, typename = if_heterogeneous_t<lookup_t>>
+  std::pair<bool, const_iterator>
+  find(const lookup_t& key) {
+    return find_view(view_t{ key });
+  }
+
+  private:
+
+  std::pair<bool, const_iterator>
+  find_view(const view_t& key) {
     std::pair<bool, const_iterator> output{ false, {}};
     auto it{ _map.find(key )};
+    count_access();
     if (it != _map.end()) {
       output.first  = true;
       move_to_front(it->second);
       output.second = _list.begin();
+      _statistics.hits++;
+    }
+    else {
+      _statistics.misses++;
     }
     return output;
   }
 
+  public:
+
   /**
    * @brief operator [] it adds a value if not found and returns a reference to
    *                    it
@@ -80,13 +250,18 @@ class cache_t {
    */
   inline const key_t&
   operator[] (const key_t& key) {
-    if (!contains(key)) {
+    auto it{ _map.find(view_t{ key }) };
+    if (it == _map.end()) {
+      _statistics.misses++;
       (void)add(key);
     }
     else {
+      count_access();
+      _statistics.hits++;
+      move_to_front(it->second);
       _last_operation_result = false;
     }
-    return *(find(key).second);
+    return _list.front();
   }
 
   /**
@@ -135,9 +310,11 @@ class cache_t {
   cache_t&
   add(const key_t& key) {
     bool ok { !contains(key) };
+    count_access();
     if (ok) {
       _list.push_front(key);
-      _map[key] = _list.cbegin();
+      _map.emplace(view_t{ _list.front() }, _list.cbegin());
+      _statistics.inserts++;
       (void) clip();
     }
     _last_operation_result = ok;
@@ -145,20 +322,110 @@ class cache_t {
   }
 
   /**
-   * @brief discards the least used recent values when the cache is full
+   * @brief add_range  It adds all keys in [first, last) that do not exist yet.
+   *                   Keys are inserted in order, so the last one becomes the
+   *                   most recent used. The index is grown once and the cache
+   *                   is clipped in batches instead of once per key; the result
+   *                   is the same as calling add for each key.
+   * @return           number of keys inserted
+   * @note   the range may hold any type accepted by the index, e.g.
+   *         std::string_view for std::string keys
+   */
+  template <class Iterator>
+  size_t
+  add_range(Iterator first, Iterator last) {
+    using category_t = typename std::iterator_traits<Iterator>::iterator_category;
+    if constexpr (std::is_base_of<std::forward_iterator_tag, category_t>::value) {
+      const auto count{ static_cast<size_t>(std::distance(first, last)) };
+      _map.reserve(_list.size() + std::min(count, _max_elements));
+    }
+    // up to twice the capacity is kept before clipping, so a range larger than
+    // the cache evicts in a few batches and doesn't grow it without bound
+    const size_t clip_at{ _max_elements + std::max<size_t>(_max_elements, 1u) };
+    size_t inserted{ 0 };
+    for (auto it = first; it != last; it++) {
+      const view_t key{ *it };
+      count_access();
+      auto found{ _map.find(key) };
+      if (found != _map.end() && _list.size() > _max_elements) {
+        // the key may lie past the capacity, where add would have evicted it
+        // already; clipping now keeps the result the same as add
+        (void) clip();
+        found = _map.find(key);
+      }
+      if (found == _map.end()) {
+        _list.emplace_front(*it);
+        _map.emplace(view_t{ _list.front() }, _list.cbegin());
+        inserted++;
+        if (_list.size() >= clip_at) {
+          (void) clip();
+        }
+      }
+    }
+    _statistics.inserts += inserted;
+    (void) clip();
+    _last_operation_result = inserted > 0;
+    return inserted;
+  }
+
+  /**
+   * @brief remove_range  It removes all keys in [first, last) from cache
+   * @return              number of keys removed
+   */
+  template <class Iterator>
+  size_t
+  remove_range(Iterator first, Iterator last) {
+    size_t removed{ 0 };
+    for (auto it = first; it != last; it++) {
+      auto found{ _map.find(view_t{ *it }) };
+      if (found != _map.end()) {
+        const auto node{ found->second };
+        _map.erase(found);
+        _list.erase(node);
+        removed++;
+      }
+    }
+    _statistics.removals += removed;
+    _last_operation_result = removed > 0;
+    return removed;
+  }
+
+  /**
+   * @brief find_many  It searches all keys in [first, last), as find does, and
+   *                   writes whether each one was found to result
+   * @return           output iterator past the last element written
+   */
+  template <class Iterator, class OutputIterator>
+  OutputIterator
+  find_many(Iterator first, Iterator last, OutputIterator result) {
+    for (auto it = first; it != last; it++) {
+      *result++ = find_view(view_t{ *it }).first;
+    }
+    return result;
+  }
+
+  /**
+   * @brief discards the least used recent values when the cache is full.
+   * All discarded values are delivered in a single on_discard_batch call.
    * @return reference to this
    * @note   use clipped method to get the ammount of clipped values
    */
   cache_t&
   clip() {
     _clipped_values = 0;
-    while (_list.size() > _max_elements) {
-      const auto& back { _list.back() };
-      _map.erase(back);
-      on_discard(back);
-      _list.pop_back();
-      _clipped_values++;
+    if (_list.size() <= _max_elements) {
+      return *this;
     }
+    _clipped_values = _list.size() - _max_elements;
+    auto cut{ _list.end() };
+    for (size_t ii = 0; ii < _clipped_values; ii++) {
+      --cut;
+      _map.erase(view_t{ *cut });
+    }
+    list_t discarded;
+    discarded.splice(discarded.end(), _list, cut, _list.end());
+    _statistics.evictions += _clipped_values;
+    on_discard_batch(discarded);
     return *this;
   }
 
@@ -180,6 +447,23 @@ class cache_t {
     return _last_operation_result;
   }
 
+  /**
+   * @brief statistics  hits, misses, inserts and evictions counted since the
+   * creation of the cache or the last reset_statistics call
+   */
+  inline const cache_statistics_t&
+  statistics() const {
+    return _statistics;
+  }
+
+  /**
+   * @brief reset_statistics  it sets all counters to zero
+   */
+  inline void
+  reset_statistics() {
+    _statistics = cache_statistics_t{};
+  }
+
   /**
    * @brief set_max  it changes the max capacity of the LRU cache
    * @param capacity new capacity
@@ -240,10 +524,30 @@ class cache_t {
    */
   cache_t&
   remove(const key_t& key) {
+    return remove_view(view_t{ key });
+  }
+
+  /**
+   * @brief remove  same as remove(const key_t&), but using any type accepted by
+   *                the index, e.g. cache_t<std::string>::remove(const char*)
+   */
+  template <typename lookup_t, typename = if_heterogeneous_t<lookup_t>>
+  cache_t&
+  remove(const lookup_t& key) {
+    return remove_view(view_t{ key });
+  }
+
+  private:
+
+  cache_t&
+  remove_view(const view_t& key) {
     auto it = _map.find(key);
     if (it != _map.end()) {
-      _list.erase(it->second);
-      _map.erase(key);
+      // the view refers to the list node, so the index entry goes first
+      const auto node{ it->second };
+      _map.erase(it);
+      _list.erase(node);
+      _statistics.removals++;
       _last_operation_result = true;
     }
     else {
@@ -252,6 +556,8 @@ class cache_t {
     return *this;
   }
 
+  public:
+
   /**
    * @brief size returns the current number of elements in the LRU cache
    * @return     returns the current number of elements in the LRU cache
@@ -299,26 +605,45 @@ class cache_t {
   on_discard(const value_t& value)
   { (void)value; }
 
+  /**
+   * Override it to handle all values discarded by one clip at once, they are
+   * ordered from the most recent used to the least recent used. By default it
+   * calls on_discard for each one, from the least recent used.
+   */
+  virtual void
+  on_discard_batch(const list_t& values) {
+    for (auto it = values.rbegin(); it != values.rend(); it++) {
+      on_discard(*it);
+    }
+  }
+
   private:
 
   /**
-   * It moves the element to the begining of the list everytime it is referenced
+   * It accumulates the current size to compute the average entry lifetime
+   */
+  inline void
+  count_access() {
+    _statistics.accesses++;
+    _statistics.occupancy += _list.size();
+  }
+
+  /**
+   * It moves the element to the begining of the list everytime it is
+   * referenced. The node is relinked, so neither the key is copied nor the
+   * index needs to be updated.
    */
   void
   move_to_front(const_iterator it) {
-    if (it != _list.begin()) {
-      key_t key{ *it  };
-      _list.erase(it);
-      _list.push_front(key);
-      _map[key] = _list.begin();
-    }
+    _list.splice(_list.begin(), _list, it);
   }
 
   size_t                                     _max_capacity{ 1024 };
   size_t                                     _max_elements{ 1024 };
   size_t                                     _clipped_values{ 0 };
   bool                                       _last_operation_result{ false };
-  std::unordered_map<key_t, const_iterator>  _map;
+  cache_statistics_t                         _statistics;
+  map_t                                      _map;
   std::list<key_t>                           _list;
 
 };
@@ -0,0 +1,257 @@
+#pragma once
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include "cache.h"
+#include "../concurrency/timer.h"
+#include "../tools/mapped_file.h"
+
+namespace advanced {
+namespace structures {
+
+/** @test TestCacheSnapshot in test/test_cache_snapshot(.h|.cpp) */
+
+class snapshot_exception_t : public std::runtime_error {
+public:
+  snapshot_exception_t(const std::string& msg) :
+    std::runtime_error{ msg } { }
+};
+
+/**
+ * @brief snapshot_codec_t  binary encoding of one key of the snapshot.
+ * Trivially copyable keys are written as raw bytes and std::string as a 32 bits
+ * length followed by its characters. Specialize it for your own key types:
+ *
+ *   static void        write(std::ostream& out, const T& key);
+ *   static const char* read(const char* first, const char* last, T& key);
+ *
+ * read must return the position right after the decoded key, or throw
+ * snapshot_exception_t if [first, last) is too short.
+ */
+template <typename T, typename = void>
+struct snapshot_codec_t;
+
+template <typename T>
+struct snapshot_codec_t<T, typename std::enable_if<
+                             std::is_trivially_copyable<T>::value>::type> {
+  static void
+  write(std::ostream& out, const T& key) {
+    out.write(reinterpret_cast<const char*>(&key), sizeof(T));
+  }
+
+  static const char*
+  read(const char* first, const char* last, T& key) {
+    if (static_cast<size_t>(last - first) < sizeof(T)) {
+      throw snapshot_exception_t{ "Truncated snapshot" };
+    }
+    std::memcpy(&key, first, sizeof(T));
+    return first + sizeof(T);
+  }
+};
+
+template <>
+struct snapshot_codec_t<std::string> {
+  static void
+  write(std::ostream& out, const std::string& key) {
+    const uint32_t length{ static_cast<uint32_t>(key.size()) };
+    out.write(reinterpret_cast<const char*>(&length), sizeof(length));
+    out.write(key.data(), length);
+  }
+
+  static const char*
+  read(const char* first, const char* last, std::string& key) {
+    uint32_t length;
+    first = snapshot_codec_t<uint32_t>::read(first, last, length);
+    if (static_cast<size_t>(last - first) < length) {
+      throw snapshot_exception_t{ "Truncated snapshot" };
+    }
+    key.assign(first, length);
+    return first + length;
+  }
+};
+
+/**
+ * @brief snapshot file header
+ */
+struct snapshot_header_t {
+  static constexpr uint32_t current_magic  { 0x53434c41 }; // "ALCS"
+  static constexpr uint32_t current_version{ 1 };
+
+  uint32_t magic  { current_magic };
+  uint32_t version{ current_version };
+  uint64_t count  { 0 };
+};
+
+/**
+ * @brief write_snapshot  writes count keys in [first, last) to path, the
+ * first key must be the least recent used one.
+ * The file is written to "<path>.tmp" and renamed afterwards, so a crash in the
+ * middle of a snapshot never corrupts the previous one.
+ * @throws snapshot_exception_t if the file cannot be written
+ */
+template <class Iterator>
+void
+write_snapshot(Iterator first, Iterator last, size_t count,
+               const std::string& path) {
+  using key_t = typename std::decay<decltype(*first)>::type;
+  const std::string temporary{ path + ".tmp" };
+  {
+    std::ofstream out{ temporary, std::ios::binary | std::ios::trunc };
+    if (!out) {
+      throw snapshot_exception_t{ "Unable to write the snapshot: " + path };
+    }
+    snapshot_header_t header;
+    header.count = count;
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    for (auto it = first; it != last; it++) {
+      snapshot_codec_t<key_t>::write(out, *it);
+    }
+    if (!out.flush()) {
+      throw snapshot_exception_t{ "Unable to write the snapshot: " + path };
+    }
+  }
+  if (std::rename(temporary.c_str(), path.c_str()) != 0) {
+    std::remove(temporary.c_str());
+    throw snapshot_exception_t{ "Unable to replace the snapshot: " + path };
+  }
+}
+
+/**
+ * @brief save_snapshot  writes all keys of the cache, from the least recent
+ * used to the most recent used, to a compact binary file. Keys are stored in
+ * the native byte order.
+ * @param cache   cache to be saved
+ * @param path    destination file
+ * @throws snapshot_exception_t if the file cannot be written
+ */
+template <typename key_t>
+void
+save_snapshot(const cache_t<key_t>& cache, const std::string& path) {
+  write_snapshot(cache.rbegin(), cache.rend(), cache.size(), path);
+}
+
+/**
+ * @brief load_snapshot  replaces the content of the cache with the keys saved
+ * by save_snapshot, preserving their recency order. The file is mapped in
+ * memory and decoded sequentially. If the snapshot has more keys than the
+ * cache capacity, only the most recent used ones are inserted.
+ * @param cache   cache to be restored, it's cleared first (without calling
+ *                on_discard)
+ * @param path    snapshot file
+ * @return        number of keys restored
+ * @throws snapshot_exception_t if the file is missing or is not a valid
+ * snapshot. The cache may be partially restored on a truncated file.
+ */
+template <typename key_t>
+size_t
+load_snapshot(cache_t<key_t>& cache, const std::string& path) {
+  std::unique_ptr<tools::mapped_file_t> file;
+  try {
+    file = std::make_unique<tools::mapped_file_t>(path);
+  }
+  catch (const tools::mapped_file_exception_t& ex) {
+    throw snapshot_exception_t{ ex.what() };
+  }
+
+  snapshot_header_t header;
+  if (file->size() < sizeof(header)) {
+    throw snapshot_exception_t{ "Invalid snapshot: " + path };
+  }
+  std::memcpy(&header, file->data(), sizeof(header));
+  if (header.magic   != snapshot_header_t::current_magic ||
+      header.version != snapshot_header_t::current_version) {
+    throw snapshot_exception_t{ "Invalid snapshot: " + path };
+  }
+
+  cache.clear();
+  const char* position{ file->begin() + sizeof(header) };
+  const size_t skipped {
+    header.count > cache.capacity() ? header.count - cache.capacity() : 0u };
+  key_t key;
+  for (uint64_t ii = 0; ii < header.count; ii++) {
+    position = snapshot_codec_t<key_t>::read(position, file->end(), key);
+    if (ii >= skipped) {
+      cache.add(key);
+    }
+  }
+  return cache.size();
+}
+
+/**
+ * @brief Timer that saves a snapshot of a cache every interval_ms.
+ * The cache type must be lockable, e.g. concurrency::lockable_t<cache_t<K>>,
+ * and every other thread using it must lock it as well.
+ *
+ * @example
+ * lockable_t<cache_t<std::string>> cache{ 100000 };
+ * snapshot_timer_t<decltype(cache)> snapshots{ cache, "cache.bin", 60000 };
+ * snapshots.start();
+ */
+template <class lockable_cache_t>
+class snapshot_timer_t : public concurrency::base_timer_t {
+  public:
+
+  snapshot_timer_t(lockable_cache_t& cache,
+                   const std::string& path,
+                   size_t interval_ms)
+    : concurrency::base_timer_t{ interval_ms }, _cache{ cache }, _path{ path }
+  { }
+
+  ~snapshot_timer_t() override {
+    safe_delete();
+  }
+
+  /**
+   * @brief snapshots  number of snapshots successfully saved
+   */
+  size_t
+  snapshots() const noexcept {
+    return _snapshots;
+  }
+
+  /**
+   * @brief failures  number of snapshots that could not be saved
+   */
+  size_t
+  failures() const noexcept {
+    return _failures;
+  }
+
+  protected:
+
+  /**
+   * A failed snapshot does not stop the timer, it's retried on the next
+   * interval
+   */
+  virtual int
+  on_interval() override {
+    try {
+      // only the copy holds the lock, the file is written without it
+      std::unique_lock<lockable_cache_t> guard{ _cache };
+      const auto keys{ _cache.values() };
+      guard.unlock();
+      write_snapshot(keys.rbegin(), keys.rend(), keys.size(), _path);
+      _snapshots++;
+    }
+    catch (const snapshot_exception_t&) {
+      _failures++;
+    }
+    return EXIT_SUCCESS;
+  }
+
+  private:
+
+  lockable_cache_t&   _cache;
+  const std::string   _path;
+  std::atomic_size_t  _snapshots{ 0 };
+  std::atomic_size_t  _failures{ 0 };
+};
+
+}
+}
@@ -0,0 +1,503 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace advanced {
+namespace structures {
+
+/** @test TestCompactAVLTree in test/test_compact_avl_tree(.h|.cpp) */
+
+/**
+ * @brief Cache-compact AVL tree. Nodes live in a single array and refer to
+ * their children by 32 bits indices, the balance factor is packed into the 2
+ * spare bits of the left index, and there is neither vtable nor parent
+ * pointer: a node is sizeof(T) + 8 bytes, against ~40 + sizeof(T) bytes of a
+ * binary_node_t. Removed nodes are kept in a free list and reused.
+ *
+ * Insertion and removal are iterative, they record the path from the root and
+ * rebalance bottom-up using the balance factors only.
+ *
+ * @note at most 2^30 - 1 nodes.
+ */
+template <class T>
+class compact_avl_tree_t {
+  using index_t = uint32_t;
+
+  static constexpr index_t null_index  { (1u << 30) - 1u };
+  static constexpr index_t index_mask  { (1u << 30) - 1u };
+  static constexpr size_t  max_height  { 64 };
+
+  struct node_t {
+    T       value;
+    index_t left_balance;   // 30 bits left child + 2 bits balance + 1
+    index_t right;
+  };
+
+public:
+
+  /**
+   * @brief bytes_per_node  memory used by each element
+   */
+  static constexpr size_t bytes_per_node{ sizeof(node_t) };
+
+  compact_avl_tree_t() = default;
+
+  /**
+   * @brief insert  it inserts a value, if it's not in the tree yet or
+   * duplicates are enabled
+   * @return whether the value was inserted or not
+   * @throws std::length_error if the tree is full
+   */
+  bool
+  insert(const T& value) {
+    std::array<index_t, max_height> path;
+    std::array<bool, max_height>    to_right;
+    size_t depth{ 0 };
+
+    for (index_t node{ _root }; node != null_index; depth++) {
+      const T& current{ _nodes[node].value };
+      if (value < current) {
+        to_right[depth] = false;
+      }
+      else if (current < value || _allow_duplicates) {
+        to_right[depth] = true;
+      }
+      else {
+        return false;
+      }
+      path[depth] = node;
+      node = to_right[depth] ? right(node) : left(node);
+    }
+
+    const index_t created{ allocate(value) };
+    if (depth) {
+      set_child(path[depth - 1], to_right[depth - 1], created);
+    }
+    else {
+      _root = created;
+    }
+    _size++;
+
+    // the subtree grew, rebalance until a subtree keeps its height
+    while (depth--) {
+      const index_t node{ path[depth] };
+      const int factor{ balance(node) + (to_right[depth] ? 1 : -1) };
+      if (factor == 0) {
+        set_balance(node, 0);
+        break;
+      }
+      if (factor == 1 || factor == -1) {
+        set_balance(node, factor);
+        continue;
+      }
+      replace(path, to_right, depth, rebalance(node, factor));
+      break;
+    }
+    return true;
+  }
+
+  /**
+   * @brief remove  it removes one element equal to value
+   * @return whether the tree contained the value
+   */
+  bool
+  remove(const T& value) {
+    std::array<index_t, max_height> path;
+    std::array<bool, max_height>    to_right;
+    size_t depth{ 0 };
+
+    index_t found{ _root };
+    while (found != null_index) {
+      const T& current{ _nodes[found].value };
+      if (value < current) {
+        to_right[depth] = false;
+      }
+      else if (current < value) {
+        to_right[depth] = true;
+      }
+      else {
+        break;
+      }
+      path[depth++] = found;
+      found = to_right[depth - 1] ? right(found) : left(found);
+    }
+    if (found == null_index) {
+      return false;
+    }
+
+    // with two children, the successor value replaces the found one and the
+    // successor node, that has no left child, is unlinked instead
+    index_t unlinked{ found };
+    if (left(found) != null_index && right(found) != null_index) {
+      path[depth] = found;
+      to_right[depth++] = true;
+      unlinked = right(found);
+      while (left(unlinked) != null_index) {
+        path[depth] = unlinked;
+        to_right[depth++] = false;
+        unlinked = left(unlinked);
+      }
+      _nodes[found].value = std::move(_nodes[unlinked].value);
+    }
+    const index_t child{
+      left(unlinked) != null_index ? left(unlinked) : right(unlinked) };
+    if (depth) {
+      set_child(path[depth - 1], to_right[depth - 1], child);
+    }
+    else {
+      _root = child;
+    }
+    deallocate(unlinked);
+    _size--;
+
+    // the subtree shrank, rebalance until a subtree keeps its height
+    while (depth--) {
+      const index_t node{ path[depth] };
+      const int factor{ balance(node) + (to_right[depth] ? -1 : 1) };
+      if (factor == 1 || factor == -1) {
+        set_balance(node, factor);
+        break;
+      }
+      if (factor == 0) {
+        set_balance(node, 0);
+        continue;
+      }
+      const index_t head{ rebalance(node, factor) };
+      replace(path, to_right, depth, head);
+      if (balance(head) != 0) {
+        break;
+      }
+    }
+    return true;
+  }
+
+  /**
+   * @brief contains  iterative search
+   * @return whether the value is in the tree or not
+   */
+  bool
+  contains(const T& value) const {
+    index_t node{ _root };
+    while (node != null_index) {
+      const T& current{ _nodes[node].value };
+      if (value < current) {
+        node = left(node);
+      }
+      else if (current < value) {
+        node = right(node);
+      }
+      else {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  /**
+   * @brief in_order  it calls func(const T&) for each value in order, until it
+   * returns true
+   * @return number of visited values
+   */
+  template <class function_t>
+  size_t
+  in_order(function_t&& func) const {
+    std::array<index_t, max_height> stack;
+    size_t  depth{ 0 };
+    size_t  visited{ 0 };
+    index_t node{ _root };
+    while (node != null_index || depth) {
+      while (node != null_index) {
+        stack[depth++] = node;
+        node = left(node);
+      }
+      node = stack[--depth];
+      visited++;
+      if (func(_nodes[node].value)) {
+        break;
+      }
+      node = right(node);
+    }
+    return visited;
+  }
+
+  /**
+   * @brief height  height of the tree, O(log n)
+   */
+  size_t
+  height() const {
+    size_t  result{ 0 };
+    index_t node{ _root };
+    while (node != null_index) {
+      result++;
+      node = balance(node) < 0 ? left(node) : right(node);
+    }
+    return result;
+  }
+
+  /**
+   * @brief left_most  the lowest value
+   * @throws std::out_of_range if the tree is empty
+   */
+  const T&
+  left_most() const {
+    index_t node{ checked_root() };
+    while (left(node) != null_index) {
+      node = left(node);
+    }
+    return _nodes[node].value;
+  }
+
+  /**
+   * @brief right_most  the greatest value
+   * @throws std::out_of_range if the tree is empty
+   */
+  const T&
+  right_most() const {
+    index_t node{ checked_root() };
+    while (right(node) != null_index) {
+      node = right(node);
+    }
+    return _nodes[node].value;
+  }
+
+  /**
+   * @brief reserve  it preallocates room for count nodes
+   */
+  void
+  reserve(size_t count) {
+    _nodes.reserve(count);
+  }
+
+  /**
+   * @brief clear  it removes all elements, the node array memory is kept
+   */
+  void
+  clear() noexcept {
+    _nodes.clear();
+    _root = _free = null_index;
+    _size = 0;
+  }
+
+  inline size_t
+  size() const noexcept {
+    return _size;
+  }
+
+  inline bool
+  empty() const noexcept {
+    return _size == 0;
+  }
+
+  /**
+   * @brief memory_usage  bytes reserved by the node array
+   */
+  inline size_t
+  memory_usage() const noexcept {
+    return _nodes.capacity() * sizeof(node_t);
+  }
+
+  void
+  enable_duplicates() {
+    _allow_duplicates = true;
+  }
+
+  void
+  disable_duplicates() {
+    _allow_duplicates = false;
+  }
+
+  inline bool
+  is_multiple_keys_allowed() const {
+    return _allow_duplicates;
+  }
+
+private:
+
+  inline index_t
+  left(index_t node) const {
+    return _nodes[node].left_balance & index_mask;
+  }
+
+  inline index_t
+  right(index_t node) const {
+    return _nodes[node].right;
+  }
+
+  /**
+   * height(right) - height(left), in [-1, 1]
+   */
+  inline int
+  balance(index_t node) const {
+    return static_cast<int>(_nodes[node].left_balance >> 30) - 1;
+  }
+
+  inline void
+  set_left(index_t node, index_t child) {
+    auto& packed{ _nodes[node].left_balance };
+    packed = (packed & ~index_mask) | child;
+  }
+
+  inline void
+  set_right(index_t node, index_t child) {
+    _nodes[node].right = child;
+  }
+
+  inline void
+  set_child(index_t node, bool to_right, index_t child) {
+    to_right ? set_right(node, child) : set_left(node, child);
+  }
+
+  inline void
+  set_balance(index_t node, int factor) {
+    auto& packed{ _nodes[node].left_balance };
+    packed = (packed & index_mask) | (static_cast<index_t>(factor + 1) << 30);
+  }
+
+  /**
+   * It links the new head of the subtree at path[depth] to its parent
+   */
+  inline void
+  replace(const std::array<index_t, max_height>& path,
+          const std::array<bool, max_height>& to_right,
+          size_t depth, index_t head) {
+    if (depth) {
+      set_child(path[depth - 1], to_right[depth - 1], head);
+    }
+    else {
+      _root = head;
+    }
+  }
+
+  /**
+   * It rotates a node whose balance factor is +2 or -2
+   * @return the new head of the subtree
+   */
+  index_t
+  rebalance(index_t node, int factor) {
+    if (factor > 0) {
+      const index_t child{ right(node) };
+      return balance(child) >= 0 ? rotate_left(node)
+                                 : double_rotate_left(node);
+    }
+    const index_t child{ left(node) };
+    return balance(child) <= 0 ? rotate_right(node)
+                               : double_rotate_right(node);
+  }
+
+  index_t
+  rotate_left(index_t node) {
+    const index_t head{ right(node) };
+    set_right(node, left(head));
+    set_left(head, node);
+    if (balance(head) == 0) {   // only after a removal
+      set_balance(node,  1);
+      set_balance(head, -1);
+    }
+    else {
+      set_balance(node, 0);
+      set_balance(head, 0);
+    }
+    return head;
+  }
+
+  index_t
+  rotate_right(index_t node) {
+    const index_t head{ left(node) };
+    set_left(node, right(head));
+    set_right(head, node);
+    if (balance(head) == 0) {   // only after a removal
+      set_balance(node, -1);
+      set_balance(head,  1);
+    }
+    else {
+      set_balance(node, 0);
+      set_balance(head, 0);
+    }
+    return head;
+  }
+
+  /**
+   * right rotation of the right child followed by a left rotation
+   */
+  index_t
+  double_rotate_left(index_t node) {
+    const index_t child{ right(node) };
+    const index_t head { left(child) };
+    const int     factor{ balance(head) };
+    set_left(child, right(head));
+    set_right(head, child);
+    set_right(node, left(head));
+    set_left(head, node);
+    set_balance(node,  factor > 0 ? -1 : 0);
+    set_balance(child, factor < 0 ?  1 : 0);
+    set_balance(head, 0);
+    return head;
+  }
+
+  /**
+   * left rotation of the left child followed by a right rotation
+   */
+  index_t
+  double_rotate_right(index_t node) {
+    const index_t child{ left(node) };
+    const index_t head { right(child) };
+    const int     factor{ balance(head) };
+    set_right(child, left(head));
+    set_left(head, child);
+    set_left(node, right(head));
+    set_right(head, node);
+    set_balance(node,  factor < 0 ?  1 : 0);
+    set_balance(child, factor > 0 ? -1 : 0);
+    set_balance(head, 0);
+    return head;
+  }
+
+  index_t
+  allocate(const T& value) {
+    const index_t empty_leaf{ null_index | (1u << 30) };
+    index_t node{ _free };
+    if (node != null_index) {
+      _free = _nodes[node].right;
+      _nodes[node] = node_t{ value, empty_leaf, null_index };
+    }
+    else {
+      if (_nodes.size() >= null_index) {
+        throw std::length_error{ "compact_avl_tree_t is full" };
+      }
+      node = static_cast<index_t>(_nodes.size());
+      _nodes.push_back(node_t{ value, empty_leaf, null_index });
+    }
+    return node;
+  }
+
+  void
+  deallocate(index_t node) {
+    if constexpr (!std::is_trivially_destructible<T>::value &&
+                  std::is_default_constructible<T>::value) {
+      _nodes[node].value = T{};   // releases the resources held by the value
+    }
+    _nodes[node].right = _free;
+    _free = node;
+  }
+
+  index_t
+  checked_root() const {
+    if (_root == null_index) {
+      throw std::out_of_range{ "compact_avl_tree_t is empty" };
+    }
+    return _root;
+  }
+
+  std::vector<node_t> _nodes;
+  index_t             _root{ null_index };
+  index_t             _free{ null_index };
+  size_t              _size{ 0 };
+  bool                _allow_duplicates{ false };
+};
+
+}
+}
@@ -0,0 +1,507 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace advanced {
+namespace structures {
+
+/** @test TestConcurrentSkipList in test/test_concurrent_skip_list(.h|.cpp) */
+
+/**
+ * @brief epoch_reclaimer_t  epoch based memory reclamation. Every operation
+ * runs inside a guard_t that announces the global epoch it saw; a retired
+ * object is deleted once the epoch advanced twice since it was retired, since
+ * no guard that could still see it is alive by then. The epoch only advances
+ * when every active guard has seen the current one.
+ * @note  at most max_guards guards can be active at the same time, further
+ * ones wait for a free slot
+ */
+template <class object_t>
+class epoch_reclaimer_t {
+public:
+  static constexpr size_t max_guards{ 128 };
+
+  /**
+   * @brief guard_t  RAII critical section, the objects reachable while it's
+   * alive are not deleted
+   */
+  class guard_t {
+  public:
+    explicit guard_t(epoch_reclaimer_t& reclaimer)
+      : _slot{ reclaimer.enter() }
+    { }
+
+    guard_t(const guard_t&)            = delete;
+    guard_t& operator=(const guard_t&) = delete;
+
+    ~guard_t() {
+      _slot->store(0, std::memory_order_release);
+    }
+
+  private:
+    std::atomic<uint64_t>* _slot;
+  };
+
+  epoch_reclaimer_t() = default;
+
+  epoch_reclaimer_t(const epoch_reclaimer_t&)            = delete;
+  epoch_reclaimer_t& operator=(const epoch_reclaimer_t&) = delete;
+
+  ~epoch_reclaimer_t() {
+    for (auto& retired : _retired) {
+      delete retired.first;
+    }
+  }
+
+  /**
+   * @brief retire  it deletes object when no guard can reach it anymore, the
+   * object must be already unreachable for new guards
+   */
+  void
+  retire(object_t* object) {
+    std::lock_guard<std::mutex> guard{ _mtx };
+    _retired.emplace_back(object, _epoch.load());
+    if (_retired.size() >= collect_threshold) {
+      collect();
+    }
+  }
+
+  /**
+   * @brief pending  number of retired objects not deleted yet
+   */
+  size_t
+  pending() const {
+    std::lock_guard<std::mutex> guard{ _mtx };
+    return _retired.size();
+  }
+
+private:
+  static constexpr size_t collect_threshold{ 64 };
+
+  struct alignas(64) slot_t {
+    std::atomic<uint64_t> epoch{ 0 };   // 0 when idle
+  };
+
+  /**
+   * It takes a free slot, starting by the one the thread used last time, and
+   * announces the current epoch
+   */
+  std::atomic<uint64_t>*
+  enter() {
+    static thread_local size_t hint{
+      std::hash<std::thread::id>{}(std::this_thread::get_id()) };
+    for (size_t ii = 0; ; ii++) {
+      auto&    slot { _slots[(hint + ii) % max_guards].epoch };
+      uint64_t idle { 0 };
+      uint64_t epoch{ _epoch.load() };
+      if (slot.compare_exchange_strong(idle, epoch)) {
+        hint = (hint + ii) % max_guards;
+        while (epoch != _epoch.load()) {
+          epoch = _epoch.load();
+          slot.store(epoch);
+        }
+        return &slot;
+      }
+      if (ii % max_guards == max_guards - 1) {
+        std::this_thread::yield();
+      }
+    }
+  }
+
+  /**
+   * It advances the epoch if every active guard has seen it, and deletes the
+   * objects retired two epochs ago. Called with _mtx locked.
+   */
+  void
+  collect() {
+    uint64_t epoch{ _epoch.load() };
+    bool     all_seen{ true };
+    for (const auto& slot : _slots) {
+      const uint64_t seen{ slot.epoch.load() };
+      all_seen &= !seen || seen == epoch;
+    }
+    if (all_seen && _epoch.compare_exchange_strong(epoch, epoch + 1)) {
+      epoch++;
+    }
+    size_t kept{ 0 };
+    for (auto& retired : _retired) {
+      if (retired.second + 2 <= epoch) {
+        delete retired.first;
+      }
+      else {
+        _retired[kept++] = retired;
+      }
+    }
+    _retired.resize(kept);
+  }
+
+  std::array<slot_t, max_guards>              _slots;
+  std::atomic<uint64_t>                       _epoch{ 1 };
+  mutable std::mutex                          _mtx;
+  std::vector<std::pair<object_t*, uint64_t>> _retired;
+};
+
+/**
+ * @brief Concurrent ordered map, a lazy skip list (Herlihy, Lev, Luchangco and
+ * Shavit). insert and remove lock only the predecessors of the node at each
+ * level and validate them optimistically, so writers on different keys don't
+ * block each other; contains, find and the range walks take no lock at all
+ * and never block behind a writer.
+ *
+ * insert, remove, contains and find are linearizable. for_each is weakly
+ * consistent: it visits the keys in order, it sees every key present during
+ * the whole walk and none of the keys absent during the whole walk.
+ *
+ * Removed nodes are deleted through an epoch_reclaimer_t once no reader can
+ * see them.
+ *
+ * @note  values are immutable once inserted, Key and Value must be default
+ * constructible (for the head node)
+ */
+template <class Key, class Value>
+class concurrent_skip_list_t {
+  static constexpr size_t max_level{ 32 };
+
+  /**
+   * @brief spin_lock_t  tiny lock for the nodes, they are held for a few
+   * pointer writes only
+   */
+  class spin_lock_t {
+  public:
+    inline void
+    lock() noexcept {
+      while (_flag.test_and_set(std::memory_order_acquire)) {
+        std::this_thread::yield();
+      }
+    }
+
+    inline void
+    unlock() noexcept {
+      _flag.clear(std::memory_order_release);
+    }
+
+  private:
+    std::atomic_flag _flag = ATOMIC_FLAG_INIT;
+  };
+
+  struct node_t {
+    node_t(const Key& key, const Value& value, size_t height)
+      : key{ key }, value{ value }, height{ height },
+        next{ new std::atomic<node_t*>[height] }
+    {
+      for (size_t level = 0; level < height; level++) {
+        next[level].store(nullptr, std::memory_order_relaxed);
+      }
+    }
+
+    const Key                                key;
+    const Value                              value;
+    const size_t                             height;
+    std::atomic_bool                         marked      { false };
+    std::atomic_bool                         fully_linked{ false };
+    spin_lock_t                              lock;
+    std::unique_ptr<std::atomic<node_t*>[]>  next;
+  };
+
+  using nodes_t = std::array<node_t*, max_level>;
+
+public:
+
+  concurrent_skip_list_t()
+    : _head{ Key{}, Value{}, max_level }
+  { }
+
+  concurrent_skip_list_t(const concurrent_skip_list_t&)            = delete;
+  concurrent_skip_list_t& operator=(const concurrent_skip_list_t&) = delete;
+
+  /**
+   * @note  no operation may be running
+   */
+  ~concurrent_skip_list_t() {
+    node_t* node{ _head.next[0].load() };
+    while (node) {
+      node_t* next{ node->next[0].load() };
+      delete node;
+      node = next;
+    }
+  }
+
+  /**
+   * @brief insert  it inserts key with value if key isn't in the map yet
+   * @return whether it was inserted or not
+   */
+  bool
+  insert(const Key& key, const Value& value) {
+    const guard_t guard{ _reclaimer };
+    const size_t  height{ random_height() };
+    nodes_t preds, succs;
+    while (true) {
+      const int found{ find(key, preds, succs) };
+      if (found >= 0) {
+        const node_t* node{ succs[found] };
+        if (!node->marked.load()) {
+          while (!node->fully_linked.load()) {
+            std::this_thread::yield();
+          }
+          return false;
+        }
+        continue;   // it's being removed, try again
+      }
+
+      size_t locked{ 0 };
+      bool   valid { true };
+      for (size_t level = 0; valid && level < height; level++, locked++) {
+        node_t* pred{ preds[level] };
+        node_t* succ{ succs[level] };
+        if (!level || pred != preds[level - 1]) {
+          pred->lock.lock();
+        }
+        valid = !pred->marked.load() && (!succ || !succ->marked.load()) &&
+                pred->next[level].load() == succ;
+      }
+      if (valid) {
+        node_t* node{ new node_t{ key, value, height } };
+        for (size_t level = 0; level < height; level++) {
+          node->next[level].store(succs[level], std::memory_order_relaxed);
+        }
+        for (size_t level = 0; level < height; level++) {
+          preds[level]->next[level].store(node);
+        }
+        node->fully_linked.store(true);
+        _size.fetch_add(1, std::memory_order_relaxed);
+      }
+      unlock(preds, locked);
+      if (valid) {
+        return true;
+      }
+    }
+  }
+
+  /**
+   * @brief remove  it removes key from the map
+   * @return whether this call removed it or not
+   */
+  bool
+  remove(const Key& key) {
+    const guard_t guard{ _reclaimer };
+    node_t* victim{ nullptr };
+    nodes_t preds, succs;
+    while (true) {
+      const int found{ find(key, preds, succs) };
+      if (!victim) {
+        if (found < 0) {
+          return false;
+        }
+        node_t* node{ succs[found] };
+        // only a fully linked node found at its top level can be removed
+        if (!node->fully_linked.load() || node->height != size_t(found) + 1 ||
+            node->marked.load()) {
+          return false;
+        }
+        node->lock.lock();
+        if (node->marked.load()) {
+          node->lock.unlock();
+          return false;
+        }
+        node->marked.store(true);   // linearization point
+        victim = node;
+      }
+
+      size_t locked{ 0 };
+      bool   valid { true };
+      for (size_t level = 0; valid && level < victim->height; level++, locked++) {
+        node_t* pred{ preds[level] };
+        if (!level || pred != preds[level - 1]) {
+          pred->lock.lock();
+        }
+        valid = !pred->marked.load() && pred->next[level].load() == victim;
+      }
+      if (valid) {
+        for (size_t level = victim->height; level--; ) {
+          preds[level]->next[level].store(victim->next[level].load());
+        }
+        victim->lock.unlock();
+        _size.fetch_sub(1, std::memory_order_relaxed);
+      }
+      unlock(preds, locked);
+      if (valid) {
+        _reclaimer.retire(victim);
+        return true;
+      }
+    }
+  }
+
+  /**
+   * @brief contains  whether key is in the map, wait-free
+   */
+  bool
+  contains(const Key& key) const {
+    const guard_t guard{ _reclaimer };
+    const node_t* node{ find_node(key) };
+    return node && node->fully_linked.load() && !node->marked.load();
+  }
+
+  /**
+   * @brief find  the value of key, if it's in the map
+   */
+  std::optional<Value>
+  find(const Key& key) const {
+    const guard_t guard{ _reclaimer };
+    const node_t* node{ find_node(key) };
+    if (node && node->fully_linked.load() && !node->marked.load()) {
+      return node->value;
+    }
+    return std::nullopt;
+  }
+
+  /**
+   * @brief for_each  it calls func(key, value) in order for the keys in
+   * [first, last), until it returns true. Weakly consistent.
+   * @return number of visited keys
+   */
+  template <class function_t>
+  size_t
+  for_each(const Key& first, const Key& last, function_t&& func) const {
+    const guard_t guard{ _reclaimer };
+    nodes_t preds, succs;
+    find(first, preds, succs);
+    return walk(succs[0], &last, func);
+  }
+
+  /**
+   * @brief for_each  it calls func(key, value) in order for all keys, until
+   * it returns true. Weakly consistent.
+   * @return number of visited keys
+   */
+  template <class function_t>
+  size_t
+  for_each(function_t&& func) const {
+    const guard_t guard{ _reclaimer };
+    return walk(_head.next[0].load(), nullptr, func);
+  }
+
+  /**
+   * @brief size  number of keys, exact only if no operation is running
+   */
+  inline size_t
+  size() const noexcept {
+    return _size.load(std::memory_order_relaxed);
+  }
+
+  inline bool
+  empty() const noexcept {
+    return size() == 0;
+  }
+
+  /**
+   * @brief pending_reclamation  removed nodes not deleted yet
+   */
+  inline size_t
+  pending_reclamation() const {
+    return _reclaimer.pending();
+  }
+
+private:
+  using guard_t = typename epoch_reclaimer_t<node_t>::guard_t;
+
+  /**
+   * @brief find  it fills the predecessor and successor of key at each level
+   * @return the highest level where key was found, or -1
+   */
+  int
+  find(const Key& key, nodes_t& preds, nodes_t& succs) const {
+    int     found{ -1 };
+    node_t* pred { const_cast<node_t*>(&_head) };
+    for (size_t level = max_level; level--; ) {
+      node_t* curr{ pred->next[level].load() };
+      while (curr && curr->key < key) {
+        pred = curr;
+        curr = pred->next[level].load();
+      }
+      if (found < 0 && curr && !(key < curr->key)) {
+        found = static_cast<int>(level);
+      }
+      preds[level] = pred;
+      succs[level] = curr;
+    }
+    return found;
+  }
+
+  /**
+   * @brief find_node  the first node equal to key, or nullptr
+   */
+  const node_t*
+  find_node(const Key& key) const {
+    const node_t* pred{ &_head };
+    for (size_t level = max_level; level--; ) {
+      const node_t* curr{ pred->next[level].load() };
+      while (curr && curr->key < key) {
+        pred = curr;
+        curr = pred->next[level].load();
+      }
+      if (curr && !(key < curr->key)) {
+        return curr;
+      }
+    }
+    return nullptr;
+  }
+
+  template <class function_t>
+  static size_t
+  walk(const node_t* node, const Key* last, function_t& func) {
+    size_t visited{ 0 };
+    for (; node && (!last || node->key < *last); node = node->next[0].load()) {
+      if (node->fully_linked.load() && !node->marked.load()) {
+        visited++;
+        if (func(node->key, node->value)) {
+          break;
+        }
+      }
+    }
+    return visited;
+  }
+
+  /**
+   * @brief unlock  it unlocks the distinct predecessors of the first levels
+   */
+  static void
+  unlock(const nodes_t& preds, size_t levels) {
+    for (size_t level = 0; level < levels; level++) {
+      if (!level || preds[level] != preds[level - 1]) {
+        preds[level]->lock.unlock();
+      }
+    }
+  }
+
+  /**
+   * @brief random_height  geometric distribution with p = 1/4
+   */
+  static size_t
+  random_height() {
+    static thread_local uint64_t state{
+      std::hash<std::thread::id>{}(std::this_thread::get_id()) | 1u };
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+    size_t height{ 1 };
+    for (uint64_t bits{ state }; (bits & 3u) == 0 && height < max_level; bits >>= 2) {
+      height++;
+    }
+    return height;
+  }
+
+  node_t                                _head;
+  std::atomic_size_t                    _size{ 0 };
+  mutable epoch_reclaimer_t<node_t>     _reclaimer;
+};
+
+}
+}
@@ -0,0 +1,374 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+#include "tree.h"
+
+namespace advanced {
+namespace structures {
+
+/** @test TestFlatTree in test/test_flat_tree(.h|.cpp) */
+
+/**
+ * @brief N-ary tree stored in two contiguous arrays, the values and the
+ * links (parent, first child, last child and next sibling as 32 bits
+ * indices), instead of one heap node plus one children vector per node like
+ * tree_node_t. Nodes are referred to by their index, the root is 0.
+ *
+ * When the nodes are stored in breadth first (or depth first pre) order, the
+ * matching search is a plain scan of the arrays. Converting a tree_t lays it
+ * out in the requested order, and add_child keeps track of whether the order
+ * still holds.
+ *
+ * @note  nodes can only be appended, null children of tree_node_t are not
+ * kept: the children of a node are its non-null children in order
+ */
+template <class T>
+class flat_tree_t {
+public:
+  using index_t = std::uint32_t;
+
+  static constexpr index_t npos{ std::numeric_limits<index_t>::max() };
+
+  enum class layout_t {
+    breadth_first,
+    depth_first
+  };
+
+  flat_tree_t() = default;
+
+  /**
+   * @brief flat_tree_t  it copies tree, its nodes are stored in the order of
+   * its breadth_first_search or its depth_first_search
+   */
+  template <class node_type_t>
+  explicit flat_tree_t(const tree_t<T, node_type_t>& tree,
+                       layout_t layout = layout_t::breadth_first) {
+    std::vector<const node_type_t*> nodes;
+    const auto collect{ [&nodes](const node_type_t& node) {
+      nodes.push_back(&node);
+      return false;
+    } };
+    if (layout == layout_t::breadth_first) {
+      tree.breadth_first_search(collect);
+    }
+    else {
+      tree.depth_first_search(collect);
+    }
+    check_capacity(nodes.size());
+    reserve(nodes.size());
+
+    // the parent of a node is the last ancestor of its predecessor (depth
+    // first), or the first node after the parent of its predecessor whose
+    // address matches (breadth first), both are found in O(n) overall
+    std::vector<index_t> ancestors;
+    index_t parent{ 0 };
+    for (const node_type_t* node : nodes) {
+      if (_values.empty()) {
+        add_root(node->get());
+        ancestors.push_back(0);
+        continue;
+      }
+      if (layout == layout_t::breadth_first) {
+        while (nodes[parent] != &node->parent()) {
+          parent++;
+        }
+      }
+      else {
+        while (nodes[ancestors.back()] != &node->parent()) {
+          ancestors.pop_back();
+        }
+        parent = ancestors.back();
+      }
+      ancestors.push_back(add_child(parent, node->get()));
+    }
+  }
+
+  /**
+   * @brief add_root  it adds the root, node 0
+   * @throws std::logic_error if the tree already has a root
+   */
+  index_t
+  add_root(const T& value) {
+    if (!_values.empty()) {
+      throw std::logic_error{ "flat_tree_t already has a root" };
+    }
+    _values.push_back(value);
+    _links.push_back(links_t{ });
+    return 0;
+  }
+
+  /**
+   * @brief add_child  it appends value as the last child of parent
+   * @return the index of the new node
+   * @throws std::out_of_range if parent is not a node of the tree
+   * @throws std::length_error if the tree already has npos nodes
+   */
+  index_t
+  add_child(index_t parent, const T& value) {
+    check_node(parent);
+    check_capacity(_values.size() + 1);
+    const index_t node { static_cast<index_t>(_values.size()) };
+    const index_t last { node - 1 };
+    // breadth first order holds while the parents are not decreasing
+    _breadth_first = _breadth_first && (last == 0 || parent >= _links[last].parent);
+    _depth_first   = _depth_first && is_ancestor_of_last(parent);
+
+    _values.push_back(value);
+    _links.push_back(links_t{ parent, npos, npos, npos });
+    links_t& links{ _links[parent] };
+    if (links.last_child == npos) {
+      links.first_child = node;
+    }
+    else {
+      _links[links.last_child].next_sibling = node;
+    }
+    links.last_child = node;
+    return node;
+  }
+
+  /**
+   * @brief is_stored_in  whether the nodes are stored in the order of the
+   * given search, so it is a scan of the arrays
+   */
+  inline bool
+  is_stored_in(layout_t layout) const noexcept {
+    return layout == layout_t::breadth_first ? _breadth_first : _depth_first;
+  }
+
+  inline T&
+  operator[](index_t node) {
+    return _values[node];
+  }
+
+  inline const T&
+  operator[](index_t node) const {
+    return _values[node];
+  }
+
+  /**
+   * @brief at  value of node
+   * @throws std::out_of_range if node is not a node of the tree
+   */
+  T&
+  at(index_t node) {
+    check_node(node);
+    return _values[node];
+  }
+
+  const T&
+  at(index_t node) const {
+    check_node(node);
+    return _values[node];
+  }
+
+  /**
+   * @brief parent  parent of node in O(1), npos for the root
+   */
+  inline index_t
+  parent(index_t node) const {
+    return _links[node].parent;
+  }
+
+  /**
+   * @brief first_child  first child of node, npos if it has no children
+   */
+  inline index_t
+  first_child(index_t node) const {
+    return _links[node].first_child;
+  }
+
+  /**
+   * @brief next_sibling  next child of the parent of node, npos if node is
+   * the last one
+   */
+  inline index_t
+  next_sibling(index_t node) const {
+    return _links[node].next_sibling;
+  }
+
+  size_t
+  children_count(index_t node) const {
+    size_t count{ 0 };
+    for (index_t child = first_child(node); child != npos; child = next_sibling(child)) {
+      count++;
+    }
+    return count;
+  }
+
+  /**
+   * @brief for_each_child  it calls func(index_t) for each child of node
+   */
+  template <class function_t>
+  void
+  for_each_child(index_t node, function_t&& func) const {
+    for (index_t child = first_child(node); child != npos; child = next_sibling(child)) {
+      func(child);
+    }
+  }
+
+  /**
+   * @brief breadth_first_search  it calls visitor(index_t) in breadth first
+   * order until it returns true
+   * @param scratch  queue owned by the caller, it is not used when the nodes
+   * are stored in breadth first order
+   * @return the number of visited nodes
+   */
+  template <class visitor_t>
+  size_t
+  breadth_first_search(visitor_t&& visitor, std::vector<index_t>& scratch) const {
+    if (_breadth_first) {
+      return scan(visitor);
+    }
+    size_t visited{ 0 };
+    scratch.assign(1, 0);
+    for (size_t front = 0; front < scratch.size(); front++) {
+      const index_t node{ scratch[front] };
+      visited++;
+      if (visitor(node)) {
+        break;
+      }
+      for_each_child(node, [&scratch](index_t child) { scratch.push_back(child); });
+    }
+    return visited;
+  }
+
+  template <class visitor_t>
+  size_t
+  breadth_first_search(visitor_t&& visitor) const {
+    std::vector<index_t> scratch;
+    return breadth_first_search(visitor, scratch);
+  }
+
+  /**
+   * @brief depth_first_search  it calls visitor(index_t) in depth first pre
+   * order until it returns true
+   * @param scratch  stack owned by the caller, it is not used when the nodes
+   * are stored in depth first order
+   * @return the number of visited nodes
+   */
+  template <class visitor_t>
+  size_t
+  depth_first_search(visitor_t&& visitor, std::vector<index_t>& scratch) const {
+    if (_depth_first) {
+      return scan(visitor);
+    }
+    size_t visited{ 0 };
+    scratch.assign(1, 0);
+    while (!scratch.empty()) {
+      const index_t node{ scratch.back() };
+      scratch.pop_back();
+      visited++;
+      if (visitor(node)) {
+        break;
+      }
+      const size_t first{ scratch.size() };
+      for_each_child(node, [&scratch](index_t child) { scratch.push_back(child); });
+      std::reverse(scratch.begin() + first, scratch.end());
+    }
+    return visited;
+  }
+
+  template <class visitor_t>
+  size_t
+  depth_first_search(visitor_t&& visitor) const {
+    std::vector<index_t> scratch;
+    return depth_first_search(visitor, scratch);
+  }
+
+  /**
+   * @brief values  all values in storage order
+   */
+  inline const std::vector<T>&
+  values() const noexcept {
+    return _values;
+  }
+
+  inline void
+  reserve(size_t nodes) {
+    _values.reserve(nodes);
+    _links.reserve(nodes);
+  }
+
+  inline void
+  clear() noexcept {
+    _values.clear();
+    _links.clear();
+    _breadth_first = _depth_first = true;
+  }
+
+  inline size_t
+  size() const noexcept {
+    return _values.size();
+  }
+
+  inline bool
+  empty() const noexcept {
+    return _values.empty();
+  }
+
+  inline bool
+  has_root() const noexcept {
+    return !_values.empty();
+  }
+
+private:
+  struct links_t {
+    index_t parent      { npos };
+    index_t first_child { npos };
+    index_t last_child  { npos };
+    index_t next_sibling{ npos };
+  };
+
+  template <class visitor_t>
+  size_t
+  scan(visitor_t& visitor) const {
+    for (size_t node = 0; node < _values.size(); node++) {
+      if (visitor(static_cast<index_t>(node))) {
+        return node + 1;
+      }
+    }
+    return _values.size();
+  }
+
+  /**
+   * In depth first order a new node must hang from the last node or one of its
+   * ancestors. Ancestors are stored before their descendants, so the walk up
+   * from the last node stops as soon as it passes parent.
+   */
+  bool
+  is_ancestor_of_last(index_t parent) const {
+    index_t node{ static_cast<index_t>(_values.size() - 1) };
+    while (node != npos && node > parent) {
+      node = _links[node].parent;
+    }
+    return node == parent;
+  }
+
+  void
+  check_node(index_t node) const {
+    if (node >= _values.size()) {
+      throw std::out_of_range{ "flat_tree_t has no node " + std::to_string(node) };
+    }
+  }
+
+  static void
+  check_capacity(size_t nodes) {
+    if (nodes >= npos) {
+      throw std::length_error{ "flat_tree_t is limited to 2^32 - 1 nodes" };
+    }
+  }
+
+  std::vector<T>       _values;
+  std::vector<links_t> _links;
+  bool                 _breadth_first{ true };
+  bool                 _depth_first  { true };
+};
+
+}
+}
@@ -0,0 +1,552 @@
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+#include "binary_tree.h"
+
+namespace advanced {
+namespace structures {
+
+/** @test TestIntervalTree in test/test_interval_tree(.h|.cpp) */
+
+template <class K, class allocator_t>
+class interval_tree_t;
+
+/**
+ * @brief interval_t  closed interval [low, high], ordered by low and then by
+ * high. Inside an interval_tree_t it also keeps the greatest high of its
+ * subtree.
+ */
+template <class K>
+class interval_t {
+  friend struct node_augmentation_t<interval_t<K>>;
+  template <class, class> friend class interval_tree_t;
+
+public:
+  interval_t() = default;
+
+  /**
+   * @throws std::invalid_argument if high < low
+   */
+  interval_t(const K& low, const K& high)
+    : _low{ low }, _high{ high }, _max{ high }
+  {
+    if (high < low) {
+      throw std::invalid_argument{ "The interval ends before it starts" };
+    }
+  }
+
+  inline const K&
+  low() const noexcept {
+    return _low;
+  }
+
+  inline const K&
+  high() const noexcept {
+    return _high;
+  }
+
+  inline bool
+  contains(const K& point) const {
+    return !(point < _low) && !(_high < point);
+  }
+
+  /**
+   * @brief overlaps  whether [low, high] and this interval share a point
+   */
+  inline bool
+  overlaps(const K& low, const K& high) const {
+    return !(high < _low) && !(_high < low);
+  }
+
+  inline bool
+  operator<(const interval_t& other) const {
+    return _low < other._low || (!(other._low < _low) && _high < other._high);
+  }
+
+  inline bool
+  operator>(const interval_t& other) const {
+    return other < *this;
+  }
+
+  inline bool
+  operator==(const interval_t& other) const {
+    return !(*this < other) && !(other < *this);
+  }
+
+  inline bool
+  operator!=(const interval_t& other) const {
+    return !(*this == other);
+  }
+
+private:
+  K _low { };
+  K _high{ };
+  K _max { };   // greatest high of the subtree in an interval_tree_t
+};
+
+/**
+ * @brief the greatest high of a subtree, kept by avl_tree_t through the
+ * insertions, removals and rotations
+ */
+template <class K>
+struct node_augmentation_t<interval_t<K>> {
+  static constexpr bool enabled{ true };
+
+  inline static void
+  update(interval_t<K>& value, const interval_t<K>* left, const interval_t<K>* right) {
+    value._max = value._high;
+    for (const interval_t<K>* child : { left, right }) {
+      if (child && value._max < child->_max) {
+        value._max = child->_max;
+      }
+    }
+  }
+};
+
+/**
+ * @brief interval_tree_t  dynamic set of intervals, an avl_tree_t ordered by
+ * the low endpoint where every node also keeps the greatest high endpoint of
+ * its subtree. The searches skip the subtrees that end before the query and
+ * the ones that start after it. Equal intervals can be repeated.
+ *
+ * insert and remove are O(log n). A query reporting k intervals is
+ * O(log n + k log(n / k)) at worst and close to O(log n + k) for intervals
+ * that are not nested. For read-only sets static_interval_tree_t is
+ * O(log n + k).
+ */
+template <class K, class allocator_t = heap_node_allocator_t<binary_node_t<interval_t<K>>>>
+class interval_tree_t {
+public:
+  using interval_type  = interval_t<K>;
+  using node_type_t    = binary_node_t<interval_type>;
+  using tree_type_t    = avl_tree_t<interval_type, allocator_t>;
+  using const_iterator = typename tree_type_t::const_iterator;
+
+  interval_tree_t() {
+    _tree.enable_duplicates();
+  }
+
+  /**
+   * @throws std::invalid_argument if high < low
+   */
+  inline void
+  insert(const K& low, const K& high) {
+    insert(interval_type{ low, high });
+  }
+
+  inline void
+  insert(const interval_type& interval) {
+    _tree.insert(interval);
+  }
+
+  /**
+   * @brief remove  it removes one interval equal to [low, high]
+   * @return whether there was one
+   */
+  inline bool
+  remove(const K& low, const K& high) {
+    return !(high < low) && _tree.remove(interval_type{ low, high });
+  }
+
+  inline bool
+  remove(const interval_type& interval) {
+    return _tree.remove(interval);
+  }
+
+  inline bool
+  contains(const K& low, const K& high) const {
+    return !(high < low) && _tree.contains(interval_type{ low, high });
+  }
+
+  /**
+   * @brief rebuild  it replaces the intervals by [first, last) in
+   * O(n log n), without rotations
+   */
+  template <class Iterator>
+  interval_tree_t&
+  rebuild(Iterator first, Iterator last) {
+    std::vector<interval_type> sorted(first, last);
+    std::sort(sorted.begin(), sorted.end());
+    _tree.rebuild(sorted.begin(), sorted.end());
+    return *this;
+  }
+
+  /**
+   * @brief for_each_overlap  it calls visitor(const interval_type&) for the
+   * intervals containing point, by increasing low, until it returns true
+   * @return the number of visited intervals
+   */
+  template <class visitor_t>
+  inline size_t
+  for_each_overlap(const K& point, visitor_t&& visitor) const {
+    return for_each_overlap(point, point, visitor);
+  }
+
+  /**
+   * @brief for_each_overlap  it calls visitor(const interval_type&) for the
+   * intervals overlapping [low, high], by increasing low, until it returns
+   * true
+   * @return the number of visited intervals
+   */
+  template <class visitor_t>
+  size_t
+  for_each_overlap(const K& low, const K& high, visitor_t&& visitor) const {
+    size_t visited{ 0u };
+    if (!(high < low) && _tree.has_root()) {
+      visit(_tree.root(), low, high, visitor, visited);
+    }
+    return visited;
+  }
+
+  /**
+   * @brief overlaps  the intervals containing point, by increasing low
+   */
+  inline std::vector<interval_type>
+  overlaps(const K& point) const {
+    return overlaps(point, point);
+  }
+
+  /**
+   * @brief overlaps  the intervals overlapping [low, high], by increasing low
+   */
+  std::vector<interval_type>
+  overlaps(const K& low, const K& high) const {
+    std::vector<interval_type> found;
+    for_each_overlap(low, high, [&found](const interval_type& interval) {
+      found.push_back(interval);
+      return false;
+    });
+    return found;
+  }
+
+  inline size_t
+  size() const {
+    return _tree.size();
+  }
+
+  inline bool
+  empty() const {
+    return _tree.size() == 0u;
+  }
+
+  inline void
+  clear() noexcept {
+    _tree.clear();
+  }
+
+  inline const_iterator
+  begin() const {
+    return _tree.begin();
+  }
+
+  inline const_iterator
+  end() const {
+    return _tree.end();
+  }
+
+  /**
+   * @brief tree  the underlying avl_tree_t
+   */
+  inline const tree_type_t&
+  tree() const noexcept {
+    return _tree;
+  }
+
+private:
+  /**
+   * @brief visit  in order search, as deep as the avl tree
+   * @return whether the visitor returned true
+   */
+  template <class visitor_t>
+  static bool
+  visit(const node_type_t& node, const K& low, const K& high,
+        visitor_t& visitor, size_t& visited) {
+    const interval_type& interval{ node.get() };
+    if (interval._max < low) {
+      return false;
+    }
+    if (node.has_left() && visit(node.left(), low, high, visitor, visited)) {
+      return true;
+    }
+    if (high < interval._low) {
+      // the right subtree starts even later
+      return false;
+    }
+    if (!(interval._high < low)) {
+      visited++;
+      if (visitor(interval)) {
+        return true;
+      }
+    }
+    return node.has_right() && visit(node.right(), low, high, visitor, visited);
+  }
+
+  tree_type_t _tree;
+};
+
+/**
+ * @brief static_interval_tree_t  build-once centered interval tree for
+ * read-only sets of intervals. Each node takes the median of the endpoints
+ * of its intervals as center and keeps the intervals containing it twice,
+ * sorted by low and by decreasing high, so a query only reads the ones it
+ * reports plus one per node in its path. The intervals ending before the
+ * center go to the left child, the ones starting after it to the right one,
+ * so the depth is at most log2(n).
+ *
+ * The build is O(n log n) and a query reporting k intervals is O(log n + k),
+ * the nodes and both lists are arrays without pointers.
+ */
+template <class K>
+class static_interval_tree_t {
+public:
+  using interval_type = interval_t<K>;
+
+  static_interval_tree_t() = default;
+
+  /**
+   * @brief static_interval_tree_t  it builds the tree with the intervals of
+   * [first, last), in any order
+   * @throws std::length_error if there are more than 2^32 - 1 intervals
+   */
+  template <class Iterator>
+  static_interval_tree_t(Iterator first, Iterator last) {
+    std::vector<interval_type> intervals(first, last);
+    if (intervals.size() >= npos) {
+      throw std::length_error{ "Too many intervals" };
+    }
+    _by_low.reserve(intervals.size());
+    _by_high.reserve(intervals.size());
+    build(std::move(intervals));
+  }
+
+  template <class allocator_t>
+  explicit static_interval_tree_t(const interval_tree_t<K, allocator_t>& tree)
+    : static_interval_tree_t{ tree.begin(), tree.end() }
+  { }
+
+  /**
+   * @brief for_each_overlap  it calls visitor(const interval_type&) for the
+   * intervals containing point, in no particular order, until it returns
+   * true
+   * @return the number of visited intervals
+   */
+  template <class visitor_t>
+  size_t
+  for_each_overlap(const K& point, visitor_t&& visitor) const {
+    size_t visited{ 0u };
+    index_t index{ _nodes.empty() ? npos : 0u };
+    while (index != npos) {
+      const node_t& node{ _nodes[index] };
+      const interval_type* first{ _by_low.data()  + node.first };
+      const interval_type* last { first + node.count };
+      if (point < node.center) {
+        for (; first != last && !(point < first->low()); ++first) {
+          visited++;
+          if (visitor(*first)) {
+            return visited;
+          }
+        }
+        index = node.left;
+      }
+      else if (node.center < point) {
+        first = _by_high.data() + node.first;
+        last  = first + node.count;
+        for (; first != last && !(first->high() < point); ++first) {
+          visited++;
+          if (visitor(*first)) {
+            return visited;
+          }
+        }
+        index = node.right;
+      }
+      else {
+        // all the intervals of the node contain its center
+        for (; first != last; ++first) {
+          visited++;
+          if (visitor(*first)) {
+            return visited;
+          }
+        }
+        break;
+      }
+    }
+    return visited;
+  }
+
+  /**
+   * @brief for_each_overlap  it calls visitor(const interval_type&) for the
+   * intervals overlapping [low, high], in no particular order, until it
+   * returns true
+   * @return the number of visited intervals
+   */
+  template <class visitor_t>
+  size_t
+  for_each_overlap(const K& low, const K& high, visitor_t&& visitor) const {
+    size_t visited{ 0u };
+    if (!(high < low) && !_nodes.empty()) {
+      visit(0u, low, high, visitor, visited);
+    }
+    return visited;
+  }
+
+  inline std::vector<interval_type>
+  overlaps(const K& point) const {
+    std::vector<interval_type> found;
+    for_each_overlap(point, [&found](const interval_type& interval) {
+      found.push_back(interval);
+      return false;
+    });
+    return found;
+  }
+
+  std::vector<interval_type>
+  overlaps(const K& low, const K& high) const {
+    std::vector<interval_type> found;
+    for_each_overlap(low, high, [&found](const interval_type& interval) {
+      found.push_back(interval);
+      return false;
+    });
+    return found;
+  }
+
+  inline size_t
+  size() const noexcept {
+    return _by_low.size();
+  }
+
+  inline bool
+  empty() const noexcept {
+    return _by_low.empty();
+  }
+
+private:
+  using index_t = uint32_t;
+
+  static constexpr index_t npos{ std::numeric_limits<index_t>::max() };
+
+  /**
+   * the intervals of a node are [first, first + count) in both lists
+   */
+  struct node_t {
+    K       center;
+    index_t first;
+    index_t count;
+    index_t left { npos };
+    index_t right{ npos };
+  };
+
+  /**
+   * @brief build  it builds the subtree of intervals, in pre order
+   * @return the index of its root, npos if there are no intervals
+   */
+  index_t
+  build(std::vector<interval_type> intervals) {
+    if (intervals.empty()) {
+      return npos;
+    }
+    std::vector<K> endpoints;
+    endpoints.reserve(2u * intervals.size());
+    for (const auto& interval : intervals) {
+      endpoints.push_back(interval.low());
+      endpoints.push_back(interval.high());
+    }
+    auto median{ endpoints.begin() + endpoints.size() / 2u };
+    std::nth_element(endpoints.begin(), median, endpoints.end());
+    const K center{ *median };
+    endpoints = std::vector<K>{ };
+
+    std::vector<interval_type> lower;
+    std::vector<interval_type> greater;
+    const size_t first{ _by_low.size() };
+    for (const auto& interval : intervals) {
+      if (interval.high() < center) {
+        lower.push_back(interval);
+      }
+      else if (center < interval.low()) {
+        greater.push_back(interval);
+      }
+      else {
+        _by_low.push_back(interval);
+        _by_high.push_back(interval);
+      }
+    }
+    intervals = std::vector<interval_type>{ };
+    std::sort(_by_low.begin() + first, _by_low.end(),
+              [](const interval_type& a, const interval_type& b) {
+      return a.low() < b.low();
+    });
+    std::sort(_by_high.begin() + first, _by_high.end(),
+              [](const interval_type& a, const interval_type& b) {
+      return b.high() < a.high();
+    });
+
+    const index_t index{ static_cast<index_t>(_nodes.size()) };
+    _nodes.push_back(node_t{ center, static_cast<index_t>(first),
+                             static_cast<index_t>(_by_low.size() - first) });
+    const index_t left{ build(std::move(lower)) };
+    _nodes[index].left  = left;
+    const index_t right{ build(std::move(greater)) };
+    _nodes[index].right = right;
+    return index;
+  }
+
+  /**
+   * @brief visit  a node with its center out of [low, high] only reads the
+   * intervals it reports and continues on one side, the other ones report all
+   * their intervals
+   * @return whether the visitor returned true
+   */
+  template <class visitor_t>
+  bool
+  visit(index_t index, const K& low, const K& high,
+        visitor_t& visitor, size_t& visited) const {
+    while (index != npos) {
+      const node_t&        node { _nodes[index] };
+      const interval_type* first{ _by_low.data() + node.first };
+      const interval_type* last { first + node.count };
+      if (high < node.center) {
+        for (; first != last && !(high < first->low()); ++first) {
+          visited++;
+          if (visitor(*first)) {
+            return true;
+          }
+        }
+        index = node.left;
+      }
+      else if (node.center < low) {
+        first = _by_high.data() + node.first;
+        last  = first + node.count;
+        for (; first != last && !(first->high() < low); ++first) {
+          visited++;
+          if (visitor(*first)) {
+            return true;
+          }
+        }
+        index = node.right;
+      }
+      else {
+        for (; first != last; ++first) {
+          visited++;
+          if (visitor(*first)) {
+            return true;
+          }
+        }
+        if (visit(node.left, low, high, visitor, visited)) {
+          return true;
+        }
+        index = node.right;
+      }
+    }
+    return false;
+  }
+
+  std::vector<node_t>        _nodes;
+  std::vector<interval_type> _by_low;    // intervals of each node by low
+  std::vector<interval_type> _by_high;   // same intervals by decreasing high
+};
+
+}
+}
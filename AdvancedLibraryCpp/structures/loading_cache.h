@@ -0,0 +1,455 @@
+#pragma once
+#include <chrono>
+#include <functional>
+#include <future>
+#include <list>
+#include <mutex>
+#include <stdexcept>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include "cache.h"
+#include "../tools/timestamp.h"
+
+namespace advanced {
+namespace structures {
+
+/** @test TestLoadingCache in test/test_loading_cache(.h|.cpp) */
+
+/**
+ * @brief thrown to the callers waiting on a key that the bulk loader did not
+ * return
+ */
+class key_not_loaded_exception_t : public std::runtime_error {
+public:
+  key_not_loaded_exception_t() :
+    std::runtime_error{ "The loader did not return a value for this key" } { }
+};
+
+/**
+ * @brief Memoizing cache built on top of the LRU cache_t.
+ *
+ * On a miss, get(key, loader) runs the loader exactly once per key, any other
+ * caller asking for the same key meanwhile waits on a shared future instead of
+ * running the loader again (request coalescing).
+ *
+ * Entries may expire after a given time (expire_after), and they can be
+ * reloaded asynchronously once they are older than refresh_after, so hot keys
+ * never block the callers on expiration (refresh-ahead). While a refresh is
+ * running, the stale value keeps being served. Refreshes run the loader given
+ * to the constructor, since they outlive the get call that triggered them.
+ *
+ * All methods are reentrant.
+ *
+ * @note the values are returned by copy, because another thread may evict
+ * them as soon as the internal lock is released.
+ * @note If you override on_load, call wait_refreshes on your destructor, a
+ * refresh may still be running when your object is destroyed.
+ */
+template <typename key_t, typename value_t>
+class loading_cache_t {
+  public:
+  using loader_t      = std::function<value_t(const key_t&)>;
+  using result_map_t  = std::unordered_map<key_t, value_t>;
+  using bulk_loader_t = std::function<result_map_t(const std::vector<key_t>&)>;
+  using duration_t    = std::chrono::milliseconds;
+
+  loading_cache_t(loading_cache_t &&)                 = delete;  // non-movable
+  loading_cache_t(const loading_cache_t &)            = delete;  // non-copyable
+  loading_cache_t &operator=(loading_cache_t &&)      = delete;  // non-movable
+  loading_cache_t &operator=(const loading_cache_t &) = delete;  // non-copyable
+
+  /**
+   * @brief loading_cache_t Constructor
+   * @param capacity        max number of entries kept in the LRU cache
+   * @param expire_after    entries older than it are reloaded synchronously,
+   *                        zero means they never expire
+   * @param refresh_after   entries older than it are reloaded asynchronously
+   *                        on the next access, zero disables refresh-ahead
+   * @param refresh_loader  function that reloads the values in the background,
+   *                        it's kept by the cache until it's destroyed
+   * @throws std::invalid_argument if refresh_after is set without a
+   *                        refresh_loader
+   */
+  loading_cache_t(size_t     capacity       = 1024,
+                  duration_t expire_after   = duration_t{ 0 },
+                  duration_t refresh_after  = duration_t{ 0 },
+                  loader_t   refresh_loader = nullptr)
+    : _keys{ _entries },
+      _expire_after{ expire_after },
+      _refresh_after{ refresh_after },
+      _refresh_loader{ std::move(refresh_loader) }
+  {
+    if (_refresh_after.count() && !_refresh_loader) {
+      throw std::invalid_argument{ "Refresh-ahead needs a refresh loader" };
+    }
+    _keys.set_capacity(capacity);
+  }
+
+  /**
+   * @brief ~loading_cache_t  it waits for any running refresh
+   */
+  virtual
+  ~loading_cache_t() {
+    wait_refreshes();
+  }
+
+  /**
+   * @brief get   returns the cached value for key, loading it if needed
+   * @param key     key to be searched
+   * @param loader  function that computes the value of a missing key. It runs
+   *                once per key, even if several threads miss it at once, and
+   *                never after get returns: stale values are reloaded by the
+   *                refresh loader given to the constructor
+   * @return        copy of the cached value
+   * @throws        anything thrown by the loader, to every waiting caller
+   */
+  value_t
+  get(const key_t& key, const loader_t& loader) {
+    std::unique_lock<std::mutex> guard{ _mtx };
+    auto entry{ lookup(key) };
+    if (entry) {
+      if (should_refresh(*entry)) {
+        schedule_refresh(key);
+      }
+      return entry->value;
+    }
+
+    auto flight{ _in_flight.find(key) };
+    if (flight != _in_flight.end()) {
+      auto future{ flight->second };
+      guard.unlock();
+      return future.get();
+    }
+
+    std::promise<value_t> promise;
+    _in_flight.emplace(key, promise.get_future().share());
+    guard.unlock();
+
+    try {
+      value_t value{ loader(key) };
+      guard.lock();
+      store(key, value);
+      _in_flight.erase(key);
+      guard.unlock();
+      promise.set_value(value);
+      return value;
+    }
+    catch (...) {
+      if (!guard.owns_lock()) {
+        guard.lock();
+      }
+      _in_flight.erase(key);
+      guard.unlock();
+      promise.set_exception(std::current_exception());
+      throw;
+    }
+  }
+
+  /**
+   * @brief get_all  returns the values of all keys, loading the missing ones
+   * with a single call to bulk_loader
+   * @param keys         keys to be searched
+   * @param bulk_loader  function receiving the missing keys and returning a
+   *                     map with their values
+   * @return  map with the values found or loaded. Keys the bulk loader did not
+   *          return are left out of the result
+   * @throws  anything thrown by the bulk loader or by a coalesced loader
+   */
+  result_map_t
+  get_all(const std::vector<key_t>& keys, const bulk_loader_t& bulk_loader) {
+    result_map_t                                             result;
+    std::vector<key_t>                                       missing;
+    std::vector<std::promise<value_t>>                       promises;
+    std::vector<std::pair<key_t, std::shared_future<value_t>>> waiting;
+
+    std::unique_lock<std::mutex> guard{ _mtx };
+    for (const auto& key : keys) {
+      if (result.count(key)) {
+        continue;
+      }
+      auto entry{ lookup(key) };
+      if (entry) {
+        result.emplace(key, entry->value);
+        continue;
+      }
+      auto flight{ _in_flight.find(key) };
+      if (flight != _in_flight.end()) {
+        waiting.emplace_back(key, flight->second);
+      }
+      else {
+        promises.emplace_back();
+        _in_flight.emplace(key, promises.back().get_future().share());
+        missing.push_back(key);
+      }
+    }
+    guard.unlock();
+
+    if (!missing.empty()) {
+      result_map_t loaded;
+      try {
+        loaded = bulk_loader(missing);
+      }
+      catch (...) {
+        auto error{ std::current_exception() };
+        guard.lock();
+        for (const auto& key : missing) {
+          _in_flight.erase(key);
+        }
+        guard.unlock();
+        for (auto& promise : promises) {
+          promise.set_exception(error);
+        }
+        throw;
+      }
+
+      guard.lock();
+      for (const auto& key : missing) {
+        auto it{ loaded.find(key) };
+        if (it != loaded.end()) {
+          store(key, it->second);
+        }
+        _in_flight.erase(key);
+      }
+      guard.unlock();
+
+      for (size_t ii = 0; ii < missing.size(); ii++) {
+        auto it{ loaded.find(missing[ii]) };
+        if (it != loaded.end()) {
+          promises[ii].set_value(it->second);
+          result.emplace(it->first, it->second);
+        }
+        else {
+          promises[ii].set_exception(
+            std::make_exception_ptr(key_not_loaded_exception_t{}));
+        }
+      }
+    }
+
+    for (auto& pending : waiting) {
+      try {
+        result.emplace(pending.first, pending.second.get());
+      }
+      catch (const key_not_loaded_exception_t&) { }
+    }
+    return result;
+  }
+
+  /**
+   * @brief contains  whether a non expired value is cached for key or not.
+   * It does not change the recency order
+   */
+  bool
+  contains(const key_t& key) const {
+    std::lock_guard<std::mutex> guard{ _mtx };
+    auto it{ _entries.find(key) };
+    return it != _entries.end() && !expired(it->second);
+  }
+
+  /**
+   * @brief invalidate  removes a key from cache
+   * @return whether the key was cached or not
+   */
+  bool
+  invalidate(const key_t& key) {
+    std::lock_guard<std::mutex> guard{ _mtx };
+    return erase(key);
+  }
+
+  /**
+   * @brief clear  removes all entries, loads in progress are not affected
+   */
+  void
+  clear() {
+    std::lock_guard<std::mutex> guard{ _mtx };
+    _keys.clear();
+    _entries.clear();
+  }
+
+  /**
+   * @brief size  current number of cached entries (including expired ones not
+   * accessed yet)
+   */
+  size_t
+  size() const {
+    std::lock_guard<std::mutex> guard{ _mtx };
+    return _entries.size();
+  }
+
+  /**
+   * @brief capacity  max number of cached entries
+   */
+  size_t
+  capacity() const {
+    std::lock_guard<std::mutex> guard{ _mtx };
+    return _keys.capacity();
+  }
+
+  /**
+   * @brief set_capacity  changes the max number of cached entries, discarding
+   * the least recent used ones if needed
+   */
+  void
+  set_capacity(size_t capacity) {
+    std::lock_guard<std::mutex> guard{ _mtx };
+    _keys.set_capacity(capacity);
+  }
+
+  /**
+   * @brief wait_refreshes  blocks until every asynchronous refresh scheduled so
+   * far is finished
+   */
+  void
+  wait_refreshes() {
+    std::unique_lock<std::mutex> guard{ _mtx };
+    while (!_refreshes.empty()) {
+      auto refreshes{ std::move(_refreshes) };
+      _refreshes.clear();
+      guard.unlock();
+      for (auto& refresh : refreshes) {
+        refresh.wait();
+      }
+      guard.lock();
+    }
+  }
+
+  protected:
+
+  struct entry_t {
+    value_t             value;
+    tools::timestamp_t  loaded;
+  };
+
+  using entries_t = std::unordered_map<key_t, entry_t>;
+
+  /**
+   * @brief LRU ordering of the keys, whenever cache_t discards a key, the
+   * loaded value is discarded too
+   */
+  class keys_cache_t : public cache_t<key_t> {
+    public:
+    keys_cache_t(entries_t& entries) : _entries{ entries } { }
+
+    protected:
+    virtual void
+    on_discard(const key_t& key) override {
+      _entries.erase(key);
+    }
+
+    private:
+    entries_t& _entries;
+  };
+
+  /**
+   * Override it if you need do some action when a value is loaded (or
+   * reloaded) into the cache. It's called with the internal lock held.
+   */
+  virtual void
+  on_load(const key_t& key, const value_t& value)
+  { (void)key; (void)value; }
+
+  private:
+
+  /**
+   * It returns the fresh entry for key moving it to the front of the LRU list,
+   * or nullptr. Expired entries are discarded. Requires the lock.
+   */
+  entry_t*
+  lookup(const key_t& key) {
+    entry_t* entry{ nullptr };
+    auto it{ _entries.find(key) };
+    if (it != _entries.end()) {
+      if (expired(it->second)) {
+        erase(key);
+      }
+      else {
+        (void)_keys.find(key);
+        entry = &it->second;
+      }
+    }
+    return entry;
+  }
+
+  /**
+   * It inserts or replaces the value for key. Requires the lock.
+   */
+  void
+  store(const key_t& key, const value_t& value) {
+    auto it{ _entries.find(key) };
+    if (it != _entries.end()) {
+      it->second.value = value;
+      it->second.loaded.reset();
+      (void)_keys.find(key);
+    }
+    else {
+      _entries.emplace(key, entry_t{ value, tools::timestamp_t{} });
+      _keys.add(key);
+    }
+    on_load(key, value);
+  }
+
+  /**
+   * It removes key from cache. Requires the lock.
+   */
+  bool
+  erase(const key_t& key) {
+    bool ok{ _entries.erase(key) > 0 };
+    if (ok) {
+      _keys.remove(key);
+    }
+    return ok;
+  }
+
+  inline bool
+  expired(const entry_t& entry) const {
+    return _expire_after.count() &&
+           entry.loaded.template difference<duration_t>() >= _expire_after;
+  }
+
+  inline bool
+  should_refresh(const entry_t& entry) const {
+    return _refresh_after.count() &&
+           entry.loaded.template difference<duration_t>() >= _refresh_after;
+  }
+
+  /**
+   * It reloads key in another thread with the refresh loader, unless it's
+   * already being reloaded. Requires the lock.
+   */
+  void
+  schedule_refresh(const key_t& key) {
+    if (_refreshing.insert(key).second) {
+      _refreshes.remove_if([](const std::future<void>& refresh) {
+        return refresh.wait_for(duration_t{ 0 }) == std::future_status::ready;
+      });
+      _refreshes.push_back(std::async(std::launch::async, [this, key]() {
+        try {
+          value_t value{ _refresh_loader(key) };
+          std::lock_guard<std::mutex> guard{ _mtx };
+          if (_entries.count(key)) {
+            store(key, value);
+          }
+          _refreshing.erase(key);
+        }
+        catch (...) {
+          // a failed refresh keeps the current value until it expires
+          std::lock_guard<std::mutex> guard{ _mtx };
+          _refreshing.erase(key);
+        }
+      }));
+    }
+  }
+
+  mutable std::mutex                                       _mtx;
+  entries_t                                                _entries;
+  keys_cache_t                                             _keys;
+  std::unordered_map<key_t, std::shared_future<value_t>>   _in_flight;
+  std::unordered_set<key_t>                                _refreshing;
+  std::list<std::future<void>>                             _refreshes;
+  const duration_t                                         _expire_after;
+  const duration_t                                         _refresh_after;
+  const loader_t                                           _refresh_loader;
+};
+
+}
+}
@@ -0,0 +1,280 @@
+#pragma once
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+#include <new>
+#include <utility>
+#include <vector>
+
+namespace advanced {
+namespace structures {
+
+/** @test TestAVLTree in test/test_avl_tree(.h|.cpp) */
+
+/**
+ * Node allocators used by binary_tree_t and avl_tree_t. An allocator must
+ * provide:
+ *
+ *   using value_type = node_type_t;             // the node it creates
+ *   node_type_t* create(Args&&... args);        // constructs a node
+ *   void         destroy(node_type_t* node);    // destroys and frees a node
+ *   void         release();                     // called once all nodes are
+ *                                               // destroyed by clear()
+ *   allocator_t  select_on_copy() const;        // allocator for a copied tree
+ *   bool         operator==(const allocator_t&) // whether nodes created by one
+ *                                               // can be destroyed by other
+ *   static constexpr bool bulk_release;         // release() frees every node
+ *
+ * When bulk_release is true and the node value is trivially destructible,
+ * clear() doesn't visit the nodes at all, it only calls release().
+ */
+
+/**
+ * @brief heap_node_allocator_t  every node is allocated with new and freed
+ * with delete, as the nodes created by binary_node_t::add_left/add_right
+ */
+template <class node_type_t>
+class heap_node_allocator_t {
+public:
+  using value_type = node_type_t;
+
+  static constexpr bool bulk_release{ false };
+
+  template <typename ...Args>
+  inline node_type_t*
+  create(Args&&...args) {
+    return new node_type_t(std::forward<Args>(args)...);
+  }
+
+  inline void
+  destroy(node_type_t* node) noexcept {
+    delete node;
+  }
+
+  inline void
+  release() noexcept { }
+
+  inline heap_node_allocator_t
+  select_on_copy() const {
+    return {};
+  }
+
+  inline bool
+  operator==(const heap_node_allocator_t&) const noexcept {
+    return true;
+  }
+};
+
+/**
+ * @brief arena_node_allocator_t  per tree slab allocator. Nodes are carved
+ * from slabs of nodes_per_slab slots, removed nodes go to a free list that is
+ * reused by the next insertions, and clear() frees all slabs at once.
+ * Neighbour nodes are created next to each other, so walks touch less pages
+ * and there is no malloc/free per insertion/removal.
+ * @note it's movable but not copyable, a copied tree gets its own arena.
+ */
+template <class node_type_t>
+class arena_node_allocator_t {
+public:
+  using value_type = node_type_t;
+
+  static constexpr bool bulk_release{ true };
+
+  explicit arena_node_allocator_t(size_t nodes_per_slab = 1024)
+    : _nodes_per_slab{ nodes_per_slab ? nodes_per_slab : 1u },
+      _next{ _nodes_per_slab }
+  { }
+
+  arena_node_allocator_t(const arena_node_allocator_t&)            = delete;
+  arena_node_allocator_t& operator=(const arena_node_allocator_t&) = delete;
+
+  arena_node_allocator_t(arena_node_allocator_t&& other) noexcept {
+    *this = std::move(other);
+  }
+
+  arena_node_allocator_t&
+  operator=(arena_node_allocator_t&& other) noexcept {
+    _slabs          = std::move(other._slabs);
+    _free           = other._free;
+    _nodes_per_slab = other._nodes_per_slab;
+    _next           = other._next;
+    _live           = other._live;
+    other._slabs.clear();
+    other._free = nullptr;
+    other._next = other._nodes_per_slab;
+    other._live = 0;
+    return *this;
+  }
+
+  template <typename ...Args>
+  node_type_t*
+  create(Args&&...args) {
+    slot_t* slot{ acquire() };
+    try {
+      node_type_t* node{ new (slot->storage) node_type_t(std::forward<Args>(args)...) };
+      _live++;
+      return node;
+    }
+    catch (...) {
+      recycle(slot);
+      throw;
+    }
+  }
+
+  void
+  destroy(node_type_t* node) noexcept {
+    if (node) {
+      node->~node_type_t();
+      recycle(reinterpret_cast<slot_t*>(node));
+      _live--;
+    }
+  }
+
+  /**
+   * @brief release  it frees all slabs, every node allocated must be already
+   * destroyed, or its value must be trivially destructible
+   */
+  void
+  release() noexcept {
+    _slabs.clear();
+    _free = nullptr;
+    _next = _nodes_per_slab;
+    _live = 0;
+  }
+
+  inline arena_node_allocator_t
+  select_on_copy() const {
+    return arena_node_allocator_t{ _nodes_per_slab };
+  }
+
+  /**
+   * Nodes can only be destroyed by the arena that created them
+   */
+  inline bool
+  operator==(const arena_node_allocator_t& other) const noexcept {
+    return this == &other;
+  }
+
+  /**
+   * @brief size  number of nodes alive
+   */
+  inline size_t
+  size() const noexcept {
+    return _live;
+  }
+
+  /**
+   * @brief capacity  number of node slots reserved
+   */
+  inline size_t
+  capacity() const noexcept {
+    return _slabs.size() * _nodes_per_slab;
+  }
+
+  /**
+   * @brief reserved_bytes  memory held by the slabs
+   */
+  inline size_t
+  reserved_bytes() const noexcept {
+    return capacity() * sizeof(slot_t);
+  }
+
+private:
+
+  union slot_t {
+    slot_t* next;
+    alignas(node_type_t) unsigned char storage[sizeof(node_type_t)];
+  };
+
+  slot_t*
+  acquire() {
+    slot_t* slot{ _free };
+    if (slot) {
+      _free = slot->next;
+    }
+    else {
+      if (_next == _nodes_per_slab) {
+        _slabs.emplace_back(new slot_t[_nodes_per_slab]);
+        _next = 0;
+      }
+      slot = &_slabs.back()[_next++];
+    }
+    return slot;
+  }
+
+  inline void
+  recycle(slot_t* slot) noexcept {
+    slot->next = _free;
+    _free      = slot;
+  }
+
+  std::vector<std::unique_ptr<slot_t[]>> _slabs;
+  slot_t*                                _free{ nullptr };
+  size_t                                 _nodes_per_slab{ 1024 };
+  size_t                                 _next{ 1024 };
+  size_t                                 _live{ 0 };
+};
+
+/**
+ * @brief pmr_node_allocator_t  nodes are allocated from a
+ * std::pmr::memory_resource, e.g. a std::pmr::unsynchronized_pool_resource
+ * shared by several trees, or a std::pmr::monotonic_buffer_resource over a
+ * stack buffer. The resource must outlive the tree.
+ */
+template <class node_type_t>
+class pmr_node_allocator_t {
+public:
+  using value_type = node_type_t;
+
+  static constexpr bool bulk_release{ false };
+
+  pmr_node_allocator_t(std::pmr::memory_resource* resource =
+                         std::pmr::get_default_resource())
+    : _resource{ resource }
+  { }
+
+  template <typename ...Args>
+  node_type_t*
+  create(Args&&...args) {
+    void* memory{ _resource->allocate(sizeof(node_type_t), alignof(node_type_t)) };
+    try {
+      return new (memory) node_type_t(std::forward<Args>(args)...);
+    }
+    catch (...) {
+      _resource->deallocate(memory, sizeof(node_type_t), alignof(node_type_t));
+      throw;
+    }
+  }
+
+  void
+  destroy(node_type_t* node) noexcept {
+    if (node) {
+      node->~node_type_t();
+      _resource->deallocate(node, sizeof(node_type_t), alignof(node_type_t));
+    }
+  }
+
+  inline void
+  release() noexcept { }
+
+  inline pmr_node_allocator_t
+  select_on_copy() const {
+    return pmr_node_allocator_t{ _resource };
+  }
+
+  inline std::pmr::memory_resource*
+  resource() const noexcept {
+    return _resource;
+  }
+
+  inline bool
+  operator==(const pmr_node_allocator_t& other) const noexcept {
+    return *_resource == *other._resource;
+  }
+
+private:
+  std::pmr::memory_resource* _resource;
+};
+
+}
+}
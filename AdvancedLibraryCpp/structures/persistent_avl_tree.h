@@ -0,0 +1,390 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace advanced {
+namespace structures {
+
+/** @test TestPersistentAVLTree in test/test_persistent_avl_tree(.h|.cpp) */
+
+/**
+ * @brief Persistent AVL tree. Nodes are immutable and reference counted, an
+ * update copies only the O(log n) nodes on the path from the root to the
+ * changed node (and the rotated ones) and shares the rest with the previous
+ * version, so snapshot() and the copy constructor are O(1).
+ *
+ * A snapshot never changes: readers can query it without any lock while the
+ * writer keeps updating the tree, and the nodes of a version are released when
+ * its last snapshot is destroyed.
+ *
+ * @note  the tree object itself is meant for one writer: only snapshot() can
+ * be called concurrently with insert/remove/clear. Keys are unique.
+ */
+template <class T>
+class persistent_avl_tree_t {
+  struct node_t;
+  using node_ptr = std::shared_ptr<const node_t>;
+
+  inline static size_t
+  height_of(const node_ptr& node) noexcept {
+    return node ? node->height : 0u;
+  }
+
+  inline static size_t
+  count_of(const node_ptr& node) noexcept {
+    return node ? node->count : 0u;
+  }
+
+  struct node_t {
+    node_t(const T& value, node_ptr left, node_ptr right)
+      : value{ value }, left{ std::move(left) }, right{ std::move(right) },
+        height{ std::max(height_of(this->left), height_of(this->right)) + 1 },
+        count{ count_of(this->left) + count_of(this->right) + 1 }
+    { }
+
+    T        value;
+    node_ptr left;
+    node_ptr right;
+    size_t   height;
+    size_t   count;     // nodes in the subtree
+  };
+
+public:
+
+  /**
+   * @brief In-order forward iterator. It keeps its version alive, so it stays
+   * valid whatever happens to the tree it came from.
+   */
+  class const_iterator {
+    friend class persistent_avl_tree_t;
+
+  public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type        = T;
+    using difference_type   = std::ptrdiff_t;
+    using pointer           = const T*;
+    using reference         = const T&;
+
+    const_iterator() = default;
+
+    inline reference
+    operator*() const {
+      return _path.back()->value;
+    }
+
+    inline pointer
+    operator->() const {
+      return &_path.back()->value;
+    }
+
+    const_iterator&
+    operator++() {
+      const node_t* node{ _path.back()->right.get() };
+      _path.pop_back();
+      push_left(node);
+      return *this;
+    }
+
+    inline const_iterator
+    operator++(int) {
+      const_iterator previous{ *this };
+      ++*this;
+      return previous;
+    }
+
+    inline bool
+    operator==(const const_iterator& other) const {
+      return _path.empty() ? other._path.empty()
+                           : !other._path.empty() && _path.back() == other._path.back();
+    }
+
+    inline bool
+    operator!=(const const_iterator& other) const {
+      return !(*this == other);
+    }
+
+  private:
+    explicit const_iterator(node_ptr root)
+      : _root{ std::move(root) }
+    {
+      push_left(_root.get());
+    }
+
+    void
+    push_left(const node_t* node) {
+      for (; node; node = node->left.get()) {
+        _path.push_back(node);
+      }
+    }
+
+    node_ptr                   _root;
+    std::vector<const node_t*> _path;    // ancestors still to be visited
+  };
+
+  using iterator = const_iterator;
+
+  persistent_avl_tree_t() = default;
+
+  /**
+   * @brief snapshot  read-only version of the current content, O(1). It can
+   * be called while another thread updates the tree.
+   */
+  persistent_avl_tree_t
+  snapshot() const {
+    persistent_avl_tree_t version;
+    version._root = std::atomic_load(&_root);
+    return version;
+  }
+
+  /**
+   * @brief insert  it inserts value, copying O(log n) nodes
+   * @return whether the value was inserted or not
+   */
+  bool
+  insert(const T& value) {
+    bool changed{ false };
+    node_ptr root{ insert(_root, value, changed) };
+    if (changed) {
+      std::atomic_store(&_root, std::move(root));
+    }
+    return changed;
+  }
+
+  /**
+   * @brief remove  it removes value, copying O(log n) nodes
+   * @return whether the tree contained the value
+   */
+  bool
+  remove(const T& value) {
+    bool changed{ false };
+    node_ptr root{ remove(_root, value, changed) };
+    if (changed) {
+      std::atomic_store(&_root, std::move(root));
+    }
+    return changed;
+  }
+
+  /**
+   * @brief clear  it removes all elements, the snapshots keep theirs
+   */
+  void
+  clear() {
+    std::atomic_store(&_root, node_ptr{});
+  }
+
+  bool
+  contains(const T& value) const {
+    const node_t* node{ _root.get() };
+    while (node) {
+      if (value < node->value) {
+        node = node->left.get();
+      }
+      else if (node->value < value) {
+        node = node->right.get();
+      }
+      else {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  /**
+   * @brief left_most  the lowest value
+   * @throws std::out_of_range if the tree is empty
+   */
+  const T&
+  left_most() const {
+    const node_t* node{ checked_root() };
+    while (node->left) {
+      node = node->left.get();
+    }
+    return node->value;
+  }
+
+  /**
+   * @brief right_most  the greatest value
+   * @throws std::out_of_range if the tree is empty
+   */
+  const T&
+  right_most() const {
+    const node_t* node{ checked_root() };
+    while (node->right) {
+      node = node->right.get();
+    }
+    return node->value;
+  }
+
+  /**
+   * @brief in_order  it calls func(const T&) for each value in order, until it
+   * returns true
+   * @return number of visited values
+   */
+  template <class function_t>
+  size_t
+  in_order(function_t&& func) const {
+    size_t visited{ 0 };
+    for (const auto& value : *this) {
+      visited++;
+      if (func(value)) {
+        break;
+      }
+    }
+    return visited;
+  }
+
+  inline size_t
+  height() const noexcept {
+    return height_of(_root);
+  }
+
+  inline size_t
+  size() const noexcept {
+    return count_of(_root);
+  }
+
+  inline bool
+  empty() const noexcept {
+    return !_root;
+  }
+
+  /**
+   * @brief is_same_version  whether both trees share the same root
+   */
+  inline bool
+  is_same_version(const persistent_avl_tree_t& other) const noexcept {
+    return _root == other._root;
+  }
+
+  inline const_iterator
+  begin() const {
+    return const_iterator{ _root };
+  }
+
+  inline const_iterator
+  end() const {
+    return const_iterator{};
+  }
+
+  inline const_iterator
+  cbegin() const {
+    return begin();
+  }
+
+  inline const_iterator
+  cend() const {
+    return end();
+  }
+
+private:
+
+
+  /**
+   * @brief make  a new node, the only place where nodes are allocated
+   */
+  inline static node_ptr
+  make(const T& value, node_ptr left, node_ptr right) {
+    return std::make_shared<const node_t>(value, std::move(left), std::move(right));
+  }
+
+  /**
+   * @brief balance  a new node with value and the given children, rotated if
+   * their heights differ by 2. Only the rotated nodes are copied.
+   */
+  static node_ptr
+  balance(const T& value, node_ptr left, node_ptr right) {
+    if (height_of(left) > height_of(right) + 1) {
+      if (height_of(left->left) >= height_of(left->right)) {
+        return make(left->value, left->left,
+                    make(value, left->right, std::move(right)));
+      }
+      const node_ptr& middle{ left->right };
+      return make(middle->value, make(left->value, left->left, middle->left),
+                  make(value, middle->right, std::move(right)));
+    }
+    if (height_of(right) > height_of(left) + 1) {
+      if (height_of(right->right) >= height_of(right->left)) {
+        return make(right->value, make(value, std::move(left), right->left),
+                    right->right);
+      }
+      const node_ptr& middle{ right->left };
+      return make(middle->value, make(value, std::move(left), middle->left),
+                  make(right->value, middle->right, right->right));
+    }
+    return make(value, std::move(left), std::move(right));
+  }
+
+  static node_ptr
+  insert(const node_ptr& node, const T& value, bool& changed) {
+    if (!node) {
+      changed = true;
+      return make(value, nullptr, nullptr);
+    }
+    if (value < node->value) {
+      node_ptr left{ insert(node->left, value, changed) };
+      return changed ? balance(node->value, std::move(left), node->right) : node;
+    }
+    if (node->value < value) {
+      node_ptr right{ insert(node->right, value, changed) };
+      return changed ? balance(node->value, node->left, std::move(right)) : node;
+    }
+    return node;
+  }
+
+  static node_ptr
+  remove(const node_ptr& node, const T& value, bool& changed) {
+    if (!node) {
+      return node;
+    }
+    if (value < node->value) {
+      node_ptr left{ remove(node->left, value, changed) };
+      return changed ? balance(node->value, std::move(left), node->right) : node;
+    }
+    if (node->value < value) {
+      node_ptr right{ remove(node->right, value, changed) };
+      return changed ? balance(node->value, node->left, std::move(right)) : node;
+    }
+    changed = true;
+    if (!node->left) {
+      return node->right;
+    }
+    if (!node->right) {
+      return node->left;
+    }
+    const T* successor{ nullptr };
+    node_ptr right{ remove_left_most(node->right, successor) };
+    return balance(*successor, node->left, std::move(right));
+  }
+
+  /**
+   * @brief remove_left_most  the subtree without its lowest value
+   * @param value[out]  the lowest value, it belongs to the old subtree
+   */
+  static node_ptr
+  remove_left_most(const node_ptr& node, const T*& value) {
+    if (!node->left) {
+      value = &node->value;
+      return node->right;
+    }
+    node_ptr left{ remove_left_most(node->left, value) };
+    return balance(node->value, std::move(left), node->right);
+  }
+
+  const node_t*
+  checked_root() const {
+    if (!_root) {
+      throw std::out_of_range{ "persistent_avl_tree_t is empty" };
+    }
+    return _root.get();
+  }
+
+  node_ptr _root;
+};
+
+}
+}
@@ -0,0 +1,261 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <stdexcept>
+#include <vector>
+#include "binary_tree.h"
+#include "../tools/sorted_range.h"
+
+namespace advanced {
+namespace structures {
+
+/** @test TestStaticSearchTree in test/test_static_search_tree(.h|.cpp) */
+
+/**
+ * @brief Build-once sorted set stored in a single array without pointers, for
+ * the read-mostly uses of avl_tree_t. The implicit layouts keep the nodes near
+ * the root together, so the first levels of every search hit the cache, and
+ * the descent does not branch on the comparisons.
+ *
+ * - layout_t::eytzinger: BFS order, node k has children 2k and 2k + 1. The
+ *   search prefetches the cache line holding the descendants 4 levels ahead
+ *   (for 4 bytes keys), so the memory latency of each level is overlapped.
+ * - layout_t::van_emde_boas: recursive layout, each subtree of height h/2 is
+ *   contiguous, so any search touches O(log_B n) cache lines whatever the
+ *   cache line size B. The tree is completed up to 2^h - 1 nodes.
+ */
+template <class T>
+class static_search_tree_t {
+public:
+
+  enum class layout_t {
+    eytzinger,
+    van_emde_boas
+  };
+
+  static_search_tree_t() = default;
+
+  /**
+   * @brief static_search_tree_t  it builds the tree from the sorted range
+   * [first, last), repeated values are skipped
+   * @throws std::invalid_argument if the range is not sorted
+   */
+  template <class Iterator>
+  static_search_tree_t(Iterator first, Iterator last,
+                       layout_t layout = layout_t::eytzinger)
+    : _layout{ layout }
+  {
+    std::vector<T> sorted;
+    sorted.reserve(tools::count_sorted(first, last));
+    std::unique_copy(first, last, std::back_inserter(sorted),
+                     [](const T& a, const T& b) { return !(a < b); });
+    build(sorted);
+  }
+
+  /**
+   * @brief static_search_tree_t  it builds the tree with the values of an
+   * avl_tree_t
+   */
+  template <class allocator_t>
+  explicit static_search_tree_t(const avl_tree_t<T, allocator_t>& tree,
+                                layout_t layout = layout_t::eytzinger)
+    : static_search_tree_t{ tree.begin(), tree.end(), layout }
+  { }
+
+  /**
+   * @brief lower_bound  the lowest value not lower than value
+   * @return a pointer to it, or nullptr if all values are lower than value
+   */
+  const T*
+  lower_bound(const T& value) const {
+    return _layout == layout_t::eytzinger ? eytzinger_lower_bound(value)
+                                          : van_emde_boas_lower_bound(value);
+  }
+
+  inline bool
+  contains(const T& value) const {
+    const T* found{ lower_bound(value) };
+    return found && !(value < *found);
+  }
+
+  inline size_t
+  size() const noexcept {
+    return _size;
+  }
+
+  inline bool
+  empty() const noexcept {
+    return _size == 0;
+  }
+
+  inline layout_t
+  layout() const noexcept {
+    return _layout;
+  }
+
+  /**
+   * @brief memory_usage  bytes used by the node array
+   */
+  inline size_t
+  memory_usage() const noexcept {
+    return _nodes.capacity() * sizeof(T);
+  }
+
+private:
+  static constexpr size_t max_height{ 64 };
+
+  /**
+   * number of nodes in a cache line, descendants 4 levels below node k are in
+   * [16k, 16k + 16) and for 4 bytes keys they fit in one line
+   */
+  static constexpr size_t prefetch_stride{ sizeof(T) < 64 ? 64 / sizeof(T) : 1 };
+
+  void
+  build(const std::vector<T>& sorted) {
+    _size = sorted.size();
+    if (sorted.empty()) {
+      return;
+    }
+    auto next{ sorted.begin() };
+    if (_layout == layout_t::eytzinger) {
+      _nodes.resize(_size + 1);       // 1-indexed, _nodes[0] is unused
+      build_eytzinger(1, next);
+      return;
+    }
+    _height = 0;
+    while ((size_t{ 1 } << _height) - 1 < _size) {
+      _height++;
+    }
+    split_van_emde_boas(0, _height);
+    _nodes.resize((size_t{ 1 } << _height) - 1);
+    std::array<size_t, max_height> positions;
+    build_van_emde_boas(1, 0, positions, next, sorted);
+  }
+
+  void
+  build_eytzinger(size_t node, typename std::vector<T>::const_iterator& next) {
+    if (node <= _size) {
+      build_eytzinger(2 * node, next);
+      _nodes[node] = *next++;
+      build_eytzinger(2 * node + 1, next);
+    }
+  }
+
+  const T*
+  eytzinger_lower_bound(const T& value) const {
+    const T* nodes{ _nodes.data() };
+    size_t   node { 1 };
+    while (node <= _size) {
+      prefetch(nodes + std::min(node * prefetch_stride, _size));
+      node = 2 * node + (nodes[node] < value);
+    }
+    // the answer is the last node where the search went left: drop the
+    // trailing right turns and the left one
+    node >>= trailing_ones(node) + 1;
+    return node ? nodes + node : nullptr;
+  }
+
+  /**
+   * It computes, for each depth d, where the nodes of depth d are placed
+   * relative to their ancestor at depth _top[d] (Brodal, Fagerberg and Jacob):
+   * a tree of height h is split in a top tree of height h / 2 followed by its
+   * bottom trees, each one laid out recursively.
+   */
+  void
+  split_van_emde_boas(size_t depth, size_t height) {
+    if (height <= 1) {
+      return;
+    }
+    const size_t top_height   { height / 2 };
+    const size_t bottom_height{ height - top_height };
+    const size_t bottom_depth { depth + top_height };
+    _top[bottom_depth]         = depth;
+    _top_size[bottom_depth]    = (size_t{ 1 } << top_height) - 1;
+    _bottom_size[bottom_depth] = (size_t{ 1 } << bottom_height) - 1;
+    split_van_emde_boas(depth, top_height);
+    split_van_emde_boas(bottom_depth, bottom_height);
+  }
+
+  /**
+   * @brief position  index in _nodes of the BFS node of the given depth,
+   * positions holds the indices of its ancestors
+   */
+  inline size_t
+  position(size_t node, size_t depth,
+           const std::array<size_t, max_height>& positions) const {
+    return depth ? positions[_top[depth]] + _top_size[depth] +
+                   (node & _top_size[depth]) * _bottom_size[depth]
+                 : 0;
+  }
+
+  /**
+   * It fills the complete tree in order, the missing nodes take the greatest
+   * value so the tree remains a search tree. They are never returned: the
+   * search only returns nodes not lower than value, and the real greatest
+   * value comes before them in order.
+   */
+  void
+  build_van_emde_boas(size_t node, size_t depth,
+                      std::array<size_t, max_height>& positions,
+                      typename std::vector<T>::const_iterator& next,
+                      const std::vector<T>& sorted) {
+    if (depth == _height) {
+      return;
+    }
+    positions[depth] = position(node, depth, positions);
+    build_van_emde_boas(2 * node, depth + 1, positions, next, sorted);
+    _nodes[positions[depth]] = next != sorted.end() ? *next++ : sorted.back();
+    build_van_emde_boas(2 * node + 1, depth + 1, positions, next, sorted);
+  }
+
+  const T*
+  van_emde_boas_lower_bound(const T& value) const {
+    std::array<size_t, max_height> positions;
+    const T* found{ nullptr };
+    size_t   node { 1 };
+    for (size_t depth = 0; depth < _height; depth++) {
+      positions[depth] = position(node, depth, positions);
+      const T*   current{ &_nodes[positions[depth]] };
+      const bool lower  { *current < value };
+      found = lower ? found : current;
+      node  = 2 * node + lower;
+    }
+    return found;
+  }
+
+  inline static void
+  prefetch(const T* address) {
+#if defined(__GNUC__)
+    __builtin_prefetch(address);
+#else
+    (void)address;
+#endif
+  }
+
+  inline static size_t
+  trailing_ones(size_t value) {
+#if defined(__GNUC__)
+    return static_cast<size_t>(__builtin_ctzll(~static_cast<unsigned long long>(value)));
+#else
+    size_t count{ 0 };
+    for (; value & 1u; value >>= 1) {
+      count++;
+    }
+    return count;
+#endif
+  }
+
+  std::vector<T>                  _nodes;
+  size_t                          _size  { 0 };
+  size_t                          _height{ 0 };
+  layout_t                        _layout{ layout_t::eytzinger };
+  std::array<size_t, max_height>  _top        { };
+  std::array<size_t, max_height>  _top_size   { };
+  std::array<size_t, max_height>  _bottom_size{ };
+};
+
+}
+}
@@ -1,5 +1,8 @@
 #pragma once
+#include <atomic>
+#include <future>
 #include <memory>
+#include <thread>
 #include <vector>
 #include <queue>
 #include <stack>
@@ -63,7 +66,7 @@ public:
               std::is_move_constructible<T>::value >
             ::type >
   base_node_t(T&& node, node_type_t* parent = nullptr)
-      : _parent{ parent }, _node{ node }
+      : _parent{ parent }, _node{ std::move(node) }
   { }
 
   template <typename = typename std::enable_if<
@@ -225,18 +228,54 @@ public:
   T                         _node;
 };
 
-template <class  T, size_t max_node_size = 2>
-class tree_node_t : public base_node_t<T, tree_node_t<T, max_node_size>> {
-  friend class tree_t<T, tree_node_t<T, max_node_size>>;
+/**
+ * @brief subtree_aggregate_t  what a tree_node_t keeps about its subtree, the
+ * aggregate of the values of the node and its descendants. The void
+ * specialization is empty, so nodes without aggregate do not grow.
+ */
+template <class T, class operation_t>
+class subtree_aggregate_t {
+protected:
+  subtree_aggregate_t() = default;
+
+  explicit subtree_aggregate_t(const T& value) : _aggregate{ value } { }
+
+  T _aggregate{ };
+};
+
+template <class T>
+class subtree_aggregate_t<T, void> {
+protected:
+  subtree_aggregate_t() = default;
+
+  explicit subtree_aggregate_t(const T&) { }
+};
+
+/**
+ * @brief tree_node_t  node with up to max_node_size children
+ * @param operation_t  opt-in subtree aggregate, e.g. tools::sum_t<T> or
+ * tools::maximum_t<T>. Each node keeps operation_t over the values of its
+ * subtree in pre order, so it must be associative. aggregate() is O(1) and
+ * the methods that change a value or a child update the aggregates of the
+ * path to the root in O(depth * max_node_size). With void, the default,
+ * nothing is kept.
+ */
+template <class  T, size_t max_node_size = 2, class operation_t = void>
+class tree_node_t : public base_node_t<T, tree_node_t<T, max_node_size, operation_t>>,
+                    private subtree_aggregate_t<T, operation_t> {
+  friend class tree_t<T, tree_node_t<T, max_node_size, operation_t>>;
 
 public:
-  using node_type_t = tree_node_t<T, max_node_size>;
-  using base_type_t = base_node_t<T, tree_node_t<T, max_node_size>>;
+  using node_type_t      = tree_node_t<T, max_node_size, operation_t>;
+  using base_type_t      = base_node_t<T, tree_node_t<T, max_node_size, operation_t>>;
+  using aggregate_type_t = subtree_aggregate_t<T, operation_t>;
   using iterator               = typename base_type_t::iterator;
   using const_iterator         = typename base_type_t::const_iterator;
   using reverse_iterator       = typename base_type_t::reverse_iterator;
   using const_reverse_iterator = typename base_type_t::const_reverse_iterator;
 
+  static constexpr bool has_aggregate{ !std::is_void<operation_t>::value };
+
   /**
    * Default construct if value type is also default constructible
    */
@@ -253,7 +292,8 @@ public:
               std::is_copy_constructible<T>::value >
             ::type >
   tree_node_t(const T& node, tree_node_t* parent = nullptr)
-    : base_node_t<T, tree_node_t<T, max_node_size> > (node, parent)
+    : base_node_t<T, tree_node_t<T, max_node_size, operation_t> > (node, parent),
+      aggregate_type_t{ node }
   { }
 
   /**
@@ -263,36 +303,143 @@ public:
               std::is_move_constructible<T>::value >
             ::type >
   tree_node_t(T&& node, tree_node_t* parent = nullptr)
-      : base_node_t<T, tree_node_t<T, max_node_size> > (node, parent)
+      : base_node_t<T, tree_node_t<T, max_node_size, operation_t> > (std::move(node), parent),
+        aggregate_type_t{ base_type_t::_node }
   { }
 
-  template <typename = typename std::enable_if<
-              std::is_move_constructible<T>::value >
-            ::type >
-  tree_node_t(tree_node_t&& other) :
-    base_node_t<T, tree_node_t<T, max_node_size> > (other)
-  {  }
+  /**
+   * @brief tree_node_t  it takes the value and the children of other, O(1)
+   * without aggregate. With aggregate, the path of other to its root is
+   * updated.
+   */
+  tree_node_t(tree_node_t&& other)
+    noexcept(std::is_nothrow_move_constructible<T>::value && !has_aggregate) :
+    base_node_t<T, tree_node_t<T, max_node_size, operation_t> > (std::move(other._node)),
+    aggregate_type_t{ static_cast<const aggregate_type_t&>(other) }
+  {
+    take_children(other);
+    other.update_aggregates();
+  }
 
   /**
-   * Copy construct if value type is also copy constructible
+   * @brief tree_node_t  deep copy of other and its subtree, the copy has no
+   * parent. It's iterative, so the depth of the tree is not limited by the
+   * call stack.
    */
-  template <typename = typename std::enable_if<
-              std::is_copy_constructible<T>::value >
-            ::type >
   tree_node_t(const tree_node_t& other) :
-    base_node_t<T, tree_node_t<T, max_node_size> > (other._node, other._parent)
+    base_node_t<T, tree_node_t<T, max_node_size, operation_t> > (other._node),
+    aggregate_type_t{ static_cast<const aggregate_type_t&>(other) }
   {
-    for (const auto& elem : other._children) {
-      add_child(elem);
+    try {
+      copy_subtree(other);
+    }
+    catch (...) {
+      destroy_children();
+      throw;
     }
   }
 
-  tree_node_t& operator=(const tree_node_t& other) = default;
-  tree_node_t& operator=(tree_node_t&& other)      = default;
+  /**
+   * @brief operator =  it replaces the value and the children of this node by
+   * a deep copy of other, the parent of this node is kept
+   */
+  tree_node_t&
+  operator=(const tree_node_t& other) {
+    if (this != &other) {
+      tree_node_t copy{ other };
+      *this = std::move(copy);
+    }
+    return *this;
+  }
+
+  /**
+   * @brief operator =  it takes the value and the children of other, O(1)
+   * without aggregate
+   */
+  tree_node_t&
+  operator=(tree_node_t&& other)
+    noexcept(std::is_nothrow_move_assignable<T>::value && !has_aggregate) {
+    if (this != &other) {
+      destroy_children();
+      base_type_t::_node = std::move(other._node);
+      take_children(other);
+      update_aggregates();
+      other.update_aggregates();
+    }
+    return *this;
+  }
 
   virtual
   ~tree_node_t() {
-    clear();
+    destroy_children();
+  }
+
+  /**
+   * @brief set_value  it sets the value of this node and updates the
+   * aggregates of the path to the root
+   */
+  void
+  set_value(const T& node) {
+    base_type_t::set_value(node);
+    update_aggregates();
+  }
+
+  /**
+   * @brief set_value  in place version
+   */
+  void
+  set_value(T&& node) {
+    base_type_t::set_value(std::move(node));
+    update_aggregates();
+  }
+
+  /**
+   * @brief swap  it swaps the values of both nodes by copy, and updates
+   * both paths
+   */
+  void
+  swap(node_type_t& other) {
+    base_type_t::swap(other);
+    update_aggregates();
+    other.update_aggregates();
+  }
+
+  /**
+   * @brief swap_move  it swaps the values of both nodes by move, and updates
+   * both paths
+   */
+  void
+  swap_move(node_type_t& other) {
+    base_type_t::swap_move(other);
+    update_aggregates();
+    other.update_aggregates();
+  }
+
+  /**
+   * @brief aggregate  operation_t over the values of this node and all its
+   * descendants, O(1). Only with an operation_t.
+   */
+  template <class aggregate_t = operation_t,
+            typename = typename std::enable_if<
+              !std::is_void<aggregate_t>::value >
+            ::type >
+  inline const T&
+  aggregate() const noexcept {
+    return this->_aggregate;
+  }
+
+  /**
+   * @brief update_aggregates  it recomputes the aggregates of this node and
+   * its ancestors. The methods of the node already call it, it is only needed
+   * after changing a value through get() or operator*.
+   */
+  void
+  update_aggregates() {
+    if constexpr (has_aggregate) {
+      for (tree_node_t* node = this; node; node = node->_parent) {
+        node->compute_aggregate();
+      }
+    }
   }
 
   /**
@@ -306,6 +453,7 @@ public:
     bool ok{ _children.size() < max_node_size };
     if (ok) {
       _children.push_back(new node_type_t{ child, this });
+      update_aggregates();
     }
     return ok;
   } // LCOV_EXCL_LINE
@@ -322,6 +470,7 @@ public:
     auto it = std::find(_children.begin(), _children.end(), nullptr);
     if ((inserted = (it != _children.end()))) {
       *it = new node_type_t{ child, this };
+      update_aggregates();
     }
     else {
       inserted = add_child(child);
@@ -345,6 +494,21 @@ public:
    */
   bool
   insert_at(size_t position, const T& child) {
+    const bool ok{ attach_at(position, child) };
+    if (ok) {
+      update_aggregates();
+    }
+    return ok;
+  } // LCOV_EXCL_LINE
+
+  /**
+   * @brief attach_at  insert_at without updating the aggregates, so a whole
+   * tree can be built in O(n). The builder must call compute_aggregate on
+   * every node afterwards, the children before their parents.
+   * @return whether the insertion was successfull or not.
+   */
+  bool
+  attach_at(size_t position, const T& child) {
     bool ok { position < max_node_size };
     if (ok) {
       if (position < _children.size()) {
@@ -361,6 +525,24 @@ public:
     return ok;
   } // LCOV_EXCL_LINE
 
+  /**
+   * @brief compute_aggregate  it recomputes the aggregate of this node only,
+   * from its value and the aggregates of its children
+   */
+  void
+  compute_aggregate() {
+    if constexpr (has_aggregate) {
+      static const operation_t operation;
+      T aggregate{ base_type_t::_node };
+      for (const tree_node_t* child : _children) {
+        if (child) {
+          aggregate = operation(aggregate, child->_aggregate);
+        }
+      }
+      this->_aggregate = std::move(aggregate);
+    }
+  }
+
   /**
    * @brief replace_at it will replace a node at a given position.
    * If the position is greater than or equal to the current container's size,
@@ -379,21 +561,22 @@ public:
    */
   std::unique_ptr<node_type_t>
   replace_at(size_t position, const T& child) {
-    bool ok { position < max_node_size };
     std::unique_ptr<node_type_t> replaced{ nullptr };
-    if (ok) {
-      if (position < _children.size()) {
-        if (_children[position] != nullptr) {
-          replaced.reset(_children[position]);
-          replaced->set_parent(nullptr);
-          _children[position] = nullptr;
-        }
-      }
-      else {
-        _children.resize(position + 1, nullptr);
+    if (position >= max_node_size) {
+      return replaced;
+    }
+    if (position < _children.size()) {
+      if (_children[position] != nullptr) {
+        replaced.reset(_children[position]);
+        replaced->set_parent(nullptr);
+        _children[position] = nullptr;
       }
     }
+    else {
+      _children.resize(position + 1, nullptr);
+    }
     _children[position] = new node_type_t{ child, this };
+    update_aggregates();
     return replaced;
   }
 
@@ -414,6 +597,7 @@ public:
         delete ptr;
       }
       _children.erase(_children.begin() + child);
+      update_aggregates();
     }
     return ok;
   }
@@ -437,6 +621,7 @@ public:
         node.reset(_children[child]);
         node->set_parent(nullptr);
         _children[child] = nullptr;
+        update_aggregates();
       }
     }
     return node;
@@ -457,10 +642,8 @@ public:
    */
   virtual void
   clear() final override {
-    for (const auto ptr : _children) {
-      if (ptr) { delete ptr; }
-    }
-    _children.clear();
+    destroy_children();
+    update_aggregates();
   }
 
   /**
@@ -475,6 +658,15 @@ public:
     return _children.size() - nulls;
   }
 
+  /**
+   * @brief slot_count  number of positions in the children container, null
+   * ones included, the children are in [0, slot_count())
+   */
+  inline size_t
+  slot_count() const noexcept {
+    return _children.size();
+  }
+
   /**
    * @brief find  it searches for a child in the list
    * @param child
@@ -700,32 +892,7 @@ protected:
    */
   virtual size_t
   in_order(const std::function<bool (node_type_t&)> &func) override {
-    static bool recursion_break{ false };
-    size_t visited{ 1u };
-    size_t calls{ std::max<size_t>(_children.size() - 1u, 1u) };
-    recursion_break = false;
-
-    if (_children.empty()) {
-      func(*this);
-    }
-    else {
-      for (auto it = _children.begin(); it != _children.end(); it++) {
-        auto ptr { *it };
-        if (ptr) {
-          visited += ptr->in_order(func);
-          if (recursion_break) {
-            break; // LCOV_EXCL_LINE
-          }
-        }
-        if (calls--) {
-          if ((recursion_break = func(*this))) {
-            break; // LCOV_EXCL_LINE
-          }
-        }
-      }
-    }
-
-    return visited;
+    return visit_in_order(*this, func);
   }
 
   /**
@@ -772,31 +939,7 @@ protected:
    */
   virtual size_t
   in_order(const std::function<bool(const node_type_t&)> &func) const override {
-    static bool recursion_break{ false };
-    size_t visited{ 1u };
-    size_t calls{ std::max<size_t>(_children.size() - 1u, 1u) };
-    recursion_break = false;
-
-    if (_children.empty()) {
-      func(*this);
-    }
-    else {
-      for (auto it = _children.begin(); it != _children.end(); it++) {
-        auto ptr { static_cast<const node_type_t* const>(*it) };
-        if (ptr) {
-          visited += ptr->in_order(func);
-          if (recursion_break) {
-            break; // LCOV_EXCL_LINE
-          }
-        }
-        if (calls--) {
-          if ((recursion_break = func(*this))) {
-            break; // LCOV_EXCL_LINE
-          }
-        }
-      }
-    }
-    return visited;
+    return visit_in_order(*this, func);
   }
 
   /**
@@ -836,6 +979,171 @@ protected:
     return visited;
   }
 
+  /**
+   * @brief destroy_children  it deletes the children without updating the
+   * aggregates, the destructor of a node does not walk up to its ancestors.
+   * It's iterative: it goes down to a leaf, deletes it and goes back up through
+   * the parent links, so it neither recurses nor allocates.
+   */
+  void
+  destroy_children() noexcept {
+    node_type_t* node{ this };
+    while (true) {
+      auto& children{ node->_children };
+      while (!children.empty() && !children.back()) {
+        children.pop_back();
+      }
+      if (!children.empty()) {
+        node_type_t* child{ children.back() };
+        child->set_parent(node);
+        node = child;
+      }
+      else if (node == this) {
+        break;
+      }
+      else {
+        // node has no children anymore, so its destructor does not recurse
+        node_type_t* parent{ node->_parent };
+        parent->_children.pop_back();
+        delete node;
+        node = parent;
+      }
+    }
+  }
+
+  inline void
+  copy_aggregate(const tree_node_t& other) {
+    if constexpr (has_aggregate) {
+      this->_aggregate = other._aggregate;
+    }
+  }
+
+  /**
+   * @brief take_children  it moves the children of other to this node
+   */
+  void
+  take_children(tree_node_t& other) noexcept {
+    _children.swap(other._children);
+    for (auto child : _children) {
+      if (child) {
+        child->set_parent(this);
+      }
+    }
+  }
+
+  /**
+   * @brief copy_subtree  it copies the descendants of source as descendants
+   * of this node, iteratively. Null children are kept, so the positions are
+   * the same.
+   */
+  void
+  copy_subtree(const tree_node_t& source) {
+    std::vector<std::pair<const tree_node_t*, tree_node_t*>> pending{
+      { &source, this }
+    };
+    while (!pending.empty()) {
+      const auto [from, to] = pending.back();
+      pending.pop_back();
+      to->_children.reserve(from->_children.size());
+      for (const tree_node_t* child : from->_children) {
+        to->_children.push_back(child ? new node_type_t{ child->_node, to } : nullptr);
+        if (child) {
+          to->_children.back()->copy_aggregate(*child);
+          pending.emplace_back(child, to->_children.back());
+        }
+      }
+    }
+  }
+
+  /**
+   * @brief visit_in_order  in_order with an inlined visitor, node_t is
+   * node_type_t or const node_type_t. The early exit is kept in a flag of
+   * this call, so different trees can be traversed from different threads.
+   * @return number of nodes
+   */
+  template <class node_t, class visitor_t>
+  static size_t
+  visit_in_order(node_t& node, visitor_t& visitor) {
+    bool stop{ false };
+    return visit_in_order(node, visitor, stop);
+  }
+
+  template <class node_t, class visitor_t>
+  static size_t
+  visit_in_order(node_t& node, visitor_t& visitor, bool& stop) {
+    size_t visited{ 1u };
+    size_t calls{ std::max<size_t>(node._children.size() - 1u, 1u) };
+
+    if (node._children.empty()) {
+      stop = visitor(node);
+    }
+    else {
+      for (node_t* child : node._children) {
+        if (child) {
+          visited += visit_in_order(*child, visitor, stop);
+          if (stop) {
+            break;
+          }
+        }
+        if (calls--) {
+          if ((stop = visitor(node))) {
+            break;
+          }
+        }
+      }
+    }
+    return visited;
+  }
+
+  /**
+   * @brief visit_pre_order  pre_order with an inlined visitor
+   * @return number of nodes
+   */
+  template <class node_t, class visitor_t>
+  static size_t
+  visit_pre_order(node_t& node, visitor_t& visitor) {
+    size_t visited{ 1u };
+    if (!visitor(node)) {
+      for (node_t* child : node._children) {
+        if (child) {
+          visited += visit_pre_order(*child, visitor);
+        }
+      }
+    }
+    return visited;
+  }
+
+  /**
+   * @brief visit_pos_order  pos_order with an inlined visitor
+   * @return number of nodes
+   */
+  template <class node_t, class visitor_t>
+  static size_t
+  visit_pos_order(node_t& node, visitor_t& visitor) {
+    size_t visited{ 1u };
+    for (node_t* child : node._children) {
+      if (child) {
+        visited += visit_pos_order(*child, visitor);
+      }
+    }
+    visitor(node);
+    return visited;
+  }
+
+  /**
+   * @brief for_each_child  it calls func(node_t*) for each non-null child,
+   * without copying the children vector
+   */
+  template <class node_t, class function_t>
+  inline static void
+  for_each_child(node_t& node, function_t&& func) {
+    for (node_t* child : node._children) {
+      if (child) {
+        func(child);
+      }
+    }
+  }
+
   /**
    * @brief children  get children as a vector
    * @return
@@ -892,45 +1200,54 @@ public:
   tree_t() = default;
 
   /**
-   * @brief tree_t  copy constructor, it copies only the root object
+   * @brief tree_t  deep copy constructor, the nodes are cloned iteratively
    * @param other
    */
-  tree_t(const tree_t& other) {
-    *this = other;
-  }
+  tree_t(const tree_t& other)
+    : base_tree_t{ other },
+      _root{ other._root ? new node_type_t{ *other._root } : nullptr }
+  { }
 
   /**
    * @brief tree_t  move constructor, it transfer the ownership from the
-   * original object to this object created
+   * original object to this object created, O(1)
    * @param other
    */
-  tree_t(tree_t&& other) {
-    *this = std::move(other);
+  tree_t(tree_t&& other) noexcept
+    : base_tree_t{ std::move(other) }, _root{ other._root }
+  {
+    other._root = nullptr;
   }
 
   /**
-   * @brief operator = copy all elements in root
+   * @brief operator = deep copy of all nodes of other, this tree is not
+   * modified if the copy fails
    * @param other
    * @return reference to this
    */
   tree_t&
   operator=(const tree_t& other) {
-    if (other.has_root()) {
-      _root = new node_type_t();
-      *_root = other.root();
+    if (this != &other) {
+      node_type_t* root{ other._root ? new node_type_t{ *other._root } : nullptr };
+      delete_root();
+      _root = root;
     }
     return *this;
   } // LCOV_EXCL_LINE
 
   /**
-   * @brief operator = transfer the ownership of root pointer
+   * @brief operator = transfer the ownership of root pointer, the previous
+   * nodes of this tree are deleted
    * @param other
    * @return reference to this
    */
   tree_t&
-  operator=(tree_t&& other) {
-    _root = other._root;
-    other._root = nullptr;
+  operator=(tree_t&& other) noexcept {
+    if (this != &other) {
+      delete_root();
+      _root = other._root;
+      other._root = nullptr;
+    }
     return *this;
   }
 
@@ -1054,6 +1371,74 @@ public:
     delete_root();
   }
 
+  /**
+   * @brief in_order  in order search with a visitor inlined at compile time,
+   * it has the same semantics than in_order(std::function) without its
+   * indirect call per node
+   * @param visitor  callable as bool(node_type_t&)
+   * @return visited nodes
+   */
+  template <class visitor_t>
+  size_t
+  in_order(visitor_t&& visitor) {
+    return has_root() ? node_type_t::visit_in_order(*_root, visitor) : 0u;
+  }
+
+  /**
+   * @brief pre_order  pre order search with a visitor inlined at compile time
+   * @param visitor  callable as bool(node_type_t&)
+   * @return visited nodes
+   */
+  template <class visitor_t>
+  size_t
+  pre_order(visitor_t&& visitor) {
+    return has_root() ? node_type_t::visit_pre_order(*_root, visitor) : 0u;
+  }
+
+  /**
+   * @brief pos_order  pos order search with a visitor inlined at compile time
+   * @param visitor  callable as bool(node_type_t&)
+   * @return visited nodes
+   */
+  template <class visitor_t>
+  size_t
+  pos_order(visitor_t&& visitor) {
+    return has_root() ? node_type_t::visit_pos_order(*_root, visitor) : 0u;
+  }
+
+  /**
+   * @brief in_order  const version, visitor is callable as
+   * bool(const node_type_t&)
+   * @return visited nodes
+   */
+  template <class visitor_t>
+  size_t
+  in_order(visitor_t&& visitor) const {
+    return has_root() ? node_type_t::visit_in_order(root(), visitor) : 0u;
+  }
+
+  /**
+   * @brief pre_order  const version, visitor is callable as
+   * bool(const node_type_t&)
+   * @return visited nodes
+   */
+  template <class visitor_t>
+  size_t
+  pre_order(visitor_t&& visitor) const {
+    return has_root() ? node_type_t::visit_pre_order(root(), visitor) : 0u;
+  }
+
+  /**
+   * @brief pos_order  const version, visitor is callable as
+   * bool(const node_type_t&)
+   * @return visited nodes
+   */
+  template <class visitor_t>
+  size_t
+  pos_order(visitor_t&& visitor) const {
+    return has_root() ? node_type_t::visit_pos_order(root(), visitor) : 0u;
+  }
+
   /**
    * @brief breadth_first_search executes a breadth first search,
    * @param pred  predicate function to be called, it must return a bool
@@ -1063,24 +1448,8 @@ public:
    */
   size_t
   breadth_first_search(const std::function<bool(node_type_t&)>& pred) {
-    size_t visited{ 0u };
-    node_type_t* node{ this->_root };
-    bool stop{ false };
-    if (has_root()) {
-      std::queue<node_type_t*> queue;
-      queue.push(node);
-      while (!stop && !queue.empty()) {
-        node = queue.front(); queue.pop();
-        stop = pred(*node);
-        visited++;
-        for (auto child : node->children()) {
-          if (child) {
-            queue.push(child);
-          }
-        }
-      }
-    }
-    return visited;
+    std::vector<node_type_t*> queue;
+    return breadth_first_search(pred, queue);
   } // LCOV_EXCL_LINE
 
   /**
@@ -1092,24 +1461,8 @@ public:
    */
   size_t
   breadth_first_search(const std::function<bool(const node_type_t&)>& pred) const {
-    size_t visited{ 0u };
-    node_type_t* node{ this->_root };
-    bool stop{ false };
-    if (has_root()) {
-      std::queue<node_type_t*> queue;
-      queue.push(node);
-      while (!stop && !queue.empty()) {
-        node = queue.front(); queue.pop();
-        stop = pred(*node);
-        visited++;
-        for (auto child : node->children()) {
-          if (child) {
-            queue.push(child);
-          }
-        }
-      }
-    }
-    return visited;
+    std::vector<const node_type_t*> queue;
+    return breadth_first_search(pred, queue);
   } // LCOV_EXCL_LINE
 
   /**
@@ -1121,26 +1474,8 @@ public:
    */
   size_t
   depth_first_search(const std::function<bool(node_type_t&)>& pred) {
-    size_t visited{ 0u };
-    node_type_t* node{ this->_root };
-    bool stop{ false };
-    if (has_root()) {
-      std::stack<node_type_t*> queue;
-      queue.push(node);
-      while (!stop && !queue.empty()) {
-        node = queue.top(); queue.pop();
-        stop = pred(*node);
-        visited++;
-        auto children { node->children() };
-        for (auto it = children.rbegin(); it != children.rend(); it++) {
-          auto child{ *it };
-          if (child) {
-            queue.push(child);
-          }
-        }
-      }
-    }
-    return visited;
+    std::vector<node_type_t*> stack;
+    return depth_first_search(pred, stack);
   } // LCOV_EXCL_LINE
 
   /**
@@ -1152,35 +1487,401 @@ public:
    */
   size_t
   depth_first_search(const std::function<bool(const node_type_t&)>& pred) const {
+    std::vector<const node_type_t*> stack;
+    return depth_first_search(pred, stack);
+  } // LCOV_EXCL_LINE
+
+  /**
+   * @brief breadth_first_search  BFS with a visitor inlined at compile time
+   * @param visitor  callable as bool(node_type_t&), the search stops at the
+   * first node where it returns true
+   * @return the number of visited nodes
+   */
+  template <class visitor_t>
+  size_t
+  breadth_first_search(visitor_t&& visitor) {
+    std::vector<node_type_t*> queue;
+    return breadth_first_search(visitor, queue);
+  }
+
+  /**
+   * @brief breadth_first_search  const version, visitor is callable as
+   * bool(const node_type_t&)
+   */
+  template <class visitor_t>
+  size_t
+  breadth_first_search(visitor_t&& visitor) const {
+    std::vector<const node_type_t*> queue;
+    return breadth_first_search(visitor, queue);
+  }
+
+  /**
+   * @brief breadth_first_search  BFS that keeps its queue in scratch, so
+   * repeated searches reusing the same vector do not allocate once it has
+   * grown to the widest level of the tree
+   * @param scratch  buffer owned by the caller, its content is discarded
+   * @return the number of visited nodes
+   */
+  template <class visitor_t>
+  size_t
+  breadth_first_search(visitor_t&& visitor, std::vector<node_type_t*>& scratch) {
+    return breadth_first(_root, visitor, scratch);
+  }
+
+  /**
+   * @brief breadth_first_search  const version with a scratch buffer
+   */
+  template <class visitor_t>
+  size_t
+  breadth_first_search(visitor_t&& visitor,
+                       std::vector<const node_type_t*>& scratch) const {
+    return breadth_first(static_cast<const node_type_t*>(_root), visitor, scratch);
+  }
+
+  /**
+   * @brief depth_first_search  DFS with a visitor inlined at compile time
+   * @param visitor  callable as bool(node_type_t&), the search stops at the
+   * first node where it returns true
+   * @return the number of visited nodes
+   */
+  template <class visitor_t>
+  size_t
+  depth_first_search(visitor_t&& visitor) {
+    std::vector<node_type_t*> stack;
+    return depth_first_search(visitor, stack);
+  }
+
+  /**
+   * @brief depth_first_search  const version, visitor is callable as
+   * bool(const node_type_t&)
+   */
+  template <class visitor_t>
+  size_t
+  depth_first_search(visitor_t&& visitor) const {
+    std::vector<const node_type_t*> stack;
+    return depth_first_search(visitor, stack);
+  }
+
+  /**
+   * @brief depth_first_search  DFS that keeps its stack in scratch
+   * @param scratch  buffer owned by the caller, its content is discarded
+   * @return the number of visited nodes
+   */
+  template <class visitor_t>
+  size_t
+  depth_first_search(visitor_t&& visitor, std::vector<node_type_t*>& scratch) {
+    return depth_first(_root, visitor, scratch);
+  }
+
+  /**
+   * @brief depth_first_search  const version with a scratch buffer
+   */
+  template <class visitor_t>
+  size_t
+  depth_first_search(visitor_t&& visitor,
+                     std::vector<const node_type_t*>& scratch) const {
+    return depth_first(static_cast<const node_type_t*>(_root), visitor, scratch);
+  }
+
+  /**
+   * @brief parallel_pre_order  pre order search where the subtrees are
+   * visited concurrently by up to threads threads. Each node is visited before
+   * its descendants, but the order between subtrees is unspecified.
+   * @param visitor  callable as bool(node_type_t&), it is called concurrently
+   * so it must be thread-safe. If it returns true the subtree of this node is
+   * skipped, like in pre_order.
+   * @return visited nodes
+   */
+  template <class visitor_t>
+  size_t
+  parallel_pre_order(visitor_t&& visitor,
+                     size_t threads = std::thread::hardware_concurrency()) {
+    return parallel_visit(_root, visitor, threads);
+  }
+
+  /**
+   * @brief parallel_pre_order  const version, visitor is callable as
+   * bool(const node_type_t&)
+   */
+  template <class visitor_t>
+  size_t
+  parallel_pre_order(visitor_t&& visitor,
+                     size_t threads = std::thread::hardware_concurrency()) const {
+    return parallel_visit(static_cast<const node_type_t*>(_root), visitor, threads);
+  }
+
+  /**
+   * @brief parallel_for_each_node  it calls func(node_type_t&) once for each
+   * node, from up to threads threads and in no particular order. func must be
+   * thread-safe, its return value is ignored.
+   * @return visited nodes
+   */
+  template <class function_t>
+  size_t
+  parallel_for_each_node(function_t&& func,
+                         size_t threads = std::thread::hardware_concurrency()) {
+    auto visitor{ [&func](node_type_t& node) { func(node); return false; } };
+    return parallel_visit(_root, visitor, threads);
+  }
+
+  /**
+   * @brief parallel_for_each_node  const version, func is callable as
+   * func(const node_type_t&)
+   */
+  template <class function_t>
+  size_t
+  parallel_for_each_node(function_t&& func,
+                         size_t threads = std::thread::hardware_concurrency()) const {
+    auto visitor{ [&func](const node_type_t& node) { func(node); return false; } };
+    return parallel_visit(static_cast<const node_type_t*>(_root), visitor, threads);
+  }
+
+  /**
+   * @brief level_order_search  level synchronous BFS: the nodes of a level
+   * (the frontier) are visited from an array while the next level is gathered
+   * in another one, and the nodes a few positions ahead in the frontier are
+   * prefetched so their cache misses overlap with the current visit. With one
+   * thread the order is the one of breadth_first_search.
+   * @param visitor  callable as bool(node_type_t&), the search stops when it
+   * returns true. With several threads it is called concurrently so it must
+   * be thread-safe, and the other threads stop at their next node.
+   * @param threads  a level is split between up to threads threads, each one
+   * visiting at least parallel_frontier nodes, so only levels of at least
+   * 2 * parallel_frontier nodes run on several threads. Every level is visited
+   * before the next one, but the order inside a level is unspecified.
+   * @return the number of visited nodes
+   */
+  template <class visitor_t>
+  size_t
+  level_order_search(visitor_t&& visitor, size_t threads = 1u) {
+    return level_order(_root, visitor, threads);
+  }
+
+  /**
+   * @brief level_order_search  const version, visitor is callable as
+   * bool(const node_type_t&)
+   */
+  template <class visitor_t>
+  size_t
+  level_order_search(visitor_t&& visitor, size_t threads = 1u) const {
+    return level_order(static_cast<const node_type_t*>(_root), visitor, threads);
+  }
+
+  /**
+   * nodes ahead of the current one that level_order_search prefetches, and
+   * fewest nodes of a level that it gives to each thread
+   */
+  static constexpr size_t prefetch_distance{ 8u };
+  static constexpr size_t parallel_frontier{ 4096u };
+
+  protected:
+
+  inline static void
+  prefetch(const void* address) noexcept {
+#if defined(__GNUC__)
+    __builtin_prefetch(address);
+#else
+    (void)address;
+#endif
+  }
+
+  /**
+   * @brief visit_frontier  it visits [first, last) of a frontier and appends
+   * their children to next, until the visitor returns true or stop is set by
+   * another thread
+   */
+  template <class node_t, class visitor_t>
+  static size_t
+  visit_frontier(node_t* const* first, node_t* const* last, visitor_t& visitor,
+                 std::vector<node_t*>& next, std::atomic<bool>& stop) {
     size_t visited{ 0u };
-    node_type_t* node{ this->_root };
-    bool stop{ false };
-    if (has_root()) {
-      std::stack<node_type_t*> queue;
-      queue.push(node);
-      while (!stop && !queue.empty()) {
-        node = queue.top(); queue.pop();
-        stop = pred(*node);
-        visited++;
-        auto children { node->children() };
-        for (auto it = children.rbegin(); it != children.rend(); it++) {
-          auto child{ *it };
-          if (child) {
-            queue.push(child);
-          }
+    for (node_t* const* it = first;
+         it != last && !stop.load(std::memory_order_relaxed); ++it) {
+      if (static_cast<size_t>(last - it) > prefetch_distance) {
+        prefetch(it[prefetch_distance]);
+      }
+      visited++;
+      if (visitor(**it)) {
+        stop.store(true, std::memory_order_relaxed);
+        break;
+      }
+      node_type_t::for_each_child(**it, [&next](node_t* child) {
+        next.push_back(child);
+      });
+    }
+    return visited;
+  }
+
+  /**
+   * @brief level_order  level synchronous BFS over the subtree of root. A wide
+   * level is cut in one chunk per thread, each thread gathers the children of
+   * its chunk and they are joined in chunk order, so the next frontier is the
+   * same than with one thread.
+   */
+  template <class node_t, class visitor_t>
+  static size_t
+  level_order(node_t* root, visitor_t& visitor, size_t threads) {
+    threads = std::max<size_t>(threads, 1u);
+
+    size_t visited{ 0u };
+    std::atomic<bool>    stop{ false };
+    std::vector<node_t*> frontier;
+    std::vector<node_t*> next;
+    std::vector<std::vector<node_t*>> parts;
+    if (root) {
+      frontier.push_back(root);
+    }
+    while (!frontier.empty() && !stop.load(std::memory_order_relaxed)) {
+      next.clear();
+      const size_t chunks{ std::min(threads, frontier.size() / parallel_frontier) };
+      if (chunks <= 1u) {
+        visited += visit_frontier(frontier.data(), frontier.data() + frontier.size(),
+                                  visitor, next, stop);
+      }
+      else {
+        parts.resize(chunks);
+        const size_t chunk_size{ (frontier.size() + chunks - 1u) / chunks };
+        auto worker{ [&](size_t chunk) {
+          node_t* const* first{ frontier.data() + chunk * chunk_size };
+          node_t* const* last { frontier.data() +
+                                std::min(frontier.size(), (chunk + 1u) * chunk_size) };
+          parts[chunk].clear();
+          return visit_frontier(first, last, visitor, parts[chunk], stop);
+        } };
+        std::vector<std::future<size_t>> workers;
+        for (size_t chunk = 1; chunk < chunks; chunk++) {
+          workers.push_back(std::async(std::launch::async, worker, chunk));
+        }
+        visited += worker(0u);
+        for (auto& forked : workers) {
+          visited += forked.get();
+        }
+        for (const auto& part : parts) {
+          next.insert(next.end(), part.begin(), part.end());
         }
       }
+      frontier.swap(next);
     }
     return visited;
-  } // LCOV_EXCL_LINE
+  }
 
-  protected:
+  /**
+   * @brief breadth_first  BFS over the subtree of root, queue is used as a
+   * ring: the visited prefix is dropped once it is the larger part
+   */
+  template <class node_t, class visitor_t>
+  static size_t
+  breadth_first(node_t* root, visitor_t& visitor, std::vector<node_t*>& queue) {
+    size_t visited{ 0u };
+    size_t front  { 0u };
+    queue.clear();
+    if (root) {
+      queue.push_back(root);
+    }
+    while (front < queue.size()) {
+      node_t* node{ queue[front++] };
+      visited++;
+      if (visitor(*node)) {
+        break;
+      }
+      if (front > 64u && 2u * front > queue.size()) {
+        queue.erase(queue.begin(), queue.begin() + front);
+        front = 0u;
+      }
+      node_type_t::for_each_child(*node, [&queue](node_t* child) {
+        queue.push_back(child);
+      });
+    }
+    return visited;
+  }
+
+  /**
+   * @brief depth_first  DFS over the subtree of root, the children are pushed
+   * in reverse order so the first one is visited first
+   */
+  template <class node_t, class visitor_t>
+  static size_t
+  depth_first(node_t* root, visitor_t& visitor, std::vector<node_t*>& stack) {
+    size_t visited{ 0u };
+    stack.clear();
+    if (root) {
+      stack.push_back(root);
+    }
+    while (!stack.empty()) {
+      node_t* node{ stack.back() };
+      stack.pop_back();
+      visited++;
+      if (visitor(*node)) {
+        break;
+      }
+      const size_t first{ stack.size() };
+      node_type_t::for_each_child(*node, [&stack](node_t* child) {
+        stack.push_back(child);
+      });
+      std::reverse(stack.begin() + first, stack.end());
+    }
+    return visited;
+  }
+
+  /**
+   * @brief parallel_visit  the calling thread visits the tree level by level
+   * until there are enough subtrees to share between the threads, then each
+   * thread takes the next unvisited subtree and runs a pre order search on it,
+   * so unbalanced subtrees do not leave threads idle.
+   */
+  template <class node_t, class visitor_t>
+  static size_t
+  parallel_visit(node_t* root, visitor_t& visitor, size_t threads) {
+    constexpr size_t subtrees_per_thread{ 8u };
+    threads = std::max<size_t>(threads, 1u);
+
+    size_t visited{ 0u };
+    std::vector<node_t*> subtrees;
+    std::vector<node_t*> next;
+    if (root) {
+      subtrees.push_back(root);
+    }
+    while (threads > 1u && !subtrees.empty() &&
+           subtrees.size() < subtrees_per_thread * threads) {
+      next.clear();
+      for (node_t* node : subtrees) {
+        visited++;
+        if (!visitor(*node)) {
+          node_type_t::for_each_child(*node, [&next](node_t* child) {
+            next.push_back(child);
+          });
+        }
+      }
+      subtrees.swap(next);
+    }
+    if (subtrees.empty()) {
+      return visited;
+    }
+
+    std::atomic<size_t> next_subtree{ 0u };
+    auto worker{ [&]() {
+      size_t count{ 0u };
+      for (size_t ii = next_subtree++; ii < subtrees.size(); ii = next_subtree++) {
+        count += node_type_t::visit_pre_order(*subtrees[ii], visitor);
+      }
+      return count;
+    } };
+    std::vector<std::future<size_t>> workers;
+    for (size_t ii = 1; ii < std::min(threads, subtrees.size()); ii++) {
+      workers.push_back(std::async(std::launch::async, worker));
+    }
+    visited += worker();
+    for (auto& forked : workers) {
+      visited += forked.get();
+    }
+    return visited;
+  }
 
   /**
    * @brief delete_root it deletes the root alongside with allnodes in the tree
    */
   void
-  delete_root() {
+  delete_root() noexcept {
     if (_root) {
       delete _root;
       _root = nullptr;
@@ -0,0 +1,459 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "segment_tree.h"
+#include "tree.h"
+#include "../tools/math_operation.h"
+
+namespace advanced {
+namespace structures {
+
+/** @test TestTreeIndex in test/test_tree_index(.h|.cpp) */
+
+/**
+ * @brief Read-mostly index over the nodes of a tree_t for ancestor queries,
+ * which otherwise walk the parent pointers in O(depth):
+ *
+ * - lowest_common_ancestor in O(1): range minimum of the depths over the Euler
+ *   tour, answered with a sparse table.
+ * - ancestor (k-th ancestor) in O(log n) with binary lifting.
+ * - path_query / update in O(log^2 n) / O(log n): heavy-light decomposition,
+ *   every heavy path is a contiguous range of a segment_tree_t.
+ *
+ * Nodes are numbered in depth first pre order (the order of
+ * tree_t::depth_first_search), the root is 0, so the subtree of node v is
+ * [v, v + subtree_size(v)).
+ *
+ * @note  the index is a snapshot: changes in the shape of the tree_t are not
+ * seen, and update only changes the values of the index
+ * @note  operation_t must be associative and commutative (sum, min, max...)
+ */
+template <class T, class node_type_t, class operation_t = tools::sum_t<T>>
+class tree_index_t {
+public:
+  using index_t = std::uint32_t;
+
+  static constexpr index_t npos{ std::numeric_limits<index_t>::max() };
+
+  tree_index_t() = default;
+
+  /**
+   * @brief tree_index_t  it indexes tree in O(n log n) time and memory
+   * @throws std::length_error if the tree has npos nodes or more
+   */
+  explicit tree_index_t(const tree_t<T, node_type_t>& tree) {
+    tree.depth_first_search([this](const node_type_t& node) {
+      _nodes.push_back(&node);
+      return false;
+    });
+    if (_nodes.size() >= npos) {
+      throw std::length_error{ "tree_index_t is limited to 2^32 - 1 nodes" };
+    }
+    index_parents();
+    index_euler_tour();
+    index_ancestors();
+    index_heavy_paths();
+  }
+
+  inline size_t
+  size() const noexcept {
+    return _nodes.size();
+  }
+
+  inline bool
+  empty() const noexcept {
+    return _nodes.empty();
+  }
+
+  /**
+   * @brief index_of  index of a node of the indexed tree
+   * @throws std::out_of_range if node was not indexed
+   */
+  index_t
+  index_of(const node_type_t& node) const {
+    const auto found{ _indices.find(&node) };
+    if (found == _indices.end()) {
+      throw std::out_of_range{ "The node is not in the tree_index_t" };
+    }
+    return found->second;
+  }
+
+  /**
+   * @brief node  the node of the tree_t with the given index
+   */
+  inline const node_type_t&
+  node(index_t index) const {
+    return *_nodes[index];
+  }
+
+  /**
+   * @brief parent  npos for the root
+   */
+  inline index_t
+  parent(index_t node) const {
+    return _parents[node];
+  }
+
+  inline size_t
+  depth(index_t node) const {
+    return _depths[node];
+  }
+
+  inline size_t
+  subtree_size(index_t node) const {
+    return _subtree_sizes[node];
+  }
+
+  /**
+   * @brief is_ancestor_of  whether ancestor is node or one of its ancestors
+   */
+  inline bool
+  is_ancestor_of(index_t ancestor, index_t node) const {
+    return ancestor <= node && node < ancestor + _subtree_sizes[ancestor];
+  }
+
+  /**
+   * @brief lowest_common_ancestor  deepest node that is an ancestor of both a
+   * and b, in O(1)
+   * @throws std::out_of_range if a or b is not a node of the index
+   */
+  index_t
+  lowest_common_ancestor(index_t a, index_t b) const {
+    check_node(a);
+    check_node(b);
+    size_t first{ _euler_first[a] };
+    size_t last { _euler_first[b] };
+    if (first > last) {
+      std::swap(first, last);
+    }
+    const size_t level{ floor_log2(last - first + 1) };
+    const std::vector<index_t>& minimums{ _euler_minimums[level] };
+    return shallower(minimums[first], minimums[last + 1 - (size_t{ 1 } << level)]);
+  }
+
+  /**
+   * @brief lowest_common_ancestor  same query with the nodes of the tree_t
+   * @throws std::out_of_range if a or b was not indexed
+   */
+  const node_type_t&
+  lowest_common_ancestor(const node_type_t& a, const node_type_t& b) const {
+    return node(lowest_common_ancestor(index_of(a), index_of(b)));
+  }
+
+  /**
+   * @brief ancestor  the ancestor k levels above node in O(log k), node itself
+   * for k = 0
+   * @return npos if node is less than k levels deep
+   * @throws std::out_of_range if node is not a node of the index
+   */
+  index_t
+  ancestor(index_t node, size_t k) const {
+    check_node(node);
+    if (k > _depths[node]) {
+      return npos;
+    }
+    for (size_t level = 0; k; level++, k >>= 1) {
+      if (k & 1u) {
+        node = _ancestors[level][node];
+      }
+    }
+    return node;
+  }
+
+  /**
+   * @brief distance  number of edges in the path between a and b
+   */
+  size_t
+  distance(index_t a, index_t b) const {
+    return _depths[a] + _depths[b] - 2 * _depths[lowest_common_ancestor(a, b)];
+  }
+
+  /**
+   * @brief value  value of node in the index, it starts as the value of the
+   * node in the tree_t
+   */
+  const T&
+  value(index_t node) const {
+    check_node(node);
+    return _values[node];
+  }
+
+  /**
+   * @brief update  it changes the value of node in the index in O(log n)
+   * @throws std::out_of_range if node is not a node of the index
+   */
+  void
+  update(index_t node, const T& value) {
+    check_node(node);
+    _values[node] = value;
+    const size_t position{ _positions[node] };
+    _segments.query_update(position, position, assign_update_t{ value });
+  }
+
+  /**
+   * @brief path_query  operation_t over the values of the nodes in the path
+   * between a and b, both included, in O(log^2 n)
+   * @note  The const modifier was dropped, see segment_tree_t::query
+   * @throws std::out_of_range if a or b is not a node of the index
+   */
+  T
+  path_query(index_t a, index_t b) {
+    static const operation_t operation;
+    check_node(a);
+    check_node(b);
+    T    result{ };
+    bool first { true };
+    const auto add{ [&](size_t from, size_t to) {
+      const T range{ _segments.query(from, to) };
+      result = first ? range : operation(result, range);
+      first  = false;
+    } };
+    // climb from the deeper head until both nodes are on the same heavy path
+    while (_heads[a] != _heads[b]) {
+      if (_depths[_heads[a]] < _depths[_heads[b]]) {
+        std::swap(a, b);
+      }
+      add(_positions[_heads[a]], _positions[a]);
+      a = _parents[_heads[a]];
+    }
+    add(std::min(_positions[a], _positions[b]), std::max(_positions[a], _positions[b]));
+    return result;
+  }
+
+private:
+  /**
+   * point update of the segment tree: the leaf takes value
+   */
+  struct assign_update_t : public empty_update_t {
+    T    value {};
+    bool assign{ false };
+
+    assign_update_t() = default;
+    explicit assign_update_t(const T& v) : value{ v }, assign{ true } { }
+
+    inline operator
+    bool() const override {
+      return assign;
+    }
+  };
+
+  struct path_transform_t
+    : public segment_node_t<T, T, path_transform_t, assign_update_t> {
+    using node_t = typename segment_node_t<T, T, path_transform_t, assign_update_t>::node_t;
+
+    path_transform_t() { }
+
+    inline void
+    join(T& parent, const T& left, const T& right) const override {
+      static const operation_t operation;
+      parent = operation(left, right);
+    }
+
+    inline void
+    build(T& value, const T& element, const size_t&) const override {
+      value = element;
+    }
+
+    inline void
+    apply(node_t& node, const assign_update_t& update) const override {
+      node.value = update.value;
+    }
+  };
+
+  void
+  index_parents() {
+    const size_t n{ _nodes.size() };
+    _indices.reserve(n);
+    _parents.assign(n, npos);
+    _depths.assign(n, 0);
+    _subtree_sizes.assign(n, 1);
+    _values.reserve(n);
+    for (index_t node = 0; node < n; node++) {
+      _indices.emplace(_nodes[node], node);
+      _values.push_back(_nodes[node]->get());
+      if (node) {
+        // in pre order the parent is already indexed
+        _parents[node] = _indices.find(&_nodes[node]->parent())->second;
+        _depths[node]  = _depths[_parents[node]] + 1;
+      }
+    }
+    for (index_t node = static_cast<index_t>(n); node-- > 1; ) {
+      _subtree_sizes[_parents[node]] += _subtree_sizes[node];
+    }
+  }
+
+  /**
+   * The children of node in pre order are node + 1 and then each next sibling
+   * starts where the subtree of the previous one ends.
+   */
+  template <class function_t>
+  inline void
+  for_each_child(index_t node, function_t&& func) const {
+    const index_t end{ node + static_cast<index_t>(_subtree_sizes[node]) };
+    for (index_t child = node + 1; child < end;
+         child += static_cast<index_t>(_subtree_sizes[child])) {
+      func(child);
+    }
+  }
+
+  /**
+   * Euler tour: the node is written when it is entered and after each child,
+   * 2n - 1 entries. The LCA of a and b is the shallowest node written between
+   * their first appearances, _euler_minimums[k][i] is the shallowest in
+   * [i, i + 2^k).
+   */
+  void
+  index_euler_tour() {
+    if (_nodes.empty()) {
+      return;
+    }
+    std::vector<index_t> tour;
+    tour.reserve(2 * _nodes.size() - 1);
+    _euler_first.assign(_nodes.size(), 0);
+    // stack of (node, next child)
+    std::vector<std::pair<index_t, index_t>> stack{ { 0, 1 } };
+    _euler_first[0] = 0;
+    tour.push_back(0);
+    while (!stack.empty()) {
+      auto& top{ stack.back() };
+      const index_t node{ top.first };
+      const index_t child{ top.second };
+      if (child < node + _subtree_sizes[node]) {
+        top.second += static_cast<index_t>(_subtree_sizes[child]);
+        _euler_first[child] = tour.size();
+        tour.push_back(child);
+        stack.emplace_back(child, child + 1);
+      }
+      else {
+        stack.pop_back();
+        if (!stack.empty()) {
+          tour.push_back(stack.back().first);
+        }
+      }
+    }
+
+    const size_t levels{ floor_log2(tour.size()) + 1 };
+    _euler_minimums.resize(levels);
+    _euler_minimums[0] = std::move(tour);
+    for (size_t level = 1; level < levels; level++) {
+      const std::vector<index_t>& previous{ _euler_minimums[level - 1] };
+      const size_t half{ size_t{ 1 } << (level - 1) };
+      std::vector<index_t>& minimums{ _euler_minimums[level] };
+      minimums.resize(previous.size() - half);
+      for (size_t i = 0; i < minimums.size(); i++) {
+        minimums[i] = shallower(previous[i], previous[i + half]);
+      }
+    }
+  }
+
+  /**
+   * _ancestors[k][v] is the ancestor 2^k levels above v, or npos
+   */
+  void
+  index_ancestors() {
+    const size_t max_depth{ _depths.empty() ? 0
+                            : *std::max_element(_depths.begin(), _depths.end()) };
+    _ancestors.clear();
+    _ancestors.push_back(_parents);
+    for (size_t level = 1; (size_t{ 1 } << level) <= max_depth; level++) {
+      const std::vector<index_t>& previous{ _ancestors.back() };
+      std::vector<index_t> next(previous.size(), npos);
+      for (size_t node = 0; node < next.size(); node++) {
+        if (previous[node] != npos) {
+          next[node] = previous[previous[node]];
+        }
+      }
+      _ancestors.push_back(std::move(next));
+    }
+  }
+
+  /**
+   * Every node continues the heavy path of its parent if it is the child with
+   * the biggest subtree, otherwise it starts a new one. The nodes of a heavy
+   * path get consecutive positions, so a path crosses O(log n) ranges.
+   */
+  void
+  index_heavy_paths() {
+    const size_t n{ _nodes.size() };
+    if (!n) {
+      return;
+    }
+    _heads.assign(n, 0);
+    _positions.assign(n, 0);
+    std::vector<index_t> heads{ 0 };
+    size_t position{ 0 };
+    while (!heads.empty()) {
+      const index_t head{ heads.back() };
+      heads.pop_back();
+      for (index_t node = head; node != npos; ) {
+        _heads[node]     = head;
+        _positions[node] = position++;
+        index_t heavy{ npos };
+        for_each_child(node, [this, &heavy](index_t child) {
+          if (heavy == npos || _subtree_sizes[child] > _subtree_sizes[heavy]) {
+            heavy = child;
+          }
+        });
+        for_each_child(node, [&heads, heavy](index_t child) {
+          if (child != heavy) {
+            heads.push_back(child);
+          }
+        });
+        node = heavy;
+      }
+    }
+    std::vector<T> ordered(n);
+    for (size_t node = 0; node < n; node++) {
+      ordered[_positions[node]] = _values[node];
+    }
+    _segments.rebuild(ordered);
+  }
+
+  inline index_t
+  shallower(index_t a, index_t b) const {
+    return _depths[b] < _depths[a] ? b : a;
+  }
+
+  void
+  check_node(index_t node) const {
+    if (node >= _nodes.size()) {
+      throw std::out_of_range{ "tree_index_t has no node " + std::to_string(node) };
+    }
+  }
+
+  inline static size_t
+  floor_log2(size_t value) {
+#if defined(__GNUC__)
+    return 63u - static_cast<size_t>(__builtin_clzll(static_cast<unsigned long long>(value)));
+#else
+    size_t log{ 0 };
+    while (value >>= 1) {
+      log++;
+    }
+    return log;
+#endif
+  }
+
+  std::vector<const node_type_t*>                       _nodes;
+  std::unordered_map<const node_type_t*, index_t>       _indices;
+  std::vector<index_t>                                  _parents;
+  std::vector<size_t>                                   _depths;
+  std::vector<size_t>                                   _subtree_sizes;
+  std::vector<T>                                        _values;
+  std::vector<size_t>                                   _euler_first;
+  std::vector<std::vector<index_t>>                     _euler_minimums;
+  std::vector<std::vector<index_t>>                     _ancestors;
+  std::vector<index_t>                                  _heads;
+  std::vector<size_t>                                   _positions;
+  segment_tree_t<T, T, path_transform_t, assign_update_t> _segments;
+};
+
+}
+}
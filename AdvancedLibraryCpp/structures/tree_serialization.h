@@ -0,0 +1,774 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <memory>
+#include <ostream>
+#include <queue>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "binary_tree.h"
+#include "tree.h"
+#include "../tools/mapped_file.h"
+
+namespace advanced {
+namespace structures {
+
+/** @test TestTreeSerialization in test/test_tree_serialization(.h|.cpp) */
+
+class tree_file_exception_t : public std::runtime_error {
+public:
+  tree_file_exception_t(const std::string& msg) :
+    std::runtime_error{ msg } { }
+};
+
+/**
+ * @brief Read-only bit vector with rank and select. It is stored as 64 bits
+ * words followed by the number of ones before each block of 8 words, so it is
+ * used straight from a mapped file. rank is O(1), select is a binary search
+ * over the blocks.
+ */
+class rank_select_bits_t {
+public:
+  static constexpr size_t words_per_block{ 8 };
+
+  /**
+   * @brief builder_t  it appends bits and writes them with their ranks
+   */
+  class builder_t {
+  public:
+    inline void
+    push_back(bool bit) {
+      if (_bits % 64 == 0) {
+        _words.push_back(0);
+      }
+      _words.back() |= static_cast<uint64_t>(bit) << (_bits % 64);
+      _bits++;
+    }
+
+    inline size_t
+    size() const noexcept {
+      return _bits;
+    }
+
+    /**
+     * @return the number of bytes written, rank_select_bits_t::bytes_for(size())
+     */
+    size_t
+    write(std::ostream& out) const {
+      std::vector<uint64_t> ranks(blocks_for(_bits), 0);
+      uint64_t ones{ 0 };
+      for (size_t word = 0; word < _words.size(); word++) {
+        if (word % words_per_block == 0) {
+          ranks[word / words_per_block] = ones;
+        }
+        ones += popcount(_words[word]);
+      }
+      ranks.back() = ones;
+      out.write(reinterpret_cast<const char*>(_words.data()),
+                static_cast<std::streamsize>(_words.size() * sizeof(uint64_t)));
+      out.write(reinterpret_cast<const char*>(ranks.data()),
+                static_cast<std::streamsize>(ranks.size() * sizeof(uint64_t)));
+      return bytes_for(_bits);
+    }
+
+  private:
+    std::vector<uint64_t> _words;
+    size_t                _bits{ 0 };
+  };
+
+  rank_select_bits_t() = default;
+
+  /**
+   * @param data  bytes_for(bits) bytes written by builder_t, 8 bytes aligned
+   */
+  rank_select_bits_t(const char* data, size_t bits)
+    : _words{ reinterpret_cast<const uint64_t*>(data) },
+      _ranks{ _words + words_for(bits) },
+      _bits { bits }
+  { }
+
+  inline static size_t
+  words_for(size_t bits) {
+    return (bits + 63) / 64;
+  }
+
+  inline static size_t
+  blocks_for(size_t bits) {
+    return (words_for(bits) + words_per_block - 1) / words_per_block + 1;
+  }
+
+  inline static size_t
+  bytes_for(size_t bits) {
+    return (words_for(bits) + blocks_for(bits)) * sizeof(uint64_t);
+  }
+
+  inline size_t
+  size() const noexcept {
+    return _bits;
+  }
+
+  inline bool
+  operator[](size_t position) const {
+    return (_words[position / 64] >> (position % 64)) & 1u;
+  }
+
+  /**
+   * @brief rank1  number of ones in [0, position)
+   */
+  inline size_t
+  rank1(size_t position) const {
+    const size_t word { position / 64 };
+    size_t       ones { _ranks[word / words_per_block] };
+    for (size_t ii = word - word % words_per_block; ii < word; ii++) {
+      ones += popcount(_words[ii]);
+    }
+    return position % 64
+         ? ones + popcount(_words[word] << (64 - position % 64))
+         : ones;
+  }
+
+  inline size_t
+  rank0(size_t position) const {
+    return position - rank1(position);
+  }
+
+  /**
+   * @brief select1  position of the k-th one, counting from 0
+   */
+  size_t
+  select1(size_t k) const {
+    return select(k, [this](size_t block) { return _ranks[block]; },
+                  [](uint64_t word) { return word; });
+  }
+
+  /**
+   * @brief select0  position of the k-th zero, counting from 0
+   */
+  size_t
+  select0(size_t k) const {
+    return select(k, [this](size_t block) {
+                    return block * words_per_block * 64 - _ranks[block];
+                  },
+                  [](uint64_t word) { return ~word; });
+  }
+
+  inline static size_t
+  popcount(uint64_t word) {
+#if defined(__GNUC__)
+    return static_cast<size_t>(__builtin_popcountll(word));
+#else
+    size_t count{ 0 };
+    for (; word; word &= word - 1) {
+      count++;
+    }
+    return count;
+#endif
+  }
+
+private:
+  template <class before_t, class word_t>
+  size_t
+  select(size_t k, before_t&& before, word_t&& word_bits) const {
+    // last block with at most k bits before it
+    size_t first{ 0 };
+    size_t last { (words_for(_bits) + words_per_block - 1) / words_per_block };
+    while (last - first > 1) {
+      const size_t middle{ (first + last) / 2 };
+      if (before(middle) <= k) {
+        first = middle;
+      }
+      else {
+        last = middle;
+      }
+    }
+    k -= before(first);
+    for (size_t word = first * words_per_block; ; word++) {
+      uint64_t     bits { word_bits(_words[word]) };
+      const size_t count{ popcount(bits) };
+      if (k < count) {
+        for (; k; k--) {
+          bits &= bits - 1;
+        }
+        return word * 64 + trailing_zeros(bits);
+      }
+      k -= count;
+    }
+  }
+
+  inline static size_t
+  trailing_zeros(uint64_t word) {
+#if defined(__GNUC__)
+    return static_cast<size_t>(__builtin_ctzll(word));
+#else
+    size_t count{ 0 };
+    for (; !(word & 1u); word >>= 1) {
+      count++;
+    }
+    return count;
+#endif
+  }
+
+  const uint64_t* _words{ nullptr };
+  const uint64_t* _ranks{ nullptr };
+  size_t          _bits { 0 };
+};
+
+/**
+ * @brief Tree file layout, all integers in native byte order:
+ *
+ *   header        magic, version and size of the values, padded to 64 bytes
+ *   values        the values in breadth first order, packed
+ *   degrees       LOUDS bits: for each node in breadth first order, a one per
+ *                 child slot and a zero
+ *   presence      a bit per slot (the root slot first): whether the slot has a
+ *                 node, so null children keep their positions
+ *   footer        number of nodes and slots, and where each section starts
+ *
+ * The node counts are in the footer, so the file is written in one pass
+ * without knowing the size of the tree beforehand.
+ */
+struct tree_file_header_t {
+  static constexpr uint32_t current_magic  { 0x54434c41 }; // "ALCT"
+  static constexpr uint32_t current_version{ 1 };
+  static constexpr uint64_t values_offset  { 64 };
+
+  uint32_t magic     { current_magic };
+  uint32_t version   { current_version };
+  uint32_t value_size{ 0 };
+  uint32_t reserved  { 0 };
+};
+
+struct tree_file_footer_t {
+  uint64_t nodes          { 0 };
+  uint64_t slot_count     { 0 };
+  uint64_t degrees_offset { 0 };
+  uint64_t presence_offset{ 0 };
+  uint32_t magic          { tree_file_header_t::current_magic };
+  uint32_t version        { tree_file_header_t::current_version };
+};
+
+/**
+ * @brief Tree saved by write_tree, read in place from a mapped file: the
+ * values are not copied and the structure is navigated with rank and select
+ * over the bit vectors. Nodes are numbered in breadth first order, the root
+ * is 0.
+ *
+ * @example
+ * save_tree(tree, "tree.bin");
+ * mapped_tree_t<int> file{ "tree.bin" };
+ * load_tree(file, other_tree);
+ */
+template <class T>
+class mapped_tree_t {
+  static_assert(std::is_trivially_copyable<T>::value,
+                "mapped_tree_t values are stored as raw bytes");
+public:
+  using index_t = uint64_t;
+
+  static constexpr index_t npos{ std::numeric_limits<index_t>::max() };
+
+  /**
+   * @brief mapped_tree_t  maps the file at path
+   * @throws tree_file_exception_t if the file is missing or it is not a tree
+   * file of T
+   */
+  explicit mapped_tree_t(const std::string& path) {
+    try {
+      _file = std::make_unique<tools::mapped_file_t>(path);
+    }
+    catch (const tools::mapped_file_exception_t& ex) {
+      throw tree_file_exception_t{ ex.what() };
+    }
+    const size_t size{ _file->size() };
+    tree_file_header_t header;
+    if (size < tree_file_header_t::values_offset + sizeof(_footer)) {
+      throw tree_file_exception_t{ "Invalid tree file: " + path };
+    }
+    std::memcpy(&header, _file->data(), sizeof(header));
+    std::memcpy(&_footer, _file->end() - sizeof(_footer), sizeof(_footer));
+    if (header.magic      != tree_file_header_t::current_magic   ||
+        header.version    != tree_file_header_t::current_version ||
+        header.value_size != sizeof(T)                           ||
+        _footer.magic     != tree_file_header_t::current_magic   ||
+        _footer.version   != tree_file_header_t::current_version) {
+      throw tree_file_exception_t{ "Invalid tree file: " + path };
+    }
+    // the sections must be in order and inside the file
+    const uint64_t end        { size - sizeof(_footer) };
+    const uint64_t values     { tree_file_header_t::values_offset };
+    const uint64_t max_nodes  { (end - values) / sizeof(T) };
+    const uint64_t degree_bits{ _footer.nodes ? _footer.nodes + _footer.slot_count - 1 : 0 };
+    if (_footer.nodes > max_nodes || _footer.nodes > _footer.slot_count ||
+        _footer.slot_count > end * 8 ||
+        _footer.degrees_offset % 8 || _footer.presence_offset % 8 ||
+        values + _footer.nodes * sizeof(T) > _footer.degrees_offset ||
+        _footer.degrees_offset > end || _footer.presence_offset > end ||
+        _footer.degrees_offset + rank_select_bits_t::bytes_for(degree_bits) > _footer.presence_offset ||
+        _footer.presence_offset + rank_select_bits_t::bytes_for(_footer.slot_count) > end) {
+      throw tree_file_exception_t{ "Invalid tree file: " + path };
+    }
+    _values   = reinterpret_cast<const T*>(_file->data() + tree_file_header_t::values_offset);
+    _degrees  = rank_select_bits_t{ _file->data() + _footer.degrees_offset, degree_bits };
+    _presence = rank_select_bits_t{ _file->data() + _footer.presence_offset, _footer.slot_count };
+    // every slot but the root one is a one in degrees, every node a one in
+    // presence, so the ranks and selects never leave the bit vectors
+    if (_degrees.rank1(degree_bits) + 1 != std::max<uint64_t>(_footer.slot_count, 1) ||
+        _presence.rank1(_footer.slot_count) != _footer.nodes) {
+      throw tree_file_exception_t{ "Invalid tree file: " + path };
+    }
+  }
+
+  inline size_t
+  size() const noexcept {
+    return static_cast<size_t>(_footer.nodes);
+  }
+
+  inline bool
+  empty() const noexcept {
+    return _footer.nodes == 0;
+  }
+
+  /**
+   * @brief values  the values in breadth first order, inside the mapped file
+   */
+  inline const T*
+  values() const noexcept {
+    return _values;
+  }
+
+  inline const T&
+  operator[](index_t node) const {
+    return _values[node];
+  }
+
+  /**
+   * @brief at  value of node
+   * @throws std::out_of_range if node is not a node of the tree
+   */
+  const T&
+  at(index_t node) const {
+    check_node(node);
+    return _values[node];
+  }
+
+  /**
+   * @brief slot_count  number of children positions of node, null ones
+   * included
+   */
+  size_t
+  slot_count(index_t node) const {
+    check_node(node);
+    return _degrees.select0(node) - block(node);
+  }
+
+  /**
+   * @brief child  the child of node at position slot
+   * @return npos if the position is null or not lower than slot_count(node)
+   */
+  index_t
+  child(index_t node, size_t slot) const {
+    if (slot >= slot_count(node)) {
+      return npos;
+    }
+    // the slots of node follow the ones of the previous nodes, after the root
+    const size_t position{ 1 + block(node) - node + slot };
+    return _presence[position] ? _presence.rank1(position) : npos;
+  }
+
+  inline bool
+  has_child(index_t node, size_t slot) const {
+    return child(node, slot) != npos;
+  }
+
+  size_t
+  children_count(index_t node) const {
+    const size_t count{ slot_count(node) };
+    const size_t first{ 1 + block(node) - node };
+    return _presence.rank1(first + count) - _presence.rank1(first);
+  }
+
+  /**
+   * @brief parent  npos for the root
+   */
+  index_t
+  parent(index_t node) const {
+    check_node(node);
+    if (node == 0) {
+      return npos;
+    }
+    // slot of node, then the block of degrees holding that slot
+    const size_t slot{ _presence.select1(node) };
+    return _degrees.rank0(_degrees.select1(slot - 1));
+  }
+
+  /**
+   * @brief for_each_slot  it calls func(slot, bool present) for the slots of
+   * all the nodes in breadth first order, in O(n) without select, and
+   * func(npos, false) at the end of each node
+   */
+  template <class function_t>
+  void
+  for_each_slot(function_t&& func) const {
+    size_t slot{ 1 };
+    for (size_t position = 0; position < _degrees.size(); position++) {
+      if (_degrees[position]) {
+        func(slot, _presence[slot]);
+        slot++;
+      }
+      else {
+        func(npos, false);
+      }
+    }
+  }
+
+private:
+  /**
+   * position where the degree bits of node start
+   */
+  inline size_t
+  block(index_t node) const {
+    return node ? _degrees.select0(node - 1) + 1 : 0;
+  }
+
+  void
+  check_node(index_t node) const {
+    if (node >= _footer.nodes) {
+      throw std::out_of_range{ "mapped_tree_t has no node " + std::to_string(node) };
+    }
+  }
+
+  std::unique_ptr<tools::mapped_file_t> _file;
+  tree_file_footer_t                    _footer;
+  const T*                              _values{ nullptr };
+  rank_select_bits_t                    _degrees;
+  rank_select_bits_t                    _presence;
+};
+
+/**
+ * @brief Streaming writer: the values go to the stream as the tree is
+ * traversed, only the bit vectors (2 or 3 bits per node) are kept in memory.
+ */
+template <class T>
+class tree_file_writer_t {
+  static_assert(std::is_trivially_copyable<T>::value,
+                "tree files store the values as raw bytes");
+public:
+  explicit tree_file_writer_t(std::ostream& out) : _out{ out } {
+    tree_file_header_t header;
+    header.value_size = sizeof(T);
+    write(&header, sizeof(header));
+    pad(tree_file_header_t::values_offset);
+  }
+
+  /**
+   * @brief add  next node in breadth first order, slots_t is a range of
+   * bools: whether each child slot of the node has a node
+   */
+  template <class slots_t>
+  void
+  add(const T& value, const slots_t& present) {
+    if (_presence.size() == 0) {
+      _presence.push_back(true);                  // the slot of the root
+    }
+    buffer(&value, sizeof(T));
+    _nodes++;
+    for (bool slot : present) {
+      _degrees.push_back(true);
+      _presence.push_back(slot);
+    }
+    _degrees.push_back(false);
+  }
+
+  /**
+   * @brief finish  it writes the structure and the footer
+   * @throws tree_file_exception_t if the stream fails
+   */
+  void
+  finish() {
+    flush();
+    pad(_written + (8 - _written % 8) % 8);
+    tree_file_footer_t footer;
+    footer.nodes           = _nodes;
+    footer.slot_count      = _presence.size();
+    footer.degrees_offset  = _written;
+    _written              += _degrees.write(_out);
+    footer.presence_offset = _written;
+    _written              += _presence.write(_out);
+    write(&footer, sizeof(footer));
+    if (!_out.flush()) {
+      throw tree_file_exception_t{ "Unable to write the tree" };
+    }
+  }
+
+private:
+  static constexpr size_t buffer_size{ 1u << 16 };
+
+  inline void
+  buffer(const void* data, size_t bytes) {
+    const char* first{ static_cast<const char*>(data) };
+    _buffer.insert(_buffer.end(), first, first + bytes);
+    if (_buffer.size() >= buffer_size) {
+      flush();
+    }
+  }
+
+  void
+  flush() {
+    write(_buffer.data(), _buffer.size());
+    _buffer.clear();
+  }
+
+  void
+  write(const void* data, size_t bytes) {
+    _out.write(static_cast<const char*>(data), static_cast<std::streamsize>(bytes));
+    _written += bytes;
+  }
+
+  void
+  pad(size_t offset) {
+    static const char zeros[64]{ };
+    write(zeros, offset - _written);
+  }
+
+  std::ostream&                 _out;
+  std::vector<char>             _buffer;
+  uint64_t                      _written{ 0 };
+  uint64_t                      _nodes  { 0 };
+  rank_select_bits_t::builder_t _degrees;
+  rank_select_bits_t::builder_t _presence;
+};
+
+/**
+ * @brief write_tree  it writes tree to out in the tree file format, in one
+ * breadth first pass. The positions of the null children are kept.
+ * @throws tree_file_exception_t if the stream fails
+ */
+template <class T, size_t max_node_size, class operation_t>
+void
+write_tree(const tree_t<T, tree_node_t<T, max_node_size, operation_t>>& tree, std::ostream& out) {
+  using node_type_t = tree_node_t<T, max_node_size, operation_t>;
+  tree_file_writer_t<T> writer{ out };
+  std::vector<bool> present;
+  tree.breadth_first_search([&writer, &present](const node_type_t& node) {
+    present.resize(node.slot_count());
+    for (size_t slot = 0; slot < present.size(); slot++) {
+      present[slot] = node.has_child(slot);
+    }
+    writer.add(node.get(), present);
+    return false;
+  });
+  writer.finish();
+}
+
+/**
+ * @brief write_tree  binary trees (binary_tree_t, avl_tree_t and
+ * order_statistic_tree_t) have the left child in slot 0 and the right one in
+ * slot 1
+ * @throws tree_file_exception_t if the stream fails
+ */
+template <class T, bool order_statistics>
+void
+write_tree(const tree_t<T, binary_node_t<T, order_statistics>>& tree, std::ostream& out) {
+  tree_file_writer_t<T> writer{ out };
+  const bool left_and_right[2][2]{ { false, true }, { true, true } };
+  const bool left_only[1]{ true };
+  const std::vector<bool> none;
+  tree.breadth_first_search([&](const binary_node_t<T, order_statistics>& node) {
+    if (node.has_right()) {
+      writer.add(node.get(), left_and_right[node.has_left()]);
+    }
+    else if (node.has_left()) {
+      writer.add(node.get(), left_only);
+    }
+    else {
+      writer.add(node.get(), none);
+    }
+    return false;
+  });
+  writer.finish();
+}
+
+/**
+ * @brief save_tree  it writes tree to path. The file is written to
+ * "<path>.tmp" and renamed afterwards, so the previous file is never left
+ * half written.
+ * @throws tree_file_exception_t if the file cannot be written
+ */
+template <class tree_type_t>
+void
+save_tree(const tree_type_t& tree, const std::string& path) {
+  const std::string temporary{ path + ".tmp" };
+  try {
+    std::ofstream out{ temporary, std::ios::binary | std::ios::trunc };
+    if (!out) {
+      throw tree_file_exception_t{ "Unable to write the tree: " + path };
+    }
+    write_tree(tree, out);
+  }
+  catch (...) {
+    std::remove(temporary.c_str());
+    throw;
+  }
+  if (std::rename(temporary.c_str(), path.c_str()) != 0) {
+    std::remove(temporary.c_str());
+    throw tree_file_exception_t{ "Unable to replace the tree: " + path };
+  }
+}
+
+/**
+ * @brief load_tree  it replaces the content of tree by the tree in file,
+ * decoding the structure sequentially in O(n). The subtree aggregates, if
+ * any, are computed once at the end, from the last node to the root.
+ * @throws tree_file_exception_t if a node has more slots than max_node_size
+ */
+template <class T, size_t max_node_size, class operation_t>
+void
+load_tree(const mapped_tree_t<T>& file, tree_t<T, tree_node_t<T, max_node_size, operation_t>>& tree) {
+  using node_type_t = tree_node_t<T, max_node_size, operation_t>;
+  tree.clear();
+  if (file.empty()) {
+    return;
+  }
+  tree.add_root(file[0]);
+  // all nodes in breadth first order, the ones from parent on have their
+  // children next
+  std::vector<node_type_t*> nodes{ &tree.root() };
+  nodes.reserve(file.size());
+  size_t parent{ 0 };
+  size_t next  { 1 };
+  size_t slot  { 0 };
+  file.for_each_slot([&](size_t position, bool present) {
+    if (parent >= nodes.size()) {
+      tree.clear();
+      throw tree_file_exception_t{ "Invalid tree file structure" };
+    }
+    if (position == mapped_tree_t<T>::npos) {
+      parent++;
+      slot = 0;
+      return;
+    }
+    if (present) {
+      node_type_t& node{ *nodes[parent] };
+      if (!node.attach_at(slot, file[next++])) {
+        tree.clear();
+        throw tree_file_exception_t{ "The tree file has more than " +
+                                     std::to_string(max_node_size) + " children per node" };
+      }
+      nodes.push_back(&node.child(slot));
+    }
+    slot++;
+  });
+  if constexpr (node_type_t::has_aggregate) {
+    for (auto it = nodes.rbegin(); it != nodes.rend(); ++it) {
+      (*it)->compute_aggregate();
+    }
+  }
+}
+
+/**
+ * @brief load_tree  binary_tree_t version, the tree keeps its shape
+ * @throws tree_file_exception_t if a node has more than two slots
+ */
+template <class T, class allocator_t>
+void
+load_tree(const mapped_tree_t<T>& file, binary_tree_t<T, allocator_t>& tree) {
+  using node_type_t = typename binary_tree_t<T, allocator_t>::node_type_t;
+  tree.clear();
+  if (file.empty()) {
+    return;
+  }
+  tree.add_root(file[0]);
+  std::queue<node_type_t*> parents;
+  parents.push(&tree.root());
+  size_t next{ 1 };
+  size_t slot{ 0 };
+  file.for_each_slot([&](size_t position, bool present) {
+    if (parents.empty()) {
+      tree.clear();
+      throw tree_file_exception_t{ "Invalid tree file structure" };
+    }
+    if (position == mapped_tree_t<T>::npos) {
+      parents.pop();
+      slot = 0;
+      return;
+    }
+    if (slot > 1) {
+      tree.clear();
+      throw tree_file_exception_t{ "The tree file is not a binary tree" };
+    }
+    if (present) {
+      node_type_t& parent{ *parents.front() };
+      if (slot == 0) {
+        tree.add_left(parent, file[next++]);
+        parents.push(&parent.left());
+      }
+      else {
+        tree.add_right(parent, file[next++]);
+        parents.push(&parent.right());
+      }
+    }
+    slot++;
+  });
+}
+
+/**
+ * @brief load_tree  avl_tree_t version: the values are taken in order and
+ * the tree is rebuilt balanced in O(n), without rotations
+ * @throws tree_file_exception_t if a node has more than two slots
+ * @throws std::invalid_argument if the values are not in order
+ */
+template <class T, class allocator_t>
+void
+load_tree(const mapped_tree_t<T>& file, avl_tree_t<T, allocator_t>& tree) {
+  using index_t = typename mapped_tree_t<T>::index_t;
+  constexpr index_t npos{ mapped_tree_t<T>::npos };
+  tree.clear();
+  // left and right child of every node, then an in order walk
+  std::vector<index_t> children(2 * file.size(), npos);
+  index_t parent{ 0 };
+  index_t next  { 1 };
+  size_t  slot  { 0 };
+  file.for_each_slot([&](size_t position, bool present) {
+    if (parent >= file.size()) {
+      throw tree_file_exception_t{ "Invalid tree file structure" };
+    }
+    if (position == npos) {
+      parent++;
+      slot = 0;
+      return;
+    }
+    if (slot > 1) {
+      throw tree_file_exception_t{ "The tree file is not a binary tree" };
+    }
+    if (present) {
+      children[2 * parent + slot] = next++;
+    }
+    slot++;
+  });
+  std::vector<T>       sorted;
+  std::vector<index_t> stack;
+  sorted.reserve(file.size());
+  for (index_t node = file.empty() ? npos : 0; node != npos || !stack.empty(); ) {
+    if (node != npos) {
+      stack.push_back(node);
+      node = children[2 * node];
+    }
+    else {
+      node = stack.back();
+      stack.pop_back();
+      sorted.push_back(file[node]);
+      node = children[2 * node + 1];
+    }
+  }
+  tree.rebuild(sorted.begin(), sorted.end());
+}
+
+}
+}
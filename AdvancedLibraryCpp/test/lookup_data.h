@@ -0,0 +1,28 @@
+#pragma once
+#include <random>
+#include <vector>
+
+namespace test {
+namespace structures {
+
+/**
+ * Sorted even keys and random queries, half of them are in the structure.
+ * Shared by the lookup benchmarks of the search structures.
+ */
+struct lookup_data_t {
+  std::vector<int> keys;
+  std::vector<int> queries;
+
+  lookup_data_t() : keys(1000000), queries(100000) {
+    std::mt19937 generator{ 3 };
+    for (size_t ii = 0; ii < keys.size(); ii++) {
+      keys[ii] = 2 * static_cast<int>(ii);
+    }
+    for (auto& query : queries) {
+      query = static_cast<int>(generator() % (2 * keys.size()));
+    }
+  }
+};
+
+}
+}
@@ -0,0 +1,399 @@
+#include "test_adaptive_radix_tree.h"
+
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "../structures/tree.h"
+
+using namespace advanced::structures;
+
+namespace {
+
+using art_t = adaptive_radix_tree_t<int>;
+
+std::vector<std::string>
+keys_of(const art_t& tree, const std::string& prefix = "") {
+  std::vector<std::string> keys;
+  tree.for_each_prefix(prefix, [&keys](const art_t::value_type& value) {
+    keys.push_back(value.first);
+    return false;
+  });
+  return keys;
+}
+
+/**
+ * url like keys sharing long prefixes
+ */
+std::vector<std::string>
+get_routes(size_t count, unsigned seed) {
+  static const std::vector<std::string> parts{
+    "api", "v1", "v2", "users", "orders", "items", "search", "static", "img", "css"
+  };
+  std::mt19937 generator{ seed };
+  std::vector<std::string> routes;
+  while (routes.size() < count) {
+    std::string route;
+    const size_t depth{ 1 + generator() % 4 };
+    for (size_t ii = 0; ii < depth; ii++) {
+      route += "/" + parts[generator() % parts.size()];
+    }
+    route += "/" + std::to_string(generator() % 10000);
+    routes.push_back(route);
+  }
+  return routes;
+}
+
+}
+
+TestAdaptiveRadixTree::TestAdaptiveRadixTree(QObject *parent) : QObject(parent)
+{ }
+
+void
+TestAdaptiveRadixTree::test_insert_and_find() {
+  art_t tree;
+  QVERIFY(tree.empty());
+  QVERIFY(!tree.find("missing"));
+  QVERIFY(tree.insert("hello", 1));
+  QVERIFY(tree.insert("help", 2));
+  QVERIFY(tree.insert("world", 3));
+  QVERIFY(!tree.insert("hello", 4));
+  QCOMPARE(tree.size(), size_t(3));
+  QCOMPARE(tree.find("hello")->second, 1);
+  QCOMPARE(tree.find("help")->second, 2);
+  QCOMPARE(tree.find("world")->second, 3);
+  QCOMPARE(tree.find("world")->first, std::string{ "world" });
+  QVERIFY(!tree.find("hel"));
+  QVERIFY(!tree.find("helper"));
+  QVERIFY(!tree.contains("w"));
+  QVERIFY(tree.contains("help"));
+
+  tree.find("help")->second = 5;
+  QCOMPARE(tree.find("help")->second, 5);
+
+  // any byte is a valid key, also the empty key
+  const std::string zero{ "a\0b", 3 };
+  QVERIFY(tree.insert(zero, 6));
+  QVERIFY(tree.insert("\xff\xfe", 7));
+  QVERIFY(tree.insert("", 8));
+  QCOMPARE(tree.find(zero)->second, 6);
+  QCOMPARE(tree.find("\xff\xfe")->second, 7);
+  QCOMPARE(tree.find("")->second, 8);
+  QVERIFY(!tree.find(std::string{ "a\0", 2 }));
+  QCOMPARE(tree.size(), size_t(6));
+}
+
+void
+TestAdaptiveRadixTree::test_insert_or_assign() {
+  art_t tree;
+  QVERIFY(tree.insert_or_assign("key", 1));
+  QVERIFY(!tree.insert_or_assign("key", 2));
+  QCOMPARE(tree.find("key")->second, 2);
+  QVERIFY(tree.insert_or_assign("keys", 3));
+  QVERIFY(!tree.insert_or_assign("key", 4));
+  QCOMPARE(tree.find("key")->second, 4);
+  QVERIFY(!tree.insert("key", 5));
+  QCOMPARE(tree.find("key")->second, 4);
+  QCOMPARE(tree.size(), size_t(2));
+}
+
+void
+TestAdaptiveRadixTree::test_keys_prefix_of_other_keys() {
+  art_t tree;
+  const std::vector<std::string> keys{ "abc", "a", "ab", "abcd", "" };
+  for (size_t ii = 0; ii < keys.size(); ii++) {
+    QVERIFY(tree.insert(keys[ii], int(ii)));
+  }
+  for (size_t ii = 0; ii < keys.size(); ii++) {
+    QCOMPARE(tree.find(keys[ii])->second, int(ii));
+  }
+  QVERIFY(!tree.find("abcde"));
+  QCOMPARE(keys_of(tree), (std::vector<std::string>{ "", "a", "ab", "abc", "abcd" }));
+}
+
+void
+TestAdaptiveRadixTree::test_path_compression_split() {
+  art_t tree;
+  QVERIFY(tree.insert("/api/v1/users/list", 1));
+  QVERIFY(tree.insert("/api/v1/users/find", 2));
+  // splits the compressed path in the middle
+  QVERIFY(tree.insert("/api/v2", 3));
+  QVERIFY(tree.insert("/ap", 4));
+  QVERIFY(tree.insert("/static", 5));
+  QCOMPARE(tree.find("/api/v1/users/list")->second, 1);
+  QCOMPARE(tree.find("/api/v1/users/find")->second, 2);
+  QCOMPARE(tree.find("/api/v2")->second, 3);
+  QCOMPARE(tree.find("/ap")->second, 4);
+  QCOMPARE(tree.find("/static")->second, 5);
+  QVERIFY(!tree.find("/api/v1"));
+  QVERIFY(!tree.find("/api/v1/users/"));
+  QVERIFY(!tree.find("/api/v3"));
+  QVERIFY(!tree.find("/a"));
+
+  // the removals merge the paths again
+  QVERIFY(tree.remove("/api/v2"));
+  QVERIFY(tree.remove("/ap"));
+  QVERIFY(tree.remove("/static"));
+  QCOMPARE(tree.find("/api/v1/users/list")->second, 1);
+  QCOMPARE(tree.find("/api/v1/users/find")->second, 2);
+  QCOMPARE(keys_of(tree), (std::vector<std::string>{ "/api/v1/users/find", "/api/v1/users/list" }));
+}
+
+void
+TestAdaptiveRadixTree::test_node_growth_and_shrink() {
+  // one node goes through node4, node16, node48 and node256 and back
+  art_t tree;
+  for (int byte = 255; byte >= 0; byte--) {
+    QVERIFY(tree.insert("k" + std::string(1, char(byte)), byte));
+    for (int other = byte; other < 256; other++) {
+      QCOMPARE(tree.find("k" + std::string(1, char(other)))->second, other);
+    }
+  }
+  QCOMPARE(tree.size(), size_t(256));
+  const std::vector<std::string> keys{ keys_of(tree) };
+  QCOMPARE(keys.size(), size_t(256));
+  for (int byte = 0; byte < 256; byte++) {
+    QCOMPARE(keys[byte], "k" + std::string(1, char(byte)));
+  }
+
+  for (int byte = 0; byte < 256; byte += 2) {
+    QVERIFY(tree.remove("k" + std::string(1, char(byte))));
+  }
+  for (int byte = 255; byte >= 0; byte -= 2) {
+    for (int other = 1; other <= byte; other += 2) {
+      QCOMPARE(tree.find("k" + std::string(1, char(other)))->second, other);
+    }
+    QVERIFY(tree.remove("k" + std::string(1, char(byte))));
+    QVERIFY(!tree.contains("k" + std::string(1, char(byte))));
+  }
+  QVERIFY(tree.empty());
+  QVERIFY(keys_of(tree).empty());
+  QVERIFY(tree.insert("k", 1));
+  QCOMPARE(tree.find("k")->second, 1);
+}
+
+void
+TestAdaptiveRadixTree::test_remove() {
+  art_t tree;
+  QVERIFY(!tree.remove("a"));
+  const std::vector<std::string> keys{ "a", "ab", "abc", "abd", "b", "" };
+  for (size_t ii = 0; ii < keys.size(); ii++) {
+    tree.insert(keys[ii], int(ii));
+  }
+  QVERIFY(!tree.remove("abe"));
+  QVERIFY(!tree.remove("abcd"));
+  QVERIFY(!tree.remove("c"));
+  QCOMPARE(tree.size(), keys.size());
+
+  // key ending in an inner node
+  QVERIFY(tree.remove("ab"));
+  QVERIFY(!tree.remove("ab"));
+  QCOMPARE(tree.find("abc")->second, 2);
+  QCOMPARE(tree.find("abd")->second, 3);
+  QVERIFY(tree.remove("abc"));
+  QCOMPARE(tree.find("abd")->second, 3);
+  QCOMPARE(tree.find("a")->second, 0);
+  QVERIFY(tree.remove("a"));
+  QCOMPARE(tree.find("abd")->second, 3);
+  QVERIFY(tree.remove(""));
+  QCOMPARE(keys_of(tree), (std::vector<std::string>{ "abd", "b" }));
+  QVERIFY(tree.remove("b"));
+  QVERIFY(tree.remove("abd"));
+  QVERIFY(tree.empty());
+  tree.insert("again", 1);
+  QCOMPARE(tree.find("again")->second, 1);
+}
+
+void
+TestAdaptiveRadixTree::test_for_each_prefix() {
+  art_t tree;
+  const std::vector<std::string> keys{ "car", "card", "care", "cart", "cat", "dog", "ca" };
+  for (const auto& key : keys) {
+    tree.insert(key, int(key.size()));
+  }
+  QCOMPARE(keys_of(tree, "car"), (std::vector<std::string>{ "car", "card", "care", "cart" }));
+  QCOMPARE(keys_of(tree, "c"), (std::vector<std::string>{ "ca", "car", "card", "care", "cart", "cat" }));
+  QCOMPARE(keys_of(tree, "cart"), (std::vector<std::string>{ "cart" }));
+  QCOMPARE(keys_of(tree, "d"), (std::vector<std::string>{ "dog" }));
+  QVERIFY(keys_of(tree, "carts").empty());
+  QVERIFY(keys_of(tree, "x").empty());
+  QCOMPARE(keys_of(tree).size(), keys.size());
+
+  // the visitor stops the visit
+  std::vector<std::string> first;
+  const size_t visited{ tree.for_each_prefix("car", [&first](const art_t::value_type& value) {
+    first.push_back(value.first);
+    return first.size() == 2;
+  }) };
+  QCOMPARE(visited, size_t(2));
+  QCOMPARE(first, (std::vector<std::string>{ "car", "card" }));
+  QCOMPARE(tree.for_each([](const art_t::value_type&) { return false; }), keys.size());
+
+  // prefix ending inside a compressed path
+  art_t routes;
+  routes.insert("/api/v1/users", 1);
+  routes.insert("/api/v1/orders", 2);
+  QCOMPARE(keys_of(routes, "/ap"), (std::vector<std::string>{ "/api/v1/orders", "/api/v1/users" }));
+  QVERIFY(keys_of(routes, "/apx").empty());
+}
+
+void
+TestAdaptiveRadixTree::test_longest_prefix_match() {
+  art_t routes;
+  QVERIFY(!routes.longest_prefix_match("/api"));
+  routes.insert("/", 1);
+  routes.insert("/api", 2);
+  routes.insert("/api/v1", 3);
+  routes.insert("/api/v1/users", 4);
+  routes.insert("/static/css", 5);
+  QCOMPARE(routes.longest_prefix_match("/api/v1/users/42")->second, 4);
+  QCOMPARE(routes.longest_prefix_match("/api/v1/users")->second, 4);
+  QCOMPARE(routes.longest_prefix_match("/api/v1/orders")->second, 3);
+  QCOMPARE(routes.longest_prefix_match("/api/v2")->second, 2);
+  QCOMPARE(routes.longest_prefix_match("/apx")->second, 1);
+  QCOMPARE(routes.longest_prefix_match("/static/css/main.css")->second, 5);
+  QCOMPARE(routes.longest_prefix_match("/static/js")->second, 1);
+  QCOMPARE(routes.longest_prefix_match("/static/js")->first, std::string{ "/" });
+  QVERIFY(!routes.longest_prefix_match("api"));
+  QVERIFY(!routes.longest_prefix_match(""));
+  routes.insert("", 0);
+  QCOMPARE(routes.longest_prefix_match("api")->second, 0);
+}
+
+void
+TestAdaptiveRadixTree::test_random_against_std_map() {
+  std::mt19937 generator{ 47 };
+  art_t tree;
+  std::map<std::string, int> expected;
+  for (int ii = 0; ii < 20000; ii++) {
+    // short keys over a small alphabet to have many shared prefixes, and some
+    // over all the bytes to have wide nodes
+    std::string key(generator() % 6, '\0');
+    const bool wide{ generator() % 4 == 0 };
+    for (auto& byte : key) {
+      byte = static_cast<char>(wide ? generator() % 256 : 'a' + generator() % 4);
+    }
+    switch (generator() % 3) {
+    case 0:
+      QCOMPARE(tree.insert(key, ii), expected.emplace(key, ii).second);
+      break;
+    case 1:
+      QCOMPARE(tree.insert_or_assign(key, ii), expected.count(key) == 0);
+      expected[key] = ii;
+      break;
+    default:
+      QCOMPARE(tree.remove(key), expected.erase(key) == 1);
+      break;
+    }
+    QCOMPARE(tree.size(), expected.size());
+    const auto found{ tree.find(key) };
+    const auto it{ expected.find(key) };
+    QCOMPARE(found != nullptr, it != expected.end());
+    if (found) {
+      QCOMPARE(found->second, it->second);
+    }
+  }
+  std::vector<std::pair<std::string, int>> visited;
+  tree.for_each([&visited](const art_t::value_type& value) {
+    visited.emplace_back(value.first, value.second);
+    return false;
+  });
+  QCOMPARE(visited, (std::vector<std::pair<std::string, int>>{ expected.begin(), expected.end() }));
+
+  // every prefix against a scan of the map
+  for (const std::string prefix : { "", "a", "ab", "dd", "abc", "cab" }) {
+    std::vector<std::string> scan;
+    for (auto it = expected.lower_bound(prefix);
+         it != expected.end() && it->first.compare(0, prefix.size(), prefix) == 0; ++it) {
+      scan.push_back(it->first);
+    }
+    QCOMPARE(keys_of(tree, prefix), scan);
+  }
+}
+
+void
+TestAdaptiveRadixTree::test_copy_and_move() {
+  art_t tree;
+  for (const auto& route : get_routes(1000, 1)) {
+    tree.insert(route, int(route.size()));
+  }
+  for (int byte = 0; byte < 256; byte++) {
+    tree.insert("w" + std::string(1, char(byte)), byte);
+  }
+  const std::vector<std::string> keys{ keys_of(tree) };
+
+  art_t copy{ tree };
+  QCOMPARE(copy.size(), tree.size());
+  QCOMPARE(keys_of(copy), keys);
+  copy.remove(keys.front());
+  copy.find(keys.back())->second = -1;
+  QCOMPARE(keys_of(tree), keys);
+  QVERIFY(tree.find(keys.back())->second != -1);
+
+  art_t moved{ std::move(copy) };
+  QVERIFY(copy.empty());
+  QCOMPARE(moved.size(), keys.size() - 1);
+  copy = moved;
+  QCOMPARE(keys_of(copy), keys_of(moved));
+  moved = std::move(tree);
+  QCOMPARE(keys_of(moved), keys);
+  QVERIFY(tree.empty());
+  copy = copy;
+  QCOMPARE(copy.size(), keys.size() - 1);
+  copy.clear();
+  QVERIFY(copy.empty());
+  QVERIFY(!copy.find(keys.back()));
+}
+
+void
+TestAdaptiveRadixTree::benchmark_tree_trie_lookup() {
+  // the trie built with tree_t: one node per character, children scanned
+  // linearly
+  using trie_t = tree_t<char, tree_node_t<char, 256>>;
+  const std::vector<std::string> routes{ get_routes(100000, 2) };
+  trie_t trie{ '\0' };
+  for (const auto& route : routes) {
+    auto* node{ &trie.root() };
+    for (char byte : route) {
+      auto found{ node->find(byte) };
+      if (!found.first) {
+        node->add_child(byte);
+        found.second = node->children_count() - 1;
+      }
+      node = &node->child(found.second);
+    }
+  }
+  QBENCHMARK {
+    size_t found{ 0 };
+    for (const auto& route : routes) {
+      const auto* node{ &trie.root() };
+      for (char byte : route) {
+        const auto child{ node->find(byte) };
+        if (!child.first) {
+          node = nullptr;
+          break;
+        }
+        node = &node->child(child.second);
+      }
+      found += node != nullptr;
+    }
+    QCOMPARE(found, routes.size());
+  }
+}
+
+void
+TestAdaptiveRadixTree::benchmark_lookup() {
+  const std::vector<std::string> routes{ get_routes(100000, 2) };
+  art_t tree;
+  for (const auto& route : routes) {
+    tree.insert(route, 0);
+  }
+  QBENCHMARK {
+    size_t found{ 0 };
+    for (const auto& route : routes) {
+      found += tree.contains(route);
+    }
+    QCOMPARE(found, routes.size());
+  }
+}
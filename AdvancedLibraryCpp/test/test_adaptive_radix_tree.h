@@ -0,0 +1,28 @@
+#pragma once
+
+#include <QObject>
+#include <QTest>
+
+#include "../structures/adaptive_radix_tree.h"
+
+class TestAdaptiveRadixTree : public QObject
+{
+  Q_OBJECT
+public:
+  explicit TestAdaptiveRadixTree(QObject *parent = nullptr);
+
+private slots:
+
+  void test_insert_and_find();
+  void test_insert_or_assign();
+  void test_keys_prefix_of_other_keys();
+  void test_path_compression_split();
+  void test_node_growth_and_shrink();
+  void test_remove();
+  void test_for_each_prefix();
+  void test_longest_prefix_match();
+  void test_random_against_std_map();
+  void test_copy_and_move();
+  void benchmark_tree_trie_lookup();
+  void benchmark_lookup();
+};
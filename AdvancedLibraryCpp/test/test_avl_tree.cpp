@@ -1,6 +1,10 @@
 #include "test_avl_tree.h"
+#include <algorithm>
+#include <iterator>
 #include <set>
 #include <cmath>
+#include <numeric>
+#include <memory_resource>
 
 using namespace advanced::structures;
 
@@ -817,3 +821,674 @@ test_search_value() {
   steps = tree.depth_first_search([](const auto& node) { return *node == 12; });
   QCOMPARE(steps, 11u);
 }
+
+void TestAVLTree::
+test_arena_allocator() {
+  using arena_t = arena_node_allocator_t<binary_node_t<int>>;
+  avl_tree_t<int, arena_t> tree{ arena_t{ 16 } };
+  const auto keys{ shuffled_keys(100) };
+  for (const auto& key : keys) {
+    QVERIFY(tree.insert(key));
+  }
+  QCOMPARE(tree.size(), 100u);
+  QCOMPARE(tree.get_allocator().size(), 100u);
+  QCOMPARE(tree.get_allocator().capacity(), 112u);
+  QCOMPARE(test_node(tree.root()), 100u);
+
+  // removed nodes are reused by the next insertions
+  for (int ii = 0; ii < 50; ii++) {
+    QVERIFY(tree.remove(ii));
+  }
+  QCOMPARE(tree.get_allocator().size(), 50u);
+  for (int ii = 100; ii < 150; ii++) {
+    QVERIFY(tree.insert(ii));
+  }
+  QCOMPARE(tree.get_allocator().capacity(), 112u);
+  for (int ii = 50; ii < 150; ii++) {
+    QVERIFY(tree.contains(ii));
+  }
+  QCOMPARE(tree.left_most().get(),  50);
+  QCOMPARE(tree.right_most().get(), 149);
+
+  tree.clear();
+  QVERIFY(!tree.has_root());
+  QCOMPARE(tree.size(), 0u);
+  QCOMPARE(tree.get_allocator().capacity(), 0u);
+  QVERIFY(tree.insert(1));
+  QVERIFY(tree.contains(1));
+}
+
+void TestAVLTree::
+test_arena_allocator_copy_and_move() {
+  using arena_t = arena_node_allocator_t<binary_node_t<std::string>>;
+  avl_tree_t<std::string, arena_t> tree{ arena_t{ 4 } };
+  for (const auto& color : { "magenta", "brown", "silver", "blue", "orange",
+                             "cyan", "yellow" }) {
+    tree.insert(color);
+  }
+
+  avl_tree_t<std::string, arena_t> copied{ tree };
+  QCOMPARE(copied.size(), 7u);
+  QCOMPARE(copied.get_allocator().size(), 7u);
+  QCOMPARE(copied.root().get(),              "magenta");
+  QCOMPARE(copied.root().left().right().get(), "cyan");
+  QCOMPARE(&copied.root().left().parent(), &copied.root());
+  QCOMPARE(copied.height(), tree.height());
+
+  tree.remove("cyan");
+  QVERIFY(copied.contains("cyan"));
+
+  avl_tree_t<std::string, arena_t> moved{ std::move(copied) };
+  QVERIFY(!copied.has_root());
+  QCOMPARE(copied.get_allocator().size(), 0u);
+  QCOMPARE(moved.get_allocator().size(), 7u);
+  QVERIFY(moved.contains("cyan"));
+  QVERIFY(moved.insert("white"));
+
+  copied = tree;
+  QCOMPARE(copied.size(), 6u);
+  QVERIFY(!copied.contains("cyan"));
+}
+
+void TestAVLTree::
+test_pmr_allocator() {
+  using pmr_t = pmr_node_allocator_t<binary_node_t<int>>;
+  char buffer[16384];
+  test::structures::counting_resource_t upstream;
+  std::pmr::monotonic_buffer_resource resource{ buffer, sizeof(buffer), &upstream };
+  {
+    avl_tree_t<int, pmr_t> tree{ pmr_t{ &resource } };
+    for (const auto& key : shuffled_keys(100)) {
+      tree.insert(key);
+    }
+    QCOMPARE(tree.size(), 100u);
+    QCOMPARE(test_node(tree.root()), 100u);
+    QCOMPARE(tree.get_allocator().resource(), &resource);
+    for (int ii = 0; ii < 100; ii++) {
+      QVERIFY(tree.contains(ii));
+    }
+    const avl_tree_t<int, pmr_t> copied{ tree };
+    QCOMPARE(copied.get_allocator().resource(), &resource);
+    QCOMPARE(test_node(copied.root()), 100u);
+  }
+  // all nodes came from the stack buffer, the upstream was never used
+  QCOMPARE(upstream.allocations, 0u);
+  (void) resource.allocate(sizeof(buffer));
+  QCOMPARE(upstream.allocations, 1u);
+}
+
+void TestAVLTree::
+benchmark_heap_insert_remove() {
+  const auto keys{ shuffled_keys(100000) };
+  avl_tree_t<int> tree;
+  QBENCHMARK {
+    insert_remove(tree, keys);
+  }
+}
+
+void TestAVLTree::
+benchmark_arena_insert_remove() {
+  using arena_t = arena_node_allocator_t<binary_node_t<int>>;
+  const auto keys{ shuffled_keys(100000) };
+  avl_tree_t<int, arena_t> tree{ arena_t{ 4096 } };
+  QBENCHMARK {
+    insert_remove(tree, keys);
+  }
+}
+
+void TestAVLTree::
+benchmark_pmr_pool_insert_remove() {
+  using pmr_t = pmr_node_allocator_t<binary_node_t<int>>;
+  const auto keys{ shuffled_keys(100000) };
+  std::pmr::unsynchronized_pool_resource pool;
+  avl_tree_t<int, pmr_t> tree{ pmr_t{ &pool } };
+  QBENCHMARK {
+    insert_remove(tree, keys);
+  }
+}
+
+void TestAVLTree::
+test_parent_links_after_rotations() {
+  avl_tree_t<int> tree;
+  const auto keys{ shuffled_keys(1000) };
+  for (const auto& key : keys) {
+    tree.insert(key);
+  }
+  for (size_t ii = 0; ii < keys.size(); ii += 3) {
+    tree.remove(keys[ii]);
+  }
+
+  size_t wrong_links{ 0 };
+  tree.pre_order([&wrong_links](const binary_node_t<int>& node) {
+    if (node.has_left() && &node.left().parent() != &node) {
+      wrong_links++;
+    }
+    if (node.has_right() && &node.right().parent() != &node) {
+      wrong_links++;
+    }
+    return false;
+  });
+  QCOMPARE(wrong_links, 0u);
+  QVERIFY(!tree.root().has_parent());
+}
+
+void TestAVLTree::
+test_random_operations_should_match_std_set() {
+  std::mt19937 generator{ 11 };
+  std::uniform_int_distribution<int> key{ 0, 1000 };
+  avl_tree_t<int> tree;
+  std::set<int> expected;
+
+  for (int ii = 0; ii < 20000; ii++) {
+    const int value{ key(generator) };
+    if (generator() % 3) {
+      QCOMPARE(tree.insert(value), expected.insert(value).second);
+    }
+    else {
+      QCOMPARE(tree.remove(value), expected.erase(value) == 1u);
+    }
+  }
+  QCOMPARE(tree.size(), expected.size());
+  QCOMPARE(test_node(tree.root()), expected.size());
+  QVERIFY(tree.height() <= 1.45 * std::log2(expected.size() + 2.0));
+  for (int value = 0; value <= 1000; value++) {
+    QCOMPARE(tree.contains(value), expected.count(value) == 1u);
+  }
+}
+
+void TestAVLTree::
+benchmark_random_keys() {
+  const auto keys{ shuffled_keys(100000) };
+  test::structures::avl_set_adapter_t tree;
+  QBENCHMARK {
+    QCOMPARE(insert_find_remove(tree, keys), keys.size());
+  }
+}
+
+void TestAVLTree::
+benchmark_random_keys_std_set() {
+  const auto keys{ shuffled_keys(100000) };
+  std::set<int> tree;
+  QBENCHMARK {
+    QCOMPARE(insert_find_remove(tree, keys), keys.size());
+  }
+}
+
+void TestAVLTree::
+benchmark_sorted_keys() {
+  std::vector<int> keys(100000);
+  std::iota(keys.begin(), keys.end(), 0);
+  test::structures::avl_set_adapter_t tree;
+  QBENCHMARK {
+    QCOMPARE(insert_find_remove(tree, keys), keys.size());
+  }
+}
+
+void TestAVLTree::
+benchmark_sorted_keys_std_set() {
+  std::vector<int> keys(100000);
+  std::iota(keys.begin(), keys.end(), 0);
+  std::set<int> tree;
+  QBENCHMARK {
+    QCOMPARE(insert_find_remove(tree, keys), keys.size());
+  }
+}
+
+void TestAVLTree::
+benchmark_reverse_sorted_keys() {
+  std::vector<int> keys(100000);
+  std::iota(keys.rbegin(), keys.rend(), 0);
+  test::structures::avl_set_adapter_t tree;
+  QBENCHMARK {
+    QCOMPARE(insert_find_remove(tree, keys), keys.size());
+  }
+}
+
+void TestAVLTree::
+benchmark_reverse_sorted_keys_std_set() {
+  std::vector<int> keys(100000);
+  std::iota(keys.rbegin(), keys.rend(), 0);
+  std::set<int> tree;
+  QBENCHMARK {
+    QCOMPARE(insert_find_remove(tree, keys), keys.size());
+  }
+}
+
+void TestAVLTree::
+test_iterators() {
+  const avl_tree_t<int> tree = get_test_tree();
+  const std::vector<int> expected{ 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12 };
+
+  QCOMPARE(std::vector<int>(tree.begin(), tree.end()), expected);
+  QCOMPARE(std::vector<int>(tree.rbegin(), tree.rend()),
+           std::vector<int>(expected.rbegin(), expected.rend()));
+  QCOMPARE(std::distance(tree.begin(), tree.end()), 12);
+  QVERIFY(std::is_sorted(tree.cbegin(), tree.cend()));
+
+  auto it{ tree.find(7) };
+  QCOMPARE(*it, 7);
+  QCOMPARE(it.node().get(), 7);
+  QCOMPARE(*++it, 8);
+  QCOMPARE(*it++, 8);
+  QCOMPARE(*it, 9);
+  QCOMPARE(*--it, 8);
+  QCOMPARE(*it--, 8);
+  QCOMPARE(*it, 7);
+  QCOMPARE(*--tree.end(), 12);
+  QVERIFY(tree.find(13) == tree.end());
+
+  int sum{ 0 };
+  for (const auto& value : tree) {
+    sum += value;
+  }
+  QCOMPARE(sum, 78);
+}
+
+void TestAVLTree::
+test_iterators_on_empty_tree() {
+  avl_tree_t<int> tree;
+  QVERIFY(tree.begin() == tree.end());
+  QVERIFY(tree.rbegin() == tree.rend());
+  QVERIFY(tree.lower_bound(1) == tree.end());
+  QVERIFY(tree.find(1) == tree.end());
+
+  tree.insert(1);
+  QVERIFY(tree.begin() != tree.end());
+  QCOMPARE(*--tree.end(), 1);
+  QVERIFY(++tree.begin() == tree.end());
+}
+
+void TestAVLTree::
+test_lower_and_upper_bound() {
+  avl_tree_t<int> tree;
+  for (int value = 0; value < 100; value += 10) {
+    tree.insert(value);
+  }
+  QCOMPARE(*tree.lower_bound(30), 30);
+  QCOMPARE(*tree.upper_bound(30), 40);
+  QCOMPARE(*tree.lower_bound(31), 40);
+  QCOMPARE(*tree.upper_bound(31), 40);
+  QCOMPARE(*tree.lower_bound(-5), 0);
+  QVERIFY(tree.lower_bound(91) == tree.end());
+  QVERIFY(tree.upper_bound(90) == tree.end());
+
+  // range scan [25, 65]
+  QCOMPARE(std::vector<int>(tree.lower_bound(25), tree.upper_bound(65)),
+           std::vector<int>({ 30, 40, 50, 60 }));
+}
+
+void TestAVLTree::
+test_equal_range_with_duplicates() {
+  avl_tree_t<int> tree;
+  tree.enable_duplicates();
+  for (int ii = 0; ii < 30; ii++) {
+    tree.insert(ii % 5);
+  }
+  const auto range{ tree.equal_range(3) };
+  QCOMPARE(std::distance(range.first, range.second), 6);
+  QVERIFY(std::all_of(range.first, range.second,
+                      [](int value) { return value == 3; }));
+  QCOMPARE(*range.second, 4);
+  QCOMPARE(*std::prev(range.first), 2);
+
+  const auto missing{ tree.equal_range(7) };
+  QVERIFY(missing.first == missing.second);
+}
+
+void TestAVLTree::
+test_order_statistics() {
+  const avl_tree_t<int> source = get_test_tree();
+  order_statistic_tree_t<int> tree;
+  for (int value : source) {
+    tree.insert(value);
+  }
+  QVERIFY(tree.has_order_statistics());
+
+  QCOMPARE(tree.rank(1),  0u);
+  QCOMPARE(tree.rank(7),  6u);
+  QCOMPARE(tree.rank(13), 12u);
+  QCOMPARE(*tree.select(0),  1);
+  QCOMPARE(*tree.select(6),  7);
+  QCOMPARE(*tree.select(11), 12);
+  QVERIFY(tree.select(12) == tree.end());
+  QCOMPARE(tree.count_range(3, 8),   6u);
+  QCOMPARE(tree.count_range(-5, 0),  0u);
+  QCOMPARE(tree.count_range(8, 3),   0u);
+  QCOMPARE(tree.count_range(0, 100), 12u);
+
+  tree.remove(7);
+  tree.insert(20);
+  QCOMPARE(tree.rank(20), 11u);
+  QCOMPARE(*tree.select(6), 8);
+
+  // copies keep the subtree sizes
+  const order_statistic_tree_t<int> copied{ tree };
+  QCOMPARE(*copied.select(6), 8);
+}
+
+void TestAVLTree::
+test_order_statistics_should_match_a_sorted_vector() {
+  std::mt19937 generator{ 5 };
+  std::uniform_int_distribution<int> key{ 0, 500 };
+  order_statistic_tree_t<int> tree;
+  tree.enable_duplicates();
+  std::multiset<int> expected;
+
+  for (int ii = 0; ii < 5000; ii++) {
+    const int value{ key(generator) };
+    if (generator() % 3) {
+      tree.insert(value);
+      expected.insert(value);
+    }
+    else if (tree.remove(value)) {
+      expected.erase(expected.find(value));
+    }
+  }
+  const std::vector<int> sorted(expected.begin(), expected.end());
+  QCOMPARE(tree.size(), sorted.size());
+  for (size_t k = 0; k < sorted.size(); k += 7) {
+    QCOMPARE(*tree.select(k), sorted[k]);
+  }
+  for (int value = -1; value <= 501; value += 3) {
+    const auto lower{ std::lower_bound(sorted.begin(), sorted.end(), value) };
+    const auto upper{ std::upper_bound(sorted.begin(), sorted.end(), value + 50) };
+    QCOMPARE(tree.rank(value), size_t(lower - sorted.begin()));
+    QCOMPARE(tree.count_range(value, value + 50), size_t(upper - lower));
+  }
+}
+
+void TestAVLTree::
+test_order_statistics_node_layout() {
+  // only the nodes of an order_statistic_tree_t keep the subtree size
+  QVERIFY(!avl_tree_t<int>::has_order_statistics());
+  QVERIFY(order_statistic_tree_t<int>::has_order_statistics());
+  QCOMPARE(sizeof(binary_node_t<int, true>),
+           sizeof(binary_node_t<int>) + sizeof(size_t));
+  QVERIFY((std::is_same<avl_tree_t<int>::node_type_t, binary_node_t<int>>::value));
+
+  // both kinds of tree keep the same shape
+  avl_tree_t<int> plain;
+  order_statistic_tree_t<int> ranked;
+  for (int ii = 0; ii < 1000; ii++) {
+    const int value{ (ii * 7919) % 1000 };
+    plain.insert(value);
+    ranked.insert(value);
+  }
+  QCOMPARE(plain.height(), ranked.height());
+  QVERIFY(std::equal(plain.begin(), plain.end(), ranked.begin(), ranked.end()));
+  QCOMPARE(test_node(ranked.root()), 1000u);
+}
+
+void TestAVLTree::
+test_rebuild_from_sorted_range() {
+  const std::vector<int> values{ 1, 2, 2, 3, 5, 8, 8, 8, 13, 21 };
+  order_statistic_tree_t<int> tree{ 100 };
+  tree.rebuild(values.begin(), values.end());
+  QCOMPARE(tree.size(), 7u);
+  QCOMPARE(test_node(tree.root()), 7u);
+  QCOMPARE(tree.height(), 3u);
+  QVERIFY(!tree.contains(100));
+  QVERIFY(std::equal(tree.begin(), tree.end(),
+                     std::vector<int>{ 1, 2, 3, 5, 8, 13, 21 }.begin()));
+  QCOMPARE(*tree.select(4), 8);
+
+  // duplicates are kept when they are enabled
+  tree.enable_duplicates();
+  tree.rebuild(values.begin(), values.end());
+  QCOMPARE(tree.size(), values.size());
+  QVERIFY(std::equal(tree.begin(), tree.end(), values.begin()));
+  QCOMPARE(tree.rank(8), 5u);
+  QVERIFY(tree.insert(4));
+  QCOMPARE(tree.rank(8), 6u);
+
+  // it's a regular tree afterwards
+  std::vector<int> sorted(1000);
+  std::iota(sorted.begin(), sorted.end(), 0);
+  tree.rebuild(sorted.begin(), sorted.end());
+  QCOMPARE(tree.height(), 10u);
+  for (int ii = 0; ii < 1000; ii += 2) {
+    QVERIFY(tree.remove(ii));
+  }
+  QCOMPARE(tree.size(), 500u);
+  QCOMPARE(test_node(tree.root()), 500u);
+  QCOMPARE(*tree.select(0), 1);
+
+  const std::vector<int> unsorted{ 1, 3, 2 };
+  QVERIFY_EXCEPTION_THROWN(tree.rebuild(unsorted.begin(), unsorted.end()),
+                           std::invalid_argument);
+  QCOMPARE(tree.size(), 0u);
+  QVERIFY(!tree.has_root());
+}
+
+void TestAVLTree::
+test_rebuild_should_free_nodes_when_it_throws() {
+  using pmr_t = pmr_node_allocator_t<binary_node_t<int>>;
+  std::vector<int> sorted(1000);
+  std::iota(sorted.begin(), sorted.end(), 0);
+  test::structures::counting_resource_t resource;
+  avl_tree_t<int, pmr_t> tree{ pmr_t{ &resource } };
+
+  // the allocation fails in the middle of every level of the recursion
+  for (size_t limit : { 1u, 2u, 3u, 250u, 500u, 999u }) {
+    resource.allocations = 0;
+    resource.limit       = limit;
+    QVERIFY_EXCEPTION_THROWN(tree.rebuild(sorted.begin(), sorted.end()),
+                             std::bad_alloc);
+    QCOMPARE(resource.allocations, limit);
+    QCOMPARE(resource.live, 0u);
+    QCOMPARE(tree.size(), 0u);
+    QVERIFY(!tree.has_root());
+  }
+
+  resource.limit = 0;
+  tree.rebuild(sorted.begin(), sorted.end());
+  QCOMPARE(tree.size(), 1000u);
+  QCOMPARE(resource.live, 1000u);
+}
+
+void TestAVLTree::
+test_split_and_join() {
+  std::vector<int> sorted(300);
+  std::iota(sorted.begin(), sorted.end(), 0);
+  avl_tree_t<int> tree;
+  tree.rebuild(sorted.begin(), sorted.end());
+
+  avl_tree_t<int> greater{ tree.split(100) };
+  QCOMPARE(tree.size(), 100u);
+  QCOMPARE(greater.size(), 200u);
+  QCOMPARE(test_node(tree.root()), 100u);
+  QCOMPARE(test_node(greater.root()), 200u);
+  QCOMPARE(tree.right_most().get(), 99);
+  QCOMPARE(greater.left_most().get(), 100);
+  QVERIFY(tree.height() <= 1.45 * std::log2(102.0));
+  QVERIFY(greater.height() <= 1.45 * std::log2(202.0));
+
+  // the parent links are valid: iterators follow them
+  QVERIFY(std::equal(tree.begin(), tree.end(), sorted.begin()));
+  QVERIFY(std::equal(greater.rbegin(), greater.rend(), sorted.rbegin()));
+
+  QVERIFY_EXCEPTION_THROWN(greater.join(std::move(tree)), std::invalid_argument);
+  QCOMPARE(tree.size(), 100u);
+
+  // join a small tree to a large one
+  avl_tree_t<int> last{ greater.split(290) };
+  tree.join(std::move(greater)).join(std::move(last));
+  QCOMPARE(tree.size(), 300u);
+  QCOMPARE(greater.size(), 0u);
+  QCOMPARE(test_node(tree.root()), 300u);
+  QVERIFY(tree.height() <= 1.45 * std::log2(302.0));
+  QVERIFY(std::equal(tree.begin(), tree.end(), sorted.begin()));
+
+  QCOMPARE(tree.split(1000).size(), 0u);
+  QCOMPARE(tree.split(-5).size(), 300u);
+  QCOMPARE(tree.size(), 0u);
+}
+
+void TestAVLTree::
+test_set_operations_should_match_std_algorithms() {
+  std::mt19937 generator{ 17 };
+  for (const int size : { 0, 10, 1000, 60000 }) {
+    std::uniform_int_distribution<int> key{ 0, 2 * size };
+    std::set<int> first, second;
+    for (int ii = 0; ii < size; ii++) {
+      first.insert(key(generator));
+      second.insert(key(generator) / 2);
+    }
+    const auto make_tree{ [](const std::set<int>& values) {
+      order_statistic_tree_t<int> tree;
+      tree.rebuild(values.begin(), values.end());
+      return tree;
+    }};
+    std::vector<int> expected;
+    order_statistic_tree_t<int> tree{ make_tree(first) };
+
+    std::set_union(first.begin(), first.end(), second.begin(), second.end(),
+                   std::back_inserter(expected));
+    tree.set_union(make_tree(second));
+    QCOMPARE(tree.size(), expected.size());
+    QVERIFY(std::equal(tree.begin(), tree.end(), expected.begin()));
+    QVERIFY(tree.height() <= 1.45 * std::log2(tree.size() + 2.0));
+    if (tree.size()) {
+      QCOMPARE(*tree.select(tree.size() / 2), expected[expected.size() / 2]);
+    }
+
+    expected.clear();
+    tree = make_tree(first);
+    std::set_intersection(first.begin(), first.end(), second.begin(), second.end(),
+                          std::back_inserter(expected));
+    tree.set_intersection(make_tree(second));
+    QCOMPARE(tree.size(), expected.size());
+    QVERIFY(std::equal(tree.begin(), tree.end(), expected.begin()));
+    QVERIFY(tree.height() <= 1.45 * std::log2(tree.size() + 2.0));
+
+    expected.clear();
+    tree = make_tree(first);
+    std::set_difference(first.begin(), first.end(), second.begin(), second.end(),
+                        std::back_inserter(expected));
+    tree.set_difference(make_tree(second));
+    QCOMPARE(tree.size(), expected.size());
+    QVERIFY(std::equal(tree.begin(), tree.end(), expected.begin()));
+    QVERIFY(tree.height() <= 1.45 * std::log2(tree.size() + 2.0));
+    if (tree.size()) {
+      QCOMPARE(tree.rank(expected.back()), expected.size() - 1);
+    }
+  }
+}
+
+void TestAVLTree::
+test_set_operations_with_arena_allocator() {
+  using arena_t = arena_node_allocator_t<binary_node_t<int>>;
+  avl_tree_t<int, arena_t> first{ arena_t{ 16 } };
+  avl_tree_t<int, arena_t> second{ arena_t{ 16 } };
+  for (int ii = 0; ii < 100; ii++) {
+    first.insert(ii);
+    second.insert(ii + 50);
+  }
+
+  // the nodes of other arenas are copied
+  first.set_union(std::move(second));
+  QCOMPARE(first.size(), 150u);
+  QCOMPARE(first.get_allocator().size(), 150u);
+  QCOMPARE(second.size(), 0u);
+  QCOMPARE(second.get_allocator().size(), 0u);
+
+  avl_tree_t<int, arena_t> greater{ first.split(75) };
+  QCOMPARE(first.size(), 75u);
+  QCOMPARE(greater.size(), 75u);
+  QCOMPARE(first.get_allocator().size(), 75u);
+  QCOMPARE(greater.get_allocator().size(), 75u);
+
+  first.set_difference(std::move(greater));
+  QCOMPARE(first.size(), 75u);
+  first.join(avl_tree_t<int, arena_t>{ 200 });
+  QCOMPARE(first.size(), 76u);
+  QCOMPARE(first.right_most().get(), 200);
+  QCOMPARE(test_node(first.root()), 76u);
+}
+
+void TestAVLTree::
+benchmark_rebuild() {
+  std::vector<int> sorted(100000);
+  std::iota(sorted.begin(), sorted.end(), 0);
+  avl_tree_t<int> tree;
+  QBENCHMARK {
+    tree.rebuild(sorted.begin(), sorted.end());
+  }
+}
+
+void TestAVLTree::
+benchmark_set_union() {
+  std::vector<int> even(200000), odd(200000);
+  for (int ii = 0; ii < 200000; ii++) {
+    even[ii] = 2 * ii;
+    odd[ii]  = 2 * ii + 1;
+  }
+  QBENCHMARK {
+    avl_tree_t<int> first, second;
+    first.rebuild(even.begin(), even.end());
+    second.rebuild(odd.begin(), odd.end());
+    first.set_union(std::move(second));
+  }
+}
+
+void TestAVLTree::
+test_trasversal_with_visitor() {
+  avl_tree_t<int> tree = get_test_tree();
+  std::vector<int> visited;
+  const auto visit { [&visited](const binary_node_t<int>& node) {
+      visited.push_back(node.get());
+      return false;
+    }
+  };
+
+  QCOMPARE(tree.in_order(visit), tree.size());
+  QVERIFY(std::equal(visited.begin(), visited.end(), tree.begin(), tree.end()));
+
+  std::vector<const binary_node_t<int>*> scratch;
+  visited.clear();
+  QCOMPARE(tree.breadth_first_search(visit, scratch), tree.size());
+  QCOMPARE(visited, std::vector<int>({ 7, 4, 10, 2, 5, 8, 12, 1, 3, 6, 9, 11 }));
+  visited.clear();
+  QCOMPARE(tree.depth_first_search(visit, scratch), tree.size());
+  QCOMPARE(visited, std::vector<int>({ 7, 4, 2, 1, 3, 5, 6, 10, 8, 9, 12, 11 }));
+
+  size_t steps = tree.breadth_first_search([](const auto& node) { return *node == 8; },
+                                           scratch);
+  QCOMPARE(steps, 6u);
+}
+
+void TestAVLTree::
+benchmark_bfs_std_function() {
+  std::vector<int> sorted(100000);
+  std::iota(sorted.begin(), sorted.end(), 0);
+  avl_tree_t<int> tree;
+  tree.rebuild(sorted.begin(), sorted.end());
+  long sum{ 0 };
+  const std::function<bool(const binary_node_t<int>&)> visit {
+    [&sum](const binary_node_t<int>& node) {
+      sum += node.get();
+      return false;
+    }
+  };
+  QBENCHMARK {
+    tree.breadth_first_search(visit);
+  }
+  QVERIFY(sum > 0);
+}
+
+void TestAVLTree::
+benchmark_bfs_visitor_with_scratch_buffer() {
+  std::vector<int> sorted(100000);
+  std::iota(sorted.begin(), sorted.end(), 0);
+  avl_tree_t<int> tree;
+  tree.rebuild(sorted.begin(), sorted.end());
+  long sum{ 0 };
+  std::vector<const binary_node_t<int>*> scratch;
+  QBENCHMARK {
+    tree.breadth_first_search([&sum](const binary_node_t<int>& node) {
+                                sum += node.get();
+                                return false;
+                              }, scratch);
+  }
+  QVERIFY(sum > 0);
+}
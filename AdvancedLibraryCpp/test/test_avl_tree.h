@@ -2,11 +2,60 @@
 
 #include <QObject>
 #include <QTest>
+#include <memory_resource>
+#include <random>
 #include "structures/binary_tree.h"
 
 namespace test {
 namespace structures {
 
+/**
+ * std::set like interface over avl_tree_t, so both can be benchmarked by the
+ * same code
+ */
+struct avl_set_adapter_t {
+  advanced::structures::avl_tree_t<int> tree;
+
+  inline void   insert(int key)      { tree.insert(key); }
+  inline size_t count(int key) const { return tree.contains(key); }
+  inline void   erase(int key)       { tree.remove(key); }
+};
+
+/**
+ * memory_resource that counts the allocations and forwards them to the heap,
+ * used as upstream to check which memory a tree uses. It throws
+ * std::bad_alloc once limit allocations are done, unless limit is zero.
+ */
+class counting_resource_t : public std::pmr::memory_resource {
+public:
+  size_t allocations{ 0 };
+  size_t live       { 0 };  // allocated and not deallocated yet
+  size_t limit      { 0 };
+
+protected:
+  void*
+  do_allocate(size_t bytes, size_t alignment) override {
+    if (limit && allocations == limit) {
+      throw std::bad_alloc{};
+    }
+    void* pointer{ std::pmr::new_delete_resource()->allocate(bytes, alignment) };
+    allocations++;
+    live++;
+    return pointer;
+  }
+
+  void
+  do_deallocate(void* pointer, size_t bytes, size_t alignment) override {
+    live--;
+    std::pmr::new_delete_resource()->deallocate(pointer, bytes, alignment);
+  }
+
+  bool
+  do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+    return this == &other;
+  }
+};
+
 class moc_avl_node {
 public:
   moc_avl_node() = default;
@@ -51,9 +100,9 @@ class TestAVLTree : public QObject
 public:
   explicit TestAVLTree(QObject *parent = nullptr);
 
-  template<class T>
+  template<class T, bool order_statistics>
   size_t
-  test_node(const advanced::structures::binary_node_t<T>& node) {
+  test_node(const advanced::structures::binary_node_t<T, order_statistics>& node) {
     size_t counter{ 1 };
     if (node.has_left()) {
       if (node.left().get() > node.get()) {
@@ -72,6 +121,51 @@ public:
 
   advanced::structures::avl_tree_t<int> get_test_tree();
 
+  /**
+   * Inserts and removes the shuffled keys, used to compare node allocators
+   */
+  template <class tree_t>
+  void
+  insert_remove(tree_t& tree, const std::vector<int>& keys) {
+    for (const auto& key : keys) {
+      tree.insert(key);
+    }
+    for (size_t ii = 0; ii < keys.size(); ii += 2) {
+      tree.remove(keys[ii]);
+    }
+    for (size_t ii = 0; ii < keys.size(); ii += 2) {
+      tree.insert(keys[ii]);
+    }
+    tree.clear();
+  }
+
+  /**
+   * Inserts, searches and removes all keys, used to compare with std::set
+   */
+  template <class container_t>
+  size_t
+  insert_find_remove(container_t& container, const std::vector<int>& keys) {
+    size_t found{ 0 };
+    for (const auto& key : keys) {
+      container.insert(key);
+    }
+    for (const auto& key : keys) {
+      found += container.count(key);
+    }
+    for (const auto& key : keys) {
+      container.erase(key);
+    }
+    return found;
+  }
+
+  std::vector<int>
+  shuffled_keys(size_t count) const {
+    std::vector<int> keys(count);
+    std::iota(keys.begin(), keys.end(), 0);
+    std::shuffle(keys.begin(), keys.end(), std::mt19937{ 42 });
+    return keys;
+  }
+
 private slots:
 
   void test_has_left();
@@ -102,5 +196,36 @@ private slots:
   void test_bfs();
   void test_dfs();
   void test_search_value();
+  void test_arena_allocator();
+  void test_arena_allocator_copy_and_move();
+  void test_pmr_allocator();
+  void benchmark_heap_insert_remove();
+  void benchmark_arena_insert_remove();
+  void benchmark_pmr_pool_insert_remove();
+  void test_parent_links_after_rotations();
+  void test_random_operations_should_match_std_set();
+  void benchmark_random_keys();
+  void benchmark_random_keys_std_set();
+  void benchmark_sorted_keys();
+  void benchmark_sorted_keys_std_set();
+  void benchmark_reverse_sorted_keys();
+  void benchmark_reverse_sorted_keys_std_set();
+  void test_iterators();
+  void test_iterators_on_empty_tree();
+  void test_lower_and_upper_bound();
+  void test_equal_range_with_duplicates();
+  void test_order_statistics();
+  void test_order_statistics_should_match_a_sorted_vector();
+  void test_order_statistics_node_layout();
+  void test_rebuild_from_sorted_range();
+  void test_rebuild_should_free_nodes_when_it_throws();
+  void test_split_and_join();
+  void test_set_operations_should_match_std_algorithms();
+  void test_set_operations_with_arena_allocator();
+  void benchmark_rebuild();
+  void benchmark_set_union();
+  void test_trasversal_with_visitor();
+  void benchmark_bfs_std_function();
+  void benchmark_bfs_visitor_with_scratch_buffer();
 };
 
@@ -0,0 +1,254 @@
+#include "test_b_plus_tree.h"
+
+#include <algorithm>
+#include <numeric>
+#include <random>
+#include <set>
+#include <string>
+#include <vector>
+#include "../structures/binary_tree.h"
+#include "lookup_data.h"
+
+using namespace advanced::structures;
+using test::structures::lookup_data_t;
+
+TestBPlusTree::
+TestBPlusTree(QObject *parent) : QObject(parent) {
+  QObject::setObjectName("TestBPlusTree");
+}
+
+void TestBPlusTree::
+test_insert_and_contains() {
+  b_plus_tree_t<int, 4> tree;
+  for (const int value : { 7, 4, 10, 2, 5, 8, 12, 1, 3, 6, 9, 11 }) {
+    QVERIFY(tree.insert(value));
+  }
+  QVERIFY(!tree.insert(5));
+  QCOMPARE(tree.size(), 12u);
+  QCOMPARE(tree.height(), 2u);
+  for (int value = 1; value <= 12; value++) {
+    QVERIFY(tree.contains(value));
+  }
+  QVERIFY(!tree.contains(0));
+  QVERIFY(!tree.contains(13));
+  QCOMPARE(tree.left_most(),  1);
+  QCOMPARE(tree.right_most(), 12);
+}
+
+void TestBPlusTree::
+test_remove() {
+  b_plus_tree_t<int, 4> tree;
+  for (int value = 0; value < 100; value++) {
+    tree.insert(value);
+  }
+  for (int value = 0; value < 100; value += 2) {
+    QVERIFY(tree.remove(value));
+  }
+  QVERIFY(!tree.remove(0));
+  QCOMPARE(tree.size(), 50u);
+  for (int value = 0; value < 100; value++) {
+    QCOMPARE(tree.contains(value), value % 2 == 1);
+  }
+
+  // the tree shrinks back to a single leaf
+  for (int value = 1; value < 95; value += 2) {
+    QVERIFY(tree.remove(value));
+  }
+  QCOMPARE(tree.size(), 3u);
+  QCOMPARE(tree.height(), 1u);
+  QVERIFY(std::equal(tree.begin(), tree.end(), std::vector<int>{ 95, 97, 99 }.begin()));
+
+  for (const int value : { 97, 95, 99 }) {
+    QVERIFY(tree.remove(value));
+  }
+  QVERIFY(tree.empty());
+  QCOMPARE(tree.height(), 0u);
+  QVERIFY(tree.begin() == tree.end());
+}
+
+void TestBPlusTree::
+test_iterators() {
+  b_plus_tree_t<int, 5> tree;
+  std::vector<int> expected;
+  for (int value = 100; value > 0; value -= 3) {
+    tree.insert(value);
+    expected.insert(expected.begin(), value);
+  }
+  QCOMPARE(size_t(std::distance(tree.begin(), tree.end())), expected.size());
+  QVERIFY(std::equal(tree.begin(), tree.end(), expected.begin()));
+  QVERIFY(std::equal(tree.rbegin(), tree.rend(), expected.rbegin()));
+
+  auto it{ tree.end() };
+  QCOMPARE(*--it, 100);
+  QCOMPARE(*--it, 97);
+  QCOMPARE(*it++, 97);
+  QVERIFY(++it == tree.end());
+  QCOMPARE(*tree.begin(), 1);
+}
+
+void TestBPlusTree::
+test_lower_and_upper_bound() {
+  b_plus_tree_t<int, 4> tree;
+  for (int value = 0; value <= 100; value += 10) {
+    tree.insert(value);
+  }
+  QCOMPARE(*tree.lower_bound(30), 30);
+  QCOMPARE(*tree.upper_bound(30), 40);
+  QCOMPARE(*tree.lower_bound(31), 40);
+  QCOMPARE(*tree.upper_bound(-1), 0);
+  QVERIFY(tree.lower_bound(101) == tree.end());
+  QVERIFY(tree.upper_bound(100) == tree.end());
+  QCOMPARE(*tree.find(70), 70);
+  QVERIFY(tree.find(75) == tree.end());
+
+  // range scan over the linked leaves
+  std::vector<int> range(tree.lower_bound(25), tree.upper_bound(80));
+  QVERIFY((range == std::vector<int>{ 30, 40, 50, 60, 70, 80 }));
+}
+
+void TestBPlusTree::
+test_random_operations_should_match_std_set() {
+  std::mt19937 generator{ 11 };
+  std::uniform_int_distribution<int> key{ 0, 2000 };
+  b_plus_tree_t<int, 6> tree;
+  std::set<int> expected;
+
+  for (int ii = 0; ii < 50000; ii++) {
+    const int value{ key(generator) };
+    if (generator() % 3) {
+      QCOMPARE(tree.insert(value), expected.insert(value).second);
+    }
+    else {
+      QCOMPARE(tree.remove(value), expected.erase(value) == 1u);
+    }
+  }
+  QCOMPARE(tree.size(), expected.size());
+  QVERIFY(std::equal(tree.begin(), tree.end(), expected.begin(), expected.end()));
+  for (int value = 0; value <= 2000; value++) {
+    QCOMPARE(tree.contains(value), expected.count(value) == 1u);
+  }
+}
+
+void TestBPlusTree::
+test_rebuild_from_sorted_range() {
+  const std::vector<int> values{ 1, 2, 2, 3, 5, 8, 8, 8, 13, 21 };
+  b_plus_tree_t<int, 4> tree;
+  tree.insert(100);
+  tree.rebuild(values.begin(), values.end());
+  QCOMPARE(tree.size(), 7u);
+  QVERIFY(!tree.contains(100));
+  QVERIFY(std::equal(tree.begin(), tree.end(),
+                     std::vector<int>{ 1, 2, 3, 5, 8, 13, 21 }.begin()));
+
+  std::vector<int> sorted(1000);
+  std::iota(sorted.begin(), sorted.end(), 0);
+  tree.rebuild(sorted.begin(), sorted.end());
+  QCOMPARE(tree.size(), 1000u);
+  QCOMPARE(tree.height(), 5u);
+  for (int value = 0; value < 1000; value += 2) {
+    QVERIFY(tree.remove(value));
+    QVERIFY(tree.insert(value + 1000));
+  }
+  QCOMPARE(tree.size(), 1000u);
+  QVERIFY(std::is_sorted(tree.begin(), tree.end()));
+  QCOMPARE(tree.left_most(), 1);
+  QCOMPARE(tree.right_most(), 1998);
+
+  const std::vector<int> unsorted{ 1, 3, 2 };
+  QVERIFY_EXCEPTION_THROWN(tree.rebuild(unsorted.begin(), unsorted.end()),
+                           std::invalid_argument);
+  QVERIFY(tree.empty());
+}
+
+void TestBPlusTree::
+test_copy_and_move() {
+  b_plus_tree_t<int, 4> tree;
+  for (int value = 0; value < 50; value++) {
+    tree.insert(value);
+  }
+  b_plus_tree_t<int, 4> copied{ tree };
+  copied.remove(10);
+  QVERIFY(tree.contains(10));
+  QCOMPARE(copied.size(), 49u);
+
+  b_plus_tree_t<int, 4> moved{ std::move(copied) };
+  QCOMPARE(moved.size(), 49u);
+  QVERIFY(copied.empty());
+  QVERIFY(copied.begin() == copied.end());
+
+  moved = tree;
+  QCOMPARE(moved.size(), 50u);
+  tree = std::move(moved);
+  QCOMPARE(tree.size(), 50u);
+  QCOMPARE(*std::prev(tree.end()), 49);
+}
+
+void TestBPlusTree::
+test_string_keys() {
+  b_plus_tree_t<std::string, 5> tree;
+  std::set<std::string> expected;
+  for (int ii = 0; ii < 500; ii++) {
+    const std::string value{ std::to_string(ii * 7919 % 1000) };
+    QCOMPARE(tree.insert(value), expected.insert(value).second);
+  }
+  for (int ii = 0; ii < 500; ii += 3) {
+    const std::string value{ std::to_string(ii) };
+    QCOMPARE(tree.remove(value), expected.erase(value) == 1u);
+  }
+  QCOMPARE(tree.size(), expected.size());
+  QVERIFY(std::equal(tree.begin(), tree.end(), expected.begin(), expected.end()));
+  QCOMPARE(*tree.lower_bound("5"), *expected.lower_bound("5"));
+}
+
+void TestBPlusTree::
+test_empty_tree() {
+  b_plus_tree_t<int> tree;
+  QVERIFY(tree.empty());
+  QVERIFY(!tree.contains(1));
+  QVERIFY(!tree.remove(1));
+  QVERIFY(tree.begin() == tree.end());
+  QVERIFY(tree.lower_bound(1) == tree.end());
+  QVERIFY_EXCEPTION_THROWN(tree.left_most(),  std::out_of_range);
+  QVERIFY_EXCEPTION_THROWN(tree.right_most(), std::out_of_range);
+}
+
+void TestBPlusTree::
+benchmark_lookup() {
+  const lookup_data_t data;
+  b_plus_tree_t<int> tree;
+  tree.rebuild(data.keys.begin(), data.keys.end());
+  size_t found{ 0 };
+  QBENCHMARK {
+    for (const auto& query : data.queries) {
+      found += tree.contains(query);
+    }
+  }
+  QVERIFY(found > 0);
+}
+
+void TestBPlusTree::
+benchmark_lookup_avl_tree() {
+  const lookup_data_t data;
+  avl_tree_t<int> tree;
+  tree.rebuild(data.keys.begin(), data.keys.end());
+  size_t found{ 0 };
+  QBENCHMARK {
+    for (const auto& query : data.queries) {
+      found += tree.contains(query);
+    }
+  }
+  QVERIFY(found > 0);
+}
+
+void TestBPlusTree::
+benchmark_lookup_std_set() {
+  const lookup_data_t data;
+  const std::set<int> tree(data.keys.begin(), data.keys.end());
+  size_t found{ 0 };
+  QBENCHMARK {
+    for (const auto& query : data.queries) {
+      found += tree.count(query);
+    }
+  }
+  QVERIFY(found > 0);
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <QObject>
+#include <QTest>
+
+#include "../structures/b_plus_tree.h"
+
+class TestBPlusTree : public QObject
+{
+  Q_OBJECT
+public:
+  explicit TestBPlusTree(QObject *parent = nullptr);
+
+private slots:
+
+  void test_insert_and_contains();
+  void test_remove();
+  void test_iterators();
+  void test_lower_and_upper_bound();
+  void test_random_operations_should_match_std_set();
+  void test_rebuild_from_sorted_range();
+  void test_copy_and_move();
+  void test_string_keys();
+  void test_empty_tree();
+  void benchmark_lookup();
+  void benchmark_lookup_avl_tree();
+  void benchmark_lookup_std_set();
+};
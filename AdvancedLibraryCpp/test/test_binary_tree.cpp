@@ -1,4 +1,7 @@
 #include "test_binary_tree.h"
+#include <algorithm>
+#include <iterator>
+#include <type_traits>
 
 using namespace advanced::structures;
 
@@ -692,3 +695,99 @@ test_search_value() {
   steps = tree.depth_first_search([](auto& node) { return *node == 12; });
   QCOMPARE(steps, 11u);
 }
+
+void TestBinaryTree::
+test_tree_allocator() {
+  using arena_t = arena_node_allocator_t<binary_node_t<std::string>>;
+  using direction = binary_node_t<std::string>::direction;
+  binary_tree_t<std::string, arena_t> tree{ arena_t{ 2 } };
+  auto& root{ tree.add_root("grandpa").root() };
+  QVERIFY(tree.add_left(root, "father"));
+  QVERIFY(!tree.add_left(root, "step-father"));
+  QVERIFY(tree.add_right(root, "uncle"));
+  QVERIFY(tree.add_left(root.left(), "son"));
+  QCOMPARE(tree.get_allocator().size(), 4u);
+  QCOMPARE(root.left().left().parent().get(), "father");
+
+  binary_tree_t<std::string, arena_t> copied{ tree };
+  QVERIFY(tree.delete_child(root, direction::left));
+  QVERIFY(!tree.delete_child(root, direction::left));
+  QCOMPARE(tree.get_allocator().size(), 2u);
+  QCOMPARE(copied.get_allocator().size(), 4u);
+  QCOMPARE(copied.root().left().left().get(), "son");
+
+  std::vector<std::string> visited;
+  copied.pre_order([&visited](const binary_node_t<std::string>& node) {
+    visited.push_back(node.get());
+    return false;
+  });
+  QCOMPARE(visited,
+           std::vector<std::string>({ "grandpa", "father", "son", "uncle" }));
+
+  tree.clear();
+  QCOMPARE(tree.get_allocator().capacity(), 0u);
+}
+
+void TestBinaryTree::
+test_in_order_iterator() {
+  const binary_tree_t<int> tree = get_test_tree();
+  std::vector<int> expected;
+  tree.in_order([&expected](const binary_node_t<int>& node) {
+    expected.push_back(node.get());
+    return false;
+  });
+  QCOMPARE(std::vector<int>(tree.begin(), tree.end()), expected);
+  QCOMPARE(std::vector<int>(tree.rbegin(), tree.rend()),
+           std::vector<int>(expected.rbegin(), expected.rend()));
+}
+
+void TestBinaryTree::
+test_deep_copy_and_move() {
+  static_assert(std::is_nothrow_move_constructible<binary_tree_t<int>>::value, "O(1) move");
+  static_assert(std::is_nothrow_move_assignable<binary_tree_t<int>>::value, "O(1) move");
+  static_assert(std::is_nothrow_move_constructible<avl_tree_t<int>>::value, "O(1) move");
+  static_assert(std::is_nothrow_move_constructible<binary_node_t<int>>::value, "O(1) move");
+
+  binary_tree_t<int> tree = get_test_tree();
+  binary_tree_t<int> copy{ tree };
+  copy.root().left().left().get() = 20;
+  QCOMPARE(tree.root().left().left().get(), 2);
+  QCOMPARE(&copy.root().left().left().parent(), &copy.root().left());
+  QVERIFY(std::equal(tree.begin(), tree.end(), get_test_tree().begin()));
+
+  // a node copied from a non-const reference is a deep copy without parent
+  auto& four{ tree.root().left() };
+  binary_node_t<int> node{ four };
+  QVERIFY(!node.has_parent());
+  QCOMPARE(node.children_count(), 2u);
+  QCOMPARE(node.left().left().get(), 1);
+  QCOMPARE(node.right().right().get(), 6);
+  QCOMPARE(&node.left().parent(), &node);
+  node = tree.root().right();
+  QCOMPARE(node.get(), 10);
+  QCOMPARE(node.right().left().get(), 11);
+  QCOMPARE(tree.root().right().right().left().get(), 11);
+
+  binary_tree_t<int> moved{ std::move(copy) };
+  QVERIFY(!copy.has_root());
+  QCOMPARE(moved.root().left().left().get(), 20);
+  copy = std::move(moved);
+  QVERIFY(!moved.has_root());
+  QCOMPARE(copy.root().get(), 7);
+}
+
+void TestBinaryTree::
+test_copy_deep_tree() {
+  // a degenerate tree deeper than the call stack could copy recursively
+  binary_tree_t<int> chain(0);
+  auto* node{ &chain.root() };
+  for (int ii = 1; ii < 1000000; ii++) {
+    node->add_right(ii);
+    node = &node->right();
+  }
+  const binary_tree_t<int> copy{ chain };
+  QCOMPARE(std::distance(copy.begin(), copy.end()), 1000000);
+  QCOMPARE(*std::prev(copy.end()), 999999);
+  chain.clear();
+  QVERIFY(!chain.has_root());
+}
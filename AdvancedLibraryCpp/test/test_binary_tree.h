@@ -61,5 +61,9 @@ private slots:
   void test_bfs();
   void test_dfs();
   void test_search_value();
+  void test_tree_allocator();
+  void test_in_order_iterator();
+  void test_deep_copy_and_move();
+  void test_copy_deep_tree();
 };
 
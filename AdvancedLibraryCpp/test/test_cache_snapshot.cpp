@@ -0,0 +1,156 @@
+#include "test_cache_snapshot.h"
+
+#include <cstdio>
+#include <fstream>
+#include <thread>
+
+using advanced::structures::cache_t;
+using advanced::structures::save_snapshot;
+using advanced::structures::load_snapshot;
+using advanced::structures::snapshot_exception_t;
+using advanced::structures::snapshot_timer_t;
+using advanced::concurrency::lockable_t;
+
+namespace {
+const std::string snapshot_path{ "test_cache_snapshot.bin" };
+}
+
+TestCacheSnapshot::
+TestCacheSnapshot(QObject *parent) : QObject(parent) {
+  QObject::setObjectName("TestCacheSnapshot");
+}
+
+void TestCacheSnapshot::
+test_snapshot_should_preserve_recency_order() {
+  const std::list<long> input {
+    34l, 3l, 5l, 67l, -345l, 9230797509l, -28394834l
+  };
+
+  cache_t<long> cache, restored;
+  for (auto it = input.rbegin(); it != input.rend(); it++) {
+    cache.add(*it);
+  }
+  (void)cache.find(67l);
+
+  save_snapshot(cache, snapshot_path);
+  QCOMPARE(load_snapshot(restored, snapshot_path), input.size());
+  QCOMPARE(restored.values(), cache.values());
+  QCOMPARE(restored.most_recent(), 67l);
+  QCOMPARE(restored.least_recent(), -28394834l);
+  std::remove(snapshot_path.c_str());
+}
+
+void TestCacheSnapshot::
+test_snapshot_with_string_keys() {
+  const std::list<std::string> input {
+    "alabama", "new york", "", "washington", "illinois", "california",
+    "texas", "new mexico"
+  };
+
+  cache_t<std::string> cache, restored;
+  for (auto it = input.rbegin(); it != input.rend(); it++) {
+    cache.add(*it);
+  }
+
+  save_snapshot(cache, snapshot_path);
+  QCOMPARE(load_snapshot(restored, snapshot_path), input.size());
+  QCOMPARE(restored.values(), input);
+  std::remove(snapshot_path.c_str());
+}
+
+void TestCacheSnapshot::
+test_restore_into_smaller_cache_should_keep_most_recent_keys() {
+  cache_t<int> cache{ 100 };
+  for (int ii = 0; ii < 100; ii++) {
+    cache.add(ii);
+  }
+
+  cache_t<int> restored{ 10 };
+  save_snapshot(cache, snapshot_path);
+  QCOMPARE(load_snapshot(restored, snapshot_path), 10u);
+  QCOMPARE(restored.most_recent(),  99);
+  QCOMPARE(restored.least_recent(), 90);
+  QCOMPARE(restored.clipped(), 0u);
+  std::remove(snapshot_path.c_str());
+}
+
+void TestCacheSnapshot::
+test_restore_should_replace_previous_content() {
+  cache_t<int> cache, restored;
+  cache.add(1).add(2);
+  restored.add(3).add(4).add(5);
+
+  save_snapshot(cache, snapshot_path);
+  QCOMPARE(load_snapshot(restored, snapshot_path), 2u);
+  QVERIFY(!restored.contains(3));
+  QCOMPARE(restored.values(), (std::list<int>{ 2, 1 }));
+  std::remove(snapshot_path.c_str());
+}
+
+void TestCacheSnapshot::
+test_invalid_snapshots_should_throw() {
+  cache_t<std::string> cache;
+  cache.add("some value");
+  QVERIFY_EXCEPTION_THROWN(load_snapshot(cache, "missing_snapshot.bin"),
+                           snapshot_exception_t);
+
+  {
+    std::ofstream out{ snapshot_path, std::ios::binary };
+    out << "definitely not a snapshot";
+  }
+  QVERIFY_EXCEPTION_THROWN(load_snapshot(cache, snapshot_path),
+                           snapshot_exception_t);
+  QVERIFY(cache.contains("some value"));
+
+  // truncated snapshot:
+  cache.add("another value");
+  save_snapshot(cache, snapshot_path);
+  std::string content;
+  {
+    std::ifstream in{ snapshot_path, std::ios::binary };
+    content.assign(std::istreambuf_iterator<char>{ in }, {});
+  }
+  {
+    std::ofstream out{ snapshot_path, std::ios::binary | std::ios::trunc };
+    out.write(content.data(), static_cast<std::streamsize>(content.size() - 3));
+  }
+  QVERIFY_EXCEPTION_THROWN(load_snapshot(cache, snapshot_path),
+                           snapshot_exception_t);
+  std::remove(snapshot_path.c_str());
+}
+
+void TestCacheSnapshot::
+test_empty_snapshot() {
+  cache_t<int> cache, restored;
+  restored.add(1);
+  save_snapshot(cache, snapshot_path);
+  QCOMPARE(load_snapshot(restored, snapshot_path), 0u);
+  QVERIFY(restored.empty());
+  std::remove(snapshot_path.c_str());
+}
+
+void TestCacheSnapshot::
+test_background_snapshots() {
+  using lockable_cache_t = lockable_t<cache_t<int>>;
+  lockable_cache_t cache{ 1000 };
+  {
+    snapshot_timer_t<lockable_cache_t> snapshots{ cache, snapshot_path, 5 };
+    snapshots.start();
+    for (int ii = 0; ii < 1000; ii++) {
+      std::lock_guard<lockable_cache_t> guard{ cache };
+      cache.add(ii);
+    }
+    // wait for a snapshot started after the last insertion:
+    const size_t taken{ snapshots.snapshots() };
+    while (snapshots.snapshots() < taken + 2) {
+      std::this_thread::sleep_for(std::chrono::milliseconds{ 5 });
+    }
+    snapshots.stop(true);
+    QCOMPARE(snapshots.failures(), 0u);
+  }
+
+  cache_t<int> restored{ 1000 };
+  QCOMPARE(load_snapshot(restored, snapshot_path), 1000u);
+  QCOMPARE(restored.values(), cache.values());
+  std::remove(snapshot_path.c_str());
+}
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <QObject>
+#include <QTest>
+
+#include <string>
+#include "../structures/cache_snapshot.h"
+#include "../concurrency/safe.h"
+
+class TestCacheSnapshot : public QObject
+{
+  Q_OBJECT
+public:
+  explicit TestCacheSnapshot(QObject *parent = nullptr);
+
+private slots:
+
+  void test_snapshot_should_preserve_recency_order();
+  void test_snapshot_with_string_keys();
+  void test_restore_into_smaller_cache_should_keep_most_recent_keys();
+  void test_restore_should_replace_previous_content();
+  void test_invalid_snapshots_should_throw();
+  void test_empty_snapshot();
+  void test_background_snapshots();
+};
@@ -0,0 +1,178 @@
+#include "test_compact_avl_tree.h"
+
+#include <cmath>
+#include <random>
+#include <set>
+#include <string>
+#include <vector>
+#include "../structures/binary_tree.h"
+
+using namespace advanced::structures;
+
+namespace {
+
+template <class T>
+std::vector<T>
+values(const compact_avl_tree_t<T>& tree) {
+  std::vector<T> result;
+  tree.in_order([&result](const T& value) {
+    result.push_back(value);
+    return false;
+  });
+  return result;
+}
+
+bool
+is_balanced(size_t height, size_t size) {
+  // an AVL tree is never higher than 1.44 log2(n + 2)
+  return height <= 1.45 * std::log2(size + 2.0);
+}
+
+}
+
+TestCompactAVLTree::
+TestCompactAVLTree(QObject *parent) : QObject(parent) {
+  QObject::setObjectName("TestCompactAVLTree");
+}
+
+void TestCompactAVLTree::
+test_node_layout() {
+  QCOMPARE(compact_avl_tree_t<int>::bytes_per_node, 12u);
+  QVERIFY(2 * compact_avl_tree_t<int>::bytes_per_node <=
+          sizeof(binary_node_t<int>));
+  QCOMPARE(compact_avl_tree_t<double>::bytes_per_node, 16u);
+}
+
+void TestCompactAVLTree::
+test_insert_and_contains() {
+  compact_avl_tree_t<int> tree;
+  for (const int value : { 7, 4, 10, 2, 5, 8, 12, 1, 3, 6, 9, 11 }) {
+    QVERIFY(tree.insert(value));
+  }
+  QVERIFY(!tree.insert(5));
+  QCOMPARE(tree.size(), 12u);
+  QCOMPARE(tree.height(), 4u);
+  for (int value = 1; value <= 12; value++) {
+    QVERIFY(tree.contains(value));
+  }
+  QVERIFY(!tree.contains(0));
+  QVERIFY(!tree.contains(13));
+  QCOMPARE(tree.left_most(),  1);
+  QCOMPARE(tree.right_most(), 12);
+}
+
+void TestCompactAVLTree::
+test_remove() {
+  compact_avl_tree_t<std::string> tree;
+  for (const char* color : { "magenta", "brown", "silver", "blue", "orange",
+                             "cyan", "yellow" }) {
+    tree.insert(color);
+  }
+  QVERIFY(tree.remove("magenta"));   // two children
+  QVERIFY(tree.remove("blue"));      // leaf
+  QVERIFY(!tree.remove("blue"));
+  QVERIFY(tree.remove("brown"));     // one child
+  QCOMPARE(tree.size(), 4u);
+  QCOMPARE(values(tree), std::vector<std::string>({
+    "cyan", "orange", "silver", "yellow" }));
+
+  // removed nodes are reused
+  const size_t memory{ tree.memory_usage() };
+  tree.insert("white");
+  tree.insert("black");
+  tree.insert("red");
+  QCOMPARE(tree.memory_usage(), memory);
+  QCOMPARE(tree.size(), 7u);
+  QVERIFY(tree.contains("black"));
+}
+
+void TestCompactAVLTree::
+test_in_order() {
+  compact_avl_tree_t<int> tree;
+  for (const int value : { 5, 3, 8, 1, 4, 9 }) {
+    tree.insert(value);
+  }
+  QCOMPARE(values(tree), std::vector<int>({ 1, 3, 4, 5, 8, 9 }));
+
+  std::vector<int> visited;
+  const size_t count{ tree.in_order([&visited](int value) {
+    visited.push_back(value);
+    return value == 4;
+  }) };
+  QCOMPARE(count, 3u);
+  QCOMPARE(visited, std::vector<int>({ 1, 3, 4 }));
+}
+
+void TestCompactAVLTree::
+test_random_operations_should_match_std_set() {
+  std::mt19937 generator{ 7 };
+  std::uniform_int_distribution<int> key{ 0, 2000 };
+  compact_avl_tree_t<int> tree;
+  std::set<int> expected;
+
+  for (int ii = 0; ii < 20000; ii++) {
+    const int value{ key(generator) };
+    if (generator() % 3) {
+      QCOMPARE(tree.insert(value), expected.insert(value).second);
+    }
+    else {
+      QCOMPARE(tree.remove(value), expected.erase(value) == 1u);
+    }
+    QCOMPARE(tree.size(), expected.size());
+  }
+  QCOMPARE(values(tree), std::vector<int>(expected.begin(), expected.end()));
+  QVERIFY(is_balanced(tree.height(), tree.size()));
+  for (int value = 0; value <= 2000; value++) {
+    QCOMPARE(tree.contains(value), expected.count(value) == 1u);
+  }
+}
+
+void TestCompactAVLTree::
+test_sorted_insertion_should_stay_balanced() {
+  compact_avl_tree_t<int> tree;
+  tree.reserve(1 << 16);
+  for (int value = 0; value < (1 << 16); value++) {
+    tree.insert(value);
+  }
+  QCOMPARE(tree.height(), 17u);
+  for (int value = 0; value < (1 << 16); value += 2) {
+    QVERIFY(tree.remove(value));
+  }
+  QCOMPARE(tree.size(), size_t(1 << 15));
+  QVERIFY(is_balanced(tree.height(), tree.size()));
+  QCOMPARE(tree.left_most(), 1);
+}
+
+void TestCompactAVLTree::
+test_duplicates() {
+  compact_avl_tree_t<int> tree;
+  tree.enable_duplicates();
+  QVERIFY(tree.is_multiple_keys_allowed());
+  for (int ii = 0; ii < 10; ii++) {
+    QVERIFY(tree.insert(ii % 3));
+  }
+  QCOMPARE(values(tree), std::vector<int>({ 0, 0, 0, 0, 1, 1, 1, 2, 2, 2 }));
+  QVERIFY(tree.remove(0));
+  QVERIFY(tree.remove(0));
+  QCOMPARE(tree.size(), 8u);
+  QVERIFY(tree.contains(0));
+
+  tree.disable_duplicates();
+  QVERIFY(!tree.insert(1));
+}
+
+void TestCompactAVLTree::
+test_empty_tree() {
+  compact_avl_tree_t<int> tree;
+  QVERIFY(tree.empty());
+  QCOMPARE(tree.height(), 0u);
+  QVERIFY(!tree.contains(1));
+  QVERIFY(!tree.remove(1));
+  QVERIFY_EXCEPTION_THROWN(tree.left_most(), std::out_of_range);
+  QVERIFY_EXCEPTION_THROWN(tree.right_most(), std::out_of_range);
+
+  tree.insert(1);
+  tree.clear();
+  QVERIFY(tree.empty());
+  QCOMPARE(values(tree), std::vector<int>());
+}
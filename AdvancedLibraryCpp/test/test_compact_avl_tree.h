@@ -0,0 +1,24 @@
+#pragma once
+
+#include <QObject>
+#include <QTest>
+
+#include "../structures/compact_avl_tree.h"
+
+class TestCompactAVLTree : public QObject
+{
+  Q_OBJECT
+public:
+  explicit TestCompactAVLTree(QObject *parent = nullptr);
+
+private slots:
+
+  void test_node_layout();
+  void test_insert_and_contains();
+  void test_remove();
+  void test_in_order();
+  void test_random_operations_should_match_std_set();
+  void test_sorted_insertion_should_stay_balanced();
+  void test_duplicates();
+  void test_empty_tree();
+};
@@ -0,0 +1,236 @@
+#include "test_concurrent_skip_list.h"
+
+#include <algorithm>
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include "../structures/binary_tree.h"
+
+using namespace advanced::structures;
+
+namespace {
+
+constexpr int    read_keys   { 100000 };
+constexpr size_t read_threads{ 4 };
+
+/**
+ * It runs func(thread index) in count threads and waits for them
+ */
+template <class function_t>
+void
+run_threads(size_t count, function_t func) {
+  std::vector<std::thread> threads;
+  for (size_t ii = 0; ii < count; ii++) {
+    threads.emplace_back(func, ii);
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+}
+
+}
+
+TestConcurrentSkipList::
+TestConcurrentSkipList(QObject *parent) : QObject(parent) {
+  QObject::setObjectName("TestConcurrentSkipList");
+}
+
+void TestConcurrentSkipList::
+test_insert_remove_and_contains() {
+  concurrent_skip_list_t<int, int> map;
+  QVERIFY(map.empty());
+  for (const int key : { 7, 4, 10, 2, 5, 8, 12 }) {
+    QVERIFY(map.insert(key, key * 10));
+  }
+  QVERIFY(!map.insert(5, 0));
+  QCOMPARE(map.size(), 7u);
+  QVERIFY(map.contains(5));
+  QVERIFY(!map.contains(6));
+
+  QVERIFY(map.remove(5));
+  QVERIFY(!map.remove(5));
+  QVERIFY(!map.contains(5));
+  QVERIFY(map.insert(5, 1));
+  QCOMPARE(map.size(), 7u);
+}
+
+void TestConcurrentSkipList::
+test_find() {
+  concurrent_skip_list_t<std::string, int> map;
+  map.insert("one", 1);
+  map.insert("two", 2);
+  QCOMPARE(map.find("two").value(), 2);
+  QVERIFY(!map.find("three").has_value());
+  map.remove("two");
+  QVERIFY(!map.find("two").has_value());
+}
+
+void TestConcurrentSkipList::
+test_for_each_range() {
+  concurrent_skip_list_t<int, int> map;
+  for (int key = 100; key > 0; key -= 10) {
+    map.insert(key, -key);
+  }
+  std::vector<int> keys;
+  const size_t visited{ map.for_each(25, 70, [&keys](int key, int value) {
+    keys.push_back(key);
+    return key != -value;
+  })};
+  QCOMPARE(visited, 4u);
+  QVERIFY((keys == std::vector<int>{ 30, 40, 50, 60 }));
+
+  keys.clear();
+  map.for_each([&keys](int key, int) {
+    keys.push_back(key);
+    return key == 50;
+  });
+  QVERIFY((keys == std::vector<int>{ 10, 20, 30, 40, 50 }));
+}
+
+void TestConcurrentSkipList::
+test_random_operations_should_match_std_map() {
+  std::mt19937 generator{ 7 };
+  concurrent_skip_list_t<int, int> map;
+  std::map<int, int> expected;
+  for (int ii = 0; ii < 50000; ii++) {
+    const int key{ static_cast<int>(generator() % 2000) };
+    if (generator() % 2) {
+      QCOMPARE(map.insert(key, ii), expected.emplace(key, ii).second);
+    }
+    else {
+      QCOMPARE(map.remove(key), expected.erase(key) == 1u);
+    }
+  }
+  QCOMPARE(map.size(), expected.size());
+  auto it{ expected.begin() };
+  bool same{ true };
+  map.for_each([&](int key, int value) {
+    same &= it != expected.end() && it->first == key && it->second == value;
+    ++it;
+    return false;
+  });
+  QVERIFY(same);
+  QVERIFY(it == expected.end());
+}
+
+void TestConcurrentSkipList::
+test_concurrent_writers() {
+  concurrent_skip_list_t<int, int> map;
+  constexpr int threads{ 4 };
+  constexpr int keys   { 2000 };
+
+  // every thread inserts and removes its own keys, then inserts them all
+  run_threads(threads, [&map](size_t thread) {
+    std::mt19937 generator{ static_cast<unsigned>(thread) };
+    for (int ii = 0; ii < 20000; ii++) {
+      const int key{ static_cast<int>(generator() % keys) * threads +
+                     static_cast<int>(thread) };
+      generator() % 2 ? map.insert(key, key) : map.remove(key);
+    }
+    for (int key = static_cast<int>(thread); key < keys * threads; key += threads) {
+      map.insert(key, key);
+    }
+  });
+  QCOMPARE(map.size(), size_t(keys * threads));
+  int missing{ 0 };
+  for (int key = 0; key < keys * threads; key++) {
+    missing += !map.contains(key);
+  }
+  QCOMPARE(missing, 0);
+}
+
+void TestConcurrentSkipList::
+test_readers_during_writes() {
+  concurrent_skip_list_t<int, int> map;
+  for (int key = 0; key < 1000; key += 2) {
+    map.insert(key, key);
+  }
+  std::atomic_bool done  { false };
+  std::atomic_int  errors{ 0 };
+
+  // even keys are never removed, odd keys come and go
+  run_threads(3, [&](size_t thread) {
+    if (thread == 0) {
+      std::mt19937 generator{ 1 };
+      for (int ii = 0; ii < 50000; ii++) {
+        const int key{ static_cast<int>(generator() % 500) * 2 + 1 };
+        generator() % 2 ? map.insert(key, key) : map.remove(key);
+      }
+      done = true;
+      return;
+    }
+    while (!done) {
+      int previous{ -1 };
+      int even    { 0 };
+      map.for_each([&](int key, int value) {
+        errors += key <= previous || key != value;
+        even   += key % 2 == 0;
+        previous = key;
+        return false;
+      });
+      errors += even != 500;
+      errors += !map.contains(998);
+    }
+  });
+  QCOMPARE(errors.load(), 0);
+}
+
+void TestConcurrentSkipList::
+test_removed_nodes_are_reclaimed() {
+  concurrent_skip_list_t<std::string, std::string> map;
+  for (int ii = 0; ii < 10000; ii++) {
+    const std::string key{ std::to_string(ii % 100) };
+    map.insert(key, std::string(100, 'x'));
+    map.remove(key);
+  }
+  QVERIFY(map.empty());
+  // without readers the epoch advances at every collection
+  QVERIFY(map.pending_reclamation() < 128u);
+}
+
+void TestConcurrentSkipList::
+benchmark_concurrent_reads() {
+  concurrent_skip_list_t<int, int> map;
+  for (int key = 0; key < read_keys; key++) {
+    map.insert(key, key);
+  }
+  std::atomic_size_t found{ 0 };
+  QBENCHMARK {
+    run_threads(read_threads, [&](size_t thread) {
+      std::mt19937 generator{ static_cast<unsigned>(thread) };
+      size_t local{ 0 };
+      for (int ii = 0; ii < read_keys; ii++) {
+        local += map.contains(static_cast<int>(generator() % (2 * read_keys)));
+      }
+      found += local;
+    });
+  }
+  QVERIFY(found > 0);
+}
+
+void TestConcurrentSkipList::
+benchmark_concurrent_reads_locked_avl_tree() {
+  avl_tree_t<int> tree;
+  std::mutex      mtx;
+  for (int key = 0; key < read_keys; key++) {
+    tree.insert(key);
+  }
+  std::atomic_size_t found{ 0 };
+  QBENCHMARK {
+    run_threads(read_threads, [&](size_t thread) {
+      std::mt19937 generator{ static_cast<unsigned>(thread) };
+      size_t local{ 0 };
+      for (int ii = 0; ii < read_keys; ii++) {
+        const int key{ static_cast<int>(generator() % (2 * read_keys)) };
+        std::lock_guard<std::mutex> guard{ mtx };
+        local += tree.contains(key);
+      }
+      found += local;
+    });
+  }
+  QVERIFY(found > 0);
+}
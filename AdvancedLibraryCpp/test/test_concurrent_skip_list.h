@@ -0,0 +1,25 @@
+#pragma once
+
+#include <QObject>
+#include <QTest>
+
+#include "../structures/concurrent_skip_list.h"
+
+class TestConcurrentSkipList : public QObject
+{
+  Q_OBJECT
+public:
+  explicit TestConcurrentSkipList(QObject *parent = nullptr);
+
+private slots:
+
+  void test_insert_remove_and_contains();
+  void test_find();
+  void test_for_each_range();
+  void test_random_operations_should_match_std_map();
+  void test_concurrent_writers();
+  void test_readers_during_writes();
+  void test_removed_nodes_are_reclaimed();
+  void benchmark_concurrent_reads();
+  void benchmark_concurrent_reads_locked_avl_tree();
+};
@@ -0,0 +1,294 @@
+#include "test_flat_tree.h"
+
+#include <string>
+#include <vector>
+#include "../structures/binary_tree.h"
+
+using namespace advanced::structures;
+
+namespace {
+
+using layout_t     = flat_tree_t<std::string>::layout_t;
+using int_layout_t = flat_tree_t<int>::layout_t;
+using quad_tree_t  = tree_t<std::string, tree_node_t<std::string, 4>>;
+
+/**
+ * same tree than TestTree::get_test_tree
+ *                                    7
+ *  null                   4              null            10
+ *          1        2         5   6              8    9       11    13
+ *            nll nll  3 nll                                       12
+ */
+quad_tree_t
+get_test_tree() {
+  quad_tree_t tree("7");
+  tree.root().insert_at(1, "4");
+  tree.root().insert_at(3, "10");
+  tree.root().child(1).add_child("1");
+  tree.root().child(1).add_child("2");
+  tree.root().child(1).add_child("5");
+  tree.root().child(1).add_child("6");
+  tree.root().child(1).child(1).insert_at(2, "3");
+  tree.root().child(3).add_child("8");
+  tree.root().child(3).add_child("9");
+  tree.root().child(3).add_child("11");
+  tree.root().child(3).add_child("13");
+  tree.root().child(3).child(3).add_child("12");
+  return tree;
+}
+
+/**
+ * complete tree of the given height with 4 children per node
+ */
+tree_t<int, tree_node_t<int, 4>>
+full_quad_tree(int height) {
+  tree_t<int, tree_node_t<int, 4>> tree{ 0 };
+  std::vector<tree_node_t<int, 4>*> level{ &tree.root() };
+  int value{ 1 };
+  for (int depth = 0; depth < height; depth++) {
+    std::vector<tree_node_t<int, 4>*> next;
+    for (auto node : level) {
+      for (size_t child = 0; child < 4; child++) {
+        node->add_child(value++);
+        next.push_back(&node->child(child));
+      }
+    }
+    level.swap(next);
+  }
+  return tree;
+}
+
+template <class T>
+std::vector<T>
+breadth_first(const flat_tree_t<T>& tree) {
+  std::vector<T> visited;
+  tree.breadth_first_search([&](auto node) {
+    visited.push_back(tree[node]);
+    return false;
+  });
+  return visited;
+}
+
+template <class T>
+std::vector<T>
+depth_first(const flat_tree_t<T>& tree) {
+  std::vector<T> visited;
+  tree.depth_first_search([&](auto node) {
+    visited.push_back(tree[node]);
+    return false;
+  });
+  return visited;
+}
+
+/**
+ * every node is the parent of its children and the sibling of the next one
+ */
+template <class T>
+bool
+check_links(const flat_tree_t<T>& tree) {
+  using index_t = typename flat_tree_t<T>::index_t;
+  size_t children{ 0 };
+  for (index_t node = 0; node < tree.size(); node++) {
+    tree.for_each_child(node, [&](index_t child) {
+      children += tree.parent(child) == node;
+    });
+  }
+  return tree.empty() || children + 1 == tree.size();
+}
+
+}
+
+TestFlatTree::
+TestFlatTree(QObject *parent) : QObject{ parent } {
+  QObject::setObjectName("TestFlatTree");
+}
+
+void TestFlatTree::
+test_add_root_and_children() {
+  flat_tree_t<int> tree;
+  QVERIFY(tree.empty());
+  QVERIFY(!tree.has_root());
+  QCOMPARE(tree.breadth_first_search([](auto) { return false; }), 0u);
+  QVERIFY_EXCEPTION_THROWN(tree.add_child(0, 1), std::out_of_range);
+
+  QCOMPARE(tree.add_root(10), 0u);
+  QVERIFY_EXCEPTION_THROWN(tree.add_root(11), std::logic_error);
+  const auto first { tree.add_child(0, 20) };
+  const auto second{ tree.add_child(0, 30) };
+  const auto third { tree.add_child(first, 40) };
+  QCOMPARE(tree.size(), 4u);
+  QCOMPARE(tree[third], 40);
+  QCOMPARE(tree.parent(third), first);
+  QCOMPARE(tree.parent(0), flat_tree_t<int>::npos);
+  QCOMPARE(tree.first_child(0), first);
+  QCOMPARE(tree.next_sibling(first), second);
+  QCOMPARE(tree.next_sibling(second), flat_tree_t<int>::npos);
+  QCOMPARE(tree.first_child(second), flat_tree_t<int>::npos);
+  QCOMPARE(tree.children_count(0), 2u);
+  QCOMPARE(tree.children_count(third), 0u);
+  QVERIFY_EXCEPTION_THROWN(tree.at(4), std::out_of_range);
+  QVERIFY_EXCEPTION_THROWN(tree.add_child(4, 1), std::out_of_range);
+
+  tree.at(third) = 41;
+  QCOMPARE(depth_first(tree), std::vector<int>({ 10, 20, 41, 30 }));
+  QCOMPARE(breadth_first(tree), std::vector<int>({ 10, 20, 30, 41 }));
+  QVERIFY(check_links(tree));
+
+  tree.clear();
+  QVERIFY(tree.empty());
+  QCOMPARE(tree.add_root(1), 0u);
+}
+
+void TestFlatTree::
+test_convert_from_tree_breadth_first() {
+  const auto quad_tree{ get_test_tree() };
+  const flat_tree_t<std::string> tree{ quad_tree };
+  const std::vector<std::string> expected {
+    "7", "4", "10", "1", "2", "5", "6", "8", "9", "11", "13", "3", "12"
+  };
+  QCOMPARE(tree.values(), expected);
+  QVERIFY(tree.is_stored_in(layout_t::breadth_first));
+  QCOMPARE(breadth_first(tree), expected);
+  QCOMPARE(depth_first(tree), std::vector<std::string>({
+    "7", "4", "1", "2", "3", "5", "6", "10", "8", "9", "11", "13", "12"
+  }));
+  QVERIFY(check_links(tree));
+  QCOMPARE(tree[tree.parent(11)], "2");
+  QCOMPARE(tree.children_count(2), 4u);
+}
+
+void TestFlatTree::
+test_convert_from_tree_depth_first() {
+  const auto quad_tree{ get_test_tree() };
+  const flat_tree_t<std::string> tree{ quad_tree, layout_t::depth_first };
+  const std::vector<std::string> expected {
+    "7", "4", "1", "2", "3", "5", "6", "10", "8", "9", "11", "13", "12"
+  };
+  QCOMPARE(tree.values(), expected);
+  QVERIFY(tree.is_stored_in(layout_t::depth_first));
+  QVERIFY(!tree.is_stored_in(layout_t::breadth_first));
+  QCOMPARE(depth_first(tree), expected);
+  QCOMPARE(breadth_first(tree), std::vector<std::string>({
+    "7", "4", "10", "1", "2", "5", "6", "8", "9", "11", "13", "3", "12"
+  }));
+  QVERIFY(check_links(tree));
+  QCOMPARE(tree[tree.parent(12)], "13");
+
+  const quad_tree_t empty;
+  QVERIFY(flat_tree_t<std::string>{ empty }.empty());
+}
+
+void TestFlatTree::
+test_convert_from_avl_tree() {
+  avl_tree_t<int> avl;
+  for (int ii = 1; ii <= 100; ii++) {
+    avl.insert(ii);
+  }
+  for (auto layout : { int_layout_t::breadth_first, int_layout_t::depth_first }) {
+    const flat_tree_t<int> tree{ avl, layout };
+    QCOMPARE(tree.size(), avl.size());
+    QVERIFY(check_links(tree));
+
+    std::vector<int> expected;
+    const auto collect{ [&expected](const binary_node_t<int>& node) {
+      expected.push_back(node.get());
+      return false;
+    } };
+    if (layout == int_layout_t::breadth_first) {
+      avl.breadth_first_search(collect);
+      QCOMPARE(breadth_first(tree), expected);
+    }
+    else {
+      avl.depth_first_search(collect);
+      QCOMPARE(depth_first(tree), expected);
+    }
+  }
+}
+
+void TestFlatTree::
+test_layout_tracking() {
+  flat_tree_t<int> tree;
+  tree.add_root(0);
+  tree.add_child(0, 1);
+  tree.add_child(1, 2);
+  QVERIFY(tree.is_stored_in(int_layout_t::breadth_first));
+  QVERIFY(tree.is_stored_in(int_layout_t::depth_first));
+
+  tree.add_child(0, 3);       // sibling of 1 after the child of 1
+  QVERIFY(!tree.is_stored_in(int_layout_t::breadth_first));
+  QVERIFY(tree.is_stored_in(int_layout_t::depth_first));
+  tree.add_child(1, 4);       // 1 is not an ancestor of 3
+  QVERIFY(!tree.is_stored_in(int_layout_t::depth_first));
+
+  QCOMPARE(breadth_first(tree), std::vector<int>({ 0, 1, 3, 2, 4 }));
+  QCOMPARE(depth_first(tree),   std::vector<int>({ 0, 1, 2, 4, 3 }));
+}
+
+void TestFlatTree::
+test_search_should_stop_early() {
+  const flat_tree_t<std::string> by_level{ get_test_tree() };
+  const flat_tree_t<std::string> by_depth{ get_test_tree(), layout_t::depth_first };
+  std::vector<flat_tree_t<std::string>::index_t> scratch;
+
+  for (const auto* tree : { &by_level, &by_depth }) {
+    const auto find_8{ [tree](auto node) { return (*tree)[node] == "8"; } };
+    QCOMPARE(tree->breadth_first_search(find_8, scratch), 8u);
+    QCOMPARE(tree->depth_first_search(find_8, scratch), 9u);
+  }
+}
+
+void TestFlatTree::
+benchmark_tree_bfs() {
+  const auto tree{ full_quad_tree(9) };
+  std::vector<const tree_node_t<int, 4>*> scratch;
+  long sum{ 0 };
+  QBENCHMARK {
+    tree.breadth_first_search([&sum](const auto& node) {
+      sum += *node;
+      return false;
+    }, scratch);
+  }
+  QVERIFY(sum > 0);
+}
+
+void TestFlatTree::
+benchmark_flat_tree_bfs() {
+  const flat_tree_t<int> tree{ full_quad_tree(9) };
+  long sum{ 0 };
+  QBENCHMARK {
+    tree.breadth_first_search([&](auto node) {
+      sum += tree[node];
+      return false;
+    });
+  }
+  QVERIFY(sum > 0);
+}
+
+void TestFlatTree::
+benchmark_tree_dfs() {
+  const auto tree{ full_quad_tree(9) };
+  std::vector<const tree_node_t<int, 4>*> scratch;
+  long sum{ 0 };
+  QBENCHMARK {
+    tree.depth_first_search([&sum](const auto& node) {
+      sum += *node;
+      return false;
+    }, scratch);
+  }
+  QVERIFY(sum > 0);
+}
+
+void TestFlatTree::
+benchmark_flat_tree_dfs() {
+  const flat_tree_t<int> tree{ full_quad_tree(9) };
+  std::vector<flat_tree_t<int>::index_t> scratch;
+  long sum{ 0 };
+  QBENCHMARK {
+    // the nodes are stored by level, so this one uses the stack
+    tree.depth_first_search([&](auto node) {
+      sum += tree[node];
+      return false;
+    }, scratch);
+  }
+  QVERIFY(sum > 0);
+}
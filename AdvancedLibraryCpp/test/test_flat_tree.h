@@ -0,0 +1,26 @@
+#pragma once
+
+#include <QObject>
+#include <QTest>
+
+#include "../structures/flat_tree.h"
+
+class TestFlatTree : public QObject
+{
+  Q_OBJECT
+public:
+  explicit TestFlatTree(QObject *parent = nullptr);
+
+private slots:
+
+  void test_add_root_and_children();
+  void test_convert_from_tree_breadth_first();
+  void test_convert_from_tree_depth_first();
+  void test_convert_from_avl_tree();
+  void test_layout_tracking();
+  void test_search_should_stop_early();
+  void benchmark_tree_bfs();
+  void benchmark_flat_tree_bfs();
+  void benchmark_tree_dfs();
+  void benchmark_flat_tree_dfs();
+};
@@ -0,0 +1,318 @@
+#include "test_interval_tree.h"
+
+#include <random>
+#include <vector>
+
+using namespace advanced::structures;
+
+namespace {
+
+using interval_type = interval_t<int>;
+
+/**
+ * the intervals of intervals overlapping [low, high], sorted
+ */
+std::vector<interval_type>
+scan(const std::vector<interval_type>& intervals, int low, int high) {
+  std::vector<interval_type> found;
+  for (const auto& interval : intervals) {
+    if (interval.overlaps(low, high)) {
+      found.push_back(interval);
+    }
+  }
+  std::sort(found.begin(), found.end());
+  return found;
+}
+
+std::vector<interval_type>
+sorted(std::vector<interval_type> intervals) {
+  std::sort(intervals.begin(), intervals.end());
+  return intervals;
+}
+
+/**
+ * time ranges: random starts and mostly short durations, some long ones
+ */
+std::vector<interval_type>
+get_ranges(size_t count, int horizon, unsigned seed) {
+  std::mt19937 generator{ seed };
+  std::vector<interval_type> ranges;
+  for (size_t ii = 0; ii < count; ii++) {
+    const int start   { static_cast<int>(generator() % horizon) };
+    const int duration{ static_cast<int>(generator() % 10 ? generator() % 100
+                                                          : generator() % 10000) };
+    ranges.emplace_back(start, start + duration);
+  }
+  return ranges;
+}
+
+}
+
+TestIntervalTree::
+TestIntervalTree(QObject *parent) : QObject(parent) {
+  QObject::setObjectName("TestIntervalTree");
+}
+
+void TestIntervalTree::
+test_interval() {
+  const interval_type interval{ 3, 7 };
+  QCOMPARE(interval.low(), 3);
+  QCOMPARE(interval.high(), 7);
+  QVERIFY(interval.contains(3));
+  QVERIFY(interval.contains(7));
+  QVERIFY(!interval.contains(8));
+  QVERIFY(interval.overlaps(7, 10));
+  QVERIFY(interval.overlaps(0, 3));
+  QVERIFY(interval.overlaps(4, 5));
+  QVERIFY(interval.overlaps(0, 10));
+  QVERIFY(!interval.overlaps(8, 10));
+  QVERIFY((interval_type{ 3, 5 } < interval));
+  QVERIFY((interval < interval_type{ 4, 5 }));
+  QVERIFY((interval == interval_type{ 3, 7 }));
+  QVERIFY((interval != interval_type{ 3, 8 }));
+  QVERIFY(interval_type(5, 5).contains(5));
+  QVERIFY_EXCEPTION_THROWN((interval_type{ 7, 3 }), std::invalid_argument);
+
+  interval_tree_t<int> tree;
+  QVERIFY_EXCEPTION_THROWN(tree.insert(2, 1), std::invalid_argument);
+  QVERIFY(tree.empty());
+}
+
+void TestIntervalTree::
+test_overlaps() {
+  interval_tree_t<int> tree;
+  QVERIFY(tree.overlaps(5).empty());
+  tree.insert(15, 20);
+  tree.insert(10, 30);
+  tree.insert(17, 19);
+  tree.insert(5, 20);
+  tree.insert(12, 15);
+  tree.insert(30, 40);
+  QCOMPARE(tree.size(), 6u);
+
+  QCOMPARE(tree.overlaps(18), (std::vector<interval_type>{ { 5, 20 }, { 10, 30 }, { 15, 20 }, { 17, 19 } }));
+  QCOMPARE(tree.overlaps(30), (std::vector<interval_type>{ { 10, 30 }, { 30, 40 } }));
+  QCOMPARE(tree.overlaps(4), std::vector<interval_type>{ });
+  QCOMPARE(tree.overlaps(41), std::vector<interval_type>{ });
+  QCOMPARE(tree.overlaps(21, 29), (std::vector<interval_type>{ { 10, 30 } }));
+  QCOMPARE(tree.overlaps(0, 11), (std::vector<interval_type>{ { 5, 20 }, { 10, 30 } }));
+  QCOMPARE(tree.overlaps(0, 100).size(), 6u);
+  QVERIFY(tree.overlaps(11, 10).empty());
+}
+
+void TestIntervalTree::
+test_insert_and_remove() {
+  interval_tree_t<int> tree;
+  tree.insert(1, 5);
+  tree.insert(1, 5);
+  tree.insert(2, 100);
+  QCOMPARE(tree.size(), 3u);
+  QVERIFY(tree.contains(1, 5));
+  QVERIFY(!tree.contains(1, 6));
+  QVERIFY(!tree.contains(6, 1));
+  QCOMPARE(tree.overlaps(3).size(), 3u);
+
+  QVERIFY(tree.remove(1, 5));
+  QVERIFY(tree.contains(1, 5));
+  QVERIFY(tree.remove(interval_type{ 1, 5 }));
+  QVERIFY(!tree.remove(1, 5));
+  QVERIFY(!tree.remove(5, 1));
+  QCOMPARE(tree.overlaps(3), (std::vector<interval_type>{ { 2, 100 } }));
+
+  // the greatest endpoint shrinks with the removal of the long interval
+  QVERIFY(tree.remove(2, 100));
+  QVERIFY(tree.overlaps(50).empty());
+  QVERIFY(tree.empty());
+  tree.insert(7, 8);
+  tree.clear();
+  QVERIFY(tree.empty());
+  QVERIFY(tree.overlaps(7).empty());
+}
+
+void TestIntervalTree::
+test_max_endpoint_through_rotations() {
+  // sorted insertions rotate at almost every step, the long intervals move
+  // around the tree
+  interval_tree_t<int> tree;
+  std::vector<interval_type> intervals;
+  for (int low = 0; low < 500; low++) {
+    const int high{ low % 50 == 0 ? low + 1000 : low + 2 };
+    tree.insert(low, high);
+    intervals.emplace_back(low, high);
+    for (int point : { 0, low / 2, low, low + 500 }) {
+      QCOMPARE(tree.overlaps(point), scan(intervals, point, point));
+    }
+  }
+  QVERIFY(tree.tree().height() <= 13u);
+
+  for (int low = 0; low < 500; low += 3) {
+    const interval_type removed{ intervals[low] };
+    QVERIFY(tree.remove(removed));
+    intervals.erase(std::find(intervals.begin(), intervals.end(), removed));
+    intervals.insert(intervals.begin() + low, interval_type{ -1, -1 });
+    tree.insert(-1, -1);
+    for (int point : { -1, low, low + 1, 1200 }) {
+      QCOMPARE(tree.overlaps(point), scan(intervals, point, point));
+    }
+  }
+}
+
+void TestIntervalTree::
+test_random_against_scan() {
+  std::mt19937 generator{ 50 };
+  interval_tree_t<int> tree;
+  std::vector<interval_type> intervals;
+  for (int step = 0; step < 4000; step++) {
+    if (intervals.empty() || generator() % 3) {
+      const int low{ static_cast<int>(generator() % 1000) };
+      const interval_type interval{ low, low + static_cast<int>(generator() % 60) };
+      tree.insert(interval);
+      intervals.push_back(interval);
+    }
+    else {
+      const size_t position{ generator() % intervals.size() };
+      QVERIFY(tree.remove(intervals[position]));
+      intervals.erase(intervals.begin() + position);
+    }
+    QCOMPARE(tree.size(), intervals.size());
+    const int low { static_cast<int>(generator() % 1100) - 50 };
+    const int high{ low + static_cast<int>(generator() % 30) };
+    QCOMPARE(tree.overlaps(low, high), scan(intervals, low, high));
+    QCOMPARE(tree.overlaps(low), scan(intervals, low, low));
+  }
+
+  const static_interval_tree_t<int> fixed{ tree };
+  QCOMPARE(fixed.size(), intervals.size());
+  for (int low = -10; low < 1100; low += 7) {
+    QCOMPARE(sorted(fixed.overlaps(low)), scan(intervals, low, low));
+    QCOMPARE(sorted(fixed.overlaps(low, low + 13)), scan(intervals, low, low + 13));
+  }
+}
+
+void TestIntervalTree::
+test_rebuild_and_copy() {
+  const auto ranges{ get_ranges(3000, 20000, 1) };
+  interval_tree_t<int> tree;
+  tree.insert(-5, -1);
+  tree.rebuild(ranges.begin(), ranges.end());
+  QCOMPARE(tree.size(), ranges.size());
+  QVERIFY(!tree.contains(-5, -1));
+  QVERIFY(std::is_sorted(tree.begin(), tree.end()));
+
+  const interval_tree_t<int> copy{ tree };
+  tree.clear();
+  for (int point = 0; point < 21000; point += 97) {
+    QCOMPARE(copy.overlaps(point), scan(ranges, point, point));
+    QCOMPARE(copy.overlaps(point, point + 500), scan(ranges, point, point + 500));
+  }
+  // the duplicates are kept
+  interval_tree_t<int> same;
+  const std::vector<interval_type> repeated(5, interval_type{ 1, 2 });
+  same.rebuild(repeated.begin(), repeated.end());
+  QCOMPARE(same.overlaps(2).size(), 5u);
+}
+
+void TestIntervalTree::
+test_static_interval_tree() {
+  const static_interval_tree_t<int> empty;
+  QVERIFY(empty.empty());
+  QVERIFY(empty.overlaps(1).empty());
+  QVERIFY(empty.overlaps(1, 2).empty());
+
+  // nested intervals all share the center
+  std::vector<interval_type> nested;
+  for (int ii = 0; ii < 100; ii++) {
+    nested.emplace_back(-ii, ii);
+  }
+  const static_interval_tree_t<int> onion{ nested.begin(), nested.end() };
+  QCOMPARE(onion.size(), nested.size());
+  for (int point = -101; point <= 101; point++) {
+    QCOMPARE(sorted(onion.overlaps(point)), scan(nested, point, point));
+    QCOMPARE(sorted(onion.overlaps(point, point + 3)), scan(nested, point, point + 3));
+  }
+
+  const auto ranges{ get_ranges(5000, 100000, 2) };
+  const static_interval_tree_t<int> tree{ ranges.begin(), ranges.end() };
+  QCOMPARE(tree.size(), ranges.size());
+  for (int point = -1; point < 110000; point += 331) {
+    QCOMPARE(sorted(tree.overlaps(point)), scan(ranges, point, point));
+    QCOMPARE(sorted(tree.overlaps(point, point + 1000)), scan(ranges, point, point + 1000));
+  }
+  QVERIFY(tree.overlaps(5, 4).empty());
+}
+
+void TestIntervalTree::
+test_visitor_stops() {
+  const auto ranges{ get_ranges(1000, 1000, 3) };
+  interval_tree_t<int> tree;
+  tree.rebuild(ranges.begin(), ranges.end());
+  const static_interval_tree_t<int> fixed{ tree };
+  const std::vector<interval_type> all{ scan(ranges, 400, 600) };
+  QVERIFY(all.size() > 10u);
+
+  std::vector<interval_type> first;
+  const size_t visited{ tree.for_each_overlap(400, 600, [&first](const interval_type& interval) {
+    first.push_back(interval);
+    return first.size() == 10u;
+  }) };
+  QCOMPARE(visited, 10u);
+  QCOMPARE(first, std::vector<interval_type>(all.begin(), all.begin() + 10));
+  size_t calls{ 0 };
+  QCOMPARE(fixed.for_each_overlap(400, 600, [&calls](const interval_type&) {
+    return ++calls == 10u;
+  }), 10u);
+  calls = 0;
+  QCOMPARE(fixed.for_each_overlap(500, [&calls](const interval_type&) {
+    return ++calls == 1u;
+  }), 1u);
+  QCOMPARE(tree.for_each_overlap(500, [](const interval_type&) { return false; }),
+           scan(ranges, 500, 500).size());
+}
+
+void TestIntervalTree::
+benchmark_avl_tree_scan() {
+  const auto ranges{ get_ranges(100000, 10000000, 4) };
+  avl_tree_t<interval_type> tree;
+  tree.enable_duplicates();
+  for (const auto& range : ranges) {
+    tree.insert(range);
+  }
+  size_t found{ 0 };
+  QBENCHMARK {
+    for (int point = 0; point < 10000000; point += 100000) {
+      for (const auto& interval : tree) {
+        found += interval.contains(point);
+      }
+    }
+  }
+  QVERIFY(found > 0u);
+}
+
+void TestIntervalTree::
+benchmark_interval_tree() {
+  const auto ranges{ get_ranges(100000, 10000000, 4) };
+  interval_tree_t<int> tree;
+  for (const auto& range : ranges) {
+    tree.insert(range);
+  }
+  size_t found{ 0 };
+  QBENCHMARK {
+    for (int point = 0; point < 10000000; point += 100000) {
+      found += tree.for_each_overlap(point, [](const interval_type&) { return false; });
+    }
+  }
+  QVERIFY(found > 0u);
+}
+
+void TestIntervalTree::
+benchmark_static_interval_tree() {
+  const auto ranges{ get_ranges(100000, 10000000, 4) };
+  const static_interval_tree_t<int> tree{ ranges.begin(), ranges.end() };
+  size_t found{ 0 };
+  QBENCHMARK {
+    for (int point = 0; point < 10000000; point += 100000) {
+      found += tree.for_each_overlap(point, [](const interval_type&) { return false; });
+    }
+  }
+  QVERIFY(found > 0u);
+}
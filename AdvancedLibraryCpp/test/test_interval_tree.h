@@ -0,0 +1,27 @@
+#pragma once
+
+#include <QObject>
+#include <QTest>
+
+#include "../structures/interval_tree.h"
+
+class TestIntervalTree : public QObject
+{
+  Q_OBJECT
+public:
+  explicit TestIntervalTree(QObject *parent = nullptr);
+
+private slots:
+
+  void test_interval();
+  void test_overlaps();
+  void test_insert_and_remove();
+  void test_max_endpoint_through_rotations();
+  void test_random_against_scan();
+  void test_rebuild_and_copy();
+  void test_static_interval_tree();
+  void test_visitor_stops();
+  void benchmark_avl_tree_scan();
+  void benchmark_interval_tree();
+  void benchmark_static_interval_tree();
+};
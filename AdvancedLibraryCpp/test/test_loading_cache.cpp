@@ -0,0 +1,233 @@
+#include "test_loading_cache.h"
+
+#include <atomic>
+#include <memory>
+#include <thread>
+
+using advanced::structures::loading_cache_t;
+using advanced::structures::key_not_loaded_exception_t;
+
+TestLoadingCache::
+TestLoadingCache(QObject *parent) : QObject(parent) {
+  QObject::setObjectName("TestLoadingCache");
+}
+
+void TestLoadingCache::
+test_get_should_load_missing_values_once() {
+  loading_cache_t<int, std::string> cache;
+  size_t calls{ 0 };
+  auto loader{ [&calls](const int& key) {
+    calls++;
+    return std::to_string(key);
+  }};
+
+  QCOMPARE(cache.get(7, loader), std::string{ "7" });
+  QCOMPARE(cache.get(7, loader), std::string{ "7" });
+  QCOMPARE(cache.get(8, loader), std::string{ "8" });
+  QCOMPARE(calls, 2u);
+  QCOMPARE(cache.size(), 2u);
+  QVERIFY(cache.contains(7));
+  QVERIFY(!cache.contains(9));
+}
+
+void TestLoadingCache::
+test_get_should_coalesce_concurrent_loads() {
+  loading_cache_t<std::string, size_t> cache;
+  std::atomic_size_t calls{ 0 };
+  auto loader{ [&calls](const std::string& key) {
+    calls++;
+    std::this_thread::sleep_for(std::chrono::milliseconds{ 50 });
+    return key.size();
+  }};
+
+  std::vector<size_t>      results(16, 0);
+  std::vector<std::thread> threads;
+  for (size_t ii = 0; ii < results.size(); ii++) {
+    threads.emplace_back([&cache, &results, &loader, ii]() {
+      results[ii] = cache.get("thundering herd", loader);
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  QCOMPARE(calls.load(), 1u);
+  for (const auto& result : results) {
+    QCOMPARE(result, std::string{ "thundering herd" }.size());
+  }
+}
+
+void TestLoadingCache::
+test_loader_exceptions_should_reach_every_waiting_caller() {
+  loading_cache_t<int, int> cache;
+  std::atomic_size_t calls{ 0 }, failures{ 0 };
+  auto loader{ [&calls](const int&) -> int {
+    calls++;
+    std::this_thread::sleep_for(std::chrono::milliseconds{ 50 });
+    throw std::runtime_error{ "backend is down" };
+  }};
+
+  std::vector<std::thread> threads;
+  for (size_t ii = 0; ii < 8; ii++) {
+    threads.emplace_back([&cache, &failures, &loader]() {
+      try {
+        (void)cache.get(42, loader);
+      }
+      catch (const std::runtime_error&) {
+        failures++;
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  QCOMPARE(calls.load(), 1u);
+  QCOMPARE(failures.load(), 8u);
+  QVERIFY(!cache.contains(42));
+
+  // the failed key is not cached, so the next call retries it:
+  QCOMPARE(cache.get(42, [](const int& key) { return key * 2; }), 84);
+}
+
+void TestLoadingCache::
+test_capacity_should_discard_least_recent_values() {
+  loading_cache_t<int, int> cache{ 3 };
+  size_t calls{ 0 };
+  auto loader{ [&calls](const int& key) { calls++; return -key; } };
+
+  (void)cache.get(1, loader);
+  (void)cache.get(2, loader);
+  (void)cache.get(3, loader);
+  (void)cache.get(1, loader); // 2 is now the least recent used
+  (void)cache.get(4, loader);
+
+  QCOMPARE(cache.size(), 3u);
+  QCOMPARE(cache.capacity(), 3u);
+  QVERIFY(cache.contains(1));
+  QVERIFY(!cache.contains(2));
+  QVERIFY(cache.contains(3));
+  QVERIFY(cache.contains(4));
+  QCOMPARE(calls, 4u);
+
+  cache.set_capacity(1);
+  QCOMPARE(cache.size(), 1u);
+  QVERIFY(cache.contains(4));
+}
+
+void TestLoadingCache::
+test_get_all_should_call_bulk_loader_with_missing_keys_only() {
+  loading_cache_t<int, int> cache;
+  std::vector<std::vector<int>> requested;
+  auto bulk_loader{ [&requested](const std::vector<int>& keys) {
+    requested.push_back(keys);
+    std::unordered_map<int, int> result;
+    for (const auto& key : keys) {
+      result[key] = key * 10;
+    }
+    return result;
+  }};
+
+  (void)cache.get(2, [](const int& key) { return key * 10; });
+  auto result{ cache.get_all({ 1, 2, 3, 3 }, bulk_loader) };
+
+  QCOMPARE(requested.size(), 1u);
+  QCOMPARE(requested.front(), (std::vector<int>{ 1, 3 }));
+  QCOMPARE(result.size(), 3u);
+  QCOMPARE(result[1], 10);
+  QCOMPARE(result[2], 20);
+  QCOMPARE(result[3], 30);
+
+  result = cache.get_all({ 1, 2, 3 }, bulk_loader);
+  QCOMPARE(requested.size(), 1u);
+  QCOMPARE(result.size(), 3u);
+}
+
+void TestLoadingCache::
+test_get_all_should_skip_keys_not_loaded() {
+  loading_cache_t<int, int> cache;
+  auto bulk_loader{ [](const std::vector<int>& keys) {
+    std::unordered_map<int, int> result;
+    for (const auto& key : keys) {
+      if (key % 2 == 0) {
+        result[key] = key;
+      }
+    }
+    return result;
+  }};
+
+  auto result{ cache.get_all({ 1, 2, 3, 4 }, bulk_loader) };
+  QCOMPARE(result.size(), 2u);
+  QVERIFY(result.count(2));
+  QVERIFY(result.count(4));
+  QVERIFY(!cache.contains(1));
+  QVERIFY(!cache.contains(3));
+  QCOMPARE(cache.size(), 2u);
+
+  QVERIFY_EXCEPTION_THROWN(
+    cache.get_all({ 5 }, [](const std::vector<int>&)
+                          -> std::unordered_map<int, int> {
+      throw std::runtime_error{ "backend is down" };
+    }),
+    std::runtime_error);
+  QVERIFY(!cache.contains(5));
+}
+
+void TestLoadingCache::
+test_expired_values_should_be_reloaded() {
+  using std::chrono::milliseconds;
+  loading_cache_t<int, int> cache{ 10, milliseconds{ 30 } };
+  size_t calls{ 0 };
+  auto loader{ [&calls](const int& key) { calls++; return key; } };
+
+  (void)cache.get(1, loader);
+  (void)cache.get(1, loader);
+  QCOMPARE(calls, 1u);
+
+  std::this_thread::sleep_for(milliseconds{ 50 });
+  QVERIFY(!cache.contains(1));
+  (void)cache.get(1, loader);
+  QCOMPARE(calls, 2u);
+}
+
+void TestLoadingCache::
+test_refresh_ahead_should_serve_stale_value_while_reloading() {
+  using std::chrono::milliseconds;
+  auto version{ std::make_shared<std::atomic_int>(0) };
+  loading_cache_t<int, int> cache{ 10, milliseconds{ 0 }, milliseconds{ 20 },
+                                   [version](const int&) { return ++*version; } };
+  QCOMPARE(cache.get(1, [](const int&) { return 10; }), 10);
+  std::this_thread::sleep_for(milliseconds{ 40 });
+
+  // the stale value is returned right away and a refresh is scheduled with
+  // the refresh loader, the one passed to get may be gone when it runs
+  {
+    std::atomic_int calls{ 0 };
+    QCOMPARE(cache.get(1, [&calls](const int&) { return ++calls; }), 10);
+  }
+  cache.wait_refreshes();
+  QCOMPARE(version->load(), 1);
+  QCOMPARE(cache.get(1, [](const int&) { return 0; }), 1);
+
+  // refresh-ahead can't be enabled without a refresh loader
+  QVERIFY_EXCEPTION_THROWN(
+    (loading_cache_t<int, int>{ 10, milliseconds{ 0 }, milliseconds{ 20 } }),
+    std::invalid_argument);
+}
+
+void TestLoadingCache::
+test_invalidate_and_clear() {
+  loading_cache_t<int, int> cache;
+  auto loader{ [](const int& key) { return key; } };
+
+  (void)cache.get(1, loader);
+  (void)cache.get(2, loader);
+  QVERIFY(cache.invalidate(1));
+  QVERIFY(!cache.invalidate(1));
+  QVERIFY(!cache.contains(1));
+  QCOMPARE(cache.size(), 1u);
+
+  cache.clear();
+  QCOMPARE(cache.size(), 0u);
+  QVERIFY(!cache.contains(2));
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <QObject>
+#include <QTest>
+
+#include <string>
+#include "../structures/loading_cache.h"
+
+class TestLoadingCache : public QObject
+{
+  Q_OBJECT
+public:
+  explicit TestLoadingCache(QObject *parent = nullptr);
+
+private slots:
+
+  void test_get_should_load_missing_values_once();
+  void test_get_should_coalesce_concurrent_loads();
+  void test_loader_exceptions_should_reach_every_waiting_caller();
+  void test_capacity_should_discard_least_recent_values();
+  void test_get_all_should_call_bulk_loader_with_missing_keys_only();
+  void test_get_all_should_skip_keys_not_loaded();
+  void test_expired_values_should_be_reloaded();
+  void test_refresh_ahead_should_serve_stale_value_while_reloading();
+  void test_invalidate_and_clear();
+};
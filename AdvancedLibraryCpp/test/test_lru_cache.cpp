@@ -1,6 +1,9 @@
 #include "test_lru_cache.h"
 
+#include <algorithm>
+#include <iterator>
 #include <memory>
+#include <numeric>
 
 using advanced::structures::cache_t;
 
@@ -616,6 +619,213 @@ test_clear() {
   QVERIFY(cache.empty());
 }
 
+void TestLRUCache::
+test_statistics_counters() {
+  cache_t<int> cache{ 3 };
+  QCOMPARE(cache.statistics().hits, 0u);
+  QCOMPARE(cache.statistics().hit_ratio(), 0.0);
+
+  cache.add(1).add(2).add(3).add(3);
+  (void)cache.find(1);
+  (void)cache.find(4);
+  (void)cache[2];
+  (void)cache[5];   // miss + insert + eviction of 3
+  cache.remove(1).remove(1);
+
+  const auto& statistics{ cache.statistics() };
+  QCOMPARE(statistics.hits,       2u);
+  QCOMPARE(statistics.misses,     2u);
+  QCOMPARE(statistics.inserts,    4u);
+  QCOMPARE(statistics.evictions,  1u);
+  QCOMPARE(statistics.removals,   1u);
+  QCOMPARE(statistics.hit_ratio(),  0.5);
+  QCOMPARE(statistics.miss_ratio(), 0.5);
+
+  cache.set_capacity(1);
+  QCOMPARE(cache.statistics().evictions, 2u);
+
+  cache.reset_statistics();
+  QCOMPARE(cache.statistics().hits,      0u);
+  QCOMPARE(cache.statistics().evictions, 0u);
+  QCOMPARE(cache.size(), 1u);
+}
+
+void TestLRUCache::
+test_statistics_average_lifetime() {
+  // a full cache that inserts on every access keeps each entry for exactly
+  // "capacity" accesses:
+  const size_t capacity{ 10 };
+  cache_t<int> cache{ capacity };
+  for (int ii = 0; ii < 100000; ii++) {
+    cache.add(ii);
+  }
+  QVERIFY(std::abs(cache.statistics().average_lifetime() - capacity) < 0.01);
+}
+
+void TestLRUCache::
+test_heterogeneous_lookup() {
+  cache_t<std::string> cache{ 3 };
+  cache.add("alabama").add("texas").add("utah");
+
+  const std::string_view texas{ "texas" };
+  QVERIFY(cache.contains(texas));
+  QVERIFY(cache.contains("utah"));
+  QVERIFY(!cache.contains("ohio"));
+
+  // a hit through a view moves the key to the front as usual
+  QVERIFY(cache.find("alabama").first);
+  QCOMPARE(cache.most_recent(), std::string{ "alabama" });
+  QVERIFY(!cache.find(std::string_view{ "ohio" }).first);
+  QCOMPARE(cache.statistics().hits,   1u);
+  QCOMPARE(cache.statistics().misses, 1u);
+
+  cache.remove(texas);
+  QVERIFY(!cache.contains(texas));
+  QCOMPARE(cache.size(), 2u);
+  cache.add("ohio").add("iowa");
+  QVERIFY(!cache.contains("utah"));
+  QVERIFY(cache.contains("alabama"));
+}
+
+void TestLRUCache::
+test_copy_is_independent() {
+  cache_t<std::string> cache{ 3 };
+  cache.add("alabama").add("texas").add("utah");
+  cache_t<std::string> copied{ cache };
+
+  cache.remove("texas").add("ohio").add("iowa");
+  QVERIFY(copied.contains("texas"));
+  QVERIFY(copied.find("alabama").first);
+  QCOMPARE(copied.most_recent(), std::string{ "alabama" });
+  copied.add("nevada");
+  QVERIFY(!copied.contains("texas"));
+  QCOMPARE(copied.size(), 3u);
+  QCOMPARE(cache.size(), 3u);
+  QVERIFY(cache.contains("utah"));
+}
+
+void TestLRUCache::
+test_add_range() {
+  const std::vector<std::string> input {
+    "alabama", "texas", "utah", "texas", "ohio"
+  };
+  test::structures::extended_cache cache;
+  cache.set_capacity(3);
+  cache.add("iowa");
+
+  QCOMPARE(cache.add_range(input.begin(), input.end()), 4u);
+  QVERIFY(cache.last_operation());
+  QCOMPARE(cache.size(), 3u);
+  // the repeated "texas" clips "iowa" first, the end of the range "alabama"
+  QCOMPARE(cache.clipped(), 1u);
+  QCOMPARE(cache.items_in_map(), 3u);
+  // the last key of the range is the most recent used one
+  QCOMPARE(std::vector<std::string>(cache.begin(), cache.end()),
+           std::vector<std::string>({ "ohio", "utah", "texas" }));
+  // on_discard keeps being called from the least recent used
+  QCOMPARE(cache.discarded_values(),
+           std::vector<std::string>({ "iowa", "alabama" }));
+  QCOMPARE(cache.statistics().inserts,   5u);
+  QCOMPARE(cache.statistics().evictions, 2u);
+
+  const std::vector<std::string_view> views{ "ohio", "utah" };
+  QCOMPARE(cache.add_range(views.begin(), views.end()), 0u);
+  QVERIFY(!cache.last_operation());
+}
+
+void TestLRUCache::
+test_add_range_larger_than_capacity() {
+  std::vector<int> input(1000);
+  std::iota(input.begin(), input.end(), 0);
+  test::structures::batch_cache cache{ 100 };
+
+  QCOMPARE(cache.add_range(input.begin(), input.end()), 1000u);
+  QCOMPARE(cache.size(), 100u);
+  QCOMPARE(cache.most_recent(),  999);
+  QCOMPARE(cache.least_recent(), 900);
+  for (int ii = 900; ii < 1000; ii++) {
+    QVERIFY(cache.contains(ii));
+  }
+
+  // evicted in a few batches, each one ordered from most to least recent used
+  size_t evicted{ 0 };
+  QVERIFY(cache.batches.size() > 1u);
+  QVERIFY(cache.batches.size() < 20u);
+  for (const auto& batch : cache.batches) {
+    QVERIFY(std::is_sorted(batch.rbegin(), batch.rend()));
+    evicted += batch.size();
+  }
+  QCOMPARE(evicted, 900u);
+  QCOMPARE(cache.batches.front().back(), 0);
+  QCOMPARE(cache.statistics().evictions, 900u);
+
+  // a single add evicts a batch of one value
+  cache.batches.clear();
+  cache.add(1000);
+  QCOMPARE(cache.batches.size(), 1u);
+  QCOMPARE(cache.batches.front(), std::vector<int>{ 900 });
+}
+
+void TestLRUCache::
+test_add_range_repeats_evicted_key() {
+  // "a" is pushed past the capacity by "b" and "c" before it is repeated, so
+  // it must be inserted again as add would do
+  const std::vector<std::string> input { "a", "b", "c", "a" };
+  cache_t<std::string> cache{ 2 };
+  QCOMPARE(cache.add_range(input.begin(), input.end()), 4u);
+  QCOMPARE(std::vector<std::string>(cache.begin(), cache.end()),
+           std::vector<std::string>({ "a", "c" }));
+  QCOMPARE(cache.statistics().inserts,   4u);
+  QCOMPARE(cache.statistics().evictions, 2u);
+
+  // keys repeated at every distance from the capacity give the same cache as
+  // adding them one by one
+  std::vector<int> keys;
+  for (int ii = 0; ii < 1000; ii++) {
+    keys.push_back((ii * 37) % 150);
+  }
+  cache_t<int> batched{ 100 };
+  cache_t<int> sequential{ 100 };
+  batched.add(7).add(500);
+  sequential.add(7).add(500);
+  size_t inserted{ 0 };
+  for (int key : keys) {
+    sequential.add(key);
+    inserted += sequential.last_operation() ? 1u : 0u;
+  }
+  QCOMPARE(batched.add_range(keys.begin(), keys.end()), inserted);
+  QCOMPARE(std::vector<int>(batched.begin(), batched.end()),
+           std::vector<int>(sequential.begin(), sequential.end()));
+  QCOMPARE(batched.statistics().evictions, sequential.statistics().evictions);
+}
+
+void TestLRUCache::
+test_remove_range_and_find_many() {
+  cache_t<std::string> cache{ 10 };
+  const std::vector<std::string> input {
+    "alabama", "texas", "utah", "ohio", "iowa"
+  };
+  cache.add_range(input.begin(), input.end());
+
+  const std::vector<const char*> searched{ "texas", "nevada", "alabama" };
+  std::vector<bool> found;
+  cache.find_many(searched.begin(), searched.end(), std::back_inserter(found));
+  QCOMPARE(found, std::vector<bool>({ true, false, true }));
+  QCOMPARE(cache.most_recent(), std::string{ "alabama" });
+  QCOMPARE(cache.statistics().hits,   2u);
+  QCOMPARE(cache.statistics().misses, 1u);
+
+  const std::vector<std::string> removed{ "utah", "nevada", "iowa", "utah" };
+  QCOMPARE(cache.remove_range(removed.begin(), removed.end()), 2u);
+  QVERIFY(cache.last_operation());
+  QCOMPARE(cache.size(), 3u);
+  QVERIFY(!cache.contains("utah"));
+  QVERIFY(!cache.contains("iowa"));
+  QCOMPARE(cache.statistics().removals, 2u);
+  QCOMPARE(cache.remove_range(removed.begin(), removed.end()), 0u);
+  QVERIFY(!cache.last_operation());
+}
+
 namespace test {
 namespace structures {
 
@@ -624,5 +834,10 @@ on_discard(const value_t &value) {
   _discarded_values.push_back(value);
 }
 
+void batch_cache::
+on_discard_batch(const list_t& values) {
+  batches.emplace_back(values.begin(), values.end());
+}
+
 }
 }
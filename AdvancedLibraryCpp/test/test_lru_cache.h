@@ -36,6 +36,18 @@ protected:
   std::vector<std::string> _discarded_values;
 };
 
+class batch_cache : public advanced::structures::cache_t<int> {
+public:
+  using advanced::structures::cache_t<int>::cache_t;
+
+  std::vector<std::vector<int>> batches;
+
+  // cache_t interface
+protected:
+  virtual void
+  on_discard_batch(const list_t& values) override;
+};
+
 class complex_data_type {
 public:
   std::string  str;
@@ -124,5 +136,13 @@ private slots:
   void test_move_copy();
   void test_cache_as_pointers();
   void test_clear();
+  void test_statistics_counters();
+  void test_statistics_average_lifetime();
+  void test_heterogeneous_lookup();
+  void test_copy_is_independent();
+  void test_add_range();
+  void test_add_range_larger_than_capacity();
+  void test_add_range_repeats_evicted_key();
+  void test_remove_range_and_find_many();
 };
 
@@ -0,0 +1,101 @@
+#include "test_miss_ratio_curve.h"
+
+#include <random>
+#include "../structures/cache.h"
+
+using advanced::tools::miss_ratio_curve_t;
+using advanced::structures::cache_t;
+
+TestMissRatioCurve::
+TestMissRatioCurve(QObject *parent) : QObject(parent) {
+  QObject::setObjectName("TestMissRatioCurve");
+}
+
+void TestMissRatioCurve::
+test_stack_distances_of_a_small_trace() {
+  // distances:       -  -  -  3  3  1  3  -
+  const std::vector<char> trace{ 'a', 'b', 'c', 'a', 'b', 'b', 'c', 'd' };
+  miss_ratio_curve_t<char> mrc;
+  mrc.replay(trace.begin(), trace.end());
+
+  QCOMPARE(mrc.references(), trace.size());
+  QCOMPARE(mrc.sampled_references(), trace.size());
+  QCOMPARE(mrc.cold_misses(), 4u);
+  QCOMPARE(mrc.distinct_keys(), 4u);
+
+  const auto curve{ mrc.curve(4) };
+  QCOMPARE(curve.size(), 5u);
+  QCOMPARE(curve[0], 1.0);
+  QCOMPARE(curve[1], 7.0 / 8.0);
+  QCOMPARE(curve[2], 7.0 / 8.0);
+  QCOMPARE(curve[3], 4.0 / 8.0);
+  QCOMPARE(curve[4], 4.0 / 8.0);
+  QCOMPARE(mrc.miss_ratio(3), 0.5);
+  QCOMPARE(mrc.miss_ratio(1000), 0.5);
+}
+
+void TestMissRatioCurve::
+test_curve_should_match_a_real_lru_cache() {
+  std::mt19937 generator{ 42 };
+  std::geometric_distribution<int> distribution{ 0.002 };
+  std::vector<int> trace(20000);
+  for (auto& key : trace) {
+    key = distribution(generator);
+  }
+
+  miss_ratio_curve_t<int> mrc;
+  mrc.replay(trace.begin(), trace.end());
+  const auto curve{ mrc.curve(1000) };
+
+  for (size_t capacity : { 1u, 10u, 100u, 333u, 1000u }) {
+    cache_t<int> cache{ capacity };
+    for (const auto& key : trace) {
+      if (!cache.find(key).first) {
+        cache.add(key);
+      }
+    }
+    QCOMPARE(cache.statistics().miss_ratio(), curve[capacity]);
+  }
+}
+
+void TestMissRatioCurve::
+test_capacity_for_target_miss_ratio() {
+  const std::vector<int> trace{ 1, 2, 3, 1, 2, 3, 1, 2, 3, 1, 2, 3 };
+  miss_ratio_curve_t<int> mrc;
+  mrc.replay(trace.begin(), trace.end());
+
+  // LRU thrashes with a cyclic trace until everything fits:
+  QCOMPARE(mrc.miss_ratio(2), 1.0);
+  QCOMPARE(mrc.miss_ratio(3), 0.25);
+  QCOMPARE(mrc.capacity_for(0.5), 3u);
+  QCOMPARE(mrc.capacity_for(1.0), 0u);
+  QCOMPARE(mrc.capacity_for(0.1), miss_ratio_curve_t<int>::not_found);
+}
+
+void TestMissRatioCurve::
+test_sampled_curve_should_approximate_the_exact_one() {
+  std::mt19937 generator{ 7 };
+  std::geometric_distribution<int> distribution{ 0.0005 };
+  std::vector<int> trace(300000);
+  for (auto& key : trace) {
+    key = distribution(generator);
+  }
+
+  miss_ratio_curve_t<int> exact, sampled{ 0.1 };
+  exact.replay(trace.begin(), trace.end());
+  sampled.replay(trace.begin(), trace.end());
+
+  QVERIFY(sampled.sampled_references() < trace.size() / 5);
+  QVERIFY(sampled.distinct_keys() < exact.distinct_keys() / 5);
+  for (size_t capacity : { 500u, 1000u, 2000u, 4000u }) {
+    QVERIFY2(std::abs(exact.miss_ratio(capacity) -
+                      sampled.miss_ratio(capacity)) < 0.05,
+             "SHARDS error should be small");
+  }
+}
+
+void TestMissRatioCurve::
+test_invalid_sampling_rate_should_throw() {
+  QVERIFY_EXCEPTION_THROWN(miss_ratio_curve_t<int>{ 0.0 }, std::invalid_argument);
+  QVERIFY_EXCEPTION_THROWN(miss_ratio_curve_t<int>{ 1.5 }, std::invalid_argument);
+}
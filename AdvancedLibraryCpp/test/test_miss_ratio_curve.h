@@ -0,0 +1,21 @@
+#pragma once
+
+#include <QObject>
+#include <QTest>
+
+#include "../tools/miss_ratio_curve.h"
+
+class TestMissRatioCurve : public QObject
+{
+  Q_OBJECT
+public:
+  explicit TestMissRatioCurve(QObject *parent = nullptr);
+
+private slots:
+
+  void test_stack_distances_of_a_small_trace();
+  void test_curve_should_match_a_real_lru_cache();
+  void test_capacity_for_target_miss_ratio();
+  void test_sampled_curve_should_approximate_the_exact_one();
+  void test_invalid_sampling_rate_should_throw();
+};
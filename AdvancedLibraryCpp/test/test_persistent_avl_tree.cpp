@@ -0,0 +1,259 @@
+#include "test_persistent_avl_tree.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <random>
+#include <set>
+#include <thread>
+#include <vector>
+#include "../structures/binary_tree.h"
+
+using namespace advanced::structures;
+
+namespace {
+
+/**
+ * int key counting its copies
+ */
+struct counted_t {
+  static size_t copies;
+
+  int value{ 0 };
+
+  counted_t(int value) : value{ value } { }
+
+  counted_t(const counted_t& other) : value{ other.value } {
+    copies++;
+  }
+
+  counted_t&
+  operator=(const counted_t& other) {
+    value = other.value;
+    copies++;
+    return *this;
+  }
+
+  bool
+  operator<(const counted_t& other) const {
+    return value < other.value;
+  }
+};
+
+size_t counted_t::copies{ 0 };
+
+bool
+is_balanced(size_t height, size_t size) {
+  return height <= 1.45 * std::log2(size + 2.0);
+}
+
+}
+
+TestPersistentAVLTree::
+TestPersistentAVLTree(QObject *parent) : QObject(parent) {
+  QObject::setObjectName("TestPersistentAVLTree");
+}
+
+void TestPersistentAVLTree::
+test_insert_remove_and_contains() {
+  persistent_avl_tree_t<int> tree;
+  QVERIFY(tree.empty());
+  for (const int value : { 7, 4, 10, 2, 5, 8, 12, 1, 3, 6, 9, 11 }) {
+    QVERIFY(tree.insert(value));
+  }
+  QVERIFY(!tree.insert(5));
+  QCOMPARE(tree.size(), 12u);
+  QCOMPARE(tree.height(), 4u);
+  QCOMPARE(tree.left_most(), 1);
+  QCOMPARE(tree.right_most(), 12);
+
+  QVERIFY(tree.remove(7));
+  QVERIFY(!tree.remove(7));
+  QVERIFY(!tree.contains(7));
+  QVERIFY(tree.contains(8));
+  QCOMPARE(tree.size(), 11u);
+
+  tree.clear();
+  QVERIFY(tree.empty());
+  QVERIFY_EXCEPTION_THROWN(tree.left_most(), std::out_of_range);
+}
+
+void TestPersistentAVLTree::
+test_snapshots_are_not_modified() {
+  persistent_avl_tree_t<int> tree;
+  for (int value = 0; value < 100; value++) {
+    tree.insert(value);
+  }
+  const auto first{ tree.snapshot() };
+  QVERIFY(first.is_same_version(tree));
+
+  for (int value = 0; value < 100; value += 2) {
+    tree.remove(value);
+  }
+  tree.insert(1000);
+  const auto second{ tree.snapshot() };
+  tree.clear();
+
+  QCOMPARE(first.size(), 100u);
+  QVERIFY(first.contains(50));
+  QVERIFY(!first.contains(1000));
+  QCOMPARE(second.size(), 51u);
+  QVERIFY(!second.contains(50));
+  QVERIFY(second.contains(1000));
+  QVERIFY(tree.empty());
+  QVERIFY(!first.is_same_version(second));
+
+  // a failed update keeps the version
+  auto copied{ second };
+  QVERIFY(!copied.insert(1000));
+  QVERIFY(copied.is_same_version(second));
+}
+
+void TestPersistentAVLTree::
+test_updates_copy_only_the_path() {
+  persistent_avl_tree_t<counted_t> tree;
+  for (int value = 0; value < 1024; value++) {
+    tree.insert(value);
+  }
+  const auto snapshot{ tree.snapshot() };
+  const size_t height{ tree.height() };
+
+  counted_t::copies = 0;
+  tree.insert(2000);
+  QVERIFY(counted_t::copies <= height + 3);
+
+  counted_t::copies = 0;
+  tree.remove(512);
+  QVERIFY(counted_t::copies <= 2 * height + 3);
+  QCOMPARE(snapshot.size(), 1024u);
+  QVERIFY(snapshot.contains(512));
+}
+
+void TestPersistentAVLTree::
+test_random_operations_should_match_std_set() {
+  std::mt19937 generator{ 13 };
+  persistent_avl_tree_t<int> tree;
+  std::set<int> expected;
+  std::vector<std::pair<persistent_avl_tree_t<int>, std::set<int>>> versions;
+
+  for (int ii = 0; ii < 20000; ii++) {
+    const int value{ static_cast<int>(generator() % 1000) };
+    if (generator() % 3) {
+      QCOMPARE(tree.insert(value), expected.insert(value).second);
+    }
+    else {
+      QCOMPARE(tree.remove(value), expected.erase(value) == 1u);
+    }
+    if (ii % 2000 == 0) {
+      versions.emplace_back(tree.snapshot(), expected);
+    }
+  }
+  QCOMPARE(tree.size(), expected.size());
+  QVERIFY(is_balanced(tree.height(), tree.size()));
+  for (const auto& version : versions) {
+    QCOMPARE(version.first.size(), version.second.size());
+    QVERIFY(std::equal(version.first.begin(), version.first.end(),
+                       version.second.begin(), version.second.end()));
+  }
+}
+
+void TestPersistentAVLTree::
+test_iterators() {
+  persistent_avl_tree_t<int> tree;
+  for (int value = 30; value > 0; value -= 3) {
+    tree.insert(value);
+  }
+  const std::vector<int> expected{ 3, 6, 9, 12, 15, 18, 21, 24, 27, 30 };
+  QVERIFY(std::equal(tree.begin(), tree.end(), expected.begin(), expected.end()));
+
+  // the iterator keeps its version alive
+  auto it{ tree.begin() };
+  tree.clear();
+  QCOMPARE(*it, 3);
+  QCOMPARE(size_t(std::distance(it, tree.end())), expected.size());
+  QVERIFY(tree.begin() == tree.end());
+
+  std::vector<int> visited;
+  persistent_avl_tree_t<int> other;
+  other.insert(1);
+  other.insert(2);
+  other.in_order([&visited](int value) {
+    visited.push_back(value);
+    return false;
+  });
+  QVERIFY((visited == std::vector<int>{ 1, 2 }));
+}
+
+void TestPersistentAVLTree::
+test_concurrent_readers_over_snapshots() {
+  persistent_avl_tree_t<int> tree;
+  std::atomic_bool done  { false };
+  std::atomic_int  errors{ 0 };
+
+  // the writer keeps the invariant: value i is present iff i + 1000 is not
+  for (int value = 0; value < 1000; value++) {
+    tree.insert(value);
+  }
+  std::thread writer{ [&]() {
+    std::mt19937 generator{ 3 };
+    for (int ii = 0; ii < 20000; ii++) {
+      const int value{ static_cast<int>(generator() % 1000) };
+      if (tree.remove(value)) {
+        tree.insert(value + 1000);
+      }
+      else {
+        tree.remove(value + 1000);
+        tree.insert(value);
+      }
+    }
+    done = true;
+  }};
+  std::vector<std::thread> readers;
+  for (int ii = 0; ii < 3; ii++) {
+    readers.emplace_back([&]() {
+      while (!done) {
+        const auto snapshot{ tree.snapshot() };
+        const size_t size{ snapshot.size() };
+        errors += size < 999 || size > 1001;
+        errors += !std::is_sorted(snapshot.begin(), snapshot.end());
+        errors += static_cast<size_t>(std::distance(snapshot.begin(), snapshot.end())) != size;
+      }
+    });
+  }
+  writer.join();
+  for (auto& reader : readers) {
+    reader.join();
+  }
+  QCOMPARE(errors.load(), 0);
+  QCOMPARE(tree.size(), 1000u);
+}
+
+void TestPersistentAVLTree::
+benchmark_snapshot() {
+  persistent_avl_tree_t<int> tree;
+  for (int value = 0; value < 100000; value++) {
+    tree.insert(value);
+  }
+  size_t total{ 0 };
+  QBENCHMARK {
+    const auto snapshot{ tree.snapshot() };
+    tree.insert(-static_cast<int>(total));
+    total += snapshot.size();
+  }
+  QVERIFY(total > 0);
+}
+
+void TestPersistentAVLTree::
+benchmark_avl_tree_copy() {
+  avl_tree_t<int> tree;
+  for (int value = 0; value < 100000; value++) {
+    tree.insert(value);
+  }
+  size_t total{ 0 };
+  QBENCHMARK {
+    const avl_tree_t<int> copied{ tree };
+    tree.insert(-static_cast<int>(total));
+    total += copied.size();
+  }
+  QVERIFY(total > 0);
+}
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <QObject>
+#include <QTest>
+
+#include "../structures/persistent_avl_tree.h"
+
+class TestPersistentAVLTree : public QObject
+{
+  Q_OBJECT
+public:
+  explicit TestPersistentAVLTree(QObject *parent = nullptr);
+
+private slots:
+
+  void test_insert_remove_and_contains();
+  void test_snapshots_are_not_modified();
+  void test_updates_copy_only_the_path();
+  void test_random_operations_should_match_std_set();
+  void test_iterators();
+  void test_concurrent_readers_over_snapshots();
+  void benchmark_snapshot();
+  void benchmark_avl_tree_copy();
+};
@@ -0,0 +1,157 @@
+#include "test_static_search_tree.h"
+
+#include <algorithm>
+#include <random>
+#include <string>
+#include <vector>
+#include "lookup_data.h"
+
+using namespace advanced::structures;
+using test::structures::lookup_data_t;
+
+namespace {
+
+using layout_t = static_search_tree_t<int>::layout_t;
+
+}
+
+TestStaticSearchTree::
+TestStaticSearchTree(QObject *parent) : QObject(parent) {
+  QObject::setObjectName("TestStaticSearchTree");
+}
+
+void TestStaticSearchTree::
+test_lower_bound_should_match_std_lower_bound() {
+  std::mt19937 generator{ 5 };
+  for (const layout_t layout : { layout_t::eytzinger, layout_t::van_emde_boas }) {
+    // every size up to a few complete trees, so all paddings are covered
+    for (size_t size = 0; size < 70; size++) {
+      std::vector<int> values(size);
+      for (auto& value : values) {
+        value = static_cast<int>(generator() % 1000);
+      }
+      std::sort(values.begin(), values.end());
+      values.erase(std::unique(values.begin(), values.end()), values.end());
+
+      const static_search_tree_t<int> tree{ values.begin(), values.end(), layout };
+      QCOMPARE(tree.size(), values.size());
+      size_t wrong{ 0 };
+      for (int value = -1; value <= 1001; value++) {
+        const auto expected{ std::lower_bound(values.begin(), values.end(), value) };
+        const int* found{ tree.lower_bound(value) };
+        wrong += expected == values.end() ? found != nullptr
+                                          : !found || *found != *expected;
+      }
+      QCOMPARE(wrong, 0u);
+    }
+  }
+}
+
+void TestStaticSearchTree::
+test_contains() {
+  const std::vector<std::string> values{ "apple", "banana", "cherry", "kiwi", "lemon" };
+  for (const auto layout : { static_search_tree_t<std::string>::layout_t::eytzinger,
+                             static_search_tree_t<std::string>::layout_t::van_emde_boas }) {
+    const static_search_tree_t<std::string> tree{ values.begin(), values.end(), layout };
+    QCOMPARE(tree.layout(), layout);
+    for (const auto& value : values) {
+      QVERIFY(tree.contains(value));
+    }
+    QVERIFY(!tree.contains("fig"));
+    QVERIFY(!tree.contains("zucchini"));
+    QCOMPARE(*tree.lower_bound("fig"), std::string{ "kiwi" });
+  }
+}
+
+void TestStaticSearchTree::
+test_build_from_avl_tree() {
+  avl_tree_t<int> avl;
+  for (int value = 0; value < 1000; value += 3) {
+    avl.insert(value);
+  }
+  const static_search_tree_t<int> tree{ avl, layout_t::van_emde_boas };
+  QCOMPARE(tree.size(), avl.size());
+  for (int value = 0; value < 1000; value++) {
+    QCOMPARE(tree.contains(value), avl.contains(value));
+  }
+  // a complete tree of height 9
+  QCOMPARE(tree.memory_usage(), 511 * sizeof(int));
+}
+
+void TestStaticSearchTree::
+test_duplicates_and_unsorted_ranges() {
+  const std::vector<int> values{ 1, 1, 2, 3, 3, 3, 7 };
+  const static_search_tree_t<int> tree{ values.begin(), values.end() };
+  QCOMPARE(tree.size(), 4u);
+  QCOMPARE(*tree.lower_bound(4), 7);
+
+  const std::vector<int> unsorted{ 3, 1, 2 };
+  QVERIFY_EXCEPTION_THROWN((static_search_tree_t<int>{ unsorted.begin(), unsorted.end() }),
+                           std::invalid_argument);
+}
+
+void TestStaticSearchTree::
+test_empty_tree() {
+  const static_search_tree_t<int> tree;
+  QVERIFY(tree.empty());
+  QVERIFY(!tree.contains(1));
+  QVERIFY(tree.lower_bound(1) == nullptr);
+
+  const std::vector<int> values;
+  const static_search_tree_t<int> built{ values.begin(), values.end(),
+                                         layout_t::van_emde_boas };
+  QVERIFY(!built.contains(0));
+}
+
+void TestStaticSearchTree::
+benchmark_eytzinger() {
+  const lookup_data_t data;
+  const static_search_tree_t<int> tree{ data.keys.begin(), data.keys.end() };
+  size_t found{ 0 };
+  QBENCHMARK {
+    for (const auto& query : data.queries) {
+      found += tree.contains(query);
+    }
+  }
+  QVERIFY(found > 0);
+}
+
+void TestStaticSearchTree::
+benchmark_van_emde_boas() {
+  const lookup_data_t data;
+  const static_search_tree_t<int> tree{ data.keys.begin(), data.keys.end(),
+                                        layout_t::van_emde_boas };
+  size_t found{ 0 };
+  QBENCHMARK {
+    for (const auto& query : data.queries) {
+      found += tree.contains(query);
+    }
+  }
+  QVERIFY(found > 0);
+}
+
+void TestStaticSearchTree::
+benchmark_avl_tree() {
+  const lookup_data_t data;
+  avl_tree_t<int> tree;
+  tree.rebuild(data.keys.begin(), data.keys.end());
+  size_t found{ 0 };
+  QBENCHMARK {
+    for (const auto& query : data.queries) {
+      found += tree.contains(query);
+    }
+  }
+  QVERIFY(found > 0);
+}
+
+void TestStaticSearchTree::
+benchmark_std_lower_bound() {
+  const lookup_data_t data;
+  size_t found{ 0 };
+  QBENCHMARK {
+    for (const auto& query : data.queries) {
+      found += std::binary_search(data.keys.begin(), data.keys.end(), query);
+    }
+  }
+  QVERIFY(found > 0);
+}
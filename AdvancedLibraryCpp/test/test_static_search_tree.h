@@ -0,0 +1,25 @@
+#pragma once
+
+#include <QObject>
+#include <QTest>
+
+#include "../structures/static_search_tree.h"
+
+class TestStaticSearchTree : public QObject
+{
+  Q_OBJECT
+public:
+  explicit TestStaticSearchTree(QObject *parent = nullptr);
+
+private slots:
+
+  void test_lower_bound_should_match_std_lower_bound();
+  void test_contains();
+  void test_build_from_avl_tree();
+  void test_duplicates_and_unsorted_ranges();
+  void test_empty_tree();
+  void benchmark_eytzinger();
+  void benchmark_van_emde_boas();
+  void benchmark_avl_tree();
+  void benchmark_std_lower_bound();
+};
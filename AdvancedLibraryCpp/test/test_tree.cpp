@@ -1,7 +1,72 @@
 #include "test_tree.h"
+#include <atomic>
+#include <future>
+#include <mutex>
+#include <random>
+#include <type_traits>
+#include <unordered_map>
+
+#include "../tools/math_operation.h"
 
 using namespace advanced::structures;
 
+namespace {
+
+/**
+ * complete tree with 4 children per node, numbered in BFS order: the children
+ * of node k are 4k + 1 ... 4k + 4
+ */
+tree_t<int, tree_node_t<int, 4>>
+full_quad_tree(int height) {
+  tree_t<int, tree_node_t<int, 4>> tree{ 0 };
+  std::vector<tree_node_t<int, 4>*> level{ &tree.root() };
+  int value{ 1 };
+  for (int depth = 0; depth < height; depth++) {
+    std::vector<tree_node_t<int, 4>*> next;
+    for (auto node : level) {
+      for (size_t child = 0; child < 4; child++) {
+        node->add_child(value++);
+        next.push_back(&node->child(child));
+      }
+    }
+    level.swap(next);
+  }
+  return tree;
+}
+
+using sum_node_t = tree_node_t<int, 4, advanced::tools::sum_t<int>>;
+using max_node_t = tree_node_t<int, 4, advanced::tools::maximum_t<int>>;
+
+/**
+ * subtree aggregate recomputed from scratch
+ */
+template <class node_t, class operation_t>
+int
+brute_aggregate(const node_t& node, operation_t operation) {
+  int aggregate{ *node };
+  for (const node_t* child : node) {
+    if (child) {
+      aggregate = operation(aggregate, brute_aggregate(*child, operation));
+    }
+  }
+  return aggregate;
+}
+
+/**
+ * whether every node of the subtree keeps the right aggregate
+ */
+template <class node_t, class operation_t>
+bool
+aggregates_match(const node_t& node, operation_t operation) {
+  bool ok{ node.aggregate() == brute_aggregate(node, operation) };
+  for (const node_t* child : node) {
+    ok = ok && (!child || aggregates_match(*child, operation));
+  }
+  return ok;
+}
+
+}
+
 TestTree::
 TestTree(QObject *parent) : QObject{ parent } {
   QObject::setObjectName("TestTree");
@@ -670,3 +735,535 @@ test_last() {
   QVERIFY_EXCEPTION_THROWN(ref.last().last().last().last(),
                            null_node_exception_t);
 }
+
+void TestTree::
+test_visitor_should_match_std_function() {
+  auto quad_tree = get_test_tree();
+  std::vector<std::string> expected, visited;
+  const std::function<bool(const tree_node_t<std::string, 4>&)> record {
+    [&expected](const auto& node) {
+      expected.push_back(node.get());
+      return false;
+    }
+  };
+  const auto visit { [&visited](const auto& node) {
+      visited.push_back(node.get());
+      return false;
+    }
+  };
+
+  const auto& tree_ref{ quad_tree };
+  QCOMPARE(quad_tree.in_order(visit), tree_ref.in_order(record));
+  QCOMPARE(visited, expected);
+  expected.clear(); visited.clear();
+  QCOMPARE(quad_tree.pre_order(visit), tree_ref.pre_order(record));
+  QCOMPARE(visited, expected);
+  expected.clear(); visited.clear();
+  QCOMPARE(quad_tree.pos_order(visit), tree_ref.pos_order(record));
+  QCOMPARE(visited, expected);
+
+  // the search stops at "3", it does not reach the right part of "2"
+  size_t steps = quad_tree.in_order([](const auto& node) { return *node == "3"; });
+  QCOMPARE(steps, 5u);
+}
+
+void TestTree::
+test_bfs_and_dfs_with_scratch_buffer() {
+  auto quad_tree = get_test_tree();
+  const auto& tree_ref{ quad_tree };
+  const std::vector<std::string> bfs {
+    "7", "4", "10", "1", "2", "5", "6", "8", "9", "11", "13", "3", "12"
+  };
+  const std::vector<std::string> dfs {
+    "7", "4", "1", "2", "3", "5", "6", "10", "8", "9", "11", "13", "12"
+  };
+  std::vector<std::string> visited;
+  const auto visit { [&visited](const auto& node) {
+      visited.push_back(node.get());
+      return false;
+    }
+  };
+
+  std::vector<tree_node_t<std::string, 4>*> scratch{ nullptr, nullptr };
+  QCOMPARE(quad_tree.breadth_first_search(visit, scratch), bfs.size());
+  QCOMPARE(visited, bfs);
+  const size_t capacity{ scratch.capacity() };
+  visited.clear();
+  QCOMPARE(quad_tree.depth_first_search(visit, scratch), dfs.size());
+  QCOMPARE(visited, dfs);
+  QCOMPARE(scratch.capacity(), capacity);
+
+  std::vector<const tree_node_t<std::string, 4>*> const_scratch;
+  visited.clear();
+  QCOMPARE(tree_ref.breadth_first_search(visit, const_scratch), bfs.size());
+  QCOMPARE(visited, bfs);
+  visited.clear();
+  QCOMPARE(tree_ref.depth_first_search(visit, const_scratch), dfs.size());
+  QCOMPARE(visited, dfs);
+
+  size_t steps = quad_tree.breadth_first_search(
+                   [](auto& node) { return *node == "8"; }, scratch);
+  QCOMPARE(steps, 8u);
+  steps = tree_ref.depth_first_search(
+            [](const auto& node) { return *node == "8"; }, const_scratch);
+  QCOMPARE(steps, 9u);
+
+  tree_t<std::string, tree_node_t<std::string, 4>> empty;
+  QCOMPARE(empty.breadth_first_search(visit, scratch), 0u);
+  QCOMPARE(empty.depth_first_search(visit, scratch), 0u);
+  QVERIFY(scratch.empty());
+}
+
+void TestTree::
+test_in_order_early_exit_is_per_call() {
+  auto quad_tree = get_test_tree();
+  const std::function<bool(tree_node_t<std::string, 4>&)> find_leaf {
+    [](auto& node) { return *node == "1"; }
+  };
+  QCOMPARE(quad_tree.in_order(find_leaf), 3u);   // "7", "4", "1"
+
+  std::vector<tree_t<std::string, tree_node_t<std::string, 4>>> trees;
+  trees.reserve(4);
+  for (size_t ii = 0; ii < 4; ii++) {
+    trees.push_back(get_test_tree());
+  }
+  std::vector<std::future<bool>> results;
+  for (auto& tree : trees) {
+    results.push_back(std::async(std::launch::async, [&tree]() {
+      bool ok{ true };
+      for (int ii = 0; ii < 1000; ii++) {
+        const std::function<bool(tree_node_t<std::string, 4>&)> find {
+          [](auto& node) { return *node == "3"; }
+        };
+        const std::function<bool(tree_node_t<std::string, 4>&)> all {
+          [](auto&) { return false; }
+        };
+        ok = ok && tree.in_order(find) == 5u && tree.in_order(all) == 13u;
+      }
+      return ok;
+    }));
+  }
+  for (auto& result : results) {
+    QVERIFY(result.get());
+  }
+}
+
+void TestTree::
+test_parallel_trasversals() {
+  auto tree{ full_quad_tree(6) };
+  const int value{ 5461 };    // nodes in the tree
+  const long expected_sum{ static_cast<long>(value) * (value - 1) / 2 };
+
+  for (size_t threads : { 1u, 2u, 4u, 8u }) {
+    std::atomic<long> sum{ 0 };
+    const size_t visited{ tree.parallel_for_each_node([&sum](auto& node) {
+        sum += *node;
+      }, threads) };
+    QCOMPARE(visited, static_cast<size_t>(value));
+    QCOMPARE(sum.load(), expected_sum);
+
+    // the subtrees of the nodes at depth 3 are skipped
+    std::atomic<size_t> calls{ 0u };
+    std::mutex mutex;
+    std::vector<int> order;
+    const auto& tree_ref{ tree };
+    const size_t pruned{ tree_ref.parallel_pre_order([&](const auto& node) {
+        std::lock_guard<std::mutex> lock{ mutex };
+        order.push_back(*node);
+        calls++;
+        return *node >= 21 && *node < 85;
+      }, threads) };
+    QCOMPARE(pruned, 85u);
+    QCOMPARE(calls.load(), 85u);
+    // each node is visited after its parent
+    std::vector<size_t> position(value);
+    for (size_t ii = 0; ii < order.size(); ii++) {
+      position[order[ii]] = ii;
+    }
+    for (int node : order) {
+      if (node) {
+        QVERIFY(position[(node - 1) / 4] < position[node]);
+      }
+    }
+  }
+
+  tree_t<int, tree_node_t<int, 4>> empty;
+  QCOMPARE(empty.parallel_for_each_node([](auto&) { }), 0u);
+}
+
+void TestTree::
+benchmark_for_each_node() {
+  auto tree{ full_quad_tree(9) };
+  std::atomic<long> sum{ 0 };
+  QBENCHMARK {
+    tree.pre_order([&sum](auto& node) {
+      sum.fetch_add(*node, std::memory_order_relaxed);
+      return false;
+    });
+  }
+}
+
+void TestTree::
+benchmark_parallel_for_each_node() {
+  auto tree{ full_quad_tree(9) };
+  std::atomic<long> sum{ 0 };
+  QBENCHMARK {
+    tree.parallel_for_each_node([&sum](auto& node) {
+      sum.fetch_add(*node, std::memory_order_relaxed);
+    });
+  }
+}
+
+void TestTree::
+test_deep_copy_and_move() {
+  using quad_tree_t = tree_t<std::string, tree_node_t<std::string, 4>>;
+  static_assert(std::is_nothrow_move_constructible<quad_tree_t>::value, "O(1) move");
+  static_assert(std::is_nothrow_move_assignable<quad_tree_t>::value, "O(1) move");
+
+  auto quad_tree = get_test_tree();
+  std::vector<std::string> expected, visited;
+  quad_tree.pre_order([&expected](auto& node) {
+    expected.push_back(node.get());
+    return false;
+  });
+
+  quad_tree_t copy{ quad_tree };
+  copy.root().child(1).child(1).child(2).get() = "33";
+  copy.root().child(3).delete_child(0);
+  quad_tree.pre_order([&visited](auto& node) {
+    visited.push_back(node.get());
+    return false;
+  });
+  QCOMPARE(visited, expected);
+  QCOMPARE(copy.root().child(1).child(1).child(2).get(), "33");
+  // null children keep their positions, parents point into the copy
+  QVERIFY(!copy.root().has_child(0));
+  QVERIFY(!copy.root().child(1).child(1).has_child(1));
+  QCOMPARE(&copy.root().child(1).child(1).child(2).parent(),
+           &copy.root().child(1).child(1));
+  QVERIFY(!copy.root().has_parent());
+
+  // a node copied from a non-const reference is a deep copy without parent
+  auto& four{ quad_tree.root().child(1) };
+  tree_node_t<std::string, 4> node{ four };
+  QVERIFY(!node.has_parent());
+  QCOMPARE(node.children_count(), 4u);
+  QCOMPARE(node.child(1).child(2).get(), "3");
+  QCOMPARE(&node.child(1).parent(), &node);
+  node = quad_tree.root().child(3);
+  QCOMPARE(node.get(), "10");
+  QCOMPARE(node.last().last().get(), "12");
+
+  copy = quad_tree;
+  copy = copy;
+  visited.clear();
+  copy.pre_order([&visited](auto& node) {
+    visited.push_back(node.get());
+    return false;
+  });
+  QCOMPARE(visited, expected);
+  copy = quad_tree_t{};
+  QVERIFY(!copy.has_root());
+
+  quad_tree_t moved{ std::move(quad_tree) };
+  QVERIFY(!quad_tree.has_root());
+  QCOMPARE(moved.root().child(1).child(0).get(), "1");
+  quad_tree = std::move(moved);
+  QVERIFY(!moved.has_root());
+  QCOMPARE(quad_tree.root().get(), "7");
+}
+
+void TestTree::
+test_copy_deep_tree() {
+  tree_t<int, tree_node_t<int, 2>> chain{ 0 };
+  auto* node{ &chain.root() };
+  for (int ii = 1; ii < 1000000; ii++) {
+    node->add_child(ii);
+    node = &node->child(0);
+  }
+  const auto copy{ chain };
+  const auto* copied{ &copy.root() };
+  int depth{ 0 };
+  for (; copied->has_child(0); copied = &copied->child(0)) {
+    depth++;
+  }
+  QCOMPARE(depth, 999999);
+  QCOMPARE(copied->get(), 999999);
+  QVERIFY(copied != node);
+}
+
+void TestTree::
+test_level_order_search() {
+  auto quad_tree = get_test_tree();
+  const auto& tree_ref{ quad_tree };
+  const std::vector<std::string> bfs {
+    "7", "4", "10", "1", "2", "5", "6", "8", "9", "11", "13", "3", "12"
+  };
+  std::vector<std::string> visited;
+  const auto visit { [&visited](const auto& node) {
+      visited.push_back(node.get());
+      return false;
+    }
+  };
+  QCOMPARE(quad_tree.level_order_search(visit), bfs.size());
+  QCOMPARE(visited, bfs);
+  visited.clear();
+  QCOMPARE(tree_ref.level_order_search(visit, 4u), bfs.size());
+  QCOMPARE(visited, bfs);
+  QCOMPARE(quad_tree.level_order_search([](auto& node) { return *node == "8"; }), 8u);
+
+  tree_t<std::string, tree_node_t<std::string, 4>> empty;
+  QCOMPARE(empty.level_order_search(visit, 2u), 0u);
+
+  // the last two levels, of 16384 and 65536 nodes, are wide enough to be
+  // split between threads
+  auto tree{ full_quad_tree(8) };
+  const int value{ 87381 };   // nodes in the tree
+  const auto depth_of{ [](int node) {
+      int depth{ 0 };
+      for (; node; node = (node - 1) / 4) {
+        depth++;
+      }
+      return depth;
+    }
+  };
+  const auto& full_ref{ tree };
+  for (size_t threads : { 1u, 2u, 4u }) {
+    std::mutex mutex;
+    std::vector<int> order;
+    const size_t count{ tree.level_order_search([&](auto& node) {
+        std::lock_guard<std::mutex> lock{ mutex };
+        order.push_back(*node);
+        return false;
+      }, threads) };
+    QCOMPARE(count, static_cast<size_t>(value));
+    QCOMPARE(order.size(), static_cast<size_t>(value));
+    // every level is visited before the next one
+    for (size_t ii = 1; ii < order.size(); ii++) {
+      QVERIFY(depth_of(order[ii - 1]) <= depth_of(order[ii]));
+    }
+    if (threads == 1u) {
+      for (int ii = 0; ii < value; ii++) {
+        QCOMPARE(order[ii], ii);
+      }
+    }
+
+    // it stops inside a split level, the other threads stop soon after
+    std::atomic<size_t> calls{ 0u };
+    const size_t steps{ full_ref.level_order_search([&calls](const auto& node) {
+        calls++;
+        return *node == 10000;
+      }, threads) };
+    QCOMPARE(steps, calls.load());
+    QVERIFY(steps >= 5462u && steps < static_cast<size_t>(value));
+    if (threads == 1u) {
+      QCOMPARE(steps, 10001u);
+    }
+  }
+}
+
+void TestTree::
+benchmark_breadth_first_search() {
+  auto tree{ full_quad_tree(9) };
+  long sum{ 0 };
+  QBENCHMARK {
+    tree.breadth_first_search([&sum](auto& node) {
+      sum += *node;
+      return false;
+    });
+  }
+}
+
+void TestTree::
+benchmark_level_order_search() {
+  auto tree{ full_quad_tree(9) };
+  long sum{ 0 };
+  QBENCHMARK {
+    tree.level_order_search([&sum](auto& node) {
+      sum += *node;
+      return false;
+    });
+  }
+}
+
+void TestTree::
+benchmark_parallel_level_order_search() {
+  auto tree{ full_quad_tree(9) };
+  std::atomic<long> sum{ 0 };
+  QBENCHMARK {
+    tree.level_order_search([&sum](auto& node) {
+      sum.fetch_add(*node, std::memory_order_relaxed);
+      return false;
+    }, std::thread::hardware_concurrency());
+  }
+}
+
+void TestTree::
+test_subtree_aggregates() {
+  const advanced::tools::sum_t<int> sum;
+  tree_t<int, sum_node_t> tree{ 1 };
+  auto& root{ tree.root() };
+  QCOMPARE(root.aggregate(), 1);
+  QVERIFY(root.add_child(2));
+  QVERIFY(root.insert_at(3, 3));
+  QVERIFY(root.child(0).add_child(4));
+  QVERIFY(root.child(0).insert_at_first_null(5));
+  QCOMPARE(root.aggregate(), 15);
+  QCOMPARE(root.child(0).aggregate(), 11);
+  QCOMPARE(root.child(3).aggregate(), 3);
+
+  root.child(0).child(1).set_value(50);
+  QCOMPARE(root.aggregate(), 60);
+  QCOMPARE(root.child(0).aggregate(), 56);
+
+  // the value changed through get() needs an explicit update
+  root.child(0).child(0).get() = 40;
+  root.child(0).child(0).update_aggregates();
+  QCOMPARE(root.aggregate(), 96);
+
+  auto replaced{ root.replace_at(0, 7) };
+  QCOMPARE(replaced->aggregate(), 92);
+  QVERIFY(!replaced->has_parent());
+  QCOMPARE(root.aggregate(), 11);
+  QVERIFY(root.replace_at(4, 100) == nullptr);
+  QCOMPARE(root.aggregate(), 11);
+
+  auto extracted{ root.extract_child(3) };
+  QCOMPARE(extracted->aggregate(), 3);
+  QCOMPARE(root.aggregate(), 8);
+  QVERIFY(root.delete_child(0));
+  QCOMPARE(root.aggregate(), 1);
+
+  QVERIFY(root.insert_at(0, 10));
+  QVERIFY(root.child(0).add_child(20));
+  root.child(0).swap(root.child(0).child(0));
+  QCOMPARE(*root.child(0), 20);
+  QCOMPARE(root.child(0).aggregate(), 30);
+  QCOMPARE(root.child(0).child(0).aggregate(), 10);
+  QCOMPARE(root.aggregate(), 31);
+
+  // copies keep the aggregates, moves update the path of the source
+  sum_node_t copy{ root };
+  QCOMPARE(copy.aggregate(), 31);
+  QVERIFY(aggregates_match(copy, sum));
+  sum_node_t moved{ std::move(root.child(0)) };
+  QCOMPARE(moved.aggregate(), 30);
+  QVERIFY(aggregates_match(moved, sum));
+  QCOMPARE(root.aggregate(), 1 + *root.child(0));
+  root.child(0) = copy;
+  QCOMPARE(root.aggregate(), 32);
+  QVERIFY(aggregates_match(root, sum));
+
+  root.child(0).clear();
+  QCOMPARE(root.aggregate(), 2);
+  root.clear();
+  QCOMPARE(root.aggregate(), 1);
+
+  const advanced::tools::maximum_t<int> maximum;
+  tree_t<int, max_node_t> max_tree{ 3 };
+  max_tree.root().add_child(8);
+  max_tree.root().add_child(5);
+  max_tree.root().child(1).add_child(9);
+  QCOMPARE(max_tree.root().aggregate(), 9);
+  max_tree.root().child(1).child(0).set_value(1);
+  QCOMPARE(max_tree.root().aggregate(), 8);
+  QCOMPARE(max_tree.root().child(1).aggregate(), 5);
+  const tree_t<int, max_node_t> max_copy{ max_tree };
+  QVERIFY(aggregates_match(max_copy.root(), maximum));
+
+  // without operation_t the node keeps nothing
+  QCOMPARE(sizeof(tree_node_t<int, 4>), sizeof(base_node_t<int, tree_node_t<int, 4>>) +
+                                        sizeof(std::vector<tree_node_t<int, 4>*>));
+}
+
+void TestTree::
+test_subtree_aggregates_random() {
+  std::mt19937 generator{ 49 };
+  const advanced::tools::sum_t<int>     sum;
+  const advanced::tools::maximum_t<int> maximum;
+  tree_t<int, sum_node_t> sum_tree{ 0 };
+  tree_t<int, max_node_t> max_tree{ 0 };
+  std::vector<sum_node_t*> sum_nodes{ &sum_tree.root() };
+  std::vector<max_node_t*> max_nodes{ &max_tree.root() };
+
+  // both trees get the same random changes
+  for (int step = 0; step < 3000; step++) {
+    const size_t node    { generator() % sum_nodes.size() };
+    const size_t position{ generator() % 4 };
+    const int    value   { static_cast<int>(generator() % 1000) - 500 };
+    const auto   change  { generator() % 10 };
+    auto& sum_node{ *sum_nodes[node] };
+    auto& max_node{ *max_nodes[node] };
+    if (change < 5) {
+      if (sum_node.insert_at(position, value)) {
+        QVERIFY(max_node.insert_at(position, value));
+        sum_nodes.push_back(&sum_node.child(position));
+        max_nodes.push_back(&max_node.child(position));
+      }
+    }
+    else if (change < 8) {
+      sum_node.set_value(value);
+      max_node.set_value(value);
+    }
+    else if (sum_node.has_child(position) && sum_nodes.size() > 100) {
+      // the extracted subtree leaves the tree, the nodes list is rebuilt
+      auto sum_extracted{ sum_node.extract_child(position) };
+      auto max_extracted{ max_node.extract_child(position) };
+      QVERIFY(aggregates_match(*sum_extracted, sum));
+      QVERIFY(aggregates_match(*max_extracted, maximum));
+      sum_nodes.clear();
+      max_nodes.clear();
+      sum_tree.pre_order([&sum_nodes](sum_node_t& visited) { sum_nodes.push_back(&visited); return false; });
+      max_tree.pre_order([&max_nodes](max_node_t& visited) { max_nodes.push_back(&visited); return false; });
+      QCOMPARE(sum_nodes.size(), max_nodes.size());
+    }
+    if (step % 100 == 0) {
+      QVERIFY(aggregates_match(sum_tree.root(), sum));
+      QVERIFY(aggregates_match(max_tree.root(), maximum));
+    }
+  }
+  QVERIFY(aggregates_match(sum_tree.root(), sum));
+  QVERIFY(aggregates_match(max_tree.root(), maximum));
+}
+
+void TestTree::
+benchmark_pos_order_subtree_sum() {
+  // one value changes, the sums of all the subtrees are recomputed
+  auto tree{ full_quad_tree(8) };
+  std::unordered_map<const tree_node_t<int, 4>*, long> sums;
+  int value{ 0 };
+  QBENCHMARK {
+    tree.root().child(3).child(3).child(3).set_value(value++);
+    tree.pos_order([&sums](const tree_node_t<int, 4>& node) {
+      long sum{ *node };
+      for (const auto* child : node) {
+        if (child) {
+          sum += sums[child];
+        }
+      }
+      sums[&node] = sum;
+      return false;
+    });
+  }
+}
+
+void TestTree::
+benchmark_subtree_aggregate_update() {
+  tree_t<int, sum_node_t> tree{ 0 };
+  std::vector<sum_node_t*> level{ &tree.root() };
+  for (int depth = 0; depth < 8; depth++) {
+    std::vector<sum_node_t*> next;
+    for (auto node : level) {
+      for (size_t child = 0; child < 4; child++) {
+        node->add_child(static_cast<int>(child));
+        next.push_back(&node->child(child));
+      }
+    }
+    level.swap(next);
+  }
+  int value{ 0 };
+  QBENCHMARK {
+    level.back()->set_value(value++);
+  }
+  QVERIFY(tree.root().aggregate() != 0);
+}
@@ -38,4 +38,20 @@ private slots:
   void test_for_range();
   void test_first();
   void test_last();
+  void test_visitor_should_match_std_function();
+  void test_bfs_and_dfs_with_scratch_buffer();
+  void test_in_order_early_exit_is_per_call();
+  void test_parallel_trasversals();
+  void benchmark_for_each_node();
+  void benchmark_parallel_for_each_node();
+  void test_deep_copy_and_move();
+  void test_copy_deep_tree();
+  void test_level_order_search();
+  void benchmark_breadth_first_search();
+  void benchmark_level_order_search();
+  void benchmark_parallel_level_order_search();
+  void test_subtree_aggregates();
+  void test_subtree_aggregates_random();
+  void benchmark_pos_order_subtree_sum();
+  void benchmark_subtree_aggregate_update();
 };
@@ -0,0 +1,294 @@
+#include "test_tree_index.h"
+
+#include <random>
+#include <utility>
+#include <vector>
+
+using namespace advanced::structures;
+
+namespace {
+
+using node_t     = tree_node_t<int, 4>;
+using int_tree_t = tree_t<int, node_t>;
+using sum_index_t = tree_index_t<int, node_t>;
+using min_index_t = tree_index_t<int, node_t, advanced::tools::minimum_t<int>>;
+using max_index_t = tree_index_t<int, node_t, advanced::tools::maximum_t<int>>;
+
+/**
+ *                     0
+ *         1           2              3
+ *      4     5               6    7     8
+ *   9                             10
+ *
+ * depth first pre order: 0 1 4 9 5 2 3 6 7 10 8
+ */
+int_tree_t
+get_test_tree() {
+  int_tree_t tree{ 0 };
+  tree.root().add_child(1);
+  tree.root().add_child(2);
+  tree.root().add_child(3);
+  tree.root().child(0).add_child(4);
+  tree.root().child(0).add_child(5);
+  tree.root().child(0).child(0).add_child(9);
+  tree.root().child(2).add_child(6);
+  tree.root().child(2).add_child(7);
+  tree.root().child(2).add_child(8);
+  tree.root().child(2).child(1).add_child(10);
+  return tree;
+}
+
+/**
+ * random tree, every node hangs from a random previous one. The value of each
+ * node is its number
+ */
+int_tree_t
+random_tree(size_t size, unsigned seed, std::vector<node_t*>& nodes) {
+  std::mt19937 generator{ seed };
+  int_tree_t tree{ 0 };
+  nodes.assign(1, &tree.root());
+  while (nodes.size() < size) {
+    node_t& parent{ *nodes[generator() % nodes.size()] };
+    if (parent.children_count() == 4) {
+      continue;
+    }
+    parent.add_child(static_cast<int>(nodes.size()));
+    for (size_t child = 0; child < 4; child++) {
+      if (parent.has_child(child) && parent.child(child).get() == static_cast<int>(nodes.size())) {
+        nodes.push_back(&parent.child(child));
+      }
+    }
+  }
+  return tree;
+}
+
+const node_t*
+parent_walk_lca(const node_t* a, const node_t* b) {
+  std::vector<const node_t*> path;
+  for (const node_t* node = a; node; node = node->has_parent() ? &node->parent() : nullptr) {
+    path.push_back(node);
+  }
+  for (const node_t* node = b; node; node = node->has_parent() ? &node->parent() : nullptr) {
+    if (std::find(path.begin(), path.end(), node) != path.end()) {
+      return node;
+    }
+  }
+  return nullptr;
+}
+
+}
+
+TestTreeIndex::
+TestTreeIndex(QObject *parent) : QObject{ parent } {
+  QObject::setObjectName("TestTreeIndex");
+}
+
+void
+TestTreeIndex::test_numbering_and_subtrees() {
+  const auto tree{ get_test_tree() };
+  const sum_index_t index{ tree };
+  QCOMPARE(index.size(), size_t{ 11 });
+  const std::vector<int> pre_order{ 0, 1, 4, 9, 5, 2, 3, 6, 7, 10, 8 };
+  for (size_t node = 0; node < pre_order.size(); node++) {
+    QCOMPARE(index.node(node).get(), pre_order[node]);
+    QCOMPARE(index.index_of(index.node(node)), static_cast<sum_index_t::index_t>(node));
+  }
+  QCOMPARE(index.parent(0), sum_index_t::npos);
+  QCOMPARE(index.parent(3), 2u);             // 9 -> 4
+  QCOMPARE(index.depth(3), size_t{ 3 });
+  QCOMPARE(index.subtree_size(1), size_t{ 4 });
+  QCOMPARE(index.subtree_size(6), size_t{ 5 });
+  QVERIFY(index.is_ancestor_of(1, 3));
+  QVERIFY(index.is_ancestor_of(3, 3));
+  QVERIFY(!index.is_ancestor_of(1, 5));
+  QVERIFY(!index.is_ancestor_of(3, 1));
+
+  int_tree_t other{ 0 };
+  QVERIFY_EXCEPTION_THROWN(index.index_of(other.root()), std::out_of_range);
+}
+
+void
+TestTreeIndex::test_lowest_common_ancestor() {
+  const auto tree{ get_test_tree() };
+  const sum_index_t index{ tree };
+  const auto lca{ [&index](int a, int b) {
+    const auto find{ [&index](int value) {
+      for (sum_index_t::index_t node = 0; node < index.size(); node++) {
+        if (index.node(node).get() == value) {
+          return node;
+        }
+      }
+      return sum_index_t::npos;
+    } };
+    return index.node(index.lowest_common_ancestor(find(a), find(b))).get();
+  } };
+  QCOMPARE(lca(9, 5), 1);
+  QCOMPARE(lca(5, 9), 1);
+  QCOMPARE(lca(9, 4), 4);
+  QCOMPARE(lca(9, 9), 9);
+  QCOMPARE(lca(10, 8), 3);
+  QCOMPARE(lca(9, 10), 0);
+  QCOMPARE(lca(2, 0), 0);
+
+  const auto& nine{ tree.root().child(0).child(0).child(0) };
+  const auto& ten { tree.root().child(2).child(1).child(0) };
+  QCOMPARE(&index.lowest_common_ancestor(nine, ten), &tree.root());
+  QCOMPARE(index.distance(index.index_of(nine), index.index_of(ten)), size_t{ 6 });
+  QVERIFY_EXCEPTION_THROWN(index.lowest_common_ancestor(0, 11), std::out_of_range);
+}
+
+void
+TestTreeIndex::test_ancestor() {
+  const auto tree{ get_test_tree() };
+  const sum_index_t index{ tree };
+  // node 3 is 9: 9 -> 4 -> 1 -> 0
+  QCOMPARE(index.ancestor(3, 0), 3u);
+  QCOMPARE(index.ancestor(3, 1), 2u);
+  QCOMPARE(index.ancestor(3, 2), 1u);
+  QCOMPARE(index.ancestor(3, 3), 0u);
+  QCOMPARE(index.ancestor(3, 4), sum_index_t::npos);
+  QCOMPARE(index.ancestor(0, 0), 0u);
+  QVERIFY_EXCEPTION_THROWN(index.ancestor(20, 1), std::out_of_range);
+}
+
+void
+TestTreeIndex::test_path_query() {
+  const auto tree{ get_test_tree() };
+  sum_index_t sums{ tree };
+  min_index_t minimums{ tree };
+  max_index_t maximums{ tree };
+  const auto& nine{ tree.root().child(0).child(0).child(0) };
+  const auto& five{ tree.root().child(0).child(1) };
+  const auto& ten { tree.root().child(2).child(1).child(0) };
+
+  // 9 4 1 0 3 7 10
+  QCOMPARE(sums.path_query(sums.index_of(nine), sums.index_of(ten)), 34);
+  QCOMPARE(sums.path_query(sums.index_of(ten), sums.index_of(nine)), 34);
+  // 9 4 1 5
+  QCOMPARE(sums.path_query(sums.index_of(nine), sums.index_of(five)), 19);
+  QCOMPARE(sums.path_query(sums.index_of(five), sums.index_of(five)), 5);
+  QCOMPARE(minimums.path_query(minimums.index_of(nine), minimums.index_of(ten)), 0);
+  QCOMPARE(minimums.path_query(minimums.index_of(nine), minimums.index_of(five)), 1);
+  QCOMPARE(maximums.path_query(maximums.index_of(nine), maximums.index_of(five)), 9);
+  QCOMPARE(maximums.path_query(maximums.index_of(ten), maximums.index_of(tree.root().child(2))), 10);
+}
+
+void
+TestTreeIndex::test_update() {
+  auto tree{ get_test_tree() };
+  sum_index_t index{ tree };
+  const auto nine{ index.index_of(tree.root().child(0).child(0).child(0)) };
+  const auto ten { index.index_of(tree.root().child(2).child(1).child(0)) };
+  const auto one { index.index_of(tree.root().child(0)) };
+
+  index.update(one, 100);
+  QCOMPARE(index.value(one), 100);
+  QCOMPARE(index.path_query(nine, ten), 133);
+  index.update(0, -5);
+  QCOMPARE(index.path_query(nine, ten), 128);
+  QCOMPARE(index.path_query(nine, one), 113);
+  // the tree is not changed
+  QCOMPARE(tree.root().child(0).get(), 1);
+  QVERIFY_EXCEPTION_THROWN(index.update(11, 0), std::out_of_range);
+}
+
+void
+TestTreeIndex::test_random_tree_against_parent_walk() {
+  std::vector<node_t*> nodes;
+  const auto tree{ random_tree(2000, 7u, nodes) };
+  sum_index_t sums{ tree };
+  max_index_t maximums{ tree };
+  QCOMPARE(sums.size(), nodes.size());
+
+  std::mt19937 generator{ 11u };
+  for (size_t query = 0; query < 2000; query++) {
+    const node_t* a{ nodes[generator() % nodes.size()] };
+    const node_t* b{ nodes[generator() % nodes.size()] };
+    const node_t* lca{ parent_walk_lca(a, b) };
+    QCOMPARE(&sums.lowest_common_ancestor(*a, *b), lca);
+
+    int sum{ lca->get() };
+    int maximum{ lca->get() };
+    for (const node_t* node : { a, b }) {
+      for (; node != lca; node = &node->parent()) {
+        sum    += node->get();
+        maximum = std::max(maximum, node->get());
+      }
+    }
+    const auto ia{ sums.index_of(*a) };
+    const auto ib{ sums.index_of(*b) };
+    QCOMPARE(sums.path_query(ia, ib), sum);
+    QCOMPARE(maximums.path_query(ia, ib), maximum);
+
+    const size_t k{ generator() % (sums.depth(ia) + 2) };
+    const node_t* expected{ a };
+    for (size_t level = 0; level < k && expected; level++) {
+      expected = expected->has_parent() ? &expected->parent() : nullptr;
+    }
+    const auto found{ sums.ancestor(ia, k) };
+    QCOMPARE(found == sum_index_t::npos ? nullptr : &sums.node(found), expected);
+  }
+}
+
+void
+TestTreeIndex::test_deep_chain() {
+  int_tree_t tree{ 0 };
+  node_t* node{ &tree.root() };
+  for (int value = 1; value < 5000; value++) {
+    node->add_child(1);
+    node = &node->child(0);
+  }
+  sum_index_t index{ tree };
+  QCOMPARE(index.depth(4999), size_t{ 4999 });
+  QCOMPARE(index.lowest_common_ancestor(4999, 1234), 1234u);
+  QCOMPARE(index.ancestor(4999, 4000), 999u);
+  QCOMPARE(index.path_query(0, 4999), 4999);
+  QCOMPARE(index.path_query(10, 20), 11);
+}
+
+void
+TestTreeIndex::test_empty_tree() {
+  const int_tree_t tree;
+  const sum_index_t index{ tree };
+  QVERIFY(index.empty());
+  QVERIFY_EXCEPTION_THROWN(index.lowest_common_ancestor(0, 0), std::out_of_range);
+}
+
+void
+TestTreeIndex::benchmark_lca_parent_walk() {
+  std::vector<node_t*> nodes;
+  const auto tree{ random_tree(100000, 3u, nodes) };
+  std::mt19937 generator{ 5u };
+  QBENCHMARK {
+    for (size_t query = 0; query < 1000; query++) {
+      const node_t* a{ nodes[generator() % nodes.size()] };
+      const node_t* b{ nodes[generator() % nodes.size()] };
+      QVERIFY(parent_walk_lca(a, b));
+    }
+  }
+}
+
+void
+TestTreeIndex::benchmark_lca_index() {
+  std::vector<node_t*> nodes;
+  const auto tree{ random_tree(100000, 3u, nodes) };
+  // the sum of the values 0..99999 of a subtree doesn't fit in an int
+  const min_index_t index{ tree };
+  std::mt19937 generator{ 5u };
+  std::vector<std::pair<const node_t*, const node_t*>> queries(1000);
+  std::vector<const node_t*> expected;
+  for (auto& query : queries) {
+    query.first  = nodes[generator() % nodes.size()];
+    query.second = nodes[generator() % nodes.size()];
+    expected.push_back(parent_walk_lca(query.first, query.second));
+  }
+  size_t wrong{ 0 };
+  QBENCHMARK {
+    for (size_t query = 0; query < queries.size(); query++) {
+      const node_t& found{
+        index.lowest_common_ancestor(*queries[query].first, *queries[query].second) };
+      wrong += &found != expected[query];
+    }
+  }
+  QCOMPARE(wrong, 0u);
+}
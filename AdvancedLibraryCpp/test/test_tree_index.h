@@ -0,0 +1,26 @@
+#pragma once
+
+#include <QObject>
+#include <QTest>
+
+#include "../structures/tree_index.h"
+
+class TestTreeIndex : public QObject
+{
+  Q_OBJECT
+public:
+  explicit TestTreeIndex(QObject *parent = nullptr);
+
+private slots:
+
+  void test_numbering_and_subtrees();
+  void test_lowest_common_ancestor();
+  void test_ancestor();
+  void test_path_query();
+  void test_update();
+  void test_random_tree_against_parent_walk();
+  void test_deep_chain();
+  void test_empty_tree();
+  void benchmark_lca_parent_walk();
+  void benchmark_lca_index();
+};
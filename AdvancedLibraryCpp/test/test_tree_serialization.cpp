@@ -0,0 +1,391 @@
+#include "test_tree_serialization.h"
+
+#include "../tools/math_operation.h"
+
+#include <cstdio>
+#include <fstream>
+#include <numeric>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace advanced::structures;
+
+namespace {
+
+const std::string tree_path{ "test_tree_serialization.bin" };
+
+using quad_tree_t = tree_t<int, tree_node_t<int, 4>>;
+
+/**
+ * same shape than TestTree::get_test_tree, with null slots
+ *                                    7
+ *  null                   4              null            10
+ *          1        2         5   6              8    9       11    13
+ *            nll nll  3 nll                                       12
+ *
+ * breadth first: 7 4 10 1 2 5 6 8 9 11 13 3 12
+ */
+quad_tree_t
+get_test_tree() {
+  quad_tree_t tree{ 7 };
+  tree.root().insert_at(1, 4);
+  tree.root().insert_at(3, 10);
+  tree.root().child(1).add_child(1);
+  tree.root().child(1).add_child(2);
+  tree.root().child(1).add_child(5);
+  tree.root().child(1).add_child(6);
+  tree.root().child(1).child(1).insert_at(2, 3);
+  tree.root().child(3).add_child(8);
+  tree.root().child(3).add_child(9);
+  tree.root().child(3).add_child(11);
+  tree.root().child(3).add_child(13);
+  tree.root().child(3).child(3).add_child(12);
+  return tree;
+}
+
+/**
+ * breadth first values and, for every node, its slots as -1 for null or the
+ * value of the child
+ */
+template <class tree_type_t>
+std::vector<std::vector<int>>
+shape(const tree_type_t& tree) {
+  std::vector<std::vector<int>> nodes;
+  tree.breadth_first_search([&nodes](const auto& node) {
+    std::vector<int> children{ node.get() };
+    for (size_t slot = 0; slot < node.slot_count(); slot++) {
+      children.push_back(node.has_child(slot) ? node.child(slot).get() : -1);
+    }
+    nodes.push_back(children);
+    return false;
+  });
+  return nodes;
+}
+
+template <class tree_type_t>
+std::vector<int>
+binary_shape(const tree_type_t& tree) {
+  std::vector<int> nodes;
+  tree.breadth_first_search([&nodes](const binary_node_t<int>& node) {
+    nodes.push_back(node.get());
+    nodes.push_back(node.has_left()  ? node.left().get()  : -1);
+    nodes.push_back(node.has_right() ? node.right().get() : -1);
+    return false;
+  });
+  return nodes;
+}
+
+}
+
+TestTreeSerialization::
+TestTreeSerialization(QObject *parent) : QObject{ parent } {
+  QObject::setObjectName("TestTreeSerialization");
+}
+
+void
+TestTreeSerialization::test_rank_select_bits() {
+  std::mt19937 generator{ 3u };
+  for (size_t bits : { 1u, 63u, 64u, 65u, 511u, 512u, 513u, 5000u }) {
+    rank_select_bits_t::builder_t builder;
+    std::vector<bool> expected;
+    for (size_t ii = 0; ii < bits; ii++) {
+      expected.push_back(generator() % 3 == 0);
+      builder.push_back(expected.back());
+    }
+    std::ostringstream out;
+    QCOMPARE(builder.write(out), rank_select_bits_t::bytes_for(bits));
+    const std::string bytes{ out.str() };
+    QCOMPARE(bytes.size(), rank_select_bits_t::bytes_for(bits));
+    std::vector<uint64_t> aligned(bytes.size() / sizeof(uint64_t));
+    std::memcpy(aligned.data(), bytes.data(), bytes.size());
+    const rank_select_bits_t view{ reinterpret_cast<const char*>(aligned.data()), bits };
+
+    size_t ones{ 0 };
+    for (size_t ii = 0; ii < bits; ii++) {
+      QCOMPARE(view[ii], static_cast<bool>(expected[ii]));
+      QCOMPARE(view.rank1(ii), ones);
+      if (expected[ii]) {
+        QCOMPARE(view.select1(ones), ii);
+      }
+      else {
+        QCOMPARE(view.select0(ii - ones), ii);
+      }
+      ones += expected[ii];
+    }
+    QCOMPARE(view.rank1(bits), ones);
+  }
+}
+
+void
+TestTreeSerialization::test_mapped_tree_keeps_null_slots() {
+  const auto tree{ get_test_tree() };
+  save_tree(tree, tree_path);
+  const mapped_tree_t<int> file{ tree_path };
+  using index_t = mapped_tree_t<int>::index_t;
+  constexpr index_t npos{ mapped_tree_t<int>::npos };
+
+  QCOMPARE(file.size(), size_t{ 13 });
+  const std::vector<int> values{ 7, 4, 10, 1, 2, 5, 6, 8, 9, 11, 13, 3, 12 };
+  QCOMPARE(std::vector<int>(file.values(), file.values() + file.size()), values);
+
+  QCOMPARE(file.slot_count(0), size_t{ 4 });
+  QCOMPARE(file.child(0, 0), npos);
+  QCOMPARE(file.child(0, 1), index_t{ 1 });
+  QCOMPARE(file.child(0, 2), npos);
+  QCOMPARE(file.child(0, 3), index_t{ 2 });
+  QCOMPARE(file.child(0, 4), npos);
+  QCOMPARE(file.children_count(0), size_t{ 2 });
+  // node 4 (2) has the slots null, null, 3
+  QCOMPARE(file[4], 2);
+  QCOMPARE(file.slot_count(4), size_t{ 3 });
+  QCOMPARE(file.children_count(4), size_t{ 1 });
+  QCOMPARE(file.child(4, 2), index_t{ 11 });
+  QCOMPARE(file.slot_count(11), size_t{ 0 });
+  QCOMPARE(file.child(10, 0), index_t{ 12 });
+
+  QCOMPARE(file.parent(0), npos);
+  QCOMPARE(file.parent(1), index_t{ 0 });
+  QCOMPARE(file.parent(2), index_t{ 0 });
+  QCOMPARE(file.parent(6), index_t{ 1 });
+  QCOMPARE(file.parent(7), index_t{ 2 });
+  QCOMPARE(file.parent(11), index_t{ 4 });
+  QCOMPARE(file.parent(12), index_t{ 10 });
+  QVERIFY_EXCEPTION_THROWN(file.at(13), std::out_of_range);
+  QVERIFY_EXCEPTION_THROWN(file.slot_count(13), std::out_of_range);
+  std::remove(tree_path.c_str());
+}
+
+void
+TestTreeSerialization::test_round_trip_tree() {
+  const auto tree{ get_test_tree() };
+  save_tree(tree, tree_path);
+
+  quad_tree_t loaded{ 100 };
+  load_tree(mapped_tree_t<int>{ tree_path }, loaded);
+  QCOMPARE(shape(loaded), shape(tree));
+
+  // the same file does not fit in nodes with two children
+  tree_t<int, tree_node_t<int, 2>> narrow;
+  QVERIFY_EXCEPTION_THROWN(load_tree(mapped_tree_t<int>{ tree_path }, narrow),
+                           tree_file_exception_t);
+  QVERIFY(!narrow.has_root());
+  std::remove(tree_path.c_str());
+}
+
+void
+TestTreeSerialization::test_round_trip_aggregated_tree() {
+  using sum_tree_t = tree_t<int, tree_node_t<int, 4, advanced::tools::sum_t<int>>>;
+  save_tree(get_test_tree(), tree_path);
+
+  sum_tree_t loaded;
+  load_tree(mapped_tree_t<int>{ tree_path }, loaded);
+  QCOMPARE(shape(loaded), shape(get_test_tree()));
+  QCOMPARE(loaded.root().aggregate(), 91);
+  QCOMPARE(loaded.root().child(1).aggregate(), 21);
+  QCOMPARE(loaded.root().child(1).child(1).aggregate(), 5);
+  QCOMPARE(loaded.root().child(3).aggregate(), 63);
+  QCOMPARE(loaded.root().child(3).child(3).aggregate(), 25);
+
+  // a long chain loads in linear time, a per insert update would be quadratic
+  constexpr int depth{ 200000 };
+  tree_t<int, tree_node_t<int, 2>> chain{ 1 };
+  auto* node{ &chain.root() };
+  for (int i = 1; i < depth; i++) {
+    node->add_child(1);
+    node = &node->child(0);
+  }
+  save_tree(chain, tree_path);
+  chain.clear();
+
+  tree_t<int, tree_node_t<int, 2, advanced::tools::sum_t<int>>> deep;
+  load_tree(mapped_tree_t<int>{ tree_path }, deep);
+  QCOMPARE(deep.root().aggregate(), depth);
+  QCOMPARE(deep.root().child(0).aggregate(), depth - 1);
+  std::remove(tree_path.c_str());
+}
+
+void
+TestTreeSerialization::test_round_trip_binary_tree() {
+  //        1
+  //    2       3
+  //      4       5
+  //             6
+  binary_tree_t<int> tree{ 1 };
+  tree.add_left(tree.root(), 2);
+  tree.add_right(tree.root(), 3);
+  tree.add_right(tree.root().left(), 4);
+  tree.add_right(tree.root().right(), 5);
+  tree.add_left(tree.root().right().right(), 6);
+  save_tree(tree, tree_path);
+
+  const mapped_tree_t<int> file{ tree_path };
+  QCOMPARE(file.slot_count(1), size_t{ 2 });       // null left, 4
+  QCOMPARE(file.child(1, 1), mapped_tree_t<int>::index_t{ 3 });
+  QCOMPARE(file.slot_count(4), size_t{ 1 });       // only left
+  QCOMPARE(file.slot_count(3), size_t{ 0 });
+
+  binary_tree_t<int> loaded;
+  load_tree(file, loaded);
+  QCOMPARE(binary_shape(loaded), binary_shape(tree));
+
+  quad_tree_t wide;
+  load_tree(file, wide);
+  QCOMPARE(wide.root().child(1).child(1).child(0).get(), 6);
+
+  save_tree(get_test_tree(), tree_path);
+  QVERIFY_EXCEPTION_THROWN(load_tree(mapped_tree_t<int>{ tree_path }, loaded),
+                           tree_file_exception_t);
+  std::remove(tree_path.c_str());
+}
+
+void
+TestTreeSerialization::test_round_trip_avl_tree() {
+  avl_tree_t<int> tree;
+  std::mt19937 generator{ 7u };
+  for (int ii = 0; ii < 10000; ii++) {
+    tree.insert(static_cast<int>(generator() % 100000));
+  }
+  save_tree(tree, tree_path);
+  const mapped_tree_t<int> file{ tree_path };
+  QCOMPARE(file.size(), tree.size());
+
+  avl_tree_t<int> loaded;
+  loaded.insert(-1);
+  load_tree(file, loaded);
+  QCOMPARE(loaded.size(), tree.size());
+  QVERIFY(std::equal(loaded.begin(), loaded.end(), tree.begin(), tree.end()));
+  QVERIFY(loaded.height() <= tree.height());
+
+  // a binary_tree_t keeps the exact shape
+  binary_tree_t<int> shaped;
+  load_tree(file, shaped);
+  QCOMPARE(binary_shape(shaped), binary_shape(tree));
+
+  // the nodes of an order_statistic_tree_t are written the same way
+  order_statistic_tree_t<int> ranked;
+  ranked.rebuild(tree.begin(), tree.end());
+  std::ostringstream ranked_out;
+  std::ostringstream plain_out;
+  write_tree(ranked, ranked_out);
+  write_tree(loaded, plain_out);
+  QCOMPARE(ranked_out.str(), plain_out.str());
+
+  save_tree(ranked, tree_path);
+  order_statistic_tree_t<int> ranked_loaded;
+  load_tree(mapped_tree_t<int>{ tree_path }, ranked_loaded);
+  QCOMPARE(ranked_loaded.size(), tree.size());
+  QCOMPARE(*ranked_loaded.select(tree.size() / 2), *ranked.select(tree.size() / 2));
+  std::remove(tree_path.c_str());
+}
+
+void
+TestTreeSerialization::test_write_to_stream() {
+  const auto tree{ get_test_tree() };
+  std::ostringstream out;
+  write_tree(tree, out);
+  save_tree(tree, tree_path);
+  std::ifstream in{ tree_path, std::ios::binary };
+  const std::string saved{ std::istreambuf_iterator<char>{ in }, { } };
+  QCOMPARE(out.str(), saved);
+  QCOMPARE(out.str().size() % 8, size_t{ 0 });
+  std::remove(tree_path.c_str());
+}
+
+void
+TestTreeSerialization::test_empty_tree() {
+  save_tree(quad_tree_t{ }, tree_path);
+  const mapped_tree_t<int> file{ tree_path };
+  QVERIFY(file.empty());
+  QVERIFY_EXCEPTION_THROWN(file.slot_count(0), std::out_of_range);
+
+  quad_tree_t tree{ 1 };
+  load_tree(file, tree);
+  QVERIFY(!tree.has_root());
+  avl_tree_t<int> avl;
+  avl.insert(1);
+  load_tree(file, avl);
+  QCOMPARE(avl.size(), size_t{ 0 });
+  std::remove(tree_path.c_str());
+}
+
+void
+TestTreeSerialization::test_invalid_files_should_throw() {
+  QVERIFY_EXCEPTION_THROWN(mapped_tree_t<int>{ "missing_tree.bin" },
+                           tree_file_exception_t);
+  {
+    std::ofstream out{ tree_path, std::ios::binary };
+    out << "definitely not a tree file, but long enough to have a header "
+           "and a footer in it, so only the magic numbers reject it";
+  }
+  QVERIFY_EXCEPTION_THROWN(mapped_tree_t<int>{ tree_path }, tree_file_exception_t);
+
+  // other value type
+  save_tree(get_test_tree(), tree_path);
+  QVERIFY_EXCEPTION_THROWN(mapped_tree_t<double>{ tree_path }, tree_file_exception_t);
+
+  // truncated
+  std::string content;
+  {
+    std::ifstream in{ tree_path, std::ios::binary };
+    content.assign(std::istreambuf_iterator<char>{ in }, { });
+  }
+  {
+    std::ofstream out{ tree_path, std::ios::binary | std::ios::trunc };
+    out.write(content.data(), static_cast<std::streamsize>(content.size() - 8));
+  }
+  QVERIFY_EXCEPTION_THROWN(mapped_tree_t<int>{ tree_path }, tree_file_exception_t);
+
+  // wrong number of nodes in the footer
+  content[content.size() - sizeof(tree_file_footer_t)] += 1;
+  {
+    std::ofstream out{ tree_path, std::ios::binary | std::ios::trunc };
+    out.write(content.data(), static_cast<std::streamsize>(content.size()));
+  }
+  QVERIFY_EXCEPTION_THROWN(mapped_tree_t<int>{ tree_path }, tree_file_exception_t);
+  std::remove(tree_path.c_str());
+}
+
+void
+TestTreeSerialization::benchmark_pre_order_encoding() {
+  std::vector<int> values(1000000);
+  std::iota(values.begin(), values.end(), 0);
+  avl_tree_t<int> tree;
+  tree.rebuild(values.begin(), values.end());
+  QBENCHMARK {
+    // one record per node: value and whether it has left and right children,
+    // decoded by inserting each value
+    std::ostringstream out;
+    tree.pre_order([&out](const binary_node_t<int>& node) {
+      const int  value{ node.get() };
+      const char children{ static_cast<char>(node.has_left() | node.has_right() << 1) };
+      out.write(reinterpret_cast<const char*>(&value), sizeof(value));
+      out.write(&children, 1);
+      return false;
+    });
+    const std::string bytes{ out.str() };
+    avl_tree_t<int> loaded;
+    for (size_t position = 0; position < bytes.size(); position += sizeof(int) + 1) {
+      int value;
+      std::memcpy(&value, bytes.data() + position, sizeof(value));
+      loaded.insert(value);
+    }
+    QCOMPARE(loaded.size(), tree.size());
+  }
+}
+
+void
+TestTreeSerialization::benchmark_save_and_load() {
+  std::vector<int> values(1000000);
+  std::iota(values.begin(), values.end(), 0);
+  avl_tree_t<int> tree;
+  tree.rebuild(values.begin(), values.end());
+  QBENCHMARK {
+    save_tree(tree, tree_path);
+    avl_tree_t<int> loaded;
+    load_tree(mapped_tree_t<int>{ tree_path }, loaded);
+    QCOMPARE(loaded.size(), tree.size());
+  }
+  std::remove(tree_path.c_str());
+}
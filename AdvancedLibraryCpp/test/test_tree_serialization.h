@@ -0,0 +1,27 @@
+#pragma once
+
+#include <QObject>
+#include <QTest>
+
+#include "../structures/tree_serialization.h"
+
+class TestTreeSerialization : public QObject
+{
+  Q_OBJECT
+public:
+  explicit TestTreeSerialization(QObject *parent = nullptr);
+
+private slots:
+
+  void test_rank_select_bits();
+  void test_mapped_tree_keeps_null_slots();
+  void test_round_trip_tree();
+  void test_round_trip_aggregated_tree();
+  void test_round_trip_binary_tree();
+  void test_round_trip_avl_tree();
+  void test_write_to_stream();
+  void test_empty_tree();
+  void test_invalid_files_should_throw();
+  void benchmark_pre_order_encoding();
+  void benchmark_save_and_load();
+};
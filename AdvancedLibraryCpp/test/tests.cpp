@@ -12,13 +12,26 @@
 #include "test_wrapper_thread.h"
 #include "test_message_queue.h"
 #include "test_lru_cache.h"
+#include "test_loading_cache.h"
+#include "test_cache_snapshot.h"
 #include "test_semaphore.h"
 #include "test_timer.h"
 #include "test_binary_tree.h"
 #include "test_avl_tree.h"
+#include "test_b_plus_tree.h"
+#include "test_adaptive_radix_tree.h"
+#include "test_flat_tree.h"
+#include "test_compact_avl_tree.h"
+#include "test_concurrent_skip_list.h"
+#include "test_persistent_avl_tree.h"
+#include "test_static_search_tree.h"
+#include "test_interval_tree.h"
 #include "test_timestamp.h"
 #include "test_math.h"
+#include "test_miss_ratio_curve.h"
 #include "test_tree.h"
+#include "test_tree_index.h"
+#include "test_tree_serialization.h"
 #include "test_fenwick_tree.h"
 #include "test_read_csv.h"
 
@@ -327,14 +340,27 @@ main(int argc, char** argv) {
     new TestWrapperThread(),
     new TestMessageQueue(),
     new TestLRUCache(),
+    new TestLoadingCache(),
+    new TestCacheSnapshot(),
     new TestSemaphore(),
     new TestTimer(),
     new TestBinaryTree(),
     new TestAVLTree(),
+    new TestBPlusTree(),
+    new TestAdaptiveRadixTree(),
+    new TestFlatTree(),
+    new TestCompactAVLTree(),
+    new TestConcurrentSkipList(),
+    new TestPersistentAVLTree(),
+    new TestStaticSearchTree(),
+    new TestIntervalTree(),
     new TestTree(),
+    new TestTreeIndex(),
+    new TestTreeSerialization(),
     new TestTimestamp(),
     new TestFenwickTree(),
 	new TestMath(),
+	new TestMissRatioCurve(),
 	new TestReadCsv()
   };
 
@@ -0,0 +1,142 @@
+#pragma once
+#include <cstddef>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define ADVANCED_HAS_MMAP 1
+#endif
+
+namespace advanced {
+namespace tools {
+
+/** @test TestCacheSnapshot in test/test_cache_snapshot(.h|.cpp) */
+
+class mapped_file_exception_t : public std::runtime_error {
+public:
+  mapped_file_exception_t(const std::string& path) :
+    std::runtime_error{ "Unable to map the file: " + path } { }
+};
+
+/**
+ * @brief Read-only view of a whole file. It uses mmap on POSIX systems, so
+ * the pages are loaded on demand by the kernel and nothing is copied, on other
+ * systems the file is read into an internal buffer.
+ */
+class mapped_file_t {
+public:
+  mapped_file_t(const mapped_file_t&)            = delete;  // non-copyable
+  mapped_file_t& operator=(const mapped_file_t&) = delete;  // non-copyable
+
+  /**
+   * @brief mapped_file_t  maps the file at path
+   * @throws mapped_file_exception_t if the file cannot be opened or mapped
+   */
+  explicit mapped_file_t(const std::string& path) {
+#ifdef ADVANCED_HAS_MMAP
+    int fd{ ::open(path.c_str(), O_RDONLY) };
+    if (fd < 0) {
+      throw mapped_file_exception_t{ path };
+    }
+    struct stat info;
+    if (::fstat(fd, &info) != 0) {
+      ::close(fd);
+      throw mapped_file_exception_t{ path };
+    }
+    _size = static_cast<size_t>(info.st_size);
+    if (_size) {
+      void* address{ ::mmap(nullptr, _size, PROT_READ, MAP_PRIVATE, fd, 0) };
+      if (address == MAP_FAILED) {
+        ::close(fd);
+        throw mapped_file_exception_t{ path };
+      }
+      ::madvise(address, _size, MADV_SEQUENTIAL);
+      _data = static_cast<const char*>(address);
+    }
+    ::close(fd);
+#else
+    std::ifstream file{ path, std::ios::binary | std::ios::ate };
+    if (!file) {
+      throw mapped_file_exception_t{ path };
+    }
+    _buffer.resize(static_cast<size_t>(file.tellg()));
+    file.seekg(0);
+    file.read(_buffer.data(), static_cast<std::streamsize>(_buffer.size()));
+    _data = _buffer.data();
+    _size = _buffer.size();
+#endif
+  }
+
+  mapped_file_t(mapped_file_t&& other) noexcept {
+    *this = std::move(other);
+  }
+
+  mapped_file_t&
+  operator=(mapped_file_t&& other) noexcept {
+    unmap();
+    _data   = other._data;
+    _size   = other._size;
+    _buffer = std::move(other._buffer);
+    other._data = nullptr;
+    other._size = 0;
+    return *this;
+  }
+
+  ~mapped_file_t() {
+    unmap();
+  }
+
+  /**
+   * @brief data  first byte of the file
+   */
+  inline const char*
+  data() const noexcept {
+    return _data;
+  }
+
+  /**
+   * @brief size  size of the file in bytes
+   */
+  inline size_t
+  size() const noexcept {
+    return _size;
+  }
+
+  inline const char*
+  begin() const noexcept {
+    return _data;
+  }
+
+  inline const char*
+  end() const noexcept {
+    return _data + _size;
+  }
+
+private:
+
+  void
+  unmap() noexcept {
+#ifdef ADVANCED_HAS_MMAP
+    if (_data) {
+      ::munmap(const_cast<char*>(_data), _size);
+    }
+#endif
+    _data = nullptr;
+    _size = 0;
+    _buffer.clear();
+  }
+
+  const char*       _data{ nullptr };
+  size_t            _size{ 0 };
+  std::vector<char> _buffer;
+};
+
+}
+}
@@ -0,0 +1,254 @@
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <stdexcept>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "../structures/fenwick_tree.h"
+
+namespace advanced {
+namespace tools {
+
+/** @test TestMissRatioCurve in test/test_miss_ratio_curve(.h|.cpp) */
+
+/**
+ * @brief Offline LRU simulator. It replays an access trace and computes the
+ * miss ratio of an LRU cache (like structures::cache_t) for every capacity in a
+ * single pass, so the capacity can be chosen from real data.
+ *
+ * It computes the Mattson stack distance of each access, i.e. the number of
+ * distinct keys referenced since the previous access to the same key: an LRU
+ * cache with capacity c hits iff the distance is lower than or equal to c.
+ * Distances are counted with a fenwick_tree_t over the access timeline, so each
+ * access costs O(log n).
+ *
+ * For very large traces, a sampling rate lower than 1 enables SHARDS (spatially
+ * hashed sampling): only the keys whose hash falls under the rate are
+ * simulated, and their distances are scaled by 1 / rate. The memory used is
+ * proportional to the sampled keys only.
+ *
+ * @see Mattson et al. "Evaluation techniques for storage hierarchies" (1970)
+ * @see Waldspurger et al. "Efficient MRC Construction with SHARDS" (FAST'15)
+ */
+template <typename key_t, typename hash_t = std::hash<key_t>>
+class miss_ratio_curve_t {
+  public:
+
+  /**
+   * @brief miss_ratio_curve_t  constructor
+   * @param sampling_rate  fraction of the keys simulated, in (0, 1]
+   * @throws std::invalid_argument if the sampling rate is out of range
+   */
+  explicit miss_ratio_curve_t(double sampling_rate = 1.0)
+    : _threshold{ static_cast<uint64_t>(sampling_rate * modulus) },
+      _scale{ 1.0 / sampling_rate }
+  {
+    if (!(sampling_rate > 0.0 && sampling_rate <= 1.0)) {
+      throw std::invalid_argument{ "The sampling rate must be in (0, 1]" };
+    }
+    rebuild_timeline(0);
+  }
+
+  /**
+   * @brief access  simulates an access to key
+   */
+  void
+  access(const key_t& key) {
+    _references++;
+    if (!sampled(key)) {
+      return;
+    }
+    _sampled++;
+
+    if (_now + 1 >= _timeline.size()) {
+      compact();
+    }
+    const size_t now{ ++_now };
+    auto it{ _last_access.find(key) };
+    if (it == _last_access.end()) {
+      _cold_misses++;
+      _last_access.emplace(key, now);
+    }
+    else {
+      const size_t previous{ it->second };
+      size_t distance{ 1 };
+      if (previous + 1 < now) {
+        distance += static_cast<size_t>(_timeline.query(previous + 1, now - 1));
+      }
+      const size_t scaled{ static_cast<size_t>(distance * _scale + 0.5) };
+      if (scaled >= _histogram.size()) {
+        _histogram.resize(std::max(scaled + 1, _histogram.size() * 2), 0u);
+      }
+      _histogram[scaled]++;
+      _timeline.update(previous, -1);
+      it->second = now;
+    }
+    _timeline.update(now, 1);
+  }
+
+  /**
+   * @brief replay  simulates all accesses in [first, last)
+   */
+  template <class Iterator>
+  miss_ratio_curve_t&
+  replay(Iterator first, Iterator last) {
+    for (auto it = first; it != last; it++) {
+      access(*it);
+    }
+    return *this;
+  }
+
+  /**
+   * @brief miss_ratio  the miss ratio of an LRU cache with the given capacity
+   */
+  double
+  miss_ratio(size_t capacity) const {
+    if (!_sampled) {
+      return 0.0;
+    }
+    size_t hits{ 0 };
+    const size_t last{ std::min(capacity + 1, _histogram.size()) };
+    for (size_t distance = 1; distance < last; distance++) {
+      hits += _histogram[distance];
+    }
+    return 1.0 - static_cast<double>(hits) / _sampled;
+  }
+
+  /**
+   * @brief curve  the miss ratio for every capacity from 0 to max_capacity
+   * @return vector where the index is the capacity
+   */
+  std::vector<double>
+  curve(size_t max_capacity) const {
+    std::vector<double> result(max_capacity + 1, _sampled ? 1.0 : 0.0);
+    size_t hits{ 0 };
+    for (size_t capacity = 1; _sampled && capacity <= max_capacity; capacity++) {
+      if (capacity < _histogram.size()) {
+        hits += _histogram[capacity];
+      }
+      result[capacity] = 1.0 - static_cast<double>(hits) / _sampled;
+    }
+    return result;
+  }
+
+  /**
+   * @brief capacity_for  the smallest capacity whose miss ratio is lower than
+   * or equal to the target
+   * @return the capacity, or not_found if no capacity reaches the target (the
+   * cold misses can't be avoided)
+   */
+  size_t
+  capacity_for(double target_miss_ratio) const {
+    size_t hits{ 0 };
+    for (size_t capacity = 0; capacity < _histogram.size(); capacity++) {
+      hits += _histogram[capacity];
+      if (1.0 - static_cast<double>(hits) / _sampled <= target_miss_ratio) {
+        return capacity;
+      }
+    }
+    return _sampled ? not_found : 0u;
+  }
+
+  /**
+   * @brief references  number of accesses replayed
+   */
+  inline size_t
+  references() const {
+    return _references;
+  }
+
+  /**
+   * @brief sampled_references  number of accesses simulated
+   */
+  inline size_t
+  sampled_references() const {
+    return _sampled;
+  }
+
+  /**
+   * @brief cold_misses  number of simulated accesses to keys never seen before
+   */
+  inline size_t
+  cold_misses() const {
+    return _cold_misses;
+  }
+
+  /**
+   * @brief distinct_keys  number of distinct keys simulated
+   */
+  inline size_t
+  distinct_keys() const {
+    return _last_access.size();
+  }
+
+  static const size_t not_found{ static_cast<size_t>(-1) };
+
+  private:
+
+  static constexpr uint64_t modulus{ 1ull << 24 };
+
+  /**
+   * splitmix64 finalizer, so identity hashes (std::hash<int>) are sampled
+   * uniformly as well
+   */
+  inline bool
+  sampled(const key_t& key) const {
+    if (_threshold >= modulus) {
+      return true;
+    }
+    uint64_t value{ static_cast<uint64_t>(_hash(key)) };
+    value = (value ^ (value >> 30)) * 0xbf58476d1ce4e5b9ull;
+    value = (value ^ (value >> 27)) * 0x94d049bb133111ebull;
+    value =  value ^ (value >> 31);
+    return (value & (modulus - 1)) < _threshold;
+  }
+
+  /**
+   * It renumbers the last access of every key from 1 to distinct_keys, keeping
+   * their order, so the timeline never grows beyond twice the distinct keys
+   */
+  void
+  compact() {
+    using access_t = typename std::unordered_map<key_t, size_t>::iterator;
+    std::vector<access_t> order;
+    order.reserve(_last_access.size());
+    for (auto it = _last_access.begin(); it != _last_access.end(); it++) {
+      order.push_back(it);
+    }
+    std::sort(order.begin(), order.end(),
+              [](const access_t& a, const access_t& b) {
+      return a->second < b->second;
+    });
+    for (size_t ii = 0; ii < order.size(); ii++) {
+      order[ii]->second = ii + 1;
+    }
+    rebuild_timeline(order.size());
+  }
+
+  /**
+   * It rebuilds the timeline with the first "used" positions marked
+   */
+  void
+  rebuild_timeline(size_t used) {
+    std::vector<long> marks(std::max<size_t>(2 * used, 1024u), 0);
+    std::fill_n(marks.begin(), used, 1);
+    _timeline.rebuild(marks);
+    _now = used;
+  }
+
+  hash_t                                  _hash;
+  const uint64_t                          _threshold;
+  const double                            _scale;
+  structures::fenwick_tree_t<long>        _timeline;
+  std::unordered_map<key_t, size_t>       _last_access;
+  std::vector<size_t>                     _histogram;
+  size_t                                  _now{ 0 };
+  size_t                                  _references{ 0 };
+  size_t                                  _sampled{ 0 };
+  size_t                                  _cold_misses{ 0 };
+};
+
+}
+}
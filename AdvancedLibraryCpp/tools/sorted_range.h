@@ -0,0 +1,36 @@
+#pragma once
+#include <cstddef>
+#include <stdexcept>
+
+namespace advanced {
+namespace tools {
+
+/** @test TestAVLTree in test/test_avl_tree(.h|.cpp) */
+
+/**
+ * @brief count_sorted  number of values in the sorted range [first, last), it
+ * is used by the structures built from a sorted range to validate it
+ * @param keep_duplicates  whether equal neighbours are counted, otherwise each
+ *                         repeated value is counted once
+ * @throws std::invalid_argument if the range is not sorted
+ */
+template <class Iterator>
+size_t
+count_sorted(Iterator first, Iterator last, bool keep_duplicates = false) {
+  size_t count{ 0 };
+  for (auto it = first, previous = first; it != last; previous = it++) {
+    if (it != first) {
+      if (*it < *previous) {
+        throw std::invalid_argument{ "The range is not sorted" };
+      }
+      if (!keep_duplicates && !(*previous < *it)) {
+        continue;
+      }
+    }
+    count++;
+  }
+  return count;
+}
+
+}
+}